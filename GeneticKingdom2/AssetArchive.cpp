@@ -0,0 +1,151 @@
+// archivo de sprites pre-decodificados
+
+#include "AssetArchive.h"
+#include <cstring>
+
+// cada bloque de pixeles arranca alineado, para que el scan0 del bitmap lo este
+const size_t ASSET_ARCHIVE_ALIGNMENT = 16;
+
+namespace {
+
+// "Enemies/Ogre.png"; los nombres son ascii asi que alcanza con truncar cada wchar
+void MakeEntryName(AssetId id, char (&name)[ASSET_ARCHIVE_NAME_SIZE])
+{
+    size_t length = 0;
+    auto append = [&](const wchar_t* text) {
+        for (; *text && length + 1 < ASSET_ARCHIVE_NAME_SIZE; ++text) {
+            name[length++] = static_cast<char>(*text);
+        }
+    };
+    append(GetAssetFolder(id));
+    append(L"/");
+    append(GetAssetFileName(id));
+    memset(name + length, 0, ASSET_ARCHIVE_NAME_SIZE - length);
+}
+
+size_t AlignUp(size_t value)
+{
+    return (value + ASSET_ARCHIVE_ALIGNMENT - 1) & ~(ASSET_ARCHIVE_ALIGNMENT - 1);
+}
+
+} // namespace
+
+AssetArchive::AssetArchive()
+    : base(nullptr)
+{
+    Close();
+}
+
+void AssetArchive::Close()
+{
+    base = nullptr;
+    for (size_t i = 0; i < ASSET_COUNT; ++i) {
+        entries[i] = nullptr;
+    }
+}
+
+bool AssetArchive::Open(const void* data, size_t size, int expectedCellSize)
+{
+    Close();
+    if (!data || size < sizeof(AssetArchiveHeader)) {
+        return false;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    const AssetArchiveHeader* header = reinterpret_cast<const AssetArchiveHeader*>(bytes);
+    if (header->magic != ASSET_ARCHIVE_MAGIC || header->version != ASSET_ARCHIVE_VERSION ||
+        header->cellSize != static_cast<uint32_t>(expectedCellSize)) {
+        return false;
+    }
+    const size_t indexEnd = sizeof(AssetArchiveHeader) + static_cast<size_t>(header->entryCount) * sizeof(AssetArchiveEntry);
+    if (header->entryCount > size / sizeof(AssetArchiveEntry) || indexEnd > size) {
+        return false;
+    }
+
+    char names[ASSET_COUNT][ASSET_ARCHIVE_NAME_SIZE];
+    for (size_t i = 0; i < ASSET_COUNT; ++i) {
+        MakeEntryName(static_cast<AssetId>(i), names[i]);
+    }
+
+    const AssetArchiveEntry* index = reinterpret_cast<const AssetArchiveEntry*>(bytes + sizeof(AssetArchiveHeader));
+    for (uint32_t e = 0; e < header->entryCount; ++e) {
+        const AssetArchiveEntry& entry = index[e];
+        const uint64_t rowBytes = static_cast<uint64_t>(entry.width) * 4;
+        const uint64_t pixelBytes = static_cast<uint64_t>(entry.stride) * entry.height;
+        if (entry.width == 0 || entry.height == 0 || entry.stride < rowBytes || entry.stride % 4 != 0 ||
+            entry.offset % ASSET_ARCHIVE_ALIGNMENT != 0 || entry.offset < indexEnd ||
+            entry.offset > size || pixelBytes > size - entry.offset) {
+            Close();
+            return false;
+        }
+        // entradas con nombres que este build no conoce se ignoran
+        for (size_t i = 0; i < ASSET_COUNT; ++i) {
+            if (!entries[i] && strncmp(entry.name, names[i], ASSET_ARCHIVE_NAME_SIZE) == 0) {
+                entries[i] = &entry;
+                break;
+            }
+        }
+    }
+
+    base = bytes;
+    return true;
+}
+
+const AssetArchiveEntry* AssetArchive::Find(AssetId id) const
+{
+    const size_t index = static_cast<size_t>(id);
+    return index < ASSET_COUNT ? entries[index] : nullptr;
+}
+
+AssetArchiveWriter::AssetArchiveWriter(int cellSize)
+    : cellSize(cellSize)
+{
+}
+
+void AssetArchiveWriter::Add(AssetId id, uint32_t width, uint32_t height, const uint8_t* pixels, size_t stride,
+                             uint64_t sourceStamp)
+{
+    Sprite sprite;
+    sprite.id = id;
+    sprite.width = width;
+    sprite.height = height;
+    sprite.sourceStamp = sourceStamp;
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    sprite.pixels.resize(rowBytes * height);
+    for (uint32_t row = 0; row < height; ++row) {
+        memcpy(&sprite.pixels[row * rowBytes], pixels + row * stride, rowBytes);
+    }
+    sprites.push_back(std::move(sprite));
+}
+
+void AssetArchiveWriter::Write(std::vector<uint8_t>& out) const
+{
+    AssetArchiveHeader header;
+    header.magic = ASSET_ARCHIVE_MAGIC;
+    header.version = ASSET_ARCHIVE_VERSION;
+    header.cellSize = static_cast<uint32_t>(cellSize);
+    header.entryCount = static_cast<uint32_t>(sprites.size());
+
+    std::vector<AssetArchiveEntry> index(sprites.size());
+    size_t offset = AlignUp(sizeof(AssetArchiveHeader) + index.size() * sizeof(AssetArchiveEntry));
+    for (size_t i = 0; i < sprites.size(); ++i) {
+        MakeEntryName(sprites[i].id, index[i].name);
+        index[i].width = sprites[i].width;
+        index[i].height = sprites[i].height;
+        index[i].stride = sprites[i].width * 4;
+        index[i].reserved = 0;
+        index[i].offset = offset;
+        index[i].sourceStamp = sprites[i].sourceStamp;
+        offset = AlignUp(offset + sprites[i].pixels.size());
+    }
+
+    out.assign(offset, 0);
+    memcpy(out.data(), &header, sizeof(header));
+    if (!index.empty()) {
+        memcpy(out.data() + sizeof(header), index.data(), index.size() * sizeof(AssetArchiveEntry));
+    }
+    for (size_t i = 0; i < sprites.size(); ++i) {
+        if (!sprites[i].pixels.empty()) {
+            memcpy(out.data() + index[i].offset, sprites[i].pixels.data(), sprites[i].pixels.size());
+        }
+    }
+}
@@ -0,0 +1,93 @@
+/*
+ * assetarchive.h - todos los sprites en un solo archivo, ya decodificados
+ *
+ * --pack-assets decodifica cada png una vez, lo escala al tamaño en que se
+ * dibuja y guarda los pixeles en 32 bits premultiplicados (el PARGB de gdi+,
+ * bytes b g r a). el juego mapea el archivo y arma los bitmaps encima de
+ * esos bytes, sin decodificar ni copiar nada.
+ *
+ * formato (little endian, todo alineado):
+ *   AssetArchiveHeader
+ *   AssetArchiveEntry x entryCount   (el indice)
+ *   pixeles de cada entrada, cada bloque alineado a 16 bytes
+ * las entradas se buscan por nombre ("Enemies/Ogre.png") y no por el numero
+ * del AssetId, asi un archivo viejo no da sprites cruzados si cambia el enum.
+ * cada entrada guarda la fecha del png que se horneo, para que el loader
+ * note si despues alguien cambio el png y no re-empaqueto.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "AssetCache.h"
+
+const uint32_t ASSET_ARCHIVE_MAGIC = 0x41504b47; // "GKPA"
+const uint32_t ASSET_ARCHIVE_VERSION = 2;
+const size_t ASSET_ARCHIVE_NAME_SIZE = 48;
+
+struct AssetArchiveHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t cellSize;    // CELL_SIZE con que se horneo; si cambia hay que re-empaquetar
+    uint32_t entryCount;
+};
+
+struct AssetArchiveEntry {
+    char name[ASSET_ARCHIVE_NAME_SIZE]; // carpeta/archivo, terminado en cero
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;      // bytes por fila
+    uint32_t reserved;
+    uint64_t offset;      // desde el inicio del archivo
+    uint64_t sourceStamp; // ultima escritura del png horneado (FILETIME), 0 si no se sabe
+};
+
+// lee un archivo que ya esta en memoria (mapeado). no copia nada: los
+// punteros que devuelve apuntan adentro de data
+class AssetArchive {
+public:
+    AssetArchive();
+
+    // valida cabecera, indice y rangos; false si el archivo no sirve
+    bool Open(const void* data, size_t size, int expectedCellSize);
+    void Close();
+    bool IsOpen() const { return base != nullptr; }
+
+    // la entrada del asset, o nullptr si el archivo no lo tiene
+    const AssetArchiveEntry* Find(AssetId id) const;
+    const uint8_t* GetPixels(const AssetArchiveEntry& entry) const { return base + entry.offset; }
+
+private:
+    const uint8_t* base;
+    const AssetArchiveEntry* entries[ASSET_COUNT];
+};
+
+// arma el archivo en memoria; lo usa el empaquetador
+class AssetArchiveWriter {
+public:
+    explicit AssetArchiveWriter(int cellSize);
+
+    // pixels en PARGB, filas de stride bytes (se copian). sourceStamp es la
+    // fecha del png de donde salio, se guarda tal cual
+    void Add(AssetId id, uint32_t width, uint32_t height, const uint8_t* pixels, size_t stride,
+             uint64_t sourceStamp);
+
+    size_t GetEntryCount() const { return sprites.size(); }
+
+    // el archivo entero, listo para escribir a disco
+    void Write(std::vector<uint8_t>& out) const;
+
+private:
+    struct Sprite {
+        AssetId id;
+        uint32_t width;
+        uint32_t height;
+        uint64_t sourceStamp;
+        std::vector<uint8_t> pixels; // filas de width * 4 bytes, sin relleno
+    };
+
+    int cellSize;
+    std::vector<Sprite> sprites;
+};
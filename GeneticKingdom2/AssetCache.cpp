@@ -0,0 +1,166 @@
+// cache de sprites del proceso
+
+#include "AssetCache.h"
+
+const wchar_t* GetAssetFolder(AssetId id)
+{
+    switch (id) {
+    case AssetId::ENEMY_OGRE:
+    case AssetId::ENEMY_DARK_ELF:
+    case AssetId::ENEMY_HARPY:
+    case AssetId::ENEMY_MERCENARY:
+        return L"Enemies";
+    case AssetId::PROJECTILE_ARROW:
+    case AssetId::PROJECTILE_FIREBALL:
+    case AssetId::PROJECTILE_CANNONBALL:
+    case AssetId::PROJECTILE_FIREARROW:
+    case AssetId::PROJECTILE_PURPLEFIREBALL:
+    case AssetId::PROJECTILE_NUKEBOMB:
+        return L"Projectiles";
+    default:
+        return L"Towers";
+    }
+}
+
+const wchar_t* GetAssetFileName(AssetId id)
+{
+    switch (id) {
+    case AssetId::ENEMY_OGRE: return L"Ogre.png";
+    case AssetId::ENEMY_DARK_ELF: return L"DarkElf.png";
+    case AssetId::ENEMY_HARPY: return L"Harpy.png";
+    case AssetId::ENEMY_MERCENARY: return L"Mercenary.png";
+    case AssetId::TOWER_ARCHER_1: return L"Archerlvl1.png";
+    case AssetId::TOWER_ARCHER_2: return L"Archerlvl2.png";
+    case AssetId::TOWER_ARCHER_3: return L"Archerlvl3.png";
+    case AssetId::TOWER_MAGE_1: return L"Magelvl1.png";
+    case AssetId::TOWER_MAGE_2: return L"Magelvl2.png";
+    case AssetId::TOWER_MAGE_3: return L"Magelvl3.png";
+    case AssetId::TOWER_GUNNER_1: return L"Gunnerlvl1.png";
+    case AssetId::TOWER_GUNNER_2: return L"Gunnerlvl2.png";
+    case AssetId::TOWER_GUNNER_3: return L"Gunnerlvl3.png";
+    case AssetId::TOWER_CONSTRUCTION: return L"Construction.png";
+    case AssetId::PROJECTILE_ARROW: return L"Arrow.png";
+    case AssetId::PROJECTILE_FIREBALL: return L"Fireball.png";
+    case AssetId::PROJECTILE_CANNONBALL: return L"Bomb.png";
+    case AssetId::PROJECTILE_FIREARROW: return L"FireArrow.png";
+    case AssetId::PROJECTILE_PURPLEFIREBALL: return L"PurpleFireball.png";
+    case AssetId::PROJECTILE_NUKEBOMB: return L"NukeBomb.png";
+    default: return L"";
+    }
+}
+
+int GetAssetDrawSize(AssetId id, int cellSize)
+{
+    switch (id) {
+    case AssetId::ENEMY_OGRE:
+    case AssetId::ENEMY_DARK_ELF:
+    case AssetId::ENEMY_HARPY:
+    case AssetId::ENEMY_MERCENARY:
+        return (cellSize * 3 + 2) / 4;  // 0.75 de la celda, redondeado
+    case AssetId::PROJECTILE_ARROW:
+    case AssetId::PROJECTILE_FIREBALL:
+    case AssetId::PROJECTILE_CANNONBALL:
+    case AssetId::PROJECTILE_FIREARROW:
+    case AssetId::PROJECTILE_PURPLEFIREBALL:
+    case AssetId::PROJECTILE_NUKEBOMB:
+        return 15;
+    case AssetId::TOWER_ARCHER_1:
+    case AssetId::TOWER_ARCHER_2:
+    case AssetId::TOWER_ARCHER_3:
+    case AssetId::TOWER_MAGE_1:
+    case AssetId::TOWER_MAGE_2:
+    case AssetId::TOWER_MAGE_3:
+    case AssetId::TOWER_GUNNER_1:
+    case AssetId::TOWER_GUNNER_2:
+    case AssetId::TOWER_GUNNER_3:
+    case AssetId::TOWER_CONSTRUCTION:
+    default:
+        return cellSize;  // la celda entera
+    }
+}
+
+AssetCache& AssetCache::Instance()
+{
+    static AssetCache cache;
+    return cache;
+}
+
+AssetCache::AssetCache()
+{
+    for (size_t i = 0; i < ASSET_COUNT; ++i) {
+        handles[i] = nullptr;
+        attempted[i] = false;
+    }
+}
+
+// si el juego no llamo a Clear antes de apagar gdi+ esto llega tarde; por eso
+// el loader de gdi+ se saca en wWinMain y aca normalmente no queda nada
+AssetCache::~AssetCache()
+{
+    Clear();
+}
+
+std::unique_ptr<AssetLoader> AssetCache::SetLoader(std::unique_ptr<AssetLoader> newLoader)
+{
+    Clear();
+    std::unique_ptr<AssetLoader> previous = std::move(loader);
+    loader = std::move(newLoader);
+    return previous;
+}
+
+void* AssetCache::Get(AssetId id)
+{
+    stats.requests++;
+    const size_t index = static_cast<size_t>(id);
+    if (index >= ASSET_COUNT) {
+        return nullptr;
+    }
+    if (!attempted[index] && loader) {
+        attempted[index] = true;
+        stats.loads++;
+        handles[index] = loader->Load(id);
+        if (!handles[index]) {
+            stats.failures++;
+        }
+    }
+    return handles[index];
+}
+
+void AssetCache::Clear()
+{
+    for (size_t i = 0; i < ASSET_COUNT; ++i) {
+        if (handles[i] && loader) {
+            loader->Free(static_cast<AssetId>(i), handles[i]);
+        }
+        handles[i] = nullptr;
+        attempted[i] = false;
+    }
+}
+
+MemoryAssetLoader::MemoryAssetLoader()
+    : loadCount(0)
+{
+    for (size_t i = 0; i < ASSET_COUNT; ++i) {
+        handles[i] = nullptr;
+    }
+}
+
+void MemoryAssetLoader::Set(AssetId id, void* handle)
+{
+    const size_t index = static_cast<size_t>(id);
+    if (index < ASSET_COUNT) {
+        handles[index] = handle;
+    }
+}
+
+void* MemoryAssetLoader::Load(AssetId id)
+{
+    loadCount++;
+    const size_t index = static_cast<size_t>(id);
+    return index < ASSET_COUNT ? handles[index] : nullptr;
+}
+
+void MemoryAssetLoader::Free(AssetId, void*)
+{
+    // los punteros son de quien los paso con Set
+}
@@ -0,0 +1,121 @@
+/*
+ * assetcache.h - cada sprite se decodifica una sola vez en todo el proceso
+ *
+ * antes cada Enemy (y cada copia que hace el GA), cada Tower y cada disparo
+ * cargaba su png con Image::FromFile probando varias rutas, y nadie lo
+ * liberaba. aca hay un solo cache por proceso, indexado por AssetId: el
+ * primero que pide un sprite lo carga y todos los demas reciben el mismo
+ * puntero. el cache es el dueño y lo suelta en Clear (antes de apagar gdi+).
+ *
+ * quien decodifica es un AssetLoader. el juego instala GdiplusAssetLoader;
+ * sin loader (headless) Get devuelve nullptr y cada clase dibuja su
+ * rectangulo de siempre. MemoryAssetLoader sirve para pruebas: entrega
+ * punteros que le dieron y cuenta cuantas veces le pidieron cargar.
+ * se usa desde el hilo del juego (dibujar).
+ */
+
+#pragma once
+
+#include <memory>
+#include <cstddef>
+
+enum class AssetId {
+    ENEMY_OGRE,
+    ENEMY_DARK_ELF,
+    ENEMY_HARPY,
+    ENEMY_MERCENARY,
+    TOWER_ARCHER_1,
+    TOWER_ARCHER_2,
+    TOWER_ARCHER_3,
+    TOWER_MAGE_1,
+    TOWER_MAGE_2,
+    TOWER_MAGE_3,
+    TOWER_GUNNER_1,
+    TOWER_GUNNER_2,
+    TOWER_GUNNER_3,
+    TOWER_CONSTRUCTION,
+    PROJECTILE_ARROW,
+    PROJECTILE_FIREBALL,
+    PROJECTILE_CANNONBALL,
+    PROJECTILE_FIREARROW,
+    PROJECTILE_PURPLEFIREBALL,
+    PROJECTILE_NUKEBOMB,
+    COUNT
+};
+
+const size_t ASSET_COUNT = static_cast<size_t>(AssetId::COUNT);
+
+// carpeta dentro de Assets y nombre del archivo, por ejemplo L"Enemies" y L"Ogre.png"
+const wchar_t* GetAssetFolder(AssetId id);
+const wchar_t* GetAssetFileName(AssetId id);
+
+// lado en pixeles con que se dibuja cada sprite (Enemy::Draw, Tower::Draw y
+// ProjectileManager::DrawProjectiles); el empaquetador los hornea a este tamaño
+int GetAssetDrawSize(AssetId id, int cellSize);
+
+// decodifica assets. lo que devuelve Load es opaco para el cache (para el
+// loader de gdi+ es un Gdiplus::Image*) y vuelve a Free cuando se suelta
+class AssetLoader {
+public:
+    virtual ~AssetLoader() {}
+    virtual void* Load(AssetId id) = 0;
+    virtual void Free(AssetId id, void* handle) = 0;
+};
+
+class AssetCache {
+public:
+    struct Stats {
+        unsigned long long requests = 0;  // Get
+        unsigned long long loads = 0;     // veces que se llamo al loader (lo unico que toca disco)
+        unsigned long long failures = 0;  // loads que no encontraron nada
+    };
+
+    // el cache del proceso
+    static AssetCache& Instance();
+
+    ~AssetCache();
+
+    // cambia quien decodifica. suelta todo lo cargado con el anterior y lo devuelve
+    std::unique_ptr<AssetLoader> SetLoader(std::unique_ptr<AssetLoader> newLoader);
+
+    // el asset, cargado la primera vez; nullptr si no hay loader o no existe.
+    // un asset que fallo no se vuelve a intentar hasta el proximo Clear
+    void* Get(AssetId id);
+
+    template <typename T>
+    T* GetAs(AssetId id) { return static_cast<T*>(Get(id)); }
+
+    // suelta todos los assets (con el loader que los cargo)
+    void Clear();
+
+    const Stats& GetStats() const { return stats; }
+    void ResetStats() { stats = Stats(); }
+
+private:
+    AssetCache();
+    AssetCache(const AssetCache&) = delete;
+    AssetCache& operator=(const AssetCache&) = delete;
+
+    std::unique_ptr<AssetLoader> loader;
+    void* handles[ASSET_COUNT];
+    bool attempted[ASSET_COUNT];
+
+    Stats stats;
+};
+
+// loader en memoria para builds headless y pruebas: Load devuelve lo que se
+// le paso con Set (no es dueño) y cuenta las llamadas
+class MemoryAssetLoader : public AssetLoader {
+public:
+    MemoryAssetLoader();
+
+    void Set(AssetId id, void* handle);
+    size_t GetLoadCount() const { return loadCount; }
+
+    void* Load(AssetId id) override;
+    void Free(AssetId id, void* handle) override;
+
+private:
+    void* handles[ASSET_COUNT];
+    size_t loadCount;
+};
@@ -0,0 +1,89 @@
+// empaquetador de sprites
+
+#include "framework.h"
+#include "AssetPacker.h"
+#include "AssetArchive.h"
+#include "GdiplusAssetLoader.h"
+#include "MappedAssetLoader.h"
+#include <vector>
+
+namespace AssetPacker {
+
+namespace {
+
+bool WriteBytes(const std::wstring& path, const std::vector<uint8_t>& bytes)
+{
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    DWORD written = 0;
+    BOOL ok = WriteFile(file, bytes.data(), static_cast<DWORD>(bytes.size()), &written, NULL);
+    CloseHandle(file);
+    return ok && written == bytes.size();
+}
+
+} // namespace
+
+bool Pack(int cellSize, std::wstring& outputPath)
+{
+    GdiplusAssetLoader loader;
+    AssetArchiveWriter writer(cellSize);
+    WCHAR debugMsg[512];
+
+    for (size_t i = 0; i < ASSET_COUNT; ++i) {
+        const AssetId id = static_cast<AssetId>(i);
+        Gdiplus::Image* image = static_cast<Gdiplus::Image*>(loader.Load(id));
+        if (!image) {
+            continue;
+        }
+
+        // Load deja en la base de trabajo la carpeta de donde salio el png
+        const std::wstring sourcePath = loader.GetWorkingBase() + GetAssetFolder(id) + L"\\" + GetAssetFileName(id);
+        const int side = GetAssetDrawSize(id, cellSize);
+        Gdiplus::Bitmap baked(side, side, PixelFormat32bppPARGB);
+        {
+            // igual que en los Draw, para que el sprite horneado sea el que se veia
+            Gdiplus::Graphics graphics(&baked);
+            graphics.Clear(Gdiplus::Color(0, 0, 0, 0));
+            graphics.SetSmoothingMode(Gdiplus::SmoothingModeHighQuality);
+            graphics.SetInterpolationMode(Gdiplus::InterpolationModeHighQualityBicubic);
+            graphics.DrawImage(image, Gdiplus::Rect(0, 0, side, side),
+                               0, 0, image->GetWidth(), image->GetHeight(), Gdiplus::UnitPixel);
+        }
+
+        Gdiplus::Rect rect(0, 0, side, side);
+        Gdiplus::BitmapData data;
+        if (baked.LockBits(&rect, Gdiplus::ImageLockModeRead, PixelFormat32bppPARGB, &data) == Gdiplus::Ok) {
+            if (data.Stride > 0) {
+                writer.Add(id, side, side, static_cast<const uint8_t*>(data.Scan0), static_cast<size_t>(data.Stride),
+                           GdiplusAssetLoader::GetFileStamp(sourcePath));
+            }
+            baked.UnlockBits(&data);
+        }
+        loader.Free(id, image);
+    }
+
+    if (writer.GetEntryCount() == 0) {
+        OutputDebugStringW(L"No se encontro ningun sprite para empaquetar\n");
+        return false;
+    }
+    if (outputPath.empty()) {
+        outputPath = loader.GetWorkingBase() + ASSET_ARCHIVE_FILE_NAME;
+    }
+
+    std::vector<uint8_t> bytes;
+    writer.Write(bytes);
+    if (!WriteBytes(outputPath, bytes)) {
+        swprintf_s(debugMsg, L"No se pudo escribir %s (el juego lo tiene abierto?)\n", outputPath.c_str());
+        OutputDebugStringW(debugMsg);
+        return false;
+    }
+
+    swprintf_s(debugMsg, L"Empaquetados %zu de %zu sprites en %s (%zu bytes)\n",
+               writer.GetEntryCount(), ASSET_COUNT, outputPath.c_str(), bytes.size());
+    OutputDebugStringW(debugMsg);
+    return true;
+}
+
+}
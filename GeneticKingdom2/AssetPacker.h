@@ -0,0 +1,20 @@
+/*
+ * assetpacker.h - arma Sprites.pak a partir de los png (modo --pack-assets)
+ *
+ * carga cada png con GdiplusAssetLoader, lo dibuja al tamaño exacto en que
+ * lo dibuja el juego (GetAssetDrawSize) con la misma interpolacion que usan
+ * los Draw y guarda el resultado en PARGB, junto con la fecha del png. es un
+ * paso offline: hay que volver a correrlo si cambian los png o CELL_SIZE. el
+ * juego ignora un archivo de otro CELL_SIZE, y cada sprite cuyo png cambio
+ * despues de empaquetar lo saca del png.
+ */
+
+#pragma once
+
+#include <string>
+
+namespace AssetPacker {
+    // empaqueta todos los sprites que encuentre. si outputPath viene vacio se
+    // escribe en la carpeta Assets donde estan los png y se devuelve ahi la ruta
+    bool Pack(int cellSize, std::wstring& outputPath);
+}
@@ -0,0 +1,2782 @@
+/*
+ * benchmark.cpp - mediciones headless de las partes calientes del juego
+ *
+ * cada benchmark compara la implementacion vieja (copiada aqui tal cual para
+ * tener una referencia honesta) contra la nueva, sobre el mismo mapa.
+ * no es ciencia espacial, solo QueryPerformanceCounter y contadores.
+ */
+
+#include "framework.h"
+#include "Benchmark.h"
+#include "Map.h"
+#include "RouteTable.h"
+#include "SurrogateFitness.h"
+#include "Enemy.h"
+#include "Projectile.h"
+#include "Economy.h"
+#include "Tower.h"
+#include "SpatialHash.h"
+#include "TowerCoverage.h"
+#include "TargetKernel.h"
+#include "AssetCache.h"
+#include "AssetArchive.h"
+#include "AssetPacker.h"
+#include "GdiplusAssetLoader.h"
+#include "MappedAssetLoader.h"
+#include <vector>
+#include <queue>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cfloat>
+#include <cmath>
+#include <random>
+
+namespace {
+    // cronometro simple con el contador de alta resolucion de windows
+    class Stopwatch {
+    public:
+        Stopwatch() {
+            QueryPerformanceFrequency(&frequency);
+            QueryPerformanceCounter(&start);
+        }
+
+        double ElapsedSeconds() const {
+            LARGE_INTEGER now;
+            QueryPerformanceCounter(&now);
+            return static_cast<double>(now.QuadPart - start.QuadPart) / static_cast<double>(frequency.QuadPart);
+        }
+
+    private:
+        LARGE_INTEGER frequency;
+        LARGE_INTEGER start;
+    };
+
+    // escribe una linea al debugger y al archivo de resultados
+    void Report(const std::wstring& line) {
+        OutputDebugStringW((line + L"\n").c_str());
+        std::wofstream file("benchmark_results.txt", std::ios::app);
+        if (file) {
+            file << line << L"\n";
+        }
+    }
+
+    // chequeos de correccion de los benchmarks. el que falla se anota y RunAll
+    // devuelve cuantos fallaron, asi --benchmark sale con error
+    int g_failedChecks = 0;
+
+    bool Check(bool ok, const wchar_t* what) {
+        if (!ok) {
+            g_failedChecks++;
+            Report(std::wstring(L"  FALLO: ") + what);
+        }
+        return ok;
+    }
+
+    // allocator que cuenta cuantas veces se pide memoria, para medir la version vieja
+    size_t g_countedAllocations = 0;
+
+    template <typename T>
+    struct CountingAllocator {
+        typedef T value_type;
+
+        CountingAllocator() {}
+        template <typename U> CountingAllocator(const CountingAllocator<U>&) {}
+
+        T* allocate(size_t n) {
+            g_countedAllocations++;
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+        void deallocate(T* p, size_t) {
+            ::operator delete(p);
+        }
+    };
+
+    template <typename T, typename U>
+    bool operator==(const CountingAllocator<T>&, const CountingAllocator<U>&) { return true; }
+    template <typename T, typename U>
+    bool operator!=(const CountingAllocator<T>&, const CountingAllocator<U>&) { return false; }
+
+    template <typename T>
+    using CountedVector = std::vector<T, CountingAllocator<T>>;
+
+    /*
+     * el a* original de Map::GetPath, tal cual estaba antes del PathFinder
+     * (matrices de vectores y priority_queue nuevas en cada llamada), solo que
+     * con el allocator contador y usando la api publica del mapa
+     */
+    struct LegacyNode {
+        int row, col;
+        float gCost, hCost, fCost;
+        std::pair<int, int> parent;
+
+        LegacyNode(int r, int c, float g, float h, std::pair<int, int> p)
+            : row(r), col(c), gCost(g), hCost(h), fCost(g + h), parent(p) {}
+
+        bool operator>(const LegacyNode& other) const {
+            return fCost > other.fCost;
+        }
+    };
+
+    bool IsLegacyBlocked(const Map& map, int r, int c) {
+        return map.IsCellOccupied(r, c) ||
+               map.IsCellTemporarilyObstructed(r, c) ||
+               map.IsConstructionSpot(r, c) ||
+               map.HasTower(r, c);
+    }
+
+    std::vector<std::pair<int, int>> LegacyGetPath(const Map& map, std::pair<int, int> startCell, std::pair<int, int> endCell) {
+        int numRows = map.GetNumRows();
+        int numCols = map.GetNumCols();
+        std::vector<std::pair<int, int>> path;
+
+        std::priority_queue<LegacyNode, CountedVector<LegacyNode>, std::greater<LegacyNode>> openList;
+        CountedVector<CountedVector<float>> gCosts(numRows, CountedVector<float>(numCols, FLT_MAX));
+        CountedVector<CountedVector<std::pair<int, int>>> parents(numRows, CountedVector<std::pair<int, int>>(numCols, std::make_pair(-1, -1)));
+        CountedVector<CountedVector<bool>> closedList(numRows, CountedVector<bool>(numCols, false));
+
+        openList.push(LegacyNode(startCell.first, startCell.second, 0.0f,
+                                 PathFinder::Heuristic(startCell.first, startCell.second, endCell.first, endCell.second), std::make_pair(-1, -1)));
+        gCosts[startCell.first][startCell.second] = 0.0f;
+
+        int dr[] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+        int dc[] = { 0, 0, -1, 1, -1, 1, -1, 1 };
+        float moveCost[] = { 1.0f, 1.0f, 1.0f, 1.0f, PATH_DIAGONAL_COST, PATH_DIAGONAL_COST, PATH_DIAGONAL_COST, PATH_DIAGONAL_COST };
+
+        while (!openList.empty()) {
+            LegacyNode currentNode = openList.top();
+            openList.pop();
+            int r = currentNode.row;
+            int c = currentNode.col;
+            if (closedList[r][c]) continue;
+            closedList[r][c] = true;
+
+            if (r == endCell.first && c == endCell.second) {
+                std::pair<int, int> currentPathNode = endCell;
+                while (currentPathNode.first != -1) {
+                    path.push_back(currentPathNode);
+                    if (currentPathNode == startCell) break;
+                    currentPathNode = parents[currentPathNode.first][currentPathNode.second];
+                }
+                std::reverse(path.begin(), path.end());
+                return path;
+            }
+
+            for (int i = 0; i < 8; ++i) {
+                int nextR = r + dr[i];
+                int nextC = c + dc[i];
+                if (nextR >= 0 && nextR < numRows && nextC >= 0 && nextC < numCols &&
+                    !IsLegacyBlocked(map, nextR, nextC) && !closedList[nextR][nextC]) {
+                    float tentativeGCost = gCosts[r][c] + moveCost[i];
+                    if (tentativeGCost < gCosts[nextR][nextC]) {
+                        parents[nextR][nextC] = std::make_pair(r, c);
+                        gCosts[nextR][nextC] = tentativeGCost;
+                        float hCost = PathFinder::Heuristic(nextR, nextC, endCell.first, endCell.second);
+                        openList.push(LegacyNode(nextR, nextC, tentativeGCost, hCost, std::make_pair(r, c)));
+                    }
+                }
+            }
+        }
+        return path;
+    }
+}
+
+namespace Benchmark {
+
+int RunAll() {
+    Report(L"==== GeneticKingdom2 benchmarks ====");
+    g_failedChecks = 0;
+
+    Map map;
+    map.Initialize(1920, 1080);
+    map.SetPathCacheEnabled(false); // los benchmarks de busqueda repiten la misma consulta, queremos medir el a*
+    std::pair<int, int> entry = std::make_pair(map.GetNumRows() / 2, 0);
+    std::pair<int, int> bridge = map.GetBridgeGridLocation();
+
+    std::wstringstream wss;
+    wss << L"Mapa: " << map.GetNumRows() << L"x" << map.GetNumCols() << L" celdas";
+    Report(wss.str());
+
+    RunPathfinding(map, entry, bridge, 5000);
+    RunDistanceField(map, 2000);
+    RunJumpPointSearch(map, 2000);
+    RunDiversePaths(map, 200);
+    RunIncrementalReplanning(map, 2000);
+    RunHierarchical(map, 2000, 50);
+    RunLandmarkHeuristic(map, 5000);
+    RunPathSmoothing(map, 2000);
+    RunRouteSharing(map, 20000);
+    RunPathCache(map, 50, 20);
+    RunConnectivity(map, 20);
+    RunOpenLists(1000, 20);
+    RunParallelAlternatives(map, 200);
+    RunTimeSlicing(600, PATH_REQUEST_BUDGET_US);
+    RunThreatMap(200, 300);
+    RunSurrogateFitness(100000);
+    RunPredictiveHits(200, 4000, 600);
+    RunLargeSteps(60, 14);
+    RunSpatialHash(60, 2000);
+    RunTowerCoverage(60);
+    RunTargetKernel(60);
+    RunProjectilePool(100000, 600);
+    RunAssetCache(200);
+    RunAssetArchive(100);
+    RunPassabilityScaling(1000);
+
+    wss.str(L"");
+    wss << L"==== fin: " << g_failedChecks << L" chequeo(s) fallado(s) ====";
+    Report(wss.str());
+    return g_failedChecks;
+}
+
+/*
+ * mide consultas por segundo y pedidos de memoria por consulta del a*
+ * de entrada al puente, version vieja contra PathFinder. tambien verifica
+ * que los dos devuelvan exactamente el mismo camino.
+ */
+void RunPathfinding(const Map& map, std::pair<int, int> entry, std::pair<int, int> bridge, int numQueries) {
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(2);
+    wss << L"[pathfinding] " << numQueries << L" consultas entrada->puente";
+    Report(wss.str());
+
+    // version vieja
+    g_countedAllocations = 0;
+    size_t legacyLength = 0;
+    Stopwatch legacyWatch;
+    for (int i = 0; i < numQueries; ++i) {
+        legacyLength += LegacyGetPath(map, entry, bridge).size();
+    }
+    double legacySeconds = legacyWatch.ElapsedSeconds();
+    size_t legacyAllocations = g_countedAllocations;
+
+    // version nueva, con un vector de salida reutilizado y el scratch ya caliente
+    std::vector<std::pair<int, int>> path;
+    map.GetPath(entry, bridge, path);
+    unsigned long long allocationsBefore = map.GetPathStats().scratchAllocations;
+    size_t pathCapacityBefore = path.capacity();
+
+    size_t newLength = 0;
+    Stopwatch newWatch;
+    for (int i = 0; i < numQueries; ++i) {
+        map.GetPath(entry, bridge, path);
+        newLength += path.size();
+    }
+    double newSeconds = newWatch.ElapsedSeconds();
+    unsigned long long newAllocations = map.GetPathStats().scratchAllocations - allocationsBefore;
+    if (path.capacity() != pathCapacityBefore) newAllocations++;
+
+    bool samePath = Check(LegacyGetPath(map, entry, bridge) == path, L"pathfinding: el a* nuevo da otro camino");
+
+    wss.str(L"");
+    wss << L"  antes:   " << (numQueries / legacySeconds) << L" consultas/s, "
+        << (static_cast<double>(legacyAllocations) / numQueries) << L" allocs/consulta";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  despues: " << (numQueries / newSeconds) << L" consultas/s, "
+        << (static_cast<double>(newAllocations) / numQueries) << L" allocs/consulta";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  speedup: " << (legacySeconds / newSeconds) << L"x, mismo camino: " << (samePath ? L"si" : L"NO")
+        << L", largo medio: " << (static_cast<double>(newLength) / numQueries)
+        << L" (viejo " << (static_cast<double>(legacyLength) / numQueries) << L")";
+    Report(wss.str());
+}
+
+/*
+ * oleada de numEnemies enemigos saliendo de celdas libres al azar (semilla
+ * fija): a* por enemigo contra un solo campo de distancias + bajar por el.
+ * despues mide cuanto cuesta poner al dia el campo cuando se bloquea una
+ * celda del camino, contra tirarlo y reconstruirlo
+ */
+void RunDistanceField(Map& map, int numEnemies) {
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(2);
+    wss << L"[distance field] " << numEnemies << L" enemigos hacia el puente";
+    Report(wss.str());
+
+    std::pair<int, int> bridge = map.GetBridgeGridLocation();
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> rowDist(0, map.GetNumRows() - 1);
+    std::uniform_int_distribution<int> colDist(0, map.GetNumCols() - 1);
+    std::vector<std::pair<int, int>> starts;
+    starts.reserve(numEnemies);
+    while (static_cast<int>(starts.size()) < numEnemies) {
+        int r = rowDist(rng);
+        int c = colDist(rng);
+        if (!IsLegacyBlocked(map, r, c)) {
+            starts.push_back(std::make_pair(r, c));
+        }
+    }
+
+    // un a* por enemigo
+    std::vector<std::pair<int, int>> path;
+    size_t aStarSteps = 0;
+    Stopwatch aStarWatch;
+    for (const auto& start : starts) {
+        map.GetPath(start, bridge, path);
+        aStarSteps += path.size();
+    }
+    double aStarSeconds = aStarWatch.ElapsedSeconds();
+
+    // campo compartido: forzamos una reconstruccion y todos bajan por el
+    unsigned long long fullBuildsBefore = map.GetBridgeFieldStats().fullBuilds;
+    map.LoadConstructionSpots();
+    size_t fieldSteps = 0;
+    Stopwatch fieldWatch;
+    for (const auto& start : starts) {
+        map.GetPathToBridge(start, path);
+        fieldSteps += path.size();
+    }
+    double fieldSeconds = fieldWatch.ElapsedSeconds();
+    unsigned long long fullBuilds = map.GetBridgeFieldStats().fullBuilds - fullBuildsBefore;
+
+    wss.str(L"");
+    wss << L"  a* por enemigo: " << (aStarSeconds * 1000.0) << L" ms, " << aStarSteps << L" pasos";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  campo:          " << (fieldSeconds * 1000.0) << L" ms, " << fieldSteps << L" pasos, "
+        << fullBuilds << L" dijkstra(s) completo(s), speedup " << (aStarSeconds / fieldSeconds) << L"x";
+    Report(wss.str());
+
+    // bloquear/desbloquear una celda del camino principal, que es el peor caso
+    // porque invalida a todos los que pasaban por ahi
+    std::pair<int, int> entry = std::make_pair(map.GetNumRows() / 2, 0);
+    map.GetPathToBridge(entry, path);
+    if (path.size() < 3) {
+        Report(L"  (no hay camino para probar la actualizacion incremental)");
+        return;
+    }
+    std::pair<int, int> toggled = path[path.size() / 2];
+    const int toggles = 200;
+
+    unsigned long long settledBefore = map.GetBridgeFieldStats().cellsSettled;
+    Stopwatch incrementalWatch;
+    for (int i = 0; i < toggles; ++i) {
+        map.SetCellOccupied(toggled.first, toggled.second, (i % 2) == 0);
+        map.GetDistanceToBridge(entry.first, entry.second);
+    }
+    double incrementalSeconds = incrementalWatch.ElapsedSeconds();
+    unsigned long long incrementalSettled = map.GetBridgeFieldStats().cellsSettled - settledBefore;
+
+    settledBefore = map.GetBridgeFieldStats().cellsSettled;
+    Stopwatch rebuildWatch;
+    for (int i = 0; i < toggles; ++i) {
+        map.LoadConstructionSpots(); // marca el campo para reconstruccion completa
+        map.GetDistanceToBridge(entry.first, entry.second);
+    }
+    double rebuildSeconds = rebuildWatch.ElapsedSeconds();
+    unsigned long long rebuildSettled = map.GetBridgeFieldStats().cellsSettled - settledBefore;
+    map.SetCellOccupied(toggled.first, toggled.second, false);
+
+    wss.str(L"");
+    wss << L"  incremental: " << (incrementalSeconds * 1e6 / toggles) << L" us/cambio, "
+        << (static_cast<double>(incrementalSettled) / toggles) << L" celdas/cambio";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  completo:    " << (rebuildSeconds * 1e6 / toggles) << L" us/cambio (incluye recargar spots), "
+        << (static_cast<double>(rebuildSettled) / toggles) << L" celdas/cambio";
+    Report(wss.str());
+}
+
+/*
+ * compara a* contra jps sobre las mismas consultas. ademas del tiempo cuenta
+ * nodos expandidos (los que salen del heap) y celdas escaneadas por los
+ * saltos, porque jps cambia heap por escaneos lineales y hay que ver las dos
+ * cosas. verifica que los largos de camino coincidan.
+ */
+namespace {
+    struct AlgorithmRun {
+        double seconds = 0.0;
+        unsigned long long nodesExpanded = 0;
+        unsigned long long cellsScanned = 0;
+        double totalCost = 0.0;
+        int found = 0;
+    };
+
+    template <typename BlockedFn>
+    AlgorithmRun RunQueries(PathFinder& finder, const std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>>& queries,
+                            BlockedFn isBlocked, std::vector<float>& costs) {
+        AlgorithmRun run;
+        std::vector<std::pair<int, int>> path;
+        costs.clear();
+        finder.ResetStats();
+        Stopwatch watch;
+        for (const auto& query : queries) {
+            bool found = finder.FindPath(query.first, query.second, isBlocked, path);
+            float cost = found ? PathFinder::PathCost(path) : -1.0f;
+            costs.push_back(cost);
+            if (found) {
+                run.found++;
+                run.totalCost += cost;
+            }
+        }
+        run.seconds = watch.ElapsedSeconds();
+        run.nodesExpanded = finder.GetStats().nodesExpanded;
+        run.cellsScanned = finder.GetStats().cellsScanned;
+        return run;
+    }
+
+    template <typename BlockedFn>
+    void CompareAlgorithms(const std::wstring& label, int rows, int cols, BlockedFn isBlocked,
+                           const std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>>& queries) {
+        PathFinder finder;
+        finder.Resize(rows, cols);
+        std::vector<float> aStarCosts;
+        std::vector<float> jpsCosts;
+
+        finder.SetAlgorithm(PathAlgorithm::ASTAR);
+        AlgorithmRun aStar = RunQueries(finder, queries, isBlocked, aStarCosts);
+        finder.SetAlgorithm(PathAlgorithm::JPS);
+        AlgorithmRun jps = RunQueries(finder, queries, isBlocked, jpsCosts);
+
+        int mismatches = 0;
+        for (size_t i = 0; i < queries.size(); ++i) {
+            if (std::fabs(aStarCosts[i] - jpsCosts[i]) > 1e-2f) mismatches++;
+        }
+
+        double n = static_cast<double>(queries.size());
+        std::wstringstream wss;
+        wss << std::fixed << std::setprecision(2);
+        wss << L"  " << label << L" (" << rows << L"x" << cols << L", " << queries.size() << L" consultas, "
+            << aStar.found << L" con ruta)";
+        Report(wss.str());
+        wss.str(L"");
+        wss << L"    a*:  " << (aStar.seconds * 1000.0 / n) << L" ms/consulta, "
+            << (aStar.nodesExpanded / n) << L" nodos/consulta";
+        Report(wss.str());
+        wss.str(L"");
+        wss << L"    jps: " << (jps.seconds * 1000.0 / n) << L" ms/consulta, "
+            << (jps.nodesExpanded / n) << L" nodos/consulta, " << (jps.cellsScanned / n) << L" celdas escaneadas/consulta";
+        Report(wss.str());
+        wss.str(L"");
+        wss << L"    speedup " << (aStar.seconds / jps.seconds) << L"x, largos distintos: " << mismatches
+            << (Check(mismatches == 0, L"jps: largos distintos de a*") ? L"" : L" (MAL)");
+        Report(wss.str());
+    }
+
+    std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> RandomQueries(int rows, int cols, int count,
+                                                                                const std::vector<uint8_t>& blocked, std::mt19937& rng) {
+        std::uniform_int_distribution<int> rowDist(0, rows - 1);
+        std::uniform_int_distribution<int> colDist(0, cols - 1);
+        std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> queries;
+        while (static_cast<int>(queries.size()) < count) {
+            std::pair<int, int> a(rowDist(rng), colDist(rng));
+            std::pair<int, int> b(rowDist(rng), colDist(rng));
+            if (!blocked[a.first * cols + a.second] && !blocked[b.first * cols + b.second]) {
+                queries.push_back(std::make_pair(a, b));
+            }
+        }
+        return queries;
+    }
+}
+
+void RunJumpPointSearch(Map& map, int numQueries) {
+    Report(L"[jps] a* vs jump point search");
+    std::mt19937 rng(4321);
+
+    // mapa del juego, tal como lo ve GetPath
+    {
+        int rows = map.GetNumRows();
+        int cols = map.GetNumCols();
+        std::vector<uint8_t> blocked(static_cast<size_t>(rows) * cols, 0);
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < cols; ++c) {
+                blocked[r * cols + c] = IsLegacyBlocked(map, r, c) ? 1 : 0;
+            }
+        }
+        auto isBlocked = [&blocked, cols](int r, int c) { return blocked[r * cols + c] != 0; };
+        CompareAlgorithms(L"mapa del juego", rows, cols, isBlocked, RandomQueries(rows, cols, numQueries, blocked, rng));
+    }
+
+    // 1000x1000 con obstaculos sueltos (20%) y con paredes largas con huecos,
+    // que es donde jps brilla de verdad
+    const int bigSide = 1000;
+    const int bigQueries = 20;
+    {
+        std::vector<uint8_t> blocked(static_cast<size_t>(bigSide) * bigSide, 0);
+        std::uniform_int_distribution<int> percent(0, 99);
+        for (auto& cell : blocked) cell = percent(rng) < 20 ? 1 : 0;
+        auto isBlocked = [&blocked, bigSide](int r, int c) { return blocked[r * bigSide + c] != 0; };
+        CompareAlgorithms(L"sintetico ruido 20%", bigSide, bigSide, isBlocked, RandomQueries(bigSide, bigSide, bigQueries, blocked, rng));
+    }
+    {
+        std::vector<uint8_t> blocked(static_cast<size_t>(bigSide) * bigSide, 0);
+        std::uniform_int_distribution<int> gapDist(0, bigSide - 1);
+        for (int c = 50; c < bigSide; c += 50) {
+            int gap = gapDist(rng);
+            for (int r = 0; r < bigSide; ++r) {
+                if (std::abs(r - gap) > 2) blocked[r * bigSide + c] = 1;
+            }
+        }
+        auto isBlocked = [&blocked, bigSide](int r, int c) { return blocked[r * bigSide + c] != 0; };
+        CompareAlgorithms(L"sintetico paredes", bigSide, bigSide, isBlocked, RandomQueries(bigSide, bigSide, bigQueries, blocked, rng));
+    }
+
+    // y por ultimo a traves del mapa, para confirmar que el switch funciona
+    PathAlgorithm previous = map.GetPathfindingAlgorithm();
+    std::pair<int, int> entry = std::make_pair(map.GetNumRows() / 2, 0);
+    std::vector<std::pair<int, int>> aStarPath;
+    std::vector<std::pair<int, int>> jpsPath;
+    map.SetPathfindingAlgorithm(PathAlgorithm::ASTAR);
+    map.GetPath(entry, map.GetBridgeGridLocation(), aStarPath);
+    map.SetPathfindingAlgorithm(PathAlgorithm::JPS);
+    map.GetPath(entry, map.GetBridgeGridLocation(), jpsPath);
+    map.SetPathfindingAlgorithm(previous);
+
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(3);
+    wss << L"  Map::GetPath entrada->puente: a* " << PathFinder::PathCost(aStarPath)
+        << L", jps " << PathFinder::PathCost(jpsPath);
+    Report(wss.str());
+}
+
+/*
+ * mete cada vez mas torres y obstaculos temporales en un mapa nuevo y mide el
+ * a* entrada->puente con dos chequeos de bloqueo: el viejo (que buscaba en la
+ * lista de obstaculos y recorria todas las torres por cada vecino) y el de la
+ * capa de bits. lo que importa es el tiempo por nodo expandido, que con la
+ * capa deberia quedarse plano
+ */
+void RunPassabilityScaling(int numQueries) {
+    Report(L"[passability] a* con torres y obstaculos creciendo");
+
+    Map map;
+    map.Initialize(1920, 1080);
+    map.SetPathCacheEnabled(false);
+    std::pair<int, int> entry = std::make_pair(map.GetNumRows() / 2, 0);
+    std::pair<int, int> bridge = map.GetBridgeGridLocation();
+    std::vector<std::pair<int, int>> spots = map.GetConstructionSpots();
+
+    std::vector<std::pair<int, int>> towerCells;
+    std::vector<std::pair<int, int>> obstacleCells;
+    std::mt19937 rng(99);
+    std::uniform_int_distribution<int> rowDist(0, map.GetNumRows() - 1);
+    std::uniform_int_distribution<int> colDist(0, map.GetNumCols() - 1);
+    TowerType towerTypes[] = { TowerType::ARCHER, TowerType::MAGE, TowerType::GUNNER };
+
+    // el chequeo de antes, con listas lineales como estaban en el mapa y el TowerManager
+    auto legacyBlocked = [&](int r, int c) {
+        return map.IsCellOccupied(r, c) ||
+               std::find(obstacleCells.begin(), obstacleCells.end(), std::make_pair(r, c)) != obstacleCells.end() ||
+               map.IsConstructionSpot(r, c) ||
+               std::find(towerCells.begin(), towerCells.end(), std::make_pair(r, c)) != towerCells.end();
+    };
+
+    PathFinder legacyFinder;
+    legacyFinder.Resize(map.GetNumRows(), map.GetNumCols());
+    std::vector<std::pair<int, int>> path;
+
+    const int levels[] = { 0, 50, 100, 200, 400 };
+    for (int level : levels) {
+        // torres en los spots que haya
+        while (static_cast<int>(towerCells.size()) < level && towerCells.size() < spots.size()) {
+            const auto& spot = spots[towerCells.size()];
+            if (map.BuildTowerAt(towerTypes[towerCells.size() % 3], spot.first, spot.second)) {
+                towerCells.push_back(spot);
+            } else {
+                break;
+            }
+        }
+        // obstaculos sueltos, pero sin cerrar el camino al puente
+        int attempts = 0;
+        while (static_cast<int>(obstacleCells.size()) < level && attempts < level * 20) {
+            attempts++;
+            std::pair<int, int> cell(rowDist(rng), colDist(rng));
+            if (cell == entry || cell == bridge || map.IsCellOccupied(cell.first, cell.second) ||
+                map.IsConstructionSpot(cell.first, cell.second) || map.IsCellTemporarilyObstructed(cell.first, cell.second)) {
+                continue;
+            }
+            map.AddTemporaryObstacle(cell.first, cell.second);
+            if (map.GetDistanceToBridge(entry.first, entry.second) == FLT_MAX) {
+                map.RemoveTemporaryObstacle(cell.first, cell.second);
+                continue;
+            }
+            obstacleCells.push_back(cell);
+        }
+
+        legacyFinder.ResetStats();
+        Stopwatch legacyWatch;
+        for (int i = 0; i < numQueries; ++i) {
+            legacyFinder.FindPath(entry, bridge, legacyBlocked, path);
+        }
+        double legacySeconds = legacyWatch.ElapsedSeconds();
+        double legacyNodes = static_cast<double>(legacyFinder.GetStats().nodesExpanded);
+
+        unsigned long long nodesBefore = map.GetPathStats().nodesExpanded;
+        Stopwatch layerWatch;
+        for (int i = 0; i < numQueries; ++i) {
+            map.GetPath(entry, bridge, path);
+        }
+        double layerSeconds = layerWatch.ElapsedSeconds();
+        double layerNodes = static_cast<double>(map.GetPathStats().nodesExpanded - nodesBefore);
+
+        std::wstringstream wss;
+        wss << std::fixed << std::setprecision(2);
+        wss << L"  torres " << towerCells.size() << L", obstaculos " << obstacleCells.size() << L": "
+            << L"antes " << (legacySeconds * 1e6 / numQueries) << L" us/consulta ("
+            << (legacyNodes > 0 ? legacySeconds * 1e9 / legacyNodes : 0.0) << L" ns/nodo), "
+            << L"capa " << (layerSeconds * 1e6 / numQueries) << L" us/consulta ("
+            << (layerNodes > 0 ? layerSeconds * 1e9 / layerNodes : 0.0) << L" ns/nodo)";
+        Report(wss.str());
+    }
+}
+
+namespace {
+    // lo que hacia GenerateAlternativePaths antes: optimo, carril de arriba,
+    // carril de abajo y zigzag, cada uno con sus obstaculos temporales y un a*
+    void LegacyAlternativePaths(Map& map, std::pair<int, int> entry, std::pair<int, int> bridge,
+                                std::vector<std::vector<std::pair<int, int>>>& outPaths) {
+        outPaths.clear();
+        int nRows = map.GetNumRows();
+        int nCols = map.GetNumCols();
+        int h_sup_r1 = nRows / 4 - 1; int h_sup_r2 = nRows / 4;
+        int h_mid_r = nRows / 2;
+        int h_inf_r1 = 3 * nRows / 4; int h_inf_r2 = 3 * nRows / 4 + 1;
+        int bridgeStartCol = nCols - nCols / 10;
+        int bridgeTopRow = (nRows - nRows / 10) / 2;
+        int bridgeHeight = nRows / 10;
+
+        auto addObstacle = [&](int r, int c) {
+            if (r < 0 || r >= nRows || c < 0 || c >= nCols) return;
+            if (r == entry.first && c == entry.second) return;
+            if (c >= bridgeStartCol && r >= bridgeTopRow && r < bridgeTopRow + bridgeHeight) return;
+            map.AddTemporaryObstacle(r, c);
+        };
+        auto addIfNew = [&](const std::vector<std::pair<int, int>>& path) {
+            if (path.empty()) return;
+            for (const auto& existing : outPaths) {
+                if (existing == path) return;
+            }
+            outPaths.push_back(path);
+        };
+
+        addIfNew(map.GetPath(entry, bridge));
+
+        map.ClearTemporaryObstacles();
+        for (int c = nCols / 4; c <= 3 * nCols / 4; c += 2) {
+            for (int r = h_mid_r; r <= h_inf_r1; ++r) { addObstacle(r, c); addObstacle(r, c + 1); }
+        }
+        addIfNew(map.GetPath(entry, bridge));
+
+        map.ClearTemporaryObstacles();
+        for (int c = nCols / 4; c <= 3 * nCols / 4; c += 2) {
+            for (int r = h_sup_r1; r <= h_mid_r; ++r) { addObstacle(r, c); addObstacle(r, c + 1); }
+        }
+        addIfNew(map.GetPath(entry, bridge));
+
+        map.ClearTemporaryObstacles();
+        int blockStartCol = nCols / 4;
+        for (int c = blockStartCol; c <= 3 * nCols / 4; c += 6) {
+            bool even = (c % 12 == blockStartCol % 12);
+            for (int k = 0; k <= 2; ++k) {
+                addObstacle(even ? h_sup_r1 : h_sup_r2, c + k);
+                addObstacle(even ? h_inf_r2 : h_inf_r1, c + 3 + k);
+            }
+        }
+        addIfNew(map.GetPath(entry, bridge));
+        map.ClearTemporaryObstacles();
+    }
+
+    // solapamiento medio entre todos los pares de rutas (0 = nada en comun)
+    double MeanPairwiseOverlap(PathFinder& finder, const std::vector<std::vector<std::pair<int, int>>>& paths) {
+        double total = 0.0;
+        int pairs = 0;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            for (size_t j = i + 1; j < paths.size(); ++j) {
+                total += finder.PathOverlap(paths[i], paths[j]);
+                pairs++;
+            }
+        }
+        return pairs > 0 ? total / pairs : 0.0;
+    }
+}
+
+void RunDiversePaths(Map& map, int repetitions) {
+    Report(L"[diverse paths] rutas alternativas para el GA");
+    std::pair<int, int> entry = std::make_pair(map.GetNumRows() / 2, 0);
+    std::pair<int, int> bridge = map.GetBridgeGridLocation();
+    std::vector<std::vector<std::pair<int, int>>> paths;
+
+    PathFinder overlapFinder;
+    overlapFinder.Resize(map.GetNumRows(), map.GetNumCols());
+
+    Stopwatch legacyWatch;
+    for (int i = 0; i < repetitions; ++i) {
+        LegacyAlternativePaths(map, entry, bridge, paths);
+    }
+    double legacySeconds = legacyWatch.ElapsedSeconds();
+
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(3);
+    wss << L"  hileras + a*: " << (legacySeconds * 1000.0 / repetitions) << L" ms, "
+        << paths.size() << L" rutas, solapamiento medio " << MeanPairwiseOverlap(overlapFinder, paths);
+    Report(wss.str());
+
+    const int counts[] = { 4, 16 };
+    for (int k : counts) {
+        DiversePathOptions options;
+        options.maxPaths = k;
+        unsigned long long searchesBefore = map.GetParallelPathStats().searches;
+        Stopwatch watch;
+        for (int i = 0; i < repetitions; ++i) {
+            map.GetAlternativePathsParallel(entry, bridge, options, paths);
+        }
+        double seconds = watch.ElapsedSeconds();
+        double searches = static_cast<double>(map.GetParallelPathStats().searches - searchesBefore) / repetitions;
+
+        float worstStretch = 1.0f;
+        if (!paths.empty()) {
+            float optimal = PathFinder::PathCost(paths[0]);
+            for (const auto& path : paths) {
+                worstStretch = (std::max)(worstStretch, PathFinder::PathCost(path) / optimal);
+            }
+        }
+
+        wss.str(L"");
+        wss << L"  k=" << k << L" capas: " << (seconds * 1000.0 / repetitions) << L" ms, "
+            << paths.size() << L" rutas, " << searches << L" busquedas, solapamiento medio "
+            << MeanPairwiseOverlap(overlapFinder, paths) << L", la mas larga " << worstStretch << L"x la optima";
+        Report(wss.str());
+    }
+}
+
+/*
+ * pone y quita obstaculos temporales de a uno (semilla fija) y despues de
+ * cada cambio pide el camino entrada->puente dos veces: con lpa*, que repara,
+ * y con el a* normal, que empieza de cero. compara nodos expandidos, tiempo
+ * y que el largo del camino sea el mismo
+ */
+void RunIncrementalReplanning(Map& map, int numChanges) {
+    Report(L"[incremental] lpa* vs a* desde cero con cambios de una celda");
+    std::pair<int, int> entry = std::make_pair(map.GetNumRows() / 2, 0);
+    std::pair<int, int> bridge = map.GetBridgeGridLocation();
+
+    std::mt19937 rng(777);
+    std::uniform_int_distribution<int> rowDist(0, map.GetNumRows() - 1);
+    std::uniform_int_distribution<int> colDist(0, map.GetNumCols() - 1);
+
+    std::vector<std::pair<int, int>> incrementalPath;
+    std::vector<std::pair<int, int>> scratchPath;
+    map.ClearTemporaryObstacles();
+    map.GetPathIncremental(entry, bridge, incrementalPath); // arbol inicial, no cuenta
+
+    unsigned long long incrementalNodesBefore = map.GetIncrementalPlannerStats().nodesExpanded;
+    unsigned long long scratchNodesBefore = map.GetPathStats().nodesExpanded;
+    double incrementalSeconds = 0.0;
+    double scratchSeconds = 0.0;
+    int mismatches = 0;
+
+    for (int i = 0; i < numChanges; ++i) {
+        std::pair<int, int> cell(rowDist(rng), colDist(rng));
+        if (cell == entry || cell == bridge || map.IsConstructionSpot(cell.first, cell.second)) {
+            continue;
+        }
+        if (map.IsCellTemporarilyObstructed(cell.first, cell.second)) {
+            map.RemoveTemporaryObstacle(cell.first, cell.second);
+        } else {
+            map.AddTemporaryObstacle(cell.first, cell.second);
+        }
+
+        Stopwatch incrementalWatch;
+        bool incrementalFound = map.GetPathIncremental(entry, bridge, incrementalPath);
+        incrementalSeconds += incrementalWatch.ElapsedSeconds();
+
+        Stopwatch scratchWatch;
+        bool scratchFound = map.GetPath(entry, bridge, scratchPath);
+        scratchSeconds += scratchWatch.ElapsedSeconds();
+
+        if (incrementalFound != scratchFound ||
+            (incrementalFound && std::fabs(PathFinder::PathCost(incrementalPath) - PathFinder::PathCost(scratchPath)) > 1e-2f)) {
+            mismatches++;
+        }
+    }
+    map.ClearTemporaryObstacles();
+
+    double incrementalNodes = static_cast<double>(map.GetIncrementalPlannerStats().nodesExpanded - incrementalNodesBefore);
+    double scratchNodes = static_cast<double>(map.GetPathStats().nodesExpanded - scratchNodesBefore);
+
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(2);
+    wss << L"  " << numChanges << L" cambios de una celda (obstaculos temporales)";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  lpa*:  " << (incrementalSeconds * 1e6 / numChanges) << L" us/cambio, "
+        << (incrementalNodes / numChanges) << L" nodos/cambio";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  a*:    " << (scratchSeconds * 1e6 / numChanges) << L" us/cambio, "
+        << (scratchNodes / numChanges) << L" nodos/cambio";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  speedup " << (scratchSeconds / incrementalSeconds) << L"x, largos distintos: " << mismatches
+        << (Check(mismatches == 0, L"replanificacion: largos distintos de a*") ? L"" : L" (MAL)");
+    Report(wss.str());
+}
+
+/*
+ * mapa grande inventado (los mapas custom que queremos soportar): bloques
+ * rectangulares de obstaculos tirados al azar. se compara el a* plano contra
+ * hpa* completo y contra hpa* refinando solo el primer tramo, que es lo que
+ * un enemigo necesita para empezar a caminar. al final se ponen y quitan
+ * celdas y se mide recalcular solo los clusters tocados vs armar todo otra vez
+ */
+void RunHierarchical(Map& map, int side, int numQueries) {
+    Report(L"[hpa*] a* plano vs pathfinding jerarquico");
+    std::mt19937 rng(2024);
+
+    std::vector<uint8_t> blocked(static_cast<size_t>(side) * side, 0);
+    std::uniform_int_distribution<int> posDist(0, side - 1);
+    std::uniform_int_distribution<int> sizeDist(2, 12);
+    for (int i = 0; i < side * side / 300; ++i) {
+        int top = posDist(rng), left = posDist(rng);
+        int height = sizeDist(rng), width = sizeDist(rng);
+        for (int r = top; r < (std::min)(top + height, side); ++r) {
+            for (int c = left; c < (std::min)(left + width, side); ++c) {
+                blocked[r * side + c] = 1;
+            }
+        }
+    }
+    auto isBlocked = [&blocked, side](int r, int c) { return blocked[r * side + c] != 0; };
+    std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> queries = RandomQueries(side, side, numQueries, blocked, rng);
+
+    HierarchicalPathFinder hierarchy;
+    Stopwatch buildWatch;
+    hierarchy.Build(&blocked, side, side, HPA_CLUSTER_SIZE);
+    double buildSeconds = buildWatch.ElapsedSeconds();
+
+    PathFinder finder;
+    finder.Resize(side, side);
+    std::vector<std::pair<int, int>> flatPath;
+    std::vector<std::pair<int, int>> hierarchicalPath;
+    HierarchicalPathFinder::Route route;
+    double flatSeconds = 0.0, hierarchicalSeconds = 0.0, firstSegmentSeconds = 0.0;
+    double flatCost = 0.0, hierarchicalCost = 0.0;
+    int found = 0, mismatches = 0;
+
+    for (const auto& query : queries) {
+        Stopwatch flatWatch;
+        bool flatFound = finder.FindPath(query.first, query.second, isBlocked, flatPath);
+        flatSeconds += flatWatch.ElapsedSeconds();
+
+        Stopwatch hierarchicalWatch;
+        bool hierarchicalFound = hierarchy.FindPath(query.first, query.second, hierarchicalPath);
+        hierarchicalSeconds += hierarchicalWatch.ElapsedSeconds();
+
+        Stopwatch routeWatch;
+        hierarchy.FindRoute(query.first, query.second, route);
+        firstSegmentSeconds += routeWatch.ElapsedSeconds();
+
+        if (flatFound != hierarchicalFound) {
+            mismatches++;
+        } else if (flatFound) {
+            found++;
+            flatCost += PathFinder::PathCost(flatPath);
+            hierarchicalCost += PathFinder::PathCost(hierarchicalPath);
+        }
+    }
+
+    double n = static_cast<double>(queries.size());
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(2);
+    wss << L"  " << side << L"x" << side << L", clusters de " << HPA_CLUSTER_SIZE << L": " << hierarchy.GetClusterCount()
+        << L" clusters, " << hierarchy.GetEntranceCount() << L" entradas, armado " << (buildSeconds * 1000.0) << L" ms";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  a* plano:        " << (flatSeconds * 1000.0 / n) << L" ms/consulta, "
+        << (finder.GetStats().nodesExpanded / n) << L" nodos/consulta";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  hpa* completo:   " << (hierarchicalSeconds * 1000.0 / n) << L" ms/consulta";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  hpa* 1er tramo:  " << (firstSegmentSeconds * 1000.0 / n) << L" ms/consulta, "
+        << (hierarchy.GetStats().abstractNodesExpanded / (2.0 * n)) << L" nodos abstractos/consulta";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  largo hpa*/a*: " << std::setprecision(3) << (found > 0 ? hierarchicalCost / flatCost : 0.0)
+        << L", rutas encontradas distinto: " << mismatches
+        << (Check(mismatches == 0, L"hpa*: encuentra rutas distinto que a*") ? L"" : L" (MAL)");
+    Report(wss.str());
+
+    // cambios de una celda: solo se recalculan los clusters que tocan
+    const int changes = 500;
+    Stopwatch updateWatch;
+    for (int i = 0; i < changes; ++i) {
+        int r = posDist(rng), c = posDist(rng);
+        blocked[r * side + c] ^= 1;
+        hierarchy.MarkCellChanged(r, c);
+        hierarchy.Refresh();
+    }
+    double updateSeconds = updateWatch.ElapsedSeconds();
+    Stopwatch rebuildWatch;
+    hierarchy.Build(&blocked, side, side, HPA_CLUSTER_SIZE);
+    double rebuildSeconds = rebuildWatch.ElapsedSeconds();
+
+    wss.str(L"");
+    wss << std::setprecision(2);
+    wss << L"  " << changes << L" cambios: " << (updateSeconds * 1e6 / changes) << L" us/cambio actualizando clusters, "
+        << (rebuildSeconds * 1000.0) << L" ms reconstruyendo todo";
+    Report(wss.str());
+
+    // y a traves del mapa del juego, para confirmar que el cableado funciona
+    std::pair<int, int> entry = std::make_pair(map.GetNumRows() / 2, 0);
+    std::vector<std::pair<int, int>> aStarPath;
+    map.GetPath(entry, map.GetBridgeGridLocation(), aStarPath);
+    map.GetPathHierarchical(entry, map.GetBridgeGridLocation(), hierarchicalPath);
+    wss.str(L"");
+    wss << std::setprecision(3);
+    wss << L"  Map::GetPathHierarchical entrada->puente: a* " << PathFinder::PathCost(aStarPath)
+        << L", hpa* " << PathFinder::PathCost(hierarchicalPath);
+    Report(wss.str());
+}
+
+/*
+ * entrada->puente y consultas al azar sobre el mapa del juego, primero con la
+ * euclidiana y despues con alt, por el mismo Map::GetPath. el largo tiene que
+ * dar igual (las dos son admisibles), lo que cambia es cuanto se expande
+ */
+void RunLandmarkHeuristic(Map& map, int numQueries) {
+    Report(L"[alt] heuristica euclidiana vs landmarks");
+    int rows = map.GetNumRows();
+    int cols = map.GetNumCols();
+    std::pair<int, int> entry = std::make_pair(rows / 2, 0);
+    std::pair<int, int> bridge = map.GetBridgeGridLocation();
+
+    std::vector<uint8_t> blocked(static_cast<size_t>(rows) * cols, 0);
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            blocked[r * cols + c] = IsLegacyBlocked(map, r, c) ? 1 : 0;
+        }
+    }
+    std::mt19937 rng(8080);
+    std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> queries = RandomQueries(rows, cols, numQueries, blocked, rng);
+
+    bool previous = map.IsLandmarkHeuristicEnabled();
+    std::vector<std::pair<int, int>> path;
+
+    struct HeuristicRun {
+        double bridgeSeconds = 0.0;
+        double randomSeconds = 0.0;
+        double bridgeNodes = 0.0;
+        double randomNodes = 0.0;
+        std::vector<float> costs;
+    };
+    auto measure = [&](HeuristicRun& run) {
+        unsigned long long nodesBefore = map.GetPathStats().nodesExpanded;
+        Stopwatch bridgeWatch;
+        for (int i = 0; i < numQueries; ++i) {
+            map.GetPath(entry, bridge, path);
+        }
+        run.bridgeSeconds = bridgeWatch.ElapsedSeconds();
+        run.costs.push_back(PathFinder::PathCost(path));
+        unsigned long long nodesMiddle = map.GetPathStats().nodesExpanded;
+
+        Stopwatch randomWatch;
+        for (const auto& query : queries) {
+            map.GetPath(query.first, query.second, path);
+            run.costs.push_back(PathFinder::PathCost(path));
+        }
+        run.randomSeconds = randomWatch.ElapsedSeconds();
+        run.bridgeNodes = static_cast<double>(nodesMiddle - nodesBefore);
+        run.randomNodes = static_cast<double>(map.GetPathStats().nodesExpanded - nodesMiddle);
+    };
+
+    HeuristicRun euclidean;
+    map.SetLandmarkHeuristic(false);
+    measure(euclidean);
+
+    // la primera consulta con alt arma las tablas; la medimos aparte
+    map.SetLandmarkHeuristic(true);
+    Stopwatch buildWatch;
+    map.GetPath(entry, bridge, path);
+    double buildSeconds = buildWatch.ElapsedSeconds();
+
+    HeuristicRun landmarks;
+    measure(landmarks);
+    map.SetLandmarkHeuristic(previous);
+
+    int mismatches = 0;
+    for (size_t i = 0; i < euclidean.costs.size(); ++i) {
+        if (std::fabs(euclidean.costs[i] - landmarks.costs[i]) > 1e-2f) mismatches++;
+    }
+
+    double n = static_cast<double>(numQueries);
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(2);
+    wss << L"  " << LANDMARK_COUNT << L" landmarks, armar tablas + 1 consulta: " << (buildSeconds * 1e6) << L" us";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  entrada->puente euclidiana: " << (euclidean.bridgeSeconds * 1e6 / n) << L" us/consulta, "
+        << (euclidean.bridgeNodes / n) << L" nodos/consulta";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  entrada->puente alt:        " << (landmarks.bridgeSeconds * 1e6 / n) << L" us/consulta, "
+        << (landmarks.bridgeNodes / n) << L" nodos/consulta";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  al azar euclidiana:         " << (euclidean.randomSeconds * 1e6 / n) << L" us/consulta, "
+        << (euclidean.randomNodes / n) << L" nodos/consulta";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  al azar alt:                " << (landmarks.randomSeconds * 1e6 / n) << L" us/consulta, "
+        << (landmarks.randomNodes / n) << L" nodos/consulta";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  largos distintos: " << mismatches
+        << (Check(mismatches == 0, L"landmarks: largos distintos de euclidiana") ? L"" : L" (MAL)");
+    Report(wss.str());
+}
+
+/*
+ * el camino entrada->puente y las rutas alternativas del GA, antes y despues de
+ * suavizarlas. cada waypoint es un cambio de objetivo en Enemy::Update y un
+ * pair<int,int> guardado por enemigo, asi que la razon celdas/waypoints es
+ * lo que se ahorra en las dos cosas
+ */
+void RunPathSmoothing(Map& map, int repetitions) {
+    Report(L"[smoothing] caminos celda por celda vs waypoints con linea de vista");
+    std::pair<int, int> entry = std::make_pair(map.GetNumRows() / 2, 0);
+    std::pair<int, int> bridge = map.GetBridgeGridLocation();
+
+    std::vector<std::vector<std::pair<int, int>>> paths;
+    DiversePathOptions options;
+    map.GetAlternativePathsParallel(entry, bridge, options, paths);
+    std::vector<std::pair<int, int>> optimal;
+    map.GetPath(entry, bridge, optimal);
+    paths.insert(paths.begin(), optimal);
+
+    std::vector<std::pair<int, int>> waypoints;
+    size_t totalCells = 0;
+    size_t totalWaypoints = 0;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        map.SmoothPath(paths[i], waypoints);
+        totalCells += paths[i].size();
+        totalWaypoints += waypoints.size();
+
+        std::wstringstream wss;
+        wss << L"  " << (i == 0 ? L"optimo" : L"ruta diversa") << L": " << paths[i].size() << L" celdas -> "
+            << waypoints.size() << L" waypoints";
+        Report(wss.str());
+    }
+
+    Stopwatch watch;
+    for (int i = 0; i < repetitions; ++i) {
+        map.SmoothPath(paths[i % paths.size()], waypoints);
+    }
+    double seconds = watch.ElapsedSeconds();
+
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(2);
+    wss << L"  total " << totalCells << L" celdas -> " << totalWaypoints << L" waypoints ("
+        << (totalWaypoints > 0 ? static_cast<double>(totalCells) / totalWaypoints : 0.0) << L"x menos), "
+        << (seconds * 1e6 / repetitions) << L" us por suavizado";
+    Report(wss.str());
+}
+
+/*
+ * lo que hace el GA con los caminos al armar una oleada: copiar el enemigo
+ * plantilla (constructor de copia) y darle una de las rutas alternativas
+ * (ResetForNewWave). aqui solo se mide la parte del camino, porque el resto
+ * del Enemy (imagen incluida) es igual en las dos versiones
+ */
+void RunRouteSharing(Map& map, int populationSize) {
+    Report(L"[rutas] camino copiado por enemigo vs RouteTable compartida");
+    std::pair<int, int> entry = std::make_pair(map.GetNumRows() / 2, 0);
+    std::pair<int, int> bridge = map.GetBridgeGridLocation();
+
+    std::vector<std::vector<std::pair<int, int>>> paths;
+    DiversePathOptions options;
+    map.GetAlternativePathsParallel(entry, bridge, options, paths);
+    if (paths.empty()) {
+        Report(L"  sin rutas, nada que medir");
+        return;
+    }
+    std::vector<std::pair<int, int>> waypoints;
+    for (auto& path : paths) {
+        map.SmoothPath(path, waypoints);
+        path.swap(waypoints);
+    }
+
+    const int waves = 10;
+
+    // antes: cada enemigo con su vector
+    struct LegacyEnemy {
+        CountedVector<std::pair<int, int>> path;
+        int currentPathIndex = 0;
+    };
+    std::vector<CountedVector<std::pair<int, int>>> legacyPaths;
+    for (const auto& path : paths) {
+        legacyPaths.push_back(CountedVector<std::pair<int, int>>(path.begin(), path.end()));
+    }
+    std::vector<LegacyEnemy> legacyPopulation(populationSize);
+    for (int i = 0; i < populationSize; ++i) {
+        legacyPopulation[i].path = legacyPaths[i % legacyPaths.size()];
+    }
+    std::vector<LegacyEnemy> legacyWave;
+    legacyWave.reserve(populationSize);
+
+    g_countedAllocations = 0;
+    Stopwatch legacyWatch;
+    for (int w = 0; w < waves; ++w) {
+        legacyWave.clear();
+        for (int i = 0; i < populationSize; ++i) {
+            LegacyEnemy enemy = legacyPopulation[i];
+            enemy.path = legacyPaths[(i + w) % legacyPaths.size()];
+            enemy.currentPathIndex = 0;
+            legacyWave.push_back(enemy);
+        }
+    }
+    double legacySeconds = legacyWatch.ElapsedSeconds();
+    size_t legacyAllocations = g_countedAllocations;
+    size_t legacyBytes = 0;
+    for (const auto& enemy : legacyWave) {
+        legacyBytes += sizeof(LegacyEnemy) + enemy.path.capacity() * sizeof(std::pair<int, int>);
+    }
+
+    // ahora: handles a rutas de la tabla
+    struct SharedEnemy {
+        RouteHandle route;
+        int currentPathIndex = 0;
+    };
+    RouteTable table(CELL_SIZE);
+    std::vector<RouteHandle> routes;
+    for (const auto& path : paths) {
+        routes.push_back(table.Intern(path));
+    }
+    std::vector<SharedEnemy> sharedPopulation(populationSize);
+    for (int i = 0; i < populationSize; ++i) {
+        sharedPopulation[i].route = routes[i % routes.size()];
+    }
+    std::vector<SharedEnemy> sharedWave;
+    sharedWave.reserve(populationSize);
+
+    Stopwatch sharedWatch;
+    for (int w = 0; w < waves; ++w) {
+        sharedWave.clear();
+        for (int i = 0; i < populationSize; ++i) {
+            SharedEnemy enemy = sharedPopulation[i];
+            enemy.route = routes[(i + w) % routes.size()];
+            enemy.currentPathIndex = 0;
+            sharedWave.push_back(enemy);
+        }
+    }
+    double sharedSeconds = sharedWatch.ElapsedSeconds();
+    size_t sharedBytes = sharedWave.size() * sizeof(SharedEnemy);
+    for (const auto& route : routes) {
+        sharedBytes += sizeof(Route) + route->cells.capacity() * sizeof(std::pair<int, int>) +
+                       route->points.capacity() * sizeof(RoutePoint);
+    }
+
+    double enemies = static_cast<double>(populationSize) * waves;
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(2);
+    wss << L"  " << populationSize << L" enemigos x " << waves << L" oleadas, " << paths.size() << L" rutas";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  copiando:    " << (legacySeconds * 1e3 / waves) << L" ms/oleada, "
+        << (legacyAllocations / enemies) << L" allocs/enemigo, "
+        << (static_cast<double>(legacyBytes) / populationSize) << L" bytes/enemigo";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  compartido:  " << (sharedSeconds * 1e3 / waves) << L" ms/oleada, 0 allocs/enemigo, "
+        << (static_cast<double>(sharedBytes) / populationSize) << L" bytes/enemigo (tabla incluida)";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  speedup " << (legacySeconds / sharedSeconds) << L"x";
+    Report(wss.str());
+}
+
+/*
+ * lo que pide el GA en cada generacion (rutas alternativas, el camino entrada->
+ * puente de respaldo y el del campo de distancias) durante varias oleadas sin
+ * tocar el mapa, con y sin la cache. con la cache, pasada la primera
+ * consulta, las oleadas no deberian correr ningun a*. despues se pone un
+ * obstaculo en el camino y se saca: las dos veces sube la version y se busca
+ * de nuevo
+ */
+void RunPathCache(Map& map, int waves, int generationsPerWave) {
+    Report(L"[path cache] consultas del GA repetidas con el mapa quieto");
+    std::pair<int, int> entry = std::make_pair(map.GetNumRows() / 2, 0);
+    std::pair<int, int> bridge = map.GetBridgeGridLocation();
+    bool wasEnabled = map.IsPathCacheEnabled();
+
+    DiversePathOptions options;
+    std::vector<std::vector<std::pair<int, int>>> paths;
+    std::vector<std::pair<int, int>> path;
+    // las del mapa y las de los workers de las rutas alternativas
+    auto searchCount = [&map]() { return map.GetPathStats().queries + map.GetParallelPathStats().searches; };
+    auto runWaves = [&](int count) {
+        for (int w = 0; w < count; ++w) {
+            for (int g = 0; g < generationsPerWave; ++g) {
+                map.GetAlternativePathsParallel(entry, bridge, options, paths);
+                map.GetPath(entry, bridge, path);
+                map.GetPathToBridge(entry, path);
+            }
+        }
+    };
+
+    map.SetPathCacheEnabled(false);
+    unsigned long long queriesBefore = searchCount();
+    Stopwatch uncachedWatch;
+    runWaves(waves);
+    double uncachedSeconds = uncachedWatch.ElapsedSeconds();
+    unsigned long long uncachedQueries = searchCount() - queriesBefore;
+
+    map.SetPathCacheEnabled(true);
+    map.ResetPathCacheStats();
+    runWaves(1); // llena la cache
+    queriesBefore = searchCount();
+    Stopwatch cachedWatch;
+    runWaves(waves);
+    double cachedSeconds = cachedWatch.ElapsedSeconds();
+    unsigned long long steadyQueries = searchCount() - queriesBefore;
+    Map::PathCacheStats steadyStats = map.GetPathCacheStats();
+
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(3);
+    wss << L"  " << waves << L" oleadas x " << generationsPerWave << L" generaciones";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  sin cache: " << (uncachedSeconds * 1e3 / waves) << L" ms/oleada, " << uncachedQueries << L" busquedas a*";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  con cache: " << (cachedSeconds * 1e3 / waves) << L" ms/oleada, " << steadyQueries
+        << L" busquedas a* en regimen, " << steadyStats.hits << L" aciertos / " << steadyStats.misses << L" fallos";
+    Report(wss.str());
+
+    // un obstaculo en medio del camino y despues sacarlo
+    map.GetPath(entry, bridge, path);
+    if (path.size() > 2) {
+        std::pair<int, int> cell = path[path.size() / 2];
+        uint64_t hashBefore = map.GetPassabilityHash();
+        map.ResetPathCacheStats();
+
+        map.AddTemporaryObstacle(cell.first, cell.second);
+        queriesBefore = searchCount();
+        runWaves(1);
+        unsigned long long blockedQueries = searchCount() - queriesBefore;
+
+        map.RemoveTemporaryObstacle(cell.first, cell.second);
+        queriesBefore = searchCount();
+        runWaves(1);
+        unsigned long long restoredQueries = searchCount() - queriesBefore;
+
+        wss.str(L"");
+        wss << L"  obstaculo en (" << cell.first << L"," << cell.second << L"): " << blockedQueries
+            << L" busquedas; sacado: " << restoredQueries << L" busquedas (version nueva)"
+            << (Check(map.GetPassabilityHash() == hashBefore, L"path cache: el hash no volvio al sacar el obstaculo") ? L"" : L" (HASH DISTINTO!)");
+        Report(wss.str());
+    }
+
+    map.SetPathCacheEnabled(wasEnabled);
+}
+
+/*
+ * validar una celda antes de bloquearla: lo de antes (ponerla como obstaculo,
+ * correr a* entrada->puente y sacarla) contra el indice de conectividad. se
+ * pregunta por todas las celdas libres del mapa y las dos respuestas tienen
+ * que coincidir. tambien mide lo que cuesta rearmar el indice despues de un
+ * cambio
+ */
+void RunConnectivity(Map& map, int repetitions) {
+    Report(L"[connectivity] celdas que cortarian el camino al puente");
+    std::pair<int, int> entry = std::make_pair(map.GetNumRows() / 2, 0);
+    std::pair<int, int> bridge = map.GetBridgeGridLocation();
+
+    std::vector<std::pair<int, int>> freeCells;
+    for (int r = 0; r < map.GetNumRows(); ++r) {
+        for (int c = 0; c < map.GetNumCols(); ++c) {
+            if (!map.IsCellOccupied(r, c) && !map.IsConstructionSpot(r, c) && !map.IsCellTemporarilyObstructed(r, c)) {
+                freeCells.push_back(std::make_pair(r, c));
+            }
+        }
+    }
+
+    // a* por celda
+    std::vector<std::pair<int, int>> path;
+    std::vector<uint8_t> legacyAnswer(freeCells.size(), 0);
+    unsigned long long nodesBefore = map.GetPathStats().nodesExpanded;
+    Stopwatch legacyWatch;
+    for (size_t i = 0; i < freeCells.size(); ++i) {
+        map.AddTemporaryObstacle(freeCells[i].first, freeCells[i].second);
+        legacyAnswer[i] = map.GetPath(entry, bridge, path) ? 0 : 1;
+        map.RemoveTemporaryObstacle(freeCells[i].first, freeCells[i].second);
+    }
+    double legacySeconds = legacyWatch.ElapsedSeconds();
+    double legacyNodes = static_cast<double>(map.GetPathStats().nodesExpanded - nodesBefore);
+
+    // indice: la primera pregunta lo arma, las demas leen un byte
+    int mismatches = 0;
+    int forbidden = 0;
+    Stopwatch indexWatch;
+    for (int rep = 0; rep < repetitions; ++rep) {
+        for (size_t i = 0; i < freeCells.size(); ++i) {
+            bool cut = map.WouldDisconnectBridge(freeCells[i].first, freeCells[i].second);
+            if (rep == 0) {
+                if (cut != (legacyAnswer[i] != 0)) mismatches++;
+                if (cut) forbidden++;
+            }
+        }
+    }
+    double indexSeconds = indexWatch.ElapsedSeconds();
+
+    // rearmado despues de un cambio que la entrada ve
+    unsigned long long buildsBefore = map.GetConnectivityStats().builds;
+    Stopwatch rebuildWatch;
+    for (int rep = 0; rep < repetitions; ++rep) {
+        map.AddTemporaryObstacle(entry.first, entry.second + 1);
+        map.WouldDisconnectBridge(entry.first, entry.second + 2);
+        map.RemoveTemporaryObstacle(entry.first, entry.second + 1);
+        map.WouldDisconnectBridge(entry.first, entry.second + 2);
+    }
+    double rebuildSeconds = rebuildWatch.ElapsedSeconds();
+    unsigned long long rebuilds = map.GetConnectivityStats().builds - buildsBefore;
+
+    // como pone torres el jugador: celdas al azar que no cortan, preguntando
+    // despues de cada una. las que cuelgan fuera de la cadena no rearman. con
+    // todas puestas se compara contra a* y despues se sacan
+    std::mt19937 rng(13);
+    std::vector<std::pair<int, int>> placed;
+    unsigned long long placeBuildsBefore = map.GetConnectivityStats().builds;
+    unsigned long long skippedBefore = map.GetConnectivityStats().skippedChanges;
+    for (int attempt = 0; attempt < 200 && placed.size() < 40; ++attempt) {
+        std::pair<int, int> cell = freeCells[rng() % freeCells.size()];
+        if (map.IsCellTemporarilyObstructed(cell.first, cell.second) ||
+            map.WouldDisconnectBridge(cell.first, cell.second)) {
+            continue;
+        }
+        map.AddTemporaryObstacle(cell.first, cell.second);
+        placed.push_back(cell);
+    }
+    // la comparacion con a* pone y saca obstaculos, no entra en la cuenta
+    unsigned long long placeBuilds = map.GetConnectivityStats().builds - placeBuildsBefore;
+    unsigned long long placeSkipped = map.GetConnectivityStats().skippedChanges - skippedBefore;
+    int placedMismatches = 0;
+    for (const auto& cell : freeCells) {
+        if (map.IsCellTemporarilyObstructed(cell.first, cell.second)) continue;
+        bool cut = map.WouldDisconnectBridge(cell.first, cell.second);
+        map.AddTemporaryObstacle(cell.first, cell.second);
+        bool legacyCut = !map.GetPath(entry, bridge, path);
+        map.RemoveTemporaryObstacle(cell.first, cell.second);
+        if (cut != legacyCut) placedMismatches++;
+    }
+    map.WouldDisconnectBridge(entry.first, entry.second + 2); // que arranque armado
+    placeBuildsBefore = map.GetConnectivityStats().builds;
+    skippedBefore = map.GetConnectivityStats().skippedChanges;
+    for (size_t i = placed.size(); i-- > 0;) {
+        map.RemoveTemporaryObstacle(placed[i].first, placed[i].second);
+        map.WouldDisconnectBridge(entry.first, entry.second + 2);
+    }
+    unsigned long long placeChanges = placed.size() * 2;
+    placeBuilds += map.GetConnectivityStats().builds - placeBuildsBefore;
+    placeSkipped += map.GetConnectivityStats().skippedChanges - skippedBefore;
+
+    double cells = static_cast<double>(freeCells.size());
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(3);
+    wss << L"  " << freeCells.size() << L" celdas libres, " << forbidden << L" cortarian el camino, "
+        << mismatches << L" diferencias con a*"
+        << (Check(mismatches == 0, L"conectividad: distinta de a*") ? L"" : L" (MAL)");
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  a* por celda: " << (legacySeconds * 1e6 / cells) << L" us/celda, "
+        << (legacyNodes / cells) << L" nodos/celda";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  indice:       " << (indexSeconds * 1e9 / (cells * repetitions)) << L" ns/celda (armado incluido)";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  rearmado:     " << (rebuilds > 0 ? rebuildSeconds * 1e6 / rebuilds : 0.0) << L" us (" << rebuilds << L" rearmados)";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  " << placed.size() << L" obstaculos puestos y sacados: " << placeSkipped << L" de " << placeChanges
+        << L" cambios sin rearmar, " << placeBuilds << L" rearmados, " << placedMismatches << L" diferencias con a*"
+        << (Check(placedMismatches == 0, L"conectividad: distinta de a* despues de poner obstaculos") ? L"" : L" (MAL)");
+    Report(wss.str());
+}
+
+namespace {
+    struct QueueSearchResult {
+        double seconds = 0.0;
+        unsigned long long pops = 0;       // entradas sacadas
+        unsigned long long stalePops = 0;  // entradas viejas descartadas (celda ya cerrada)
+        size_t maxOpen = 0;
+        double costSum = 0.0;
+    };
+
+    /*
+     * el mismo a* (8 direcciones, euclidiana) que el PathFinder, escrito una
+     * vez por tipo de lista abierta para poder medir las dos en el mismo
+     * ejecutable. el PathFinder usa solo la que se eligio al compilar
+     */
+    template <typename Queue>
+    void QueueSearch(Queue& open, int side, const std::vector<uint8_t>& blocked,
+                     const std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>>& queries,
+                     QueueSearchResult& result) {
+        static const int dr[] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+        static const int dc[] = { 0, 0, -1, 1, -1, 1, -1, 1 };
+        static const float moveCost[] = {
+            PATH_STRAIGHT_COST, PATH_STRAIGHT_COST, PATH_STRAIGHT_COST, PATH_STRAIGHT_COST,
+            PATH_DIAGONAL_COST, PATH_DIAGONAL_COST, PATH_DIAGONAL_COST, PATH_DIAGONAL_COST
+        };
+        const size_t cellCount = static_cast<size_t>(side) * side;
+        std::vector<float> gCost(cellCount);
+        std::vector<uint8_t> closed(cellCount);
+        open.Reserve(cellCount);
+
+        Stopwatch watch;
+        for (const auto& query : queries) {
+            std::fill(gCost.begin(), gCost.end(), FLT_MAX);
+            std::fill(closed.begin(), closed.end(), 0);
+            open.Clear();
+            const int goal = query.second.first * side + query.second.second;
+            const int start = query.first.first * side + query.first.second;
+            gCost[start] = 0.0f;
+            open.Push(PathFinder::Heuristic(query.first.first, query.first.second, query.second.first, query.second.second), start);
+
+            while (!open.Empty()) {
+                result.maxOpen = (std::max)(result.maxOpen, open.Size());
+                int current = open.Pop().index;
+                result.pops++;
+                if (closed[current]) {
+                    result.stalePops++;
+                    continue;
+                }
+                closed[current] = 1;
+                if (current == goal) {
+                    result.costSum += gCost[goal];
+                    break;
+                }
+                int r = current / side;
+                int c = current - r * side;
+                for (int i = 0; i < 8; ++i) {
+                    int nr = r + dr[i];
+                    int nc = c + dc[i];
+                    if (nr < 0 || nr >= side || nc < 0 || nc >= side) continue;
+                    int next = nr * side + nc;
+                    if (closed[next] || blocked[next]) continue;
+                    float g = gCost[current] + moveCost[i];
+                    if (g < gCost[next]) {
+                        gCost[next] = g;
+                        open.Push(g + PathFinder::Heuristic(nr, nc, query.second.first, query.second.second), next);
+                    }
+                }
+            }
+        }
+        result.seconds = watch.ElapsedSeconds();
+    }
+}
+
+/*
+ * heap binario vs radix heap como lista abierta del a*, en un grid grande con
+ * muchos obstaculos. el largo total de los caminos tiene que dar igual: el
+ * radix heap usa los bits del float como clave, no redondea nada
+ */
+void RunOpenLists(int side, int numQueries) {
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(3);
+#ifdef PATHFINDER_USE_RADIX_HEAP
+    wss << L"[open list] heap binario vs radix heap (PathFinder compilado con radix heap)";
+#else
+    wss << L"[open list] heap binario vs radix heap (PathFinder compilado con heap binario)";
+#endif
+    Report(wss.str());
+
+    std::mt19937 rng(2024);
+    const int densities[] = { 20, 35 };
+    for (int density : densities) {
+        std::vector<uint8_t> blocked(static_cast<size_t>(side) * side, 0);
+        std::uniform_int_distribution<int> percent(0, 99);
+        for (auto& cell : blocked) cell = percent(rng) < density ? 1 : 0;
+        auto queries = RandomQueries(side, side, numQueries, blocked, rng);
+
+        BinaryHeapOpenList heap;
+        RadixHeapOpenList radix;
+        QueueSearchResult heapResult;
+        QueueSearchResult radixResult;
+        QueueSearch(heap, side, blocked, queries, heapResult);
+        QueueSearch(radix, side, blocked, queries, radixResult);
+
+        const QueueSearchResult* results[] = { &heapResult, &radixResult };
+        const wchar_t* names[] = { L"heap binario", L"radix heap  " };
+        for (int i = 0; i < 2; ++i) {
+            const QueueSearchResult& result = *results[i];
+            wss.str(L"");
+            wss << L"  " << side << L"x" << side << L" " << density << L"% " << names[i] << L": "
+                << (result.seconds * 1e3 / numQueries) << L" ms/consulta, "
+                << (result.seconds * 1e9 / (std::max)(1ull, result.pops)) << L" ns/pop, "
+                << result.stalePops << L" pops viejos, abierta maxima " << result.maxOpen;
+            Report(wss.str());
+        }
+        wss.str(L"");
+        wss << L"  largo total: heap " << heapResult.costSum << L", radix " << radixResult.costSum
+            << (Check(std::fabs(heapResult.costSum - radixResult.costSum) < 1e-3, L"open lists: heap y radix dan otro largo")
+                ? L" (iguales)" : L" (DISTINTOS!)");
+        Report(wss.str());
+    }
+}
+
+/*
+ * rutas alternativas con capas de obstaculos repartidas entre hilos. en el
+ * mapa del juego se mira lo que recibe el GA; en un grid grande se mide como
+ * baja la latencia con mas hilos
+ */
+void RunParallelAlternatives(Map& map, int repetitions) {
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(3);
+    wss << L"[parallel paths] rutas alternativas con " << map.GetPathWorkerCount() << L" hilos";
+    Report(wss.str());
+
+    std::pair<int, int> entry = std::make_pair(map.GetNumRows() / 2, 0);
+    std::pair<int, int> bridge = map.GetBridgeGridLocation();
+    PathFinder overlapFinder;
+    overlapFinder.Resize(map.GetNumRows(), map.GetNumCols());
+
+    DiversePathOptions options;
+    std::vector<std::vector<std::pair<int, int>>> paths;
+    {
+        Stopwatch watch;
+        for (int i = 0; i < repetitions; ++i) {
+            map.GetAlternativePathsParallel(entry, bridge, options, paths);
+        }
+        double seconds = watch.ElapsedSeconds();
+        float worstStretch = 1.0f;
+        if (!paths.empty()) {
+            float optimal = PathFinder::PathCost(paths[0]);
+            for (const auto& path : paths) {
+                worstStretch = (std::max)(worstStretch, PathFinder::PathCost(path) / optimal);
+            }
+        }
+        wss.str(L"");
+        wss << L"  capas: " << (seconds * 1e3 / repetitions)
+            << L" ms, " << paths.size() << L" rutas, solapamiento medio " << MeanPairwiseOverlap(overlapFinder, paths)
+            << L", la mas larga " << worstStretch << L"x la optima";
+        Report(wss.str());
+    }
+
+    // grid grande: la misma tanda con 1, 2, 4... hilos
+    const int side = 600;
+    std::mt19937 rng(77);
+    std::vector<uint8_t> blocked(static_cast<size_t>(side) * side, 0);
+    std::uniform_int_distribution<int> percent(0, 99);
+    for (auto& cell : blocked) cell = percent(rng) < 20 ? 1 : 0;
+    std::pair<int, int> start(side / 2, 0);
+    std::pair<int, int> goal(side / 2, side - 1);
+    blocked[start.first * side + start.second] = 0;
+    blocked[goal.first * side + goal.second] = 0;
+    auto isBlocked = [&blocked, side](int r, int c) { return blocked[r * side + c] != 0; };
+
+    // los workers con la misma configuracion que el mapa (alt prendido), y
+    // las rutas tienen que salir iguales con cualquier cantidad de hilos
+    PathFinder reference;
+    reference.Resize(side, side);
+    reference.SetUseLandmarks(true);
+    reference.BuildLandmarks(LANDMARK_COUNT, goal, isBlocked);
+
+    double singleThread = 0.0;
+    uint64_t singleThreadHash = 0;
+    for (int threads = 1; threads <= map.GetPathWorkerCount(); threads *= 2) {
+        ParallelPathPlanner planner(threads);
+        planner.Resize(side, side);
+        planner.Configure(reference);
+        Stopwatch watch;
+        planner.FindAlternatives(start, goal, isBlocked, options, paths);
+        double seconds = watch.ElapsedSeconds();
+        uint64_t hash = 0;
+        for (const auto& path : paths) hash = hash * 31 + PathFinder::PathHash(path);
+        if (threads == 1) {
+            singleThread = seconds;
+            singleThreadHash = hash;
+        }
+        wss.str(L"");
+        wss << L"  " << side << L"x" << side << L" capas, " << threads << L" hilos: " << (seconds * 1e3) << L" ms, "
+            << paths.size() << L" rutas, " << planner.GetStats().searches << L" busquedas, speedup "
+            << (singleThread / seconds) << L"x"
+            << (Check(hash == singleThreadHash, L"parallel: las rutas cambian con los hilos") ? L"" : L" (RUTAS DISTINTAS!)");
+        Report(wss.str());
+    }
+}
+
+void RunTimeSlicing(int side, double budgetMicroseconds) {
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(3);
+    wss << L"[time slicing] " << side << L"x" << side << L", " << budgetMicroseconds << L" us por frame";
+    Report(wss.str());
+
+    std::mt19937 rng(91);
+    std::vector<uint8_t> blocked(static_cast<size_t>(side) * side, 0);
+    std::uniform_int_distribution<int> percent(0, 99);
+    for (auto& cell : blocked) cell = percent(rng) < 25 ? 1 : 0;
+    std::pair<int, int> start(side / 2, 0);
+    std::pair<int, int> goal(side / 2, side - 1);
+    blocked[start.first * side + start.second] = 0;
+    blocked[goal.first * side + goal.second] = 0;
+    auto isBlocked = [&blocked, side](int r, int c) { return blocked[r * side + c] != 0; };
+
+    DiversePathOptions options;
+    ParallelPathPlanner planner;
+    planner.Resize(side, side);
+    for (int variant = 0; variant < 2; ++variant) {
+        const bool diverse = variant == 1;
+
+        // de una vez, como lo haria GetPath / GetAlternativePathsParallel en medio del frame
+        PathFinder finder;
+        finder.Resize(side, side);
+        std::vector<std::vector<std::pair<int, int>>> reference(1);
+        Stopwatch watch;
+        if (diverse) planner.FindAlternatives(start, goal, isBlocked, options, reference);
+        else finder.FindPath(start, goal, isBlocked, reference[0]);
+        double blockingMs = watch.ElapsedSeconds() * 1e3;
+
+        // por tramos: un Process por "frame" hasta que llega la respuesta. las
+        // capas van en los hilos del planner, como en el juego
+        PathRequestQueue queue;
+        queue.Resize(side, side);
+        queue.SetWorkerPool(&planner.GetWorkerPool());
+        PathRequestHandle request = diverse ? queue.EnqueueAlternatives(start, goal, options) : queue.Enqueue(start, goal);
+        Stopwatch slicedWatch;
+        int frames = 0;
+        while (!request->IsDone() && frames < 1000000) {
+            queue.Process(budgetMicroseconds, 0, isBlocked);
+            frames++;
+        }
+        double slicedMs = slicedWatch.ElapsedSeconds() * 1e3;
+
+        bool sameCost = request->GetPaths().size() == reference.size();
+        for (size_t i = 0; sameCost && i < reference.size(); ++i) {
+            sameCost = PathFinder::PathCost(request->GetPaths()[i]) == PathFinder::PathCost(reference[i]);
+        }
+        const PathRequestQueue::Stats& stats = queue.GetStats();
+        wss.str(L"");
+        wss << L"  " << (diverse ? L"rutas alternativas: " : L"un camino:          ") << L"de una vez " << blockingMs
+            << L" ms | por tramos " << slicedMs << L" ms en " << frames << L" frames, tramo maximo "
+            << stats.maxSliceMicroseconds << L" us, " << stats.slicesOverBudget << L" tramos pasados, "
+            << stats.expansions << L" nodos, mismos costos: "
+            << (Check(sameCost, L"time slicing: la cola da otros costos") ? L"si" : L"NO");
+        Report(wss.str());
+    }
+}
+
+void RunThreatMap(int side, int numTowers) {
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(3);
+    wss << L"[threat map] " << side << L"x" << side << L", " << numTowers << L" torres";
+    Report(wss.str());
+
+    // torres al azar con los mismos rangos y dps que Tower (nivel 1 a 3)
+    struct FakeTower { int row, col, range; ThreatChannel channel; float dps; };
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> cell(0, side - 1);
+    std::uniform_int_distribution<int> kind(0, 2);
+    std::uniform_int_distribution<int> level(1, 3);
+    const int baseRange[] = { 5, 3, 2 };
+    const float baseDps[] = { 15 * 1.2f, 25 * 0.8f, 40 * 0.4f };
+    std::vector<FakeTower> towers;
+    std::vector<uint8_t> blocked(static_cast<size_t>(side) * side, 0);
+    for (int i = 0; i < numTowers; ++i) {
+        int k = kind(rng);
+        int l = level(rng);
+        FakeTower tower = { cell(rng), cell(rng), baseRange[k] + (l - 1) / 2, static_cast<ThreatChannel>(k),
+                            baseDps[k] * l * (1.0f + 0.15f * (l - 1)) };
+        towers.push_back(tower);
+        blocked[tower.row * side + tower.col] = 1;
+    }
+
+    // cada click: el disco de la torre nueva vs rehacer el raster con todas
+    ThreatMap threat;
+    threat.Resize(side, side);
+    Stopwatch incrementalWatch;
+    for (const FakeTower& tower : towers) {
+        threat.AddDisc(tower.channel, tower.row, tower.col, tower.range, tower.dps);
+    }
+    double incrementalUs = incrementalWatch.ElapsedSeconds() * 1e6 / numTowers;
+
+    ThreatMap rebuilt;
+    rebuilt.Resize(side, side);
+    const int rebuildSamples = (std::min)(numTowers, 50);
+    Stopwatch rebuildWatch;
+    for (int i = 0; i < rebuildSamples; ++i) {
+        rebuilt.Clear();
+        for (const FakeTower& tower : towers) {
+            rebuilt.AddDisc(tower.channel, tower.row, tower.col, tower.range, tower.dps);
+        }
+    }
+    double rebuildUs = rebuildWatch.ElapsedSeconds() * 1e6 / rebuildSamples;
+
+    wss.str(L"");
+    wss << L"  por torre: disco " << incrementalUs << L" us (" << (threat.GetStats().cellsTouched / numTowers)
+        << L" celdas) vs recalcular todo " << rebuildUs << L" us, amenaza maxima " << threat.GetMaxCombined();
+    Report(wss.str());
+
+    // caminos de punta a punta con y sin el raster como costo
+    std::pair<int, int> start(side / 2, 0);
+    std::pair<int, int> goal(side / 2, side - 1);
+    blocked[start.first * side + start.second] = 0;
+    blocked[goal.first * side + goal.second] = 0;
+    auto isBlocked = [&blocked, side](int r, int c) { return blocked[r * side + c] != 0; };
+
+    PathFinder finder;
+    finder.Resize(side, side);
+    std::vector<std::pair<int, int>> path;
+    for (int variant = 0; variant < 2; ++variant) {
+        finder.SetCostField(variant == 1 ? threat.GetCombinedData() : nullptr, THREAT_PATH_WEIGHT);
+        finder.ResetStats();
+        Stopwatch watch;
+        finder.FindPath(start, goal, isBlocked, path);
+        double ms = watch.ElapsedSeconds() * 1e3;
+        float exposure = 0.0f;
+        for (const auto& step : path) {
+            exposure += threat.GetCombined(step.first, step.second);
+        }
+        wss.str(L"");
+        wss << L"  " << (variant == 0 ? L"por distancia: " : L"por amenaza:   ") << L"largo " << PathFinder::PathCost(path)
+            << L", amenaza acumulada " << exposure << L", " << finder.GetStats().nodesExpanded << L" nodos, " << ms << L" ms";
+        Report(wss.str());
+    }
+}
+
+void RunSurrogateFitness(int numGenomes) {
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(3);
+    wss << L"[surrogate] " << numGenomes << L" genomas";
+    Report(wss.str());
+
+    // grid del tamaño del juego, torres al azar y una ruta de punta a punta
+    const int rows = 21;
+    const int cols = 38;
+    std::mt19937 rng(17);
+    ThreatMap threat;
+    threat.Resize(rows, cols);
+    std::vector<uint8_t> blocked(static_cast<size_t>(rows) * cols, 0);
+    const int baseRange[] = { 5, 3, 2 };
+    const float baseDps[] = { 15 * 1.2f, 25 * 0.8f, 40 * 0.4f };
+    for (int i = 0; i < 25; ++i) {
+        int k = static_cast<int>(rng() % 3);
+        int r = static_cast<int>(rng() % rows);
+        int c = 2 + static_cast<int>(rng() % (cols - 4));
+        threat.AddDisc(static_cast<ThreatChannel>(k), r, c, baseRange[k], baseDps[k]);
+        blocked[r * cols + c] = 1;
+    }
+    PathFinder finder;
+    finder.Resize(rows, cols);
+    std::vector<std::pair<int, int>> cells;
+    blocked[(rows / 2) * cols] = 0;
+    blocked[(rows / 2) * cols + cols - 1] = 0;
+    finder.FindPath(std::make_pair(rows / 2, 0), std::make_pair(rows / 2, cols - 1),
+                    [&blocked, cols](int r, int c) { return blocked[r * cols + c] != 0; }, cells);
+    RouteHandle route = RouteTable::MakeRoute(cells, CELL_SIZE);
+
+    SurrogateEvaluator evaluator;
+    Stopwatch profileWatch;
+    int routeIndex = evaluator.AddRoute(*route, threat, CELL_SIZE);
+    double profileUs = profileWatch.ElapsedSeconds() * 1e6;
+
+    // genomas en los rangos del juego (vida 50-400, velocidad 30-120 px/s)
+    std::uniform_real_distribution<float> health(50.0f, 400.0f);
+    std::uniform_real_distribution<float> speed(30.0f, 120.0f);
+    std::uniform_real_distribution<float> resistance(0.0f, 1.5f);
+    std::vector<SurrogateGenome> genomes(numGenomes);
+    for (SurrogateGenome& genome : genomes) {
+        genome.health = health(rng);
+        genome.speed = speed(rng);
+        for (float& r : genome.resistance) r = resistance(rng);
+    }
+    std::vector<SurrogateOutcome> outcomes(numGenomes);
+    Stopwatch watch;
+    evaluator.EvaluateBatch(genomes.data(), genomes.size(), routeIndex, outcomes.data());
+    double ms = watch.ElapsedSeconds() * 1e3;
+
+    // referencia: caminar la ruta a pasos de 1/60 s leyendo la celda de cada paso
+    const int checks = (std::min)(numGenomes, 200);
+    double errorSum = 0.0;
+    int agree = 0;
+    Stopwatch simWatch;
+    for (int g = 0; g < checks; ++g) {
+        const SurrogateGenome& genome = genomes[g];
+        const float dt = 1.0f / 60.0f;
+        float hp = genome.health;
+        float time = 0.0f;
+        bool reached = true;
+        for (size_t i = 1; i < route->points.size() && reached; ++i) {
+            RoutePoint from = route->points[i - 1];
+            RoutePoint to = route->points[i];
+            float length = std::sqrt((to.x - from.x) * (to.x - from.x) + (to.y - from.y) * (to.y - from.y));
+            for (float d = 0.0f; d < length; d += genome.speed * dt) {
+                float px = from.x + (to.x - from.x) * d / length;
+                float py = from.y + (to.y - from.y) * d / length;
+                int r = static_cast<int>(py / CELL_SIZE);
+                int c = static_cast<int>(px / CELL_SIZE);
+                for (int ch = 0; ch < THREAT_CHANNEL_COUNT; ++ch) {
+                    hp -= threat.Get(static_cast<ThreatChannel>(ch), r, c) * genome.resistance[ch] * dt;
+                }
+                time += dt;
+                if (hp <= 0.0f) { reached = false; break; }
+            }
+        }
+        errorSum += std::fabs(time - outcomes[g].survivalTime);
+        if (reached == outcomes[g].reachedBridge) agree++;
+    }
+    double simMs = simWatch.ElapsedSeconds() * 1e3 / checks;
+
+    wss.str(L"");
+    wss << L"  perfil de la ruta " << profileUs << L" us, " << (numGenomes / ms) << L" genomas/ms | simular uno "
+        << simMs << L" ms | error medio " << (errorSum / checks) << L" s, llegan o no igual en " << agree << L"/" << checks;
+    Report(wss.str());
+}
+
+/*
+ * proyectiles contra enemigos: el loop de siempre (cada proyectil contra
+ * cada enemigo en cada frame) vs impactos predichos al disparar. sin jitter
+ * los dos mundos son deterministas y tienen que dar casi los mismos impactos
+ * (cambia a quien le pega si toca a dos en el mismo frame); con
+ * jitter se ve cuantas veces hay que volver a predecir. el predictivo con
+ * grid (armado en cada frame, como Map::Update) tiene que dar lo mismo que
+ * sin grid, con menos pruebas por prediccion.
+ */
+void RunPredictiveHits(int numEnemies, int numProjectiles, int frames) {
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(3);
+    wss << L"[predictive hits] " << numEnemies << L" enemigos, " << numProjectiles << L" proyectiles, " << frames << L" frames";
+    Report(wss.str());
+
+    const int rows = 21;
+    const int cols = 38;
+    const float mapWidth = static_cast<float>(cols * CELL_SIZE);
+    const float mapHeight = static_cast<float>(rows * CELL_SIZE);
+    const float dt = 1.0f / 60.0f;
+    const int fireFrames = frames / 3;
+
+    // rutas en zigzag de izquierda a derecha, compartidas entre varios enemigos
+    std::mt19937 routeRng(23);
+    std::vector<RouteHandle> routes;
+    for (int i = 0; i < 8; ++i) {
+        std::vector<std::pair<int, int>> cells;
+        for (int c = 0; c < cols; c += 6) {
+            cells.push_back(std::make_pair(static_cast<int>(routeRng() % rows), c));
+        }
+        cells.push_back(std::make_pair(static_cast<int>(routeRng() % rows), cols - 1));
+        routes.push_back(RouteTable::MakeRoute(cells, CELL_SIZE));
+    }
+
+    struct Result {
+        double ms;
+        int hits;
+        long long damage;
+        ProjectileManager::Stats stats;
+    };
+    auto run = [&](bool predictive, bool jitter, bool useGrid) {
+        std::mt19937 rng(29);
+        std::vector<Enemy> enemies;
+        enemies.reserve(numEnemies);
+        for (int i = 0; i < numEnemies; ++i) {
+            const RouteHandle& route = routes[i % routes.size()];
+            EnemyType type = static_cast<EnemyType>(rng() % 4);
+            enemies.emplace_back(type, route->points[0].x, route->points[0].y, route);
+            enemies.back().SetPathJitter(jitter ? enemies.back().GetPathJitter() : 0.0f);
+            enemies.back().SetSpawnDelay(static_cast<float>(rng() % 300) / 100.0f);
+        }
+
+        ProjectileManager manager;
+        manager.SetPredictiveHits(predictive);
+        SpatialHash grid;
+        grid.Resize(mapWidth, mapHeight, static_cast<float>(CELL_SIZE));
+        Economy economy;
+        const ProjectileType types[] = { ProjectileType::ARROW, ProjectileType::FIREBALL, ProjectileType::CANNONBALL };
+        int fired = 0;
+        double seconds = 0.0;
+        for (int f = 0; f < frames; ++f) {
+            // disparos como los de Tower::Update: desde una celda al enemigo donde esta ahora
+            int toFire = f < fireFrames ? (numProjectiles - fired) / (fireFrames - f) : 0;
+            for (int k = 0; k < toFire; ++k, ++fired) {
+                const Enemy& target = enemies[rng() % enemies.size()];
+                int row = static_cast<int>(rng() % rows);
+                int col = static_cast<int>(rng() % cols);
+                manager.AddProjectile(types[rng() % 3], row, col, 0, 0, CELL_SIZE, target.GetX(), target.GetY());
+            }
+
+            Stopwatch watch;
+            if (useGrid) {
+                float maxSpeed = 0.0f;
+                grid.Build(enemies.size(), [&](size_t i, float& x, float& y) {
+                    const Enemy& enemy = enemies[i];
+                    if (!enemy.IsActive() || !enemy.IsAlive()) {
+                        return false;
+                    }
+                    x = enemy.GetX();
+                    y = enemy.GetY();
+                    maxSpeed = (std::max)(maxSpeed, enemy.GetSpeed());
+                    return true;
+                });
+                grid.SetMaxSpeed(maxSpeed);
+            }
+            manager.Update(dt, mapWidth, mapHeight);
+            manager.CheckCollisions(enemies, CELL_SIZE, economy, useGrid ? &grid : nullptr);
+            seconds += watch.ElapsedSeconds();
+
+            for (Enemy& enemy : enemies) {
+                enemy.Update(dt);
+            }
+        }
+
+        Result result;
+        result.ms = seconds * 1e3 / frames;
+        result.stats = manager.GetStats();
+        result.hits = static_cast<int>(result.stats.hits);
+        result.damage = 0;
+        for (const Enemy& enemy : enemies) {
+            result.damage += enemy.GetMaxHealth() - enemy.GetHealth();
+        }
+        return result;
+    };
+
+    Result brute = run(false, false, false);
+    Result predicted = run(true, false, false);
+    Result predictedGrid = run(true, false, true);
+    wss.str(L"");
+    wss << L"  sin jitter: todos contra todos " << brute.ms << L" ms/frame, " << brute.stats.contactTests << L" pruebas, "
+        << brute.hits << L" impactos, daño " << brute.damage;
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"              predictivo " << predicted.ms << L" ms/frame, " << predicted.stats.contactTests << L" pruebas ("
+        << predicted.stats.predictions << L" predicciones, " << predicted.stats.fallbacks << L" re-predicciones), "
+        << predicted.hits << L" impactos, daño " << predicted.damage;
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"              predictivo con grid " << predictedGrid.ms << L" ms/frame, " << predictedGrid.stats.contactTests
+        << L" pruebas, " << predictedGrid.hits << L" impactos, daño " << predictedGrid.damage
+        << (Check(predictedGrid.hits == predicted.hits && predictedGrid.damage == predicted.damage,
+                  L"predictive hits: con grid da otros impactos") ? L"" : L" (DISTINTO!)");
+    Report(wss.str());
+
+    Result bruteJitter = run(false, true, false);
+    Result predictedJitter = run(true, true, false);
+    wss.str(L"");
+    wss << L"  con jitter: todos contra todos " << bruteJitter.ms << L" ms/frame, " << bruteJitter.hits
+        << L" impactos | predictivo " << predictedJitter.ms << L" ms/frame, " << predictedJitter.hits << L" impactos, "
+        << predictedJitter.stats.fallbacks << L" re-predicciones";
+    Report(wss.str());
+}
+
+/*
+ * una oleada entera (torres disparando, proyectiles, enemigos caminando)
+ * simulada con pasos de distinto tamaño. con colision barrida y varios
+ * disparos por paso el resultado tiene que parecerse al de 1/60 s aunque el
+ * paso sea de un segundo; lo que cambia es cuanto tarda.
+ */
+void RunLargeSteps(int numEnemies, int numTowers) {
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(3);
+    wss << L"[large steps] " << numEnemies << L" enemigos, " << numTowers << L" torres";
+    Report(wss.str());
+
+    const int rows = 21;
+    const int cols = 38;
+    std::mt19937 routeRng(5);
+    std::vector<std::pair<int, int>> cells;
+    for (int c = 0; c < cols; c += 4) {
+        cells.push_back(std::make_pair(5 + static_cast<int>(routeRng() % 10), c));
+    }
+    cells.push_back(std::make_pair(rows / 2, cols - 1));
+    RouteHandle route = RouteTable::MakeRoute(cells, CELL_SIZE);
+
+    const float steps[] = { 1.0f / 60.0f, 1.0f / 30.0f, 0.25f, 0.5f, 1.0f };
+    for (float dt : steps) {
+        std::srand(1); // el 20% de disparos poderosos sale de rand()
+        std::mt19937 rng(7);
+        std::vector<Enemy> enemies;
+        enemies.reserve(numEnemies);
+        for (int i = 0; i < numEnemies; ++i) {
+            enemies.emplace_back(static_cast<EnemyType>(rng() % 4), route->points[0].x, route->points[0].y, route);
+            enemies.back().SetPathJitter(0.0f);
+            enemies.back().SetSpawnDelay(i * 0.7f);
+        }
+        TowerManager towers;
+        towers.Initialize();
+        for (int k = 0; k < numTowers; ++k) {
+            towers.AddTower(static_cast<TowerType>(rng() % 3), 2 + static_cast<int>(rng() % (rows - 4)),
+                            3 + static_cast<int>(rng() % (cols - 6)));
+        }
+        ProjectileManager projectiles;
+        Economy economy;
+        economy.Initialize(0);
+
+        Stopwatch watch;
+        int stepCount = 0;
+        bool anyActive = true;
+        for (float time = 0.0f; time < 300.0f && anyActive; time += dt, ++stepCount) {
+            towers.Update(dt, projectiles, CELL_SIZE, enemies);
+            projectiles.Update(dt, static_cast<float>(cols * CELL_SIZE), static_cast<float>(rows * CELL_SIZE));
+            projectiles.CheckCollisions(enemies, CELL_SIZE, economy);
+            anyActive = false;
+            for (Enemy& enemy : enemies) {
+                enemy.Update(dt);
+                anyActive = anyActive || enemy.IsActive();
+            }
+        }
+        double ms = watch.ElapsedSeconds() * 1e3;
+
+        int dead = 0;
+        int reached = 0;
+        long long damage = 0;
+        for (const Enemy& enemy : enemies) {
+            dead += enemy.IsAlive() ? 0 : 1;
+            reached += enemy.HasReachedBridge() ? 1 : 0;
+            damage += enemy.GetMaxHealth() - enemy.GetHealth();
+        }
+        wss.str(L"");
+        wss << L"  paso " << dt << L" s: " << stepCount << L" pasos en " << ms << L" ms | " << projectiles.GetStats().hits
+            << L" impactos, " << dead << L" muertos, " << reached << L" al puente, daño " << damage;
+        Report(wss.str());
+    }
+}
+
+/*
+ * "enemigos cerca de este punto" con el recorrido de siempre vs el grid,
+ * para 100 a 50000 enemigos repartidos por el mapa del juego. las torres
+ * buscan al mas cercano en rango y los proyectiles a los que estan a menos
+ * de un radio de colision; los dos caminos tienen que elegir lo mismo.
+ * son puntos sueltos (sin Enemy) para que lo que se mida sea la busqueda.
+ */
+void RunSpatialHash(int numTowers, int numProjectiles) {
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(3);
+    wss << L"[spatial hash] " << numTowers << L" torres, " << numProjectiles << L" proyectiles";
+    Report(wss.str());
+
+    const float width = 38.0f * CELL_SIZE;
+    const float height = 21.0f * CELL_SIZE;
+    const float towerRange = 4.0f * CELL_SIZE;
+    const float hitRadius = 6.0f + CELL_SIZE / 4.0f + 5.0f; // colision + medio tramo de un frame
+
+    std::mt19937 rng(31);
+    std::uniform_real_distribution<float> px(0.0f, width);
+    std::uniform_real_distribution<float> py(0.0f, height);
+    std::vector<float> towerX(numTowers), towerY(numTowers), shotX(numProjectiles), shotY(numProjectiles);
+    for (int i = 0; i < numTowers; ++i) {
+        towerX[i] = px(rng);
+        towerY[i] = py(rng);
+    }
+    for (int i = 0; i < numProjectiles; ++i) {
+        shotX[i] = px(rng);
+        shotY[i] = py(rng);
+    }
+
+    SpatialHash grid;
+    grid.Resize(width, height, static_cast<float>(CELL_SIZE));
+    const int counts[] = { 100, 1000, 5000, 20000, 50000 };
+    for (int count : counts) {
+        std::vector<float> ex(count), ey(count);
+        for (int i = 0; i < count; ++i) {
+            ex[i] = px(rng);
+            ey[i] = py(rng);
+        }
+
+        // recorrido completo
+        std::vector<int> scanTarget(numTowers, -1);
+        long long scanHits = 0;
+        Stopwatch scanWatch;
+        for (int t = 0; t < numTowers; ++t) {
+            float best = towerRange * towerRange;
+            for (int i = 0; i < count; ++i) {
+                float dx = ex[i] - towerX[t];
+                float dy = ey[i] - towerY[t];
+                float d = dx * dx + dy * dy;
+                if (d <= best && (scanTarget[t] < 0 || d < best)) {
+                    best = d;
+                    scanTarget[t] = i;
+                }
+            }
+        }
+        for (int p = 0; p < numProjectiles; ++p) {
+            for (int i = 0; i < count; ++i) {
+                float dx = ex[i] - shotX[p];
+                float dy = ey[i] - shotY[p];
+                scanHits += dx * dx + dy * dy <= hitRadius * hitRadius ? 1 : 0;
+            }
+        }
+        double scanMs = scanWatch.ElapsedSeconds() * 1e3;
+
+        // grid: armado + las mismas consultas
+        Stopwatch buildWatch;
+        grid.Build(static_cast<size_t>(count), [&](size_t i, float& x, float& y) {
+            x = ex[i];
+            y = ey[i];
+            return true;
+        });
+        double buildMs = buildWatch.ElapsedSeconds() * 1e3;
+
+        std::vector<int> gridTarget(numTowers, -1);
+        long long gridHits = 0;
+        Stopwatch queryWatch;
+        for (int t = 0; t < numTowers; ++t) {
+            float best = FLT_MAX;
+            int& target = gridTarget[t];
+            grid.ForEachInRadius(towerX[t], towerY[t], towerRange, [&](uint32_t i, float, float, float d) {
+                if (d < best || (d == best && static_cast<int>(i) < target)) {
+                    best = d;
+                    target = static_cast<int>(i);
+                }
+            });
+        }
+        for (int p = 0; p < numProjectiles; ++p) {
+            grid.ForEachInRadius(shotX[p], shotY[p], hitRadius, [&](uint32_t, float, float, float) { gridHits++; });
+        }
+        double queryMs = queryWatch.ElapsedSeconds() * 1e3;
+
+        int same = 0;
+        for (int t = 0; t < numTowers; ++t) {
+            same += scanTarget[t] == gridTarget[t] ? 1 : 0;
+        }
+        wss.str(L"");
+        wss << L"  " << count << L" enemigos: recorrido " << scanMs << L" ms | grid " << buildMs << L" ms armado + "
+            << queryMs << L" ms consultas | objetivos iguales " << same << L"/" << numTowers << L", contactos "
+            << scanHits << L" vs " << gridHits
+            << (Check(same == numTowers && scanHits == gridHits, L"spatial hash: distinto del recorrido") ? L"" : L" (MAL)");
+        Report(wss.str());
+    }
+}
+
+/*
+ * objetivo de numTowers torres (rangos de 2 a 5 celdas) para 100 a 50000
+ * enemigos: recorrerlos todos por torre, consultar el grid por baldes, o
+ * repartirlos una vez por celda con el indice de cobertura y que cada torre
+ * mire solo su lista. tambien cuanto cuesta mejorar una torre (solo su disco)
+ * contra volver a marcar todas
+ */
+void RunTowerCoverage(int numTowers) {
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(3);
+    wss << L"[tower coverage] " << numTowers << L" torres";
+    Report(wss.str());
+
+    const int rows = 21;
+    const int cols = 38;
+    const float width = static_cast<float>(cols * CELL_SIZE);
+    const float height = static_cast<float>(rows * CELL_SIZE);
+
+    std::mt19937 rng(37);
+    std::uniform_int_distribution<int> rowDist(0, rows - 1);
+    std::uniform_int_distribution<int> colDist(0, cols - 1);
+    std::uniform_int_distribution<int> rangeDist(2, 5);
+    std::vector<float> towerX(numTowers), towerY(numTowers), towerRange(numTowers);
+    TowerCoverage coverage;
+    coverage.Resize(rows, cols, static_cast<float>(CELL_SIZE));
+    for (int t = 0; t < numTowers; ++t) {
+        towerX[t] = (colDist(rng) + 0.5f) * CELL_SIZE;
+        towerY[t] = (rowDist(rng) + 0.5f) * CELL_SIZE;
+        towerRange[t] = static_cast<float>(rangeDist(rng) * CELL_SIZE);
+        coverage.SetTower(t, towerX[t], towerY[t], towerRange[t]);
+    }
+
+    // mejorar: una torre cambia de rango, solo se toca su disco
+    coverage.ResetStats();
+    const int upgrades = 10000;
+    Stopwatch upgradeWatch;
+    for (int k = 0; k < upgrades; ++k) {
+        int t = k % numTowers;
+        float grown = towerRange[t] + ((k / numTowers) % 2 == 0 ? CELL_SIZE : 0.0f);
+        coverage.SetTower(t, towerX[t], towerY[t], grown);
+    }
+    double upgradeUs = upgradeWatch.ElapsedSeconds() * 1e6 / upgrades;
+    double cellsPerUpgrade = static_cast<double>(coverage.GetStats().cellsChanged) / upgrades;
+
+    // volver a marcar todas desde cero
+    const int rebuilds = 200;
+    Stopwatch rebuildWatch;
+    for (int k = 0; k < rebuilds; ++k) {
+        coverage.Resize(rows, cols, static_cast<float>(CELL_SIZE));
+        for (int t = 0; t < numTowers; ++t) {
+            coverage.SetTower(t, towerX[t], towerY[t], towerRange[t]);
+        }
+    }
+    double rebuildUs = rebuildWatch.ElapsedSeconds() * 1e6 / rebuilds;
+    wss.str(L"");
+    wss << L"  mejora: " << upgradeUs << L" us (" << cellsPerUpgrade << L" celdas) vs volver a marcar todo "
+        << rebuildUs << L" us";
+    Report(wss.str());
+
+    SpatialHash grid;
+    grid.Resize(width, height, static_cast<float>(CELL_SIZE));
+    std::uniform_real_distribution<float> px(0.0f, width);
+    std::uniform_real_distribution<float> py(0.0f, height);
+    const int counts[] = { 100, 1000, 5000, 20000, 50000 };
+    for (int count : counts) {
+        std::vector<float> ex(count), ey(count);
+        for (int i = 0; i < count; ++i) {
+            ex[i] = px(rng);
+            ey[i] = py(rng);
+        }
+
+        auto nearest = [&](int t, size_t i, float& best, int& target) {
+            float dx = ex[i] - towerX[t];
+            float dy = ey[i] - towerY[t];
+            float d = dx * dx + dy * dy;
+            if (d <= towerRange[t] * towerRange[t] &&
+                (d < best || (d == best && static_cast<int>(i) < target))) {
+                best = d;
+                target = static_cast<int>(i);
+            }
+        };
+
+        // recorrido completo
+        std::vector<int> scanTarget(numTowers, -1);
+        Stopwatch scanWatch;
+        for (int t = 0; t < numTowers; ++t) {
+            float best = FLT_MAX;
+            for (int i = 0; i < count; ++i) {
+                nearest(t, i, best, scanTarget[t]);
+            }
+        }
+        double scanMs = scanWatch.ElapsedSeconds() * 1e3;
+
+        // grid por baldes
+        std::vector<int> gridTarget(numTowers, -1);
+        Stopwatch gridWatch;
+        grid.Build(static_cast<size_t>(count), [&](size_t i, float& x, float& y) {
+            x = ex[i];
+            y = ey[i];
+            return true;
+        });
+        for (int t = 0; t < numTowers; ++t) {
+            float best = FLT_MAX;
+            grid.ForEachInRadius(towerX[t], towerY[t], towerRange[t], [&](uint32_t i, float, float, float) {
+                nearest(t, i, best, gridTarget[t]);
+            });
+        }
+        double gridMs = gridWatch.ElapsedSeconds() * 1e3;
+
+        // cobertura: una pasada por celda y cada torre su lista
+        std::vector<int> coverageTarget(numTowers, -1);
+        coverage.ResetStats();
+        Stopwatch coverageWatch;
+        coverage.Bin(static_cast<size_t>(count), [&](size_t i, float& x, float& y) {
+            x = ex[i];
+            y = ey[i];
+            return true;
+        });
+        for (int t = 0; t < numTowers; ++t) {
+            float best = FLT_MAX;
+            size_t candidateCount = 0;
+            const uint32_t* candidates = coverage.GetCandidates(t, candidateCount);
+            for (size_t k = 0; k < candidateCount; ++k) {
+                nearest(t, candidates[k], best, coverageTarget[t]);
+            }
+        }
+        double coverageMs = coverageWatch.ElapsedSeconds() * 1e3;
+
+        int same = 0;
+        for (int t = 0; t < numTowers; ++t) {
+            same += (scanTarget[t] == gridTarget[t] && scanTarget[t] == coverageTarget[t]) ? 1 : 0;
+        }
+        wss.str(L"");
+        wss << L"  " << count << L" enemigos: recorrido " << scanMs << L" ms | grid " << gridMs << L" ms | cobertura "
+            << coverageMs << L" ms (" << coverage.GetStats().candidates << L" pares vs "
+            << static_cast<long long>(count) * numTowers << L") | objetivos iguales " << same << L"/" << numTowers
+            << (Check(same == numTowers, L"cobertura: objetivos distintos del recorrido") ? L"" : L" (MAL)");
+        Report(wss.str());
+    }
+}
+
+/*
+ * objetivo mas cercano para numTowers torres sobre 1000, 10000 y 100000
+ * enemigos: recorriendo los Enemy con sus getters (como FindTarget) contra
+ * TargetKernel sobre la copia plana, en escalar, sse2 y avx2 (los que haya)
+ */
+void RunTargetKernel(int numTowers) {
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(3);
+    wss << L"[target kernel] " << numTowers << L" torres";
+    Report(wss.str());
+
+    const int rows = 21;
+    const int cols = 38;
+    std::vector<std::pair<int, int>> cells;
+    cells.push_back(std::make_pair(0, 0));
+    cells.push_back(std::make_pair(rows - 1, cols - 1));
+    RouteHandle route = RouteTable::MakeRoute(cells, CELL_SIZE);
+
+    std::mt19937 rng(41);
+    std::uniform_real_distribution<float> px(0.0f, static_cast<float>(cols * CELL_SIZE));
+    std::uniform_real_distribution<float> py(0.0f, static_cast<float>(rows * CELL_SIZE));
+    std::vector<TargetKernel::Query> queries(numTowers);
+    for (int t = 0; t < numTowers; ++t) {
+        float range = static_cast<float>((2 + rng() % 4) * CELL_SIZE);
+        queries[t].x = (static_cast<int>(rng() % cols) + 0.5f) * CELL_SIZE;
+        queries[t].y = (static_cast<int>(rng() % rows) + 0.5f) * CELL_SIZE;
+        queries[t].rangeSq = range * range;
+        queries[t].skipFlying = (t % 3 == 2);
+    }
+
+    const TargetKernel::Path paths[] = { TargetKernel::Path::SCALAR, TargetKernel::Path::SSE2, TargetKernel::Path::AVX2 };
+    const wchar_t* pathNames[] = { L"escalar", L"sse2", L"avx2" };
+    const int counts[] = { 1000, 10000, 100000 };
+    for (int count : counts) {
+        std::vector<Enemy> enemies;
+        enemies.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            enemies.emplace_back(static_cast<EnemyType>(rng() % 4), px(rng), py(rng), route);
+            if (i % 10 == 0) {
+                enemies.back().SetActive(false);
+            }
+        }
+        const int repetitions = (std::max)(1, 1000000 / count);
+
+        // los Enemy uno por uno
+        std::vector<int32_t> scanTarget(numTowers, -1);
+        Stopwatch scanWatch;
+        for (int r = 0; r < repetitions; ++r) {
+            for (int t = 0; t < numTowers; ++t) {
+                const TargetKernel::Query& q = queries[t];
+                float best = FLT_MAX;
+                int32_t target = -1;
+                for (size_t i = 0; i < enemies.size(); ++i) {
+                    const Enemy& enemy = enemies[i];
+                    if (!enemy.IsActive() || !enemy.IsAlive() || (q.skipFlying && enemy.IsFlying())) {
+                        continue;
+                    }
+                    float dx = enemy.GetX() - q.x;
+                    float dy = enemy.GetY() - q.y;
+                    float d = dx * dx + dy * dy;
+                    if (d <= q.rangeSq && d < best) {
+                        best = d;
+                        target = static_cast<int32_t>(i);
+                    }
+                }
+                scanTarget[t] = target;
+            }
+        }
+        double scanMs = scanWatch.ElapsedSeconds() * 1e3 / repetitions;
+
+        wss.str(L"");
+        wss << L"  " << count << L" enemigos: Enemy " << scanMs << L" ms";
+
+        TargetKernel kernel;
+        Stopwatch buildWatch;
+        for (int r = 0; r < repetitions; ++r) {
+            kernel.Build(enemies.size(), [&](size_t i, float& x, float& y, bool& flying) {
+                const Enemy& enemy = enemies[i];
+                if (!enemy.IsActive() || !enemy.IsAlive()) {
+                    return false;
+                }
+                x = enemy.GetX();
+                y = enemy.GetY();
+                flying = enemy.IsFlying();
+                return true;
+            });
+        }
+        double buildMs = buildWatch.ElapsedSeconds() * 1e3 / repetitions;
+        wss << L" | copia plana " << buildMs << L" ms";
+
+        std::vector<int32_t> kernelTarget(numTowers, -1);
+        for (int p = 0; p < 3; ++p) {
+            kernel.SetPath(paths[p]);
+            if (kernel.GetPath() != paths[p]) {
+                continue; // este procesador no lo tiene
+            }
+            Stopwatch kernelWatch;
+            for (int r = 0; r < repetitions; ++r) {
+                kernel.FindNearest(queries.data(), queries.size(), kernelTarget.data());
+            }
+            double kernelMs = kernelWatch.ElapsedSeconds() * 1e3 / repetitions;
+            bool same = Check(kernelTarget == scanTarget, L"target kernel: otro objetivo que el recorrido");
+            wss << L" | " << pathNames[p] << L" " << kernelMs << L" ms (" << (scanMs / kernelMs) << L"x"
+                << (same ? L"" : L", DISTINTO") << L")";
+        }
+        Report(wss.str());
+    }
+}
+
+/*
+ * numProjectiles proyectiles vivos durante frames frames a 60 fps: los que
+ * salen del mapa se reponen para que siempre haya la misma cantidad. la
+ * version vieja (un new por disparo, erase en el medio del vector, seno y
+ * coseno en cada paso) contra el ProjectilePool del gestor
+ */
+void RunProjectilePool(int numProjectiles, int frames) {
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(3);
+    wss << L"[projectile pool] " << numProjectiles << L" proyectiles vivos, " << frames << L" frames";
+    Report(wss.str());
+
+    const int rows = 21;
+    const int cols = 38;
+    const float mapWidth = static_cast<float>(cols * CELL_SIZE);
+    const float mapHeight = static_cast<float>(rows * CELL_SIZE);
+    const float dt = 1.0f / 60.0f;
+    const ProjectileType types[] = { ProjectileType::ARROW, ProjectileType::FIREBALL, ProjectileType::CANNONBALL };
+
+    // version vieja, lo que hacia Projectile sin la imagen
+    struct LegacyProjectile {
+        float x, y, angle, speed;
+        bool isActive;
+    };
+
+    std::mt19937 legacyRng(43);
+    std::vector<LegacyProjectile*> legacy;
+    long long legacyFired = 0;
+    size_t legacyNews = 0;
+    auto legacyFire = [&]() {
+        int row = static_cast<int>(legacyRng() % rows);
+        int col = static_cast<int>(legacyRng() % cols);
+        float targetX = static_cast<float>(legacyRng() % static_cast<unsigned>(mapWidth));
+        float targetY = static_cast<float>(legacyRng() % static_cast<unsigned>(mapHeight));
+        LegacyProjectile* projectile = new LegacyProjectile();
+        projectile->x = (col + 0.5f) * CELL_SIZE;
+        projectile->y = (row + 0.5f) * CELL_SIZE;
+        projectile->angle = atan2(targetY - projectile->y, targetX - projectile->x);
+        projectile->speed = GetProjectileSpeed(types[legacyRng() % 3]);
+        projectile->isActive = true;
+        legacy.push_back(projectile);
+        legacyNews++;
+        legacyFired++;
+    };
+    for (int i = 0; i < numProjectiles; ++i) {
+        legacyFire();
+    }
+    legacyNews = 0;
+    legacyFired = 0;
+
+    Stopwatch legacyWatch;
+    for (int f = 0; f < frames; ++f) {
+        for (size_t i = 0; i < legacy.size();) {
+            if (!legacy[i]->isActive) {
+                delete legacy[i];
+                legacy.erase(legacy.begin() + i);
+                continue;
+            }
+            LegacyProjectile* projectile = legacy[i];
+            projectile->x += projectile->speed * cos(projectile->angle) * dt;
+            projectile->y += projectile->speed * sin(projectile->angle) * dt;
+            if (projectile->x < 0 || projectile->x > mapWidth || projectile->y < 0 || projectile->y > mapHeight) {
+                projectile->isActive = false;
+            }
+            i++;
+        }
+        size_t alive = 0;
+        for (LegacyProjectile* projectile : legacy) {
+            alive += projectile->isActive ? 1 : 0;
+        }
+        for (size_t k = alive; k < static_cast<size_t>(numProjectiles); ++k) {
+            legacyFire();
+        }
+    }
+    double legacyMs = legacyWatch.ElapsedSeconds() * 1e3 / frames;
+    for (LegacyProjectile* projectile : legacy) {
+        delete projectile;
+    }
+    legacy.clear();
+
+    // pool: el gestor de verdad, sin enemigos (solo moverse y salir del mapa)
+    std::mt19937 poolRng(43);
+    ProjectileManager manager;
+    std::vector<Enemy> noEnemies;
+    Economy economy;
+    long long poolFired = 0;
+    auto poolFire = [&]() {
+        int row = static_cast<int>(poolRng() % rows);
+        int col = static_cast<int>(poolRng() % cols);
+        float targetX = static_cast<float>(poolRng() % static_cast<unsigned>(mapWidth));
+        float targetY = static_cast<float>(poolRng() % static_cast<unsigned>(mapHeight));
+        manager.AddProjectile(types[poolRng() % 3], row, col, 0, 0, CELL_SIZE, targetX, targetY);
+        poolFired++;
+    };
+    for (int i = 0; i < numProjectiles; ++i) {
+        poolFire();
+    }
+    poolFired = 0;
+    size_t capacityBefore = manager.GetPool().x.capacity();
+    size_t growths = 0;
+
+    Stopwatch poolWatch;
+    for (int f = 0; f < frames; ++f) {
+        manager.Update(dt, mapWidth, mapHeight);
+        manager.CheckCollisions(noEnemies, CELL_SIZE, economy);
+        for (size_t k = manager.GetProjectileCount(); k < static_cast<size_t>(numProjectiles); ++k) {
+            poolFire();
+        }
+        if (manager.GetPool().x.capacity() != capacityBefore) {
+            capacityBefore = manager.GetPool().x.capacity();
+            growths++;
+        }
+    }
+    double poolMs = poolWatch.ElapsedSeconds() * 1e3 / frames;
+
+    wss.str(L"");
+    wss << L"  antes:   " << legacyMs << L" ms/frame, " << (static_cast<double>(legacyFired) / frames)
+        << L" disparos/frame, " << (legacyFired > 0 ? static_cast<double>(legacyNews) / legacyFired : 0.0) << L" new/disparo";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  despues: " << poolMs << L" ms/frame, " << (static_cast<double>(poolFired) / frames)
+        << L" disparos/frame, " << growths << L" veces crecio el pool";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  speedup: " << (legacyMs / poolMs) << L"x";
+    Report(wss.str());
+}
+
+/*
+ * una oleada de numEnemies enemigos (mas la copia de cada uno que hace el GA).
+ * antes cada construccion y cada copia probaba rutas con Image::FromFile;
+ * lo comparable es lo mismo pidiendo el sprite al AssetCache, arrancando en
+ * frio. despues la oleada entera (torres que se mejoran, disparos, todo
+ * dibujado en un dc de memoria) con el cache caliente no tiene que cargar
+ * nada. la ultima parte hace lo mismo con un MemoryAssetLoader, como un
+ * build sin gdi+: la oleada despues del calentamiento tiene que dar cero cargas
+ */
+void RunAssetCache(int numEnemies) {
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(3);
+    wss << L"[asset cache] oleada de " << numEnemies << L" enemigos";
+    Report(wss.str());
+
+    const EnemyType enemyTypes[] = { EnemyType::OGRE, EnemyType::DARK_ELF, EnemyType::HARPY, EnemyType::MERCENARY };
+    const wchar_t* enemyFiles[] = { L"Ogre.png", L"DarkElf.png", L"Harpy.png", L"Mercenary.png" };
+    const AssetId enemyAssets[] = { AssetId::ENEMY_OGRE, AssetId::ENEMY_DARK_ELF, AssetId::ENEMY_HARPY, AssetId::ENEMY_MERCENARY };
+    std::vector<std::pair<int, int>> cells;
+    cells.push_back(std::make_pair(10, 0));
+    cells.push_back(std::make_pair(10, 37));
+    RouteHandle route = RouteTable::MakeRoute(cells, CELL_SIZE);
+
+    // version vieja: cada Enemy (y cada copia) probaba las rutas hasta encontrar el png
+    size_t legacyOpens = 0;
+    auto legacyLoad = [&](const wchar_t* fileName) {
+        const wchar_t* possibleBasePaths[] = {
+            L"Assets\\Enemies\\",
+            L"..\\GeneticKingdom2\\Assets\\Enemies\\",
+            L"GeneticKingdom2\\Assets\\Enemies\\"
+        };
+        for (const wchar_t* basePath : possibleBasePaths) {
+            std::wstring fullPath = std::wstring(basePath) + fileName;
+            legacyOpens++;
+            Gdiplus::Image* image = Gdiplus::Image::FromFile(fullPath.c_str());
+            bool ok = image && image->GetLastStatus() == Gdiplus::Ok;
+            delete image;
+            if (ok) {
+                return;
+            }
+        }
+    };
+    Stopwatch legacyWatch;
+    for (int i = 0; i < numEnemies; ++i) {
+        legacyLoad(enemyFiles[i % 4]); // construccion
+        legacyLoad(enemyFiles[i % 4]); // copia del GA
+    }
+    double legacyMs = legacyWatch.ElapsedSeconds() * 1e3;
+
+    // lo mismo con el cache, vaciado antes: solo la primera de cada tipo carga
+    AssetCache& assets = AssetCache::Instance();
+    assets.Clear();
+    assets.ResetStats();
+    Stopwatch loadWatch;
+    for (int i = 0; i < numEnemies; ++i) {
+        assets.Get(enemyAssets[i % 4]); // construccion
+        assets.Get(enemyAssets[i % 4]); // copia del GA
+    }
+    double loadMs = loadWatch.ElapsedSeconds() * 1e3;
+    unsigned long long coldLoads = assets.GetStats().loads;
+
+    HDC screen = GetDC(NULL);
+    HDC memoryDc = CreateCompatibleDC(screen);
+    HBITMAP bitmap = CreateCompatibleBitmap(screen, 38 * CELL_SIZE, 21 * CELL_SIZE);
+    HBITMAP oldBitmap = static_cast<HBITMAP>(SelectObject(memoryDc, bitmap));
+
+    // la oleada de ahora: construir, copiar, mejorar, disparar y dibujar
+    auto runWave = [&]() {
+        std::vector<Enemy> enemies;
+        enemies.reserve(numEnemies);
+        for (int i = 0; i < numEnemies; ++i) {
+            enemies.emplace_back(enemyTypes[i % 4], route->points[0].x + i % 30, route->points[0].y, route);
+        }
+        std::vector<Enemy> offspring;
+        offspring.reserve(numEnemies);
+        for (const Enemy& enemy : enemies) {
+            offspring.push_back(Enemy(enemy));
+        }
+        TowerManager towers;
+        ProjectileManager projectiles;
+        const TowerType towerTypes[] = { TowerType::ARCHER, TowerType::MAGE, TowerType::GUNNER };
+        for (int t = 0; t < 9; ++t) {
+            towers.AddTower(towerTypes[t % 3], 2 + t, 3 + 3 * t);
+            for (int level = 0; level < t / 3; ++level) {
+                towers.UpgradeTower(2 + t, 3 + 3 * t);
+            }
+            projectiles.AddProjectile(static_cast<ProjectileType>(t % 6), 2 + t, 3 + 3 * t, 10, 20, CELL_SIZE);
+            projectiles.AddProjectile(static_cast<ProjectileType>((t + 3) % 6), 2 + t, 3 + 3 * t, 10, 20, CELL_SIZE);
+        }
+        for (const Enemy& enemy : offspring) {
+            enemy.Draw(memoryDc);
+        }
+        towers.DrawTowers(memoryDc, CELL_SIZE);
+        projectiles.DrawProjectiles(memoryDc);
+    };
+
+    runWave(); // calentamiento
+    assets.ResetStats();
+    Stopwatch cachedWatch;
+    runWave();
+    double cachedMs = cachedWatch.ElapsedSeconds() * 1e3;
+    AssetCache::Stats cached = assets.GetStats();
+
+    wss.str(L"");
+    wss << L"  sprite de cada enemigo y copia: antes " << legacyMs << L" ms, " << legacyOpens << L" FromFile ("
+        << (static_cast<double>(legacyOpens) / (2 * numEnemies)) << L" por enemigo o copia) | despues " << loadMs
+        << L" ms, " << coldLoads << L" cargas | speedup " << (legacyMs / loadMs) << L"x";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  oleada entera con dibujo y el cache caliente: " << cachedMs << L" ms, "
+        << (Check(cached.loads == 0, L"asset cache: la oleada cargo sprites despues de calentar") ? L"" : L"(MAL) ")
+        << cached.loads << L" cargas, " << cached.requests << L" pedidos al cache";
+    Report(wss.str());
+
+    // headless: loader en memoria sin imagenes (cada clase dibuja su rectangulo)
+    MemoryAssetLoader* memoryLoader = new MemoryAssetLoader();
+    std::unique_ptr<AssetLoader> gameLoader = assets.SetLoader(std::unique_ptr<AssetLoader>(memoryLoader));
+    runWave();
+    size_t warmupLoads = memoryLoader->GetLoadCount();
+    runWave();
+    size_t waveLoads = memoryLoader->GetLoadCount() - warmupLoads;
+    assets.SetLoader(std::move(gameLoader));
+
+    wss.str(L"");
+    wss << L"  headless: " << warmupLoads << L" cargas al calentar, " << waveLoads << L" en la oleada siguiente"
+        << (Check(waveLoads == 0, L"asset cache: headless cargo sprites despues de calentar") ? L" (ok)" : L" (MAL)");
+    Report(wss.str());
+
+    SelectObject(memoryDc, oldBitmap);
+    DeleteObject(bitmap);
+    DeleteDC(memoryDc);
+    ReleaseDC(NULL, screen);
+}
+
+namespace {
+
+// saca el archivo de la cache del sistema: abrirlo sin buffer hace que
+// windows descarte sus paginas si nadie mas lo tiene abierto o mapeado.
+// asi el arranque lee de disco de verdad sin tener que reiniciar
+void EvictFromFileCache(const std::wstring& path)
+{
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
+                              FILE_FLAG_NO_BUFFERING, NULL);
+    if (file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+    }
+}
+
+} // namespace
+
+/*
+ * arranque en frio de los sprites: desde que se instala el loader hasta que
+ * cada sprite se dibujo una vez (gdi+ decodifica el png recien al dibujar),
+ * con los png de siempre y con Sprites.pak mapeado. antes de cada arranque el
+ * cache se vacia y los png y el archivo se sacan de la cache del sistema, asi
+ * que se paga disco + decodificar + escalar como al abrir el juego (el exe y
+ * gdi+ si quedan calientes). despues frames dibujando todos los sprites con
+ * cada uno. el archivo se empaqueta aparte en el directorio actual y se borra
+ * al final
+ */
+void RunAssetArchive(int frames) {
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(3);
+    wss << L"[asset archive] png vs Sprites.pak mapeado, " << ASSET_COUNT << L" sprites, " << frames << L" frames";
+    Report(wss.str());
+
+    const std::wstring archivePath = L"benchmark_sprites.pak";
+    std::wstring packedPath = archivePath;
+    Stopwatch packWatch;
+    bool packed = AssetPacker::Pack(CELL_SIZE, packedPath);
+    double packMs = packWatch.ElapsedSeconds() * 1e3;
+    if (!packed) {
+        Report(L"  no se encontraron los png, se salta");
+        return;
+    }
+
+    HDC screen = GetDC(NULL);
+    HDC memoryDc = CreateCompatibleDC(screen);
+    HBITMAP bitmap = CreateCompatibleBitmap(screen, 38 * CELL_SIZE, 21 * CELL_SIZE);
+    HBITMAP oldBitmap = static_cast<HBITMAP>(SelectObject(memoryDc, bitmap));
+
+    AssetCache& assets = AssetCache::Instance();
+    // todos los sprites a su tamaño de juego, como los Draw
+    auto drawAll = [&]() {
+        Gdiplus::Graphics graphics(memoryDc);
+        graphics.SetSmoothingMode(Gdiplus::SmoothingModeHighQuality);
+        graphics.SetInterpolationMode(Gdiplus::InterpolationModeHighQualityBicubic);
+        for (size_t i = 0; i < ASSET_COUNT; ++i) {
+            const AssetId id = static_cast<AssetId>(i);
+            Gdiplus::Image* image = assets.GetAs<Gdiplus::Image>(id);
+            if (!image) {
+                continue;
+            }
+            const int side = GetAssetDrawSize(id, CELL_SIZE);
+            DrawSprite(graphics, image, Gdiplus::Rect(static_cast<int>(i) * CELL_SIZE, 0, side, side));
+        }
+    };
+    // sin loader el cache suelta todo (FromFile deja el png abierto) y se
+    // puede sacar cada archivo de la cache del sistema
+    auto coldStart = [&]() {
+        assets.SetLoader(nullptr);
+        for (size_t i = 0; i < ASSET_COUNT; ++i) {
+            EvictFromFileCache(GdiplusAssetLoader::FindFile(static_cast<AssetId>(i)));
+        }
+        EvictFromFileCache(archivePath);
+    };
+
+    // arranque con png
+    std::unique_ptr<AssetLoader> gameLoader = assets.SetLoader(nullptr);
+    coldStart();
+    Stopwatch pngStartWatch;
+    assets.SetLoader(std::unique_ptr<AssetLoader>(new GdiplusAssetLoader()));
+    drawAll();
+    double pngStartMs = pngStartWatch.ElapsedSeconds() * 1e3;
+    Stopwatch pngDrawWatch;
+    for (int f = 0; f < frames; ++f) {
+        drawAll();
+    }
+    double pngDrawMs = pngDrawWatch.ElapsedSeconds() * 1e3;
+
+    // arranque con el archivo mapeado (sin respaldo, para ver que esta todo)
+    coldStart();
+    Stopwatch mappedStartWatch;
+    MappedAssetLoader* mapped = new MappedAssetLoader(nullptr);
+    bool opened = mapped->Open(archivePath, CELL_SIZE);
+    assets.SetLoader(std::unique_ptr<AssetLoader>(mapped));
+    assets.ResetStats();
+    drawAll();
+    double mappedStartMs = mappedStartWatch.ElapsedSeconds() * 1e3;
+    AssetCache::Stats mappedStats = assets.GetStats();
+    size_t staleSprites = mapped->GetStaleCount();
+    Stopwatch mappedDrawWatch;
+    for (int f = 0; f < frames; ++f) {
+        drawAll();
+    }
+    double mappedDrawMs = mappedDrawWatch.ElapsedSeconds() * 1e3;
+
+    // el cache suelta los bitmaps antes de que se desmapee el archivo
+    assets.SetLoader(std::move(gameLoader));
+    DeleteFileW(archivePath.c_str());
+
+    wss.str(L"");
+    wss << L"  empaquetar (offline): " << packMs << L" ms";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  png:    arranque " << pngStartMs << L" ms, dibujar " << (pngDrawMs / frames) << L" ms por frame";
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  mapeo:  arranque " << mappedStartMs << L" ms, dibujar " << (mappedDrawMs / frames) << L" ms por frame"
+        << (Check(opened, L"asset archive: no se pudo abrir el archivo recien empaquetado") ? L"" : L" (NO SE PUDO ABRIR)") << L", " << (mappedStats.loads - mappedStats.failures) << L"/"
+        << ASSET_COUNT << L" sprites del archivo"
+        << (Check(staleSprites == 0, L"asset archive: recien empaquetado y hay sprites viejos") ? L"" : L" (MAL: viejos)");
+    Report(wss.str());
+    wss.str(L"");
+    wss << L"  arranque " << (mappedStartMs > 0.0 ? pngStartMs / mappedStartMs : 0.0) << L"x, dibujo "
+        << (mappedDrawMs > 0.0 ? pngDrawMs / mappedDrawMs : 0.0) << L"x";
+    Report(wss.str());
+
+    SelectObject(memoryDc, oldBitmap);
+    DeleteObject(bitmap);
+    DeleteDC(memoryDc);
+    ReleaseDC(NULL, screen);
+}
+
+}
@@ -0,0 +1,123 @@
+/*
+ * benchmark.h - benchmarks headless del juego
+ *
+ * se corren sin abrir la ventana con:
+ *     GeneticKingdom2.exe --benchmark
+ *
+ * los resultados salen por OutputDebugString y tambien se escriben en
+ * benchmark_results.txt en el directorio de trabajo, para poder comparar
+ * entre corridas sin tener el debugger pegado.
+ */
+
+#pragma once
+
+#include <utility>
+
+class Map;
+
+namespace Benchmark {
+    // corre todos los benchmarks sobre un mapa de 1920x1080. devuelve cuantos
+    // chequeos de correccion fallaron (0 = todo bien)
+    int RunAll();
+
+    // a* de entrada->puente repetido numQueries veces, version original vs PathFinder
+    void RunPathfinding(const Map& map, std::pair<int, int> entry, std::pair<int, int> bridge, int numQueries);
+
+    // numEnemies caminos al puente: un a* por enemigo vs el campo de distancias compartido,
+    // y costo de la actualizacion incremental vs reconstruir el campo entero
+    void RunDistanceField(Map& map, int numEnemies);
+
+    // a* vs jump point search: nodos expandidos y tiempo, en el mapa del juego
+    // y en grids sinteticos de 1000x1000
+    void RunJumpPointSearch(Map& map, int numQueries);
+
+    // costo del a* a medida que crecen torres y obstaculos temporales: chequeo
+    // de bloqueo viejo (std::find + recorrer torres) vs la capa de bits del mapa
+    void RunPassabilityScaling(int numQueries);
+
+    // rutas alternativas del GA: hileras de obstaculos a mano + a* (lo de antes)
+    // vs las k rutas alternativas por capas
+    void RunDiversePaths(Map& map, int repetitions);
+
+    // flujo de cambios de una celda: reparar con lpa* vs a* desde cero despues de cada uno
+    void RunIncrementalReplanning(Map& map, int numChanges);
+
+    // hpa* vs a* plano en un grid sintetico de side x side: armado del grafo,
+    // latencia por consulta (completa y solo el primer tramo), largo de los
+    // caminos y costo de actualizar clusters vs reconstruir todo
+    void RunHierarchical(Map& map, int side, int numQueries);
+
+    // GetPath con la heuristica euclidiana vs alt (landmarks): nodos y latencia
+    // por consulta, y lo que cuesta armar las tablas
+    void RunLandmarkHeuristic(Map& map, int numQueries);
+
+    // string pulling: celdas por camino vs waypoints (lo que guarda cada enemigo
+    // y las veces que cambia de objetivo) y lo que cuesta suavizar
+    void RunPathSmoothing(Map& map, int repetitions);
+
+    // generar oleadas de populationSize enemigos copiando el camino a cada uno
+    // (lo de antes) vs compartir rutas de la RouteTable
+    void RunRouteSharing(Map& map, int populationSize);
+
+    // consultas de camino del GA durante varias oleadas sin cambios en el mapa,
+    // con y sin la cache por version de la capa de transitabilidad
+    void RunPathCache(Map& map, int waves, int generationsPerWave);
+
+    // "bloquear esta celda corta el camino al puente?" para todas las celdas
+    // libres: un a* por celda vs el indice de conectividad del mapa
+    void RunConnectivity(Map& map, int repetitions);
+
+    // lista abierta del a*: heap binario (con duplicados) vs radix heap (con
+    // decrease-key) en un grid sintetico de side x side con muchos obstaculos
+    void RunOpenLists(int side, int numQueries);
+
+    // rutas alternativas por capas de obstaculos en paralelo, y como escala
+    // con los hilos
+    void RunParallelAlternatives(Map& map, int repetitions);
+
+    // a* y rutas alternativas de una vez (lo que congela el frame) vs repartidas
+    // en la cola por tramos con budgetMicroseconds por frame, en un grid de side x side
+    void RunTimeSlicing(int side, double budgetMicroseconds);
+
+    // raster de amenaza en un grid de side x side con numTowers torres: sumar
+    // el disco de una torre nueva vs recalcular todo, y caminos por distancia
+    // vs por amenaza (largo y daño que reciben)
+    void RunThreatMap(int side, int numTowers);
+
+    // estimador de fitness del GA: genomas por milisegundo y cuanto se aleja de
+    // simular el recorrido paso a paso con el mismo raster de amenaza
+    void RunSurrogateFitness(int numGenomes);
+
+    // colisiones de numProjectiles proyectiles contra numEnemies enemigos
+    // durante frames frames: todos contra todos en cada frame vs impactos
+    // predichos al disparar, con y sin jitter
+    void RunPredictiveHits(int numEnemies, int numProjectiles, int frames);
+
+    // una oleada simulada con pasos de 1/60 s hasta 1 s: impactos, muertos y
+    // llegadas al puente tienen que dar parecido, cambia el tiempo que tarda
+    void RunLargeSteps(int numEnemies, int numTowers);
+
+    // enemigos cerca de un punto para 100 a 50000 enemigos: recorrerlos todos
+    // por torre y por proyectil vs el grid por baldes (armado + consultas)
+    void RunSpatialHash(int numTowers, int numProjectiles);
+
+    // objetivo mas cercano por torre: recorrido completo vs grid vs listas por
+    // celda del indice de cobertura; y costo de mejorar una torre
+    void RunTowerCoverage(int numTowers);
+
+    // objetivo mas cercano leyendo los Enemy vs TargetKernel sobre arreglos
+    // planos (escalar, sse2, avx2) con 1000 a 100000 enemigos
+    void RunTargetKernel(int numTowers);
+
+    // numProjectiles proyectiles vivos todo el tiempo: vector de punteros con
+    // new y erase vs ProjectilePool con swap-and-pop
+    void RunProjectilePool(int numProjectiles, int frames);
+
+    // cargas de sprites en una oleada: FromFile por enemigo y copia vs el
+    // AssetCache; y que headless la oleada despues de calentar no cargue nada
+    void RunAssetCache(int numEnemies);
+
+    // arranque de los sprites (cargar y dibujar cada uno una vez) con png
+    // vs Sprites.pak mapeado, y el costo de dibujar cada frame con cada uno
+    void RunAssetArchive(int frames);
+}
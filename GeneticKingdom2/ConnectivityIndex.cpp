@@ -0,0 +1,209 @@
+// puntos de articulacion entre la entrada y el puente
+
+#include "ConnectivityIndex.h"
+#include <algorithm>
+
+ConnectivityIndex::ConnectivityIndex()
+    : rows(0), cols(0), sourceIndex(-1), targetIndex(-1), built(false), connected(false), criticalCount(0)
+{
+}
+
+/*
+ * tarjan iterativo (en mapas grandes la recursion revienta la pila). el grid
+ * es no dirigido y las diagonales valen aunque las ortogonales esten
+ * bloqueadas, igual que en el a*, asi que los vecinos son las 8 celdas libres.
+ *
+ * con el arbol armado desde la entrada, una celda v del camino del arbol hasta
+ * el puente lo separa de la entrada si el hijo w de v que lleva al puente
+ * cumple low[w] >= discovery[v]: nada en el subarbol de w vuelve por encima
+ * de v, asi que sin v el puente queda aislado. las celdas fuera de ese camino
+ * nunca separan (el camino del arbol no las usa).
+ *
+ * con el mismo arbol sale de que celda cuelga cada una (LabelBranches), que
+ * es lo que usa NotifyCellChanged para no rearmar de gusto.
+ */
+void ConnectivityIndex::Analyze()
+{
+    static const int dr[] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+    static const int dc[] = { 0, 0, -1, 1, -1, 1, -1, 1 };
+
+    const size_t cellCount = walkable.size();
+    discovery.assign(cellCount, 0);
+    low.assign(cellCount, 0);
+    parent.assign(cellCount, -1);
+    critical.assign(cellCount, 0);
+    attach.assign(cellCount, -1);
+    onPath.assign(cellCount, 0);
+    order.clear();
+    criticalCount = 0;
+    connected = false;
+    built = true;
+    stats.builds++;
+
+    if (sourceIndex < 0 || targetIndex < 0) {
+        return;
+    }
+    if (sourceIndex == targetIndex) {
+        connected = true; // como el a*: inicio == fin siempre tiene camino
+        return;
+    }
+
+    int timer = 0;
+    discovery[sourceIndex] = low[sourceIndex] = ++timer;
+    order.push_back(sourceIndex);
+    stack.clear();
+    stack.push_back({ sourceIndex, 0 });
+    while (!stack.empty()) {
+        const int cell = stack.back().cell;
+        if (stack.back().nextDir < 8) {
+            const int dir = stack.back().nextDir++;
+            const int r = cell / cols + dr[dir];
+            const int c = cell % cols + dc[dir];
+            if (r < 0 || r >= rows || c < 0 || c >= cols) {
+                continue;
+            }
+            const int next = r * cols + c;
+            if (!walkable[next]) {
+                continue;
+            }
+            if (discovery[next] == 0) {
+                parent[next] = cell;
+                discovery[next] = low[next] = ++timer;
+                order.push_back(next);
+                stack.push_back({ next, 0 });
+            } else if (next != parent[cell]) {
+                low[cell] = (std::min)(low[cell], discovery[next]);
+            }
+        } else {
+            stack.pop_back();
+            const int up = parent[cell];
+            if (up >= 0) {
+                low[up] = (std::min)(low[up], low[cell]);
+            }
+        }
+    }
+
+    if (discovery[targetIndex] == 0) {
+        return; // ya no hay camino, no hay nada que proteger
+    }
+    connected = true;
+
+    critical[targetIndex] = 1;
+    criticalCount = 1;
+    onPath[targetIndex] = 1;
+    onPath[sourceIndex] = 1;
+    int child = targetIndex;
+    int cell = parent[child];
+    while (cell != sourceIndex) {
+        onPath[cell] = 1;
+        if (low[child] >= discovery[cell]) {
+            critical[cell] = 1;
+            criticalCount++;
+        }
+        child = cell;
+        cell = parent[cell];
+    }
+    LabelBranches(timer);
+}
+
+/*
+ * un hijo w de v fuera del camino del arbol con low[w] >= discovery[v] no
+ * vuelve por encima de v: todo su subarbol cuelga de v. si v ya colgaba de
+ * alguna celda, sus hijos cuelgan de la misma. si low[w] < discovery[v], w
+ * esta en el mismo bloque que la arista que llega a v, que por induccion es
+ * de la cadena. se recorre en orden de discovery para tener el padre listo
+ */
+void ConnectivityIndex::LabelBranches(int timer)
+{
+    for (int i = 1; i < timer; ++i) {
+        const int cell = order[i];
+        if (onPath[cell]) {
+            continue;
+        }
+        const int up = parent[cell];
+        if (attach[up] >= 0) {
+            attach[cell] = attach[up];
+        } else if (low[cell] >= discovery[up]) {
+            attach[cell] = up;
+        }
+    }
+}
+
+void ConnectivityIndex::NotifyCellChanged(int row, int col, bool blocked)
+{
+    if (!built || row < 0 || row >= rows || col < 0 || col >= cols) {
+        return;
+    }
+    const int index = row * cols + col;
+    if (index == sourceIndex) {
+        stats.ignoredChanges++; // el inicio siempre cuenta como libre
+        return;
+    }
+    walkable[index] = blocked ? 0 : 1;
+
+    // si ni la celda ni sus vecinas las alcanzo el dfs, el cambio no conecta
+    // ni corta nada de lo que ve la entrada
+    bool reached = false;
+    bool unreachedFree = false;
+    bool sameBranch = true;
+    int key = -1;
+    for (int r = row - 1; r <= row + 1; ++r) {
+        for (int c = col - 1; c <= col + 1; ++c) {
+            if (r < 0 || r >= rows || c < 0 || c >= cols) continue;
+            const int next = r * cols + c;
+            if (discovery[next] != 0) {
+                reached = true;
+            }
+            if (next == index || !walkable[next]) {
+                continue;
+            }
+            if (discovery[next] == 0) {
+                unreachedFree = true;
+            } else if (key < 0) {
+                key = BranchKey(next);
+            } else if (BranchKey(next) != key) {
+                sameBranch = false;
+            }
+        }
+    }
+    if (!reached) {
+        stats.ignoredChanges++;
+        return;
+    }
+    if (!connected || index == targetIndex) {
+        built = false;
+        return;
+    }
+
+    if (blocked) {
+        // si cuelga fuera de la cadena ningun camino simple al puente pasa por
+        // ahi. lo que queda detras sigue marcado como alcanzado, que solo
+        // puede hacer rearmar de mas
+        if (discovery[index] == 0 || attach[index] >= 0) {
+            stats.skippedChanges++;
+        } else {
+            built = false;
+        }
+        return;
+    }
+
+    // liberada: un camino nuevo por aca entra y sale por la misma celda de la
+    // que cuelgan todas sus vecinas, asi que no le sirve a la entrada. con una
+    // vecina libre sin alcanzar se sumaria una zona que el indice no conoce
+    if (key >= 0 && sameBranch && !unreachedFree) {
+        discovery[index] = 1; // alcanzada; el valor solo importa que no sea 0
+        attach[index] = key;
+        stats.skippedChanges++;
+    } else {
+        built = false;
+    }
+}
+
+bool ConnectivityIndex::WouldDisconnect(int row, int col) const
+{
+    stats.queries++;
+    if (!built || row < 0 || row >= rows || col < 0 || col >= cols) {
+        return false;
+    }
+    return critical[row * cols + col] != 0;
+}
@@ -0,0 +1,130 @@
+/*
+ * connectivityindex.h - que celdas no se pueden bloquear sin cortar el camino
+ *
+ * la regla del juego es que las torres nunca pueden dejar a los enemigos sin
+ * ninguna ruta al puente. la unica forma que habia de saberlo era correr un
+ * a* y esperar a que inunde todo el grid antes de volver vacio.
+ *
+ * aca se hace un dfs (tarjan) desde la entrada sobre las celdas libres, con
+ * las mismas 8 direcciones del a*, y se marcan los puntos de articulacion que
+ * separan la entrada del puente: los del camino del arbol entre los dos cuyo
+ * hijo hacia el puente no tiene ninguna arista de vuelta por encima de ellos.
+ * despues "bloquear (r,c) corta el camino?" es leer un byte.
+ *
+ * el analisis es lineal en las celdas y no se rehace en cada cambio. los
+ * caminos simples de la entrada al puente solo pasan por la "cadena" de
+ * bloques biconexos que une a los dos; lo demas cuelga de alguna celda de la
+ * cadena (attach) y para entrar ahi hay que volver a salir por esa celda. asi
+ * que no se rehace:
+ *  - si la celda no la alcanza la entrada ni ninguna vecina
+ *  - si se bloquea una celda que cuelga fuera de la cadena
+ *  - si se libera una celda cuyas vecinas alcanzadas cuelgan todas de la
+ *    misma celda (o son esa celda) y no tiene vecinas libres sin alcanzar
+ * en cualquier otro caso se marca para rearmar en la proxima pregunta.
+ *
+ * igual que el a*: la celda de inicio no se revisa (aunque este bloqueada se
+ * puede salir de ahi) y la de destino si.
+ */
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+class ConnectivityIndex {
+public:
+    struct Stats {
+        unsigned long long builds = 0;          // analisis completos
+        unsigned long long ignoredChanges = 0;  // cambios en celdas que la entrada no alcanza
+        unsigned long long skippedChanges = 0;  // cambios fuera de la cadena, sin rearmar
+        unsigned long long queries = 0;         // preguntas respondidas
+    };
+
+    ConnectivityIndex();
+
+    // analiza el grid de rows x cols desde source hasta target
+    template <typename BlockedFn>
+    void Build(int rows, int cols, std::pair<int, int> source, std::pair<int, int> target, BlockedFn isBlocked);
+
+    bool IsBuilt() const { return built; }
+    void Invalidate() { built = false; }
+
+    // la celda cambio de libre a bloqueada o al reves (blocked = como quedo).
+    // si no puede cambiar las celdas criticas se anota y listo; si no, hay que
+    // volver a armar el indice
+    void NotifyCellChanged(int row, int col, bool blocked);
+
+    // hay algun camino de la entrada al puente
+    bool IsConnected() const { return connected; }
+
+    // bloquear esa celda dejaria la entrada sin camino al puente. false si ya
+    // estaba cortado, o si la celda ya estaba bloqueada
+    bool WouldDisconnect(int row, int col) const;
+
+    // cuantas celdas no se pueden bloquear
+    int GetCriticalCount() const { return criticalCount; }
+
+    const Stats& GetStats() const { return stats; }
+    void ResetStats() { stats = Stats(); }
+
+private:
+    // dfs iterativo + marcado del camino, sobre walkable ya cargado
+    void Analyze();
+
+    // de que celda cuelga cada celda alcanzada, a partir del arbol del dfs
+    void LabelBranches(int timer);
+
+    // clave para comparar vecinas al liberar: la celda de la que cuelga, o
+    // la celda misma si esta en la cadena
+    int BranchKey(int index) const { return attach[index] >= 0 ? attach[index] : index; }
+
+    int rows;
+    int cols;
+    int sourceIndex;
+    int targetIndex;
+    bool built;
+    bool connected;
+    int criticalCount;
+
+    std::vector<uint8_t> walkable;
+    std::vector<int> discovery;  // orden de visita del dfs, 0 = no alcanzada
+    std::vector<int> low;        // menor discovery alcanzable desde el subarbol
+    std::vector<int> parent;
+    std::vector<uint8_t> critical;
+    std::vector<int> attach;     // celda de la que cuelga, -1 = en la cadena (o no alcanzada)
+    std::vector<int> order;      // celdas en orden de discovery
+    std::vector<uint8_t> onPath; // camino del arbol de la entrada al puente
+
+    struct Frame {
+        int cell;
+        int nextDir;
+    };
+    std::vector<Frame> stack;
+
+    mutable Stats stats;
+};
+
+template <typename BlockedFn>
+void ConnectivityIndex::Build(int rows, int cols, std::pair<int, int> source, std::pair<int, int> target, BlockedFn isBlocked)
+{
+    this->rows = rows;
+    this->cols = cols;
+    auto inside = [rows, cols](std::pair<int, int> cell) {
+        return cell.first >= 0 && cell.first < rows && cell.second >= 0 && cell.second < cols;
+    };
+    sourceIndex = inside(source) ? source.first * cols + source.second : -1;
+    targetIndex = inside(target) ? target.first * cols + target.second : -1;
+
+    walkable.assign(static_cast<size_t>(rows) * cols, 0);
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            walkable[r * cols + c] = isBlocked(r, c) ? 0 : 1;
+        }
+    }
+    if (sourceIndex >= 0) {
+        walkable[sourceIndex] = 1; // el inicio no se revisa
+    }
+    Analyze();
+}
@@ -0,0 +1,204 @@
+// partes no-template del campo de distancias. la construccion y la
+// actualizacion viven en el header porque reciben el predicado de bloqueo
+
+#include "DistanceField.h"
+#include <algorithm>
+#include <functional>
+
+namespace {
+    // vecinos en 8 direcciones, mismo orden que el a*
+    const int kDr[] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+    const int kDc[] = { 0, 0, -1, 1, -1, 1, -1, 1 };
+    const float kMoveCost[] = {
+        PATH_STRAIGHT_COST, PATH_STRAIGHT_COST, PATH_STRAIGHT_COST, PATH_STRAIGHT_COST,
+        PATH_DIAGONAL_COST, PATH_DIAGONAL_COST, PATH_DIAGONAL_COST, PATH_DIAGONAL_COST
+    };
+}
+
+DistanceField::DistanceField()
+    : rows(0), cols(0), built(false), seedGeneration(0)
+{
+}
+
+void DistanceField::Resize(int newRows, int newCols)
+{
+    if (newRows < 0) newRows = 0;
+    if (newCols < 0) newCols = 0;
+    rows = newRows;
+    cols = newCols;
+
+    size_t cellCount = static_cast<size_t>(rows) * static_cast<size_t>(cols);
+    dist.assign(cellCount, FLT_MAX);
+    next.assign(cellCount, -1);
+    blocked.assign(cellCount, 0);
+    isTarget.assign(cellCount, 0);
+    seedStamp.assign(cellCount, 0);
+    seedGeneration = 0;
+    heap.clear();
+    heap.reserve(cellCount);
+    targets.clear();
+    built = false;
+}
+
+void DistanceField::Push(float distance, int index)
+{
+    QueueEntry entry;
+    entry.distance = distance;
+    entry.index = index;
+    heap.push_back(entry);
+    std::push_heap(heap.begin(), heap.end(), std::greater<QueueEntry>());
+}
+
+// dijkstra normal, pero arrancando de lo que haya en el heap. sirve tanto
+// para la construccion completa como para rellenar un pedazo
+void DistanceField::Propagate()
+{
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<QueueEntry>());
+        QueueEntry current = heap.back();
+        heap.pop_back();
+
+        if (current.distance > dist[current.index]) {
+            continue; // entrada vieja
+        }
+        stats.cellsSettled++;
+
+        int r = current.index / cols;
+        int c = current.index - r * cols;
+        for (int i = 0; i < 8; ++i) {
+            int nr = r + kDr[i];
+            int nc = c + kDc[i];
+            if (nr < 0 || nr >= rows || nc < 0 || nc >= cols) continue;
+
+            int neighbor = nr * cols + nc;
+            if (blocked[neighbor]) continue;
+
+            float candidate = current.distance + kMoveCost[i];
+            if (candidate < dist[neighbor]) {
+                dist[neighbor] = candidate;
+                next[neighbor] = current.index;
+                Push(candidate, neighbor);
+            }
+        }
+    }
+}
+
+// le da a la celda la mejor distancia que ofrecen sus vecinos validos y la
+// mete al heap para que la mejora se propague
+void DistanceField::SeedFromNeighbors(int index)
+{
+    if (blocked[index]) {
+        return;
+    }
+    if (isTarget[index]) {
+        dist[index] = 0.0f;
+        next[index] = -1;
+        Push(0.0f, index);
+        return;
+    }
+
+    int r = index / cols;
+    int c = index - r * cols;
+    float best = FLT_MAX;
+    int bestNeighbor = -1;
+    for (int i = 0; i < 8; ++i) {
+        int nr = r + kDr[i];
+        int nc = c + kDc[i];
+        if (nr < 0 || nr >= rows || nc < 0 || nc >= cols) continue;
+
+        int neighbor = nr * cols + nc;
+        if (blocked[neighbor] || dist[neighbor] == FLT_MAX) continue;
+
+        float candidate = dist[neighbor] + kMoveCost[i];
+        if (candidate < best) {
+            best = candidate;
+            bestNeighbor = neighbor;
+        }
+    }
+
+    dist[index] = best;
+    next[index] = bestNeighbor;
+    if (bestNeighbor != -1) {
+        Push(best, index);
+    }
+}
+
+// las celdas cuyo "next" apunta a la bloqueada (y las que apuntan a esas, etc)
+// ya no tienen una distancia valida. como next siempre es un vecino, el
+// recorrido solo mira los 8 vecinos de cada celda y se queda en la zona afectada
+void DistanceField::InvalidateSubtree(int index)
+{
+    stack.clear();
+    stack.push_back(index);
+    dist[index] = FLT_MAX;
+    next[index] = -1;
+
+    while (!stack.empty()) {
+        int current = stack.back();
+        stack.pop_back();
+        stats.cellsInvalidated++;
+
+        if (!blocked[current] && seedStamp[current] != seedGeneration) {
+            seedStamp[current] = seedGeneration;
+            seeds.push_back(current);
+        }
+
+        int r = current / cols;
+        int c = current - r * cols;
+        for (int i = 0; i < 8; ++i) {
+            int nr = r + kDr[i];
+            int nc = c + kDc[i];
+            if (nr < 0 || nr >= rows || nc < 0 || nc >= cols) continue;
+
+            int neighbor = nr * cols + nc;
+            if (next[neighbor] == current) {
+                dist[neighbor] = FLT_MAX;
+                next[neighbor] = -1;
+                stack.push_back(neighbor);
+            }
+        }
+    }
+}
+
+bool DistanceField::GetNextStep(int row, int col, std::pair<int, int>& outNext) const
+{
+    if (!built || row < 0 || row >= rows || col < 0 || col >= cols) {
+        return false;
+    }
+    int step = next[row * cols + col];
+    if (step == -1) {
+        return false;
+    }
+    outNext = std::make_pair(step / cols, step % cols);
+    return true;
+}
+
+// sigue las flechitas hasta llegar a distancia cero. devuelve el camino en el
+// mismo formato que Map::GetPath para que los enemigos no noten la diferencia
+bool DistanceField::ExtractPath(std::pair<int, int> start, std::vector<std::pair<int, int>>& outPath) const
+{
+    outPath.clear();
+    if (!built || start.first < 0 || start.first >= rows || start.second < 0 || start.second >= cols) {
+        return false;
+    }
+
+    int current = start.first * cols + start.second;
+    if (dist[current] == FLT_MAX) {
+        return false;
+    }
+
+    size_t maxLength = dist.size() + 1;
+    while (current != -1) {
+        outPath.push_back(std::make_pair(current / cols, current % cols));
+        if (isTarget[current] && dist[current] == 0.0f) {
+            return true;
+        }
+        current = next[current];
+        if (outPath.size() > maxLength) { // ciclo, no deberia pasar nunca
+            break;
+        }
+    }
+
+    outPath.clear();
+    return false;
+}
@@ -0,0 +1,182 @@
+/*
+ * distancefield.h - campo de distancias compartido hacia un objetivo
+ *
+ * todos los enemigos van al mismo lugar (el puente), asi que en vez de correr
+ * un a* por cada uno hacemos un dijkstra al reves UNA vez desde el objetivo.
+ * cada celda guarda su distancia al puente y a cual vecino hay que moverse
+ * para bajar. cualquier enemigo desde cualquier celda solo tiene que seguir
+ * las flechitas, O(1) por paso.
+ *
+ * cuando cambia la transitabilidad de unas pocas celdas no recalculamos todo:
+ * - si una celda se bloquea, se invalida solo el "subarbol" de celdas cuyo
+ *   camino pasaba por ella y se rellena desde su borde
+ * - si una celda se libera, se propaga la mejora desde ahi hasta donde llegue
+ *
+ * mismos costos que el a* (1 recto, raiz de 2 diagonal, 8 direcciones), asi
+ * que las distancias coinciden con el largo de los caminos del PathFinder.
+ */
+
+#pragma once
+
+#include "PathFinder.h"
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cfloat>
+
+class DistanceField {
+public:
+    struct Stats {
+        unsigned long long fullBuilds = 0;         // dijkstras completos
+        unsigned long long incrementalUpdates = 0; // actualizaciones parciales
+        unsigned long long cellsSettled = 0;       // celdas sacadas del heap en total
+        unsigned long long cellsInvalidated = 0;   // celdas reseteadas por bloqueos
+    };
+
+    DistanceField();
+
+    // dimensiona el campo, lo deja sin construir
+    void Resize(int rows, int cols);
+
+    int GetRows() const { return rows; }
+    int GetCols() const { return cols; }
+    bool IsBuilt() const { return built; }
+
+    // dijkstra completo desde las celdas objetivo
+    template <typename BlockedFn>
+    void Build(const std::vector<std::pair<int, int>>& targetCells, BlockedFn isBlocked);
+
+    // re-evalua solo las celdas que pudieron cambiar. si son demasiadas
+    // sale mas barato reconstruir todo y eso hace
+    template <typename BlockedFn>
+    void Update(const std::vector<std::pair<int, int>>& changedCells, BlockedFn isBlocked);
+
+    // distancia al objetivo, FLT_MAX si no se puede llegar
+    float GetDistance(int row, int col) const {
+        if (row < 0 || row >= rows || col < 0 || col >= cols) return FLT_MAX;
+        return dist[row * cols + col];
+    }
+
+    // siguiente celda bajando por el campo. false si ya es el objetivo o no hay ruta
+    bool GetNextStep(int row, int col, std::pair<int, int>& outNext) const;
+
+    // camino completo desde start hasta el objetivo (incluye ambos extremos)
+    bool ExtractPath(std::pair<int, int> start, std::vector<std::pair<int, int>>& outPath) const;
+
+    const Stats& GetStats() const { return stats; }
+    void ResetStats() { stats = Stats(); }
+
+private:
+    struct QueueEntry {
+        float distance;
+        int index;
+
+        bool operator>(const QueueEntry& other) const {
+            return distance > other.distance;
+        }
+    };
+
+    // saca celdas del heap y relaja vecinos hasta vaciarlo
+    void Propagate();
+    void Push(float distance, int index);
+
+    // mejor distancia posible de una celda segun sus vecinos actuales
+    void SeedFromNeighbors(int index);
+
+    // resetea todas las celdas cuyo camino pasaba por index
+    void InvalidateSubtree(int index);
+
+    int rows;
+    int cols;
+    bool built;
+    std::vector<float> dist;           // distancia al objetivo
+    std::vector<int> next;             // vecino hacia el objetivo, -1 si no hay
+    std::vector<uint8_t> blocked;      // foto de la transitabilidad con la que se calculo
+    std::vector<uint8_t> isTarget;     // celdas objetivo (distancia 0)
+    std::vector<std::pair<int, int>> targets;
+    std::vector<QueueEntry> heap;      // heap binario, se reutiliza
+    std::vector<int> stack;            // scratch para invalidar subarboles
+    std::vector<int> seeds;            // scratch de celdas a re-sembrar
+    std::vector<uint32_t> seedStamp;   // evita sembrar dos veces la misma celda
+    uint32_t seedGeneration;
+    Stats stats;
+};
+
+template <typename BlockedFn>
+void DistanceField::Build(const std::vector<std::pair<int, int>>& targetCells, BlockedFn isBlocked)
+{
+    targets = targetCells;
+    heap.clear();
+    std::fill(dist.begin(), dist.end(), FLT_MAX);
+    std::fill(next.begin(), next.end(), -1);
+    std::fill(isTarget.begin(), isTarget.end(), static_cast<uint8_t>(0));
+
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            blocked[r * cols + c] = isBlocked(r, c) ? 1 : 0;
+        }
+    }
+
+    for (const auto& target : targets) {
+        if (target.first < 0 || target.first >= rows || target.second < 0 || target.second >= cols) continue;
+        int index = target.first * cols + target.second;
+        isTarget[index] = 1;
+        if (!blocked[index]) {
+            dist[index] = 0.0f;
+            Push(0.0f, index);
+        }
+    }
+
+    Propagate();
+    built = true;
+    stats.fullBuilds++;
+}
+
+template <typename BlockedFn>
+void DistanceField::Update(const std::vector<std::pair<int, int>>& changedCells, BlockedFn isBlocked)
+{
+    if (!built) {
+        return; // sin campo base no hay nada que actualizar
+    }
+    // con muchos cambios el dijkstra completo sale igual o mas barato
+    if (changedCells.size() * 4 > dist.size()) {
+        std::vector<std::pair<int, int>> savedTargets = targets;
+        Build(savedTargets, isBlocked);
+        return;
+    }
+
+    seedGeneration++;
+    if (seedGeneration == 0) {
+        std::fill(seedStamp.begin(), seedStamp.end(), 0u);
+        seedGeneration = 1;
+    }
+    seeds.clear();
+    heap.clear();
+
+    for (const auto& cell : changedCells) {
+        if (cell.first < 0 || cell.first >= rows || cell.second < 0 || cell.second >= cols) continue;
+        int index = cell.first * cols + cell.second;
+        uint8_t nowBlocked = isBlocked(cell.first, cell.second) ? 1 : 0;
+        if (nowBlocked == blocked[index]) {
+            continue; // se puso y se quito antes de actualizar, no paso nada
+        }
+        blocked[index] = nowBlocked;
+
+        if (nowBlocked) {
+            InvalidateSubtree(index);
+        } else if (seedStamp[index] != seedGeneration) {
+            seedStamp[index] = seedGeneration;
+            seeds.push_back(index);
+        }
+    }
+
+    if (seeds.empty()) {
+        return;
+    }
+
+    for (int index : seeds) {
+        SeedFromNeighbors(index);
+    }
+    Propagate();
+    stats.incrementalUpdates++;
+}
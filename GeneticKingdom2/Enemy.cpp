@@ -23,24 +23,37 @@
 #include "Enemy.h"
 #include "Projectile.h"
 #include "Map.h"
+#include "GdiplusAssetLoader.h"
 #include <algorithm>
 #include <random>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <cfloat>
 
 // tiempo entre recalculos de jitter - no tocar
 const float JITTER_RECALC_INTERVAL = 1.4f; 
 // multiplicador de jitter en y - hace que el movimiento se vea mas natural
 const float JITTER_Y_MULTIPLIER = 1.55f;    
+// cuantos objetivos (waypoints o subtargets) puede pasar en un solo Update
+const int MAX_MOVE_HOPS = 16;
+
+// contador global de revisiones de movimiento, ver GetMotionRevision
+static uint32_t nextMotionRevision = 0;
 
 // constructor principal - inicializa un enemigo con sus atributos basicos
 Enemy::Enemy(EnemyType type, float startX, float startY, const std::vector<std::pair<int, int>>& initialPath)
-    : type(type), x(startX), y(startY), path(initialPath), currentPathIndex(0), isActive(true), fitness(0.0), timeAlive(0.0f), FUSION_ASSISTANT_SECRET_MARKER_reachedBridge(false), pEnemyImage(NULL), pathJitter(0.0f), spawnDelay(0.0f), hasSpawned(true),
+    : Enemy(type, startX, startY, RouteTable::MakeRoute(initialPath, CELL_SIZE)) {
+}
+
+// igual, pero con una ruta ya guardada en la tabla del GA (no copia el camino)
+Enemy::Enemy(EnemyType type, float startX, float startY, RouteHandle initialRoute)
+    : type(type), x(startX), y(startY), route(std::move(initialRoute)), currentPathIndex(0), isActive(true), fitness(0.0), timeAlive(0.0f), FUSION_ASSISTANT_SECRET_MARKER_reachedBridge(false), pathJitter(0.0f), spawnDelay(0.0f), hasSpawned(true),
       subTargetX(0.0f), subTargetY(0.0f), hasSubTarget(false), timeSinceLastSubTargetRecalc(0.0f) {
+    BumpMotionRevision();
     InitializeAttributes();
     health = maxHealth;
-    if (!path.empty()) {
+    if (PathLength() > 0) {
         UpdateTargetPosition();
     } else {
         targetX = x;
@@ -57,7 +70,7 @@ Enemy::Enemy(const Enemy& parent)
       goldReward(parent.goldReward), 
       x(parent.x),
       y(parent.y),
-      path(parent.path), 
+      route(parent.route), 
       currentPathIndex(0), 
       isActive(true), 
       isFlying(parent.isFlying),
@@ -68,14 +81,14 @@ Enemy::Enemy(const Enemy& parent)
       fitness(0.0),
       timeAlive(0.0f),
       FUSION_ASSISTANT_SECRET_MARKER_reachedBridge(false),
-      pEnemyImage(NULL),
       spawnDelay(parent.spawnDelay),
       hasSpawned(parent.hasSpawned),
       subTargetX(parent.subTargetX), subTargetY(parent.subTargetY), 
       hasSubTarget(parent.hasSubTarget), timeSinceLastSubTargetRecalc(parent.timeSinceLastSubTargetRecalc)
 {
+    BumpMotionRevision();
     health = maxHealth;
-    if (!path.empty()) {
+    if (PathLength() > 0) {
         UpdateTargetPosition();
     } else {
         targetX = x;
@@ -86,9 +99,8 @@ Enemy::Enemy(const Enemy& parent)
 }
 
 
-// destructor - limpia la imagen del enemigo
+// destructor - la imagen es del AssetCache, aca no hay nada que limpiar
 Enemy::~Enemy() {
-    pEnemyImage = NULL; 
 }
 
 // inicializa los atributos del enemigo segun su tipo
@@ -139,7 +151,6 @@ void Enemy::InitializeAttributes() {
         break;
     }
     health = maxHealth;
-    LoadImage(); 
     
     // inicializa el jitter aleatorio para que no se muevan como robots
     std::random_device rd;
@@ -152,10 +163,12 @@ void Enemy::InitializeAttributes() {
 }
 
 void Enemy::UpdateTargetPosition() {
-    if (currentPathIndex < path.size()) {
-        // Path stores grid cells, convert to pixel coordinates (center of cell)
-        targetX = static_cast<float>(path[currentPathIndex].second * CELL_SIZE + CELL_SIZE / 2.0f);
-        targetY = static_cast<float>(path[currentPathIndex].first * CELL_SIZE + CELL_SIZE / 2.0f);
+    BumpMotionRevision();
+    if (currentPathIndex < PathLength()) {
+        // la ruta ya trae los waypoints en pixeles (centro de la celda)
+        const RoutePoint& point = route->points[currentPathIndex];
+        targetX = point.x;
+        targetY = point.y;
         hasSubTarget = false; // Force recalculation of sub-target
         timeSinceLastSubTargetRecalc = 0.0f; // Reset timer for sub-target recalculation
     } else {
@@ -179,6 +192,26 @@ double getMinFrom(double a, double b) {
     return a < b ? a : b;
 }
 
+// lleva el punto (px, py) a la franja de medio ancho halfWidth alrededor del
+// tramo a-b: se proyecta sobre el tramo y se recorta la distancia al costado
+static void ClampToCorridor(float ax, float ay, float bx, float by, float halfWidth, float& px, float& py) {
+    float segX = bx - ax;
+    float segY = by - ay;
+    float lengthSq = segX * segX + segY * segY;
+    if (lengthSq <= 0.0f) {
+        px = bx;
+        py = by;
+        return;
+    }
+    float length = std::sqrt(lengthSq);
+    float along = ((px - ax) * segX + (py - ay) * segY) / lengthSq;
+    float side = ((px - ax) * -segY + (py - ay) * segX) / length;
+    along = static_cast<float>(getMaxFrom(0.0, getMinFrom(along, 1.0)));
+    side = static_cast<float>(getMaxFrom(-halfWidth, getMinFrom(side, halfWidth)));
+    px = ax + segX * along - segY / length * side;
+    py = ay + segY * along + segX / length * side;
+}
+
 // que asco de funcion :V actualiza la posicion del enemigo
 // y maneja toda la shi del movimiento con jitter para que no se
 // vean como robots moviendose en linea recta. si lo tocas y lo rompes
@@ -189,6 +222,8 @@ void Enemy::Update(float deltaTime) {
         spawnDelay -= deltaTime;
         if (spawnDelay > 0.0f) return;
         hasSpawned = true;
+        deltaTime = -spawnDelay; // lo que sobro del paso despues de aparecer
+        spawnDelay = 0.0f;
     }
 
     // si esta muerto o inactivo no pierdas tiempo
@@ -196,105 +231,236 @@ void Enemy::Update(float deltaTime) {
         return;
     }
 
+    // para saber al final si cambio el rumbo (y los impactos predichos ya no valen)
+    const bool hadSubTarget = hasSubTarget;
+    const float oldSubTargetX = subTargetX;
+    const float oldSubTargetY = subTargetY;
+    const int oldPathIndex = currentPathIndex;
+
     // actualiza contadores de tiempo
     timeAlive += deltaTime;
     timeSinceLastSubTargetRecalc += deltaTime;
 
-    float currentMoveTargetX, currentMoveTargetY;
-    bool useSubTargetThisFrame = false;
-
-    // calcula distancia al objetivo principal
-    float mainPathDx = targetX - x;
-    float mainPathDy = targetY - y;
-    float distToMainTargetSq = mainPathDx * mainPathDx + mainPathDy * mainPathDy;
-
-    // aqui empieza la shi del jitter - genera subtargets aleatorios
-    // para que el movimiento no sea tan robotico
-    if (pathJitter > 0.0f && distToMainTargetSq > (0.5f * CELL_SIZE * 0.5f * CELL_SIZE)) {
-        if (!hasSubTarget || timeSinceLastSubTargetRecalc >= JITTER_RECALC_INTERVAL) {
-            std::random_device rd;
-            std::mt19937 gen(rd());
-            std::uniform_real_distribution<float> angleOffset(-static_cast<float>(M_PI) / 3.0f, static_cast<float>(M_PI) / 3.0f);
-            std::uniform_real_distribution<float> distFactor(0.6f, 1.0f);
-
-            // calcula angulo aleatorio y distancia para el subtarget
-            float mainPathAngle = atan2(mainPathDy, mainPathDx);
-            float randomAngle = mainPathAngle + angleOffset(gen);
-            float randomDist = pathJitter * distFactor(gen);
+    // pixeles que le tocan este frame. si llega a un objetivo antes de
+    // gastarlos sigue hacia el siguiente en vez de tirar lo que sobra, asi con
+    // pasos grandes (simulacion rapida) recorre lo mismo que con pasos chicos
+    float moveBudget = speed * deltaTime;
+    for (int hop = 0; hop < MAX_MOVE_HOPS && moveBudget > 0.0f && isActive; ++hop) {
+        float currentMoveTargetX, currentMoveTargetY;
+        bool useSubTargetThisFrame = false;
+
+        // calcula distancia al objetivo principal
+        float mainPathDx = targetX - x;
+        float mainPathDy = targetY - y;
+        float distToMainTargetSq = mainPathDx * mainPathDx + mainPathDy * mainPathDy;
+
+        // aqui empieza la shi del jitter - genera subtargets aleatorios
+        // para que el movimiento no sea tan robotico
+        if (pathJitter > 0.0f && distToMainTargetSq > (0.5f * CELL_SIZE * 0.5f * CELL_SIZE)) {
+            if (!hasSubTarget || timeSinceLastSubTargetRecalc >= JITTER_RECALC_INTERVAL) {
+                std::random_device rd;
+                std::mt19937 gen(rd());
+                std::uniform_real_distribution<float> angleOffset(-static_cast<float>(M_PI) / 3.0f, static_cast<float>(M_PI) / 3.0f);
+                std::uniform_real_distribution<float> distFactor(0.6f, 1.0f);
+
+                // calcula angulo aleatorio y distancia para el subtarget
+                float mainPathAngle = atan2(mainPathDy, mainPathDx);
+                float randomAngle = mainPathAngle + angleOffset(gen);
+                float randomDist = pathJitter * distFactor(gen);
             
-            // aplica offset al movimiento, con mas variacion en y para que se vea mejor
-            float dX_component = cos(randomAngle) * randomDist;
-            float dY_component = sin(randomAngle) * randomDist * JITTER_Y_MULTIPLIER;
+                // aplica offset al movimiento, con mas variacion en y para que se vea mejor
+                float dX_component = cos(randomAngle) * randomDist;
+                float dY_component = sin(randomAngle) * randomDist * JITTER_Y_MULTIPLIER;
             
-            float candidateSubTargetX = x + dX_component;
-            float candidateSubTargetY = y + dY_component;
-
-            // verifica que el subtarget no nos aleje del objetivo principal
-            float distFromCandidateSubToMainTargetSq = (targetX - candidateSubTargetX) * (targetX - candidateSubTargetX) + 
-                                                     (targetY - candidateSubTargetY) * (targetY - candidateSubTargetY);
-
-            if (distFromCandidateSubToMainTargetSq < distToMainTargetSq || distToMainTargetSq < (CELL_SIZE * 0.5f * CELL_SIZE * 0.5f) ) {
-                subTargetX = candidateSubTargetX;
-                subTargetY = candidateSubTargetY;
-
-                // mantiene el subtarget dentro de los limites del mapa
-                float mapWidth = static_cast<float>(GetSystemMetrics(SM_CXSCREEN));
-                float mapHeight = static_cast<float>(GetSystemMetrics(SM_CYSCREEN));
-                subTargetX = static_cast<float>(getMaxFrom(0.0, getMinFrom(static_cast<double>(subTargetX), static_cast<double>(mapWidth - 1.0f))));
-                subTargetY = static_cast<float>(getMaxFrom(0.0, getMinFrom(static_cast<double>(subTargetY), static_cast<double>(mapHeight - 1.0f))));
+                float candidateSubTargetX = x + dX_component;
+                float candidateSubTargetY = y + dY_component;
+
+                // el subtarget no se puede salir del pasillo que SmoothPath reviso
+                // alrededor del tramo (waypoint anterior -> objetivo), si no corta
+                // esquinas por celdas bloqueadas. los tramos entre celdas vecinas
+                // no los revisa nadie: en diagonal pueden rozar una esquina, asi
+                // que ahi no hay jitter de costado. en el primer tramo tampoco
+                float corridorStartX = x;
+                float corridorStartY = y;
+                float corridorHalfWidth = 0.0f;
+                if (currentPathIndex > 0 && currentPathIndex < PathLength()) {
+                    const std::pair<int, int>& fromCell = route->cells[currentPathIndex - 1];
+                    const std::pair<int, int>& toCell = route->cells[currentPathIndex];
+                    int spanR = std::abs(toCell.first - fromCell.first);
+                    int spanC = std::abs(toCell.second - fromCell.second);
+                    corridorStartX = route->points[currentPathIndex - 1].x;
+                    corridorStartY = route->points[currentPathIndex - 1].y;
+                    if (spanR > 1 || spanC > 1 || spanR + spanC == 1) {
+                        corridorHalfWidth = PATH_SMOOTH_CLEARANCE * CELL_SIZE;
+                    }
+                }
+                ClampToCorridor(corridorStartX, corridorStartY, targetX, targetY, corridorHalfWidth,
+                                candidateSubTargetX, candidateSubTargetY);
+
+                // verifica que el subtarget no nos aleje del objetivo principal
+                float distFromCandidateSubToMainTargetSq = (targetX - candidateSubTargetX) * (targetX - candidateSubTargetX) + 
+                                                         (targetY - candidateSubTargetY) * (targetY - candidateSubTargetY);
+
+                if (distFromCandidateSubToMainTargetSq < distToMainTargetSq || distToMainTargetSq < (CELL_SIZE * 0.5f * CELL_SIZE * 0.5f) ) {
+                    subTargetX = candidateSubTargetX;
+                    subTargetY = candidateSubTargetY;
+
+                    // mantiene el subtarget dentro de los limites del mapa
+                    float mapWidth = static_cast<float>(GetSystemMetrics(SM_CXSCREEN));
+                    float mapHeight = static_cast<float>(GetSystemMetrics(SM_CYSCREEN));
+                    subTargetX = static_cast<float>(getMaxFrom(0.0, getMinFrom(static_cast<double>(subTargetX), static_cast<double>(mapWidth - 1.0f))));
+                    subTargetY = static_cast<float>(getMaxFrom(0.0, getMinFrom(static_cast<double>(subTargetY), static_cast<double>(mapHeight - 1.0f))));
                 
-                hasSubTarget = true;
+                    hasSubTarget = true;
+                    useSubTargetThisFrame = true;
+                } else {
+                    hasSubTarget = false;
+                }
+                timeSinceLastSubTargetRecalc = 0.0f;
+            } else if (hasSubTarget) {
                 useSubTargetThisFrame = true;
-            } else {
-                hasSubTarget = false;
             }
-            timeSinceLastSubTargetRecalc = 0.0f;
         } else if (hasSubTarget) {
-            useSubTargetThisFrame = true;
+            hasSubTarget = false;
+        }
+
+        // decide si usar el subtarget o el target principal
+        if (useSubTargetThisFrame && hasSubTarget) {
+            currentMoveTargetX = subTargetX;
+            currentMoveTargetY = subTargetY;
+        } else {
+            currentMoveTargetX = targetX;
+            currentMoveTargetY = targetY;
+            hasSubTarget = false;
+        }
+
+        // mueve el enemigo hacia el target actual
+        float dx = currentMoveTargetX - x;
+        float dy = currentMoveTargetY - y;
+        float distance = std::sqrt(dx * dx + dy * dy);
+
+        // si esta cerca del target, actualiza posicion y siguiente objetivo
+        if (distance <= moveBudget || distance < 2.0f) { 
+            moveBudget -= distance;
+            x = currentMoveTargetX;
+            y = currentMoveTargetY;
+
+            if (useSubTargetThisFrame && hasSubTarget && 
+                (std::abs(x - subTargetX) < 2.0f && std::abs(y - subTargetY) < 2.0f)) {
+                hasSubTarget = false; 
+            } else {
+                currentPathIndex++;
+                if (currentPathIndex < PathLength()) {
+                    UpdateTargetPosition();
+                } else {
+                    isActive = false; 
+                    if (IsAlive()) { FUSION_ASSISTANT_SECRET_MARKER_reachedBridge = true; }
+                    hasSubTarget = false;
+                }
+            }
+        } else {
+            // mueve el enemigo interpolando la posicion
+            float moveX = (dx / distance) * moveBudget;
+            float moveY = (dy / distance) * moveBudget;
+            x += moveX;
+            y += moveY;
+            moveBudget = 0.0f;
         }
-    } else if (hasSubTarget) {
-        hasSubTarget = false;
     }
 
-    // decide si usar el subtarget o el target principal
-    if (useSubTargetThisFrame && hasSubTarget) {
-        currentMoveTargetX = subTargetX;
-        currentMoveTargetY = subTargetY;
-    } else {
-        currentMoveTargetX = targetX;
-        currentMoveTargetY = targetY;
-        hasSubTarget = false;
+    if (hasSubTarget != hadSubTarget || currentPathIndex != oldPathIndex || !isActive ||
+        (hasSubTarget && (subTargetX != oldSubTargetX || subTargetY != oldSubTargetY))) {
+        BumpMotionRevision();
     }
+}
 
-    // mueve el enemigo hacia el target actual
-    float dx = currentMoveTargetX - x;
-    float dy = currentMoveTargetY - y;
-    float distance = std::sqrt(dx * dx + dy * dy);
+void Enemy::BumpMotionRevision() {
+    motionRevision = ++nextMotionRevision;
+}
 
-    // si esta cerca del target, actualiza posicion y siguiente objetivo
-    if (distance < speed * deltaTime || distance < 2.0f) { 
-        x = currentMoveTargetX;
-        y = currentMoveTargetY;
+// donde va a estar dentro de t segundos si nada cambia: lo mismo que
+// GetMotionSegments pero caminando sin armar los tramos
+bool Enemy::PredictPosition(float t, float& outX, float& outY) const {
+    if (!isActive || !IsAlive()) {
+        return false;
+    }
+    outX = x;
+    outY = y;
+    if (!hasSpawned) {
+        t -= spawnDelay;
+    }
+    if (t <= 0.0f || speed <= 0.0f) {
+        return true;
+    }
 
-        if (useSubTargetThisFrame && hasSubTarget && 
-            (std::abs(x - subTargetX) < 2.0f && std::abs(y - subTargetY) < 2.0f)) {
-            hasSubTarget = false; 
-        } else {
-            currentPathIndex++;
-            if (currentPathIndex < path.size()) {
-                UpdateTargetPosition();
-            } else {
-                isActive = false; 
-                if (IsAlive()) { FUSION_ASSISTANT_SECRET_MARKER_reachedBridge = true; }
-                hasSubTarget = false;
+    float budget = speed * t;
+    auto walk = [&](float tx, float ty) {
+        float dx = tx - outX;
+        float dy = ty - outY;
+        float d = std::sqrt(dx * dx + dy * dy);
+        if (d >= budget) {
+            if (d > 0.0f) {
+                outX += dx / d * budget;
+                outY += dy / d * budget;
             }
+            return true;
         }
-    } else {
-        // mueve el enemigo interpolando la posicion
-        float moveX = (dx / distance) * speed * deltaTime;
-        float moveY = (dy / distance) * speed * deltaTime;
-        x += moveX;
-        y += moveY;
+        budget -= d;
+        outX = tx;
+        outY = ty;
+        return false;
+    };
+    if (hasSubTarget && walk(subTargetX, subTargetY)) return true;
+    if (walk(targetX, targetY)) return true;
+    for (size_t i = static_cast<size_t>(currentPathIndex) + 1; i < PathLength(); ++i) {
+        if (walk(route->points[i].x, route->points[i].y)) return true;
+    }
+    return false; // para entonces ya llego al puente
+}
+
+// tramos rectos que le quedan desde ahora: la espera del spawn, el subtarget
+// del jitter si tiene uno, el waypoint actual y el resto de la ruta. despues
+// del ultimo llega al puente y ya no esta para que le peguen
+void Enemy::GetMotionSegments(std::vector<MotionSegment>& out) const {
+    out.clear();
+    if (!isActive || !IsAlive()) {
+        return;
+    }
+
+    float t = 0.0f;
+    float cx = x;
+    float cy = y;
+    if (!hasSpawned && spawnDelay > 0.0f) {
+        out.push_back({ 0.0f, spawnDelay, x, y, 0.0f, 0.0f });
+        t = spawnDelay;
+    }
+    if (speed <= 0.0f) {
+        out.push_back({ t, FLT_MAX, x, y, 0.0f, 0.0f });
+        return;
+    }
+
+    auto moveTo = [&](float tx, float ty) {
+        float dx = tx - cx;
+        float dy = ty - cy;
+        float d = std::sqrt(dx * dx + dy * dy);
+        if (d <= 0.0f) return;
+        float duration = d / speed;
+        out.push_back({ t, t + duration, cx, cy, dx / d * speed, dy / d * speed });
+        t += duration;
+        cx = tx;
+        cy = ty;
+    };
+    if (hasSubTarget) {
+        moveTo(subTargetX, subTargetY);
+    }
+    moveTo(targetX, targetY);
+    for (size_t i = static_cast<size_t>(currentPathIndex) + 1; i < PathLength(); ++i) {
+        moveTo(route->points[i].x, route->points[i].y);
+    }
+
+    // parado justo en el ultimo punto: igual se le puede pegar ahora mismo
+    if (out.empty()) {
+        out.push_back({ 0.0f, 0.0f, x, y, 0.0f, 0.0f });
     }
 }
 
@@ -319,23 +485,20 @@ void Enemy::Draw(HDC hdc) const {
         return;
     }
 
+    // lado entero del sprite, el mismo con que se hornea en Sprites.pak
+    const int spriteSize = GetAssetDrawSize(GetAssetId(), CELL_SIZE);
+    Gdiplus::Image* pEnemyImage = AssetCache::Instance().GetAs<Gdiplus::Image>(GetAssetId());
     if (pEnemyImage && pEnemyImage->GetLastStatus() == Gdiplus::Ok) {
-        // dibuja la imagen del enemigo con antialiasing y bicubic
+        // dibuja la imagen del enemigo con antialiasing y bicubic (si no viene horneada)
         Gdiplus::Graphics graphics(hdc);
         graphics.SetSmoothingMode(Gdiplus::SmoothingModeAntiAlias);
         graphics.SetInterpolationMode(Gdiplus::InterpolationModeHighQualityBicubic);
 
-        float enemyDrawWidth = CELL_SIZE * 0.75f;
-        float enemyDrawHeight = CELL_SIZE * 0.75f;
-
-        // centra la imagen en x,y
-        graphics.DrawImage(
-            pEnemyImage,
-            x - enemyDrawWidth / 2.0f,
-            y - enemyDrawHeight / 2.0f,
-            enemyDrawWidth,
-            enemyDrawHeight
-        );
+        // centra la imagen en x,y, redondeado al pixel
+        DrawSprite(graphics, pEnemyImage,
+                   Gdiplus::Rect(static_cast<int>(std::floor(x + 0.5f)) - spriteSize / 2,
+                                 static_cast<int>(std::floor(y + 0.5f)) - spriteSize / 2,
+                                 spriteSize, spriteSize));
 
     } else {
         // si no hay imagen dibuja un rectangulo de color, que mas quieres que haga?
@@ -371,11 +534,11 @@ void Enemy::Draw(HDC hdc) const {
 
     // dibuja la barra de vida si el enemigo esta vivo y ha spawneado
     if (IsAlive() && hasSpawned) { 
-        int barWidth = CELL_SIZE * 0.75f; // mismo ancho que el sprite
+        int barWidth = spriteSize; // mismo ancho que el sprite
         int barHeight = 5;
         // pon la barra arriba del enemigo
         int barX = static_cast<int>(x - barWidth / 2.0f);
-        int barY = static_cast<int>(y - (CELL_SIZE * 0.75f) / 2.0f - barHeight - 2); 
+        int barY = static_cast<int>(y - spriteSize / 2.0f - barHeight - 2); 
 
         // fondo de la barra (rojo o gris oscuro)
         HBRUSH hBgBrush;
@@ -454,6 +617,7 @@ void Enemy::TakeDamage(int damageAmount, ProjectileType projectileType) {
         health = 0;
         isActive = false; 
         FUSION_ASSISTANT_SECRET_MARKER_reachedBridge = false; 
+        BumpMotionRevision();
         wss_td << L", IS NOW DEAD & INACTIVE";
     } else {
         wss_td << L", IsActive: " << (isActive ? L"Yes" : L"No");
@@ -476,6 +640,7 @@ bool Enemy::IsActive() const {
 // activa/desactiva el enemigo (no shit)
 void Enemy::SetActive(bool active) {
     isActive = active;
+    BumpMotionRevision();
 }
 
 // cuanto oro suelta al morir, si es que muere
@@ -502,9 +667,13 @@ bool Enemy::IsFlying() const {
 
 // dale un nuevo camino al papu
 void Enemy::SetPath(const std::vector<std::pair<int, int>>& newPath) {
-    path = newPath;
+    SetRoute(RouteTable::MakeRoute(newPath, CELL_SIZE));
+}
+
+void Enemy::SetRoute(RouteHandle newRoute) {
+    route = std::move(newRoute);
     currentPathIndex = 0;
-    if (!path.empty()) {
+    if (PathLength() > 0) {
         UpdateTargetPosition();
         isActive = true; // lo reactivamos si estaba inactivo por no tener camino
     } else {
@@ -533,6 +702,12 @@ double Enemy::GetFitness() const {
 // timeSurvived: cuanto tiempo sobrevivio el bastardo
 // reachedBridge: si llego al puente o no (por aquello xd)
 void Enemy::CalculateFitness(const std::pair<int, int>& bridgeLocation, float mapWidth, float mapHeight, float timeSurvived, bool FUSION_ASSISTANT_SECRET_MARKER_reachedBridge_param) {
+    fitness = ComputeFitness(x, y, bridgeLocation, mapWidth, mapHeight, timeSurvived,
+                             FUSION_ASSISTANT_SECRET_MARKER_reachedBridge_param, health <= 0);
+}
+
+double Enemy::ComputeFitness(float x, float y, const std::pair<int, int>& bridgeLocation, float mapWidth, float mapHeight,
+                             float timeSurvived, bool reachedBridge, bool died) {
     // Cálculo base de distancia como antes
     float maxPossibleDistance = getMaxFrom(1.0f, std::sqrt(mapWidth * mapWidth + mapHeight * mapHeight)); 
     // Cálculo correcto de distancia al puente
@@ -556,18 +731,18 @@ void Enemy::CalculateFitness(const std::pair<int, int>& bridgeLocation, float ma
         pathDiversityBonus = 15.0;
     }
 
-    double bridgeBonus = FUSION_ASSISTANT_SECRET_MARKER_reachedBridge_param ? 100.0 : 0.0;
+    double bridgeBonus = reachedBridge ? 100.0 : 0.0;
     double survivalBonus = static_cast<double>(timeSurvived) * 5.0; // Aumentado el peso del tiempo de supervivencia
     
     // Nuevo cálculo de fitness que da más peso a la distancia y supervivencia
-    fitness = (distanceScore * 60.0) + bridgeBonus + survivalBonus + pathDiversityBonus;
+    double fitness = (distanceScore * 60.0) + bridgeBonus + survivalBonus + pathDiversityBonus;
     
-    if (health <= 0 && !FUSION_ASSISTANT_SECRET_MARKER_reachedBridge_param) { 
+    if (died && !reachedBridge) { 
         fitness *= 0.5; // Penalización por muerte sin llegar al puente
     }
 
     // Asegurarse de que el fitness nunca sea negativo
-    fitness = getMaxFrom(0.0, fitness);
+    return getMaxFrom(0.0, fitness);
 }
 
 // maldita funcion de mutacion - aqui es donde los enemigos se vuelven mas fuertes o mas debiles
@@ -644,6 +819,10 @@ void Enemy::Mutate(float mutationRate) {
  * lo cual no deberia pasar nunca pero por si acaso lo manejamos.
  */
 void Enemy::ResetForNewWave(float startX, float startY, const std::vector<std::pair<int, int>>& newPath) {
+    ResetForNewWave(startX, startY, RouteTable::MakeRoute(newPath, CELL_SIZE));
+}
+
+void Enemy::ResetForNewWave(float startX, float startY, RouteHandle newRoute) {
     std::wstringstream wss_reset;
     wss_reset << L"Enemy::ResetForNewWave - ID: " << std::hex << this 
               << L", Type: " << static_cast<int>(type)
@@ -653,7 +832,7 @@ void Enemy::ResetForNewWave(float startX, float startY, const std::vector<std::p
 
     x = startX;
     y = startY;
-    path = newPath;
+    route = std::move(newRoute);
     currentPathIndex = 0;
     
     isActive = true;
@@ -668,7 +847,7 @@ void Enemy::ResetForNewWave(float startX, float startY, const std::vector<std::p
               << L", SpawnDelay: " << spawnDelay;
     OutputDebugStringW((wss_reset.str() + L"\n").c_str());
 
-    if (!path.empty()) {
+    if (PathLength() > 0) {
         UpdateTargetPosition();
     } else {
         targetX = x;
@@ -694,63 +873,14 @@ std::wstring GetEnemyTypeName(EnemyType type) {
     }
 }
 
-// carga la imagen del enemigo, si falla devuelve false y loggea el error
-// intenta cargar desde varios directorios porque windows es una mrd
-// y nunca sabes donde esta el directorio de trabajo
-bool Enemy::LoadImage() {
-    pEnemyImage = NULL;
-    std::wstring fileName;
+// que sprite le toca a cada tipo
+AssetId Enemy::GetAssetId() const {
     switch (type) {
-    case EnemyType::OGRE: fileName = L"Ogre.png"; break;
-    case EnemyType::DARK_ELF: fileName = L"DarkElf.png"; break;
-    case EnemyType::HARPY: fileName = L"Harpy.png"; break;
-    case EnemyType::MERCENARY: fileName = L"Mercenary.png"; break;
-    default:
-        OutputDebugStringW(L"Enemy::LoadImage - Unknown enemy type\n");
-        return false;
+    case EnemyType::DARK_ELF: return AssetId::ENEMY_DARK_ELF;
+    case EnemyType::HARPY: return AssetId::ENEMY_HARPY;
+    case EnemyType::MERCENARY: return AssetId::ENEMY_MERCENARY;
+    default: return AssetId::ENEMY_OGRE;
     }
-
-    const wchar_t* possibleBasePaths[] = {
-        L"Assets\\Enemies\\",
-        L"..\\GeneticKingdom2\\Assets\\Enemies\\",
-        L"GeneticKingdom2\\Assets\\Enemies\\"
-    };
-
-    for (const wchar_t* basePath : possibleBasePaths) {
-        std::wstring fullPath = basePath + fileName;
-        Gdiplus::Image* tempImage = Gdiplus::Image::FromFile(fullPath.c_str());
-        if (tempImage && tempImage->GetLastStatus() == Gdiplus::Ok) {
-            pEnemyImage = tempImage;
-            return true;
-        }
-        if (tempImage) {
-            delete tempImage;
-            tempImage = NULL;
-        }
-    }
-
-    // ultimo intento - buscar desde el path del exe
-    // porque microsoft no puede hacer nada simple
-    WCHAR exePath[MAX_PATH];
-    GetModuleFileNameW(NULL, exePath, MAX_PATH);
-    WCHAR* lastSlash = wcsrchr(exePath, L'\\');
-    if (lastSlash != NULL) {
-        *lastSlash = L'\0';
-        std::wstring fullPath = exePath;
-        fullPath += L"\\Assets\\Enemies\\" + fileName;
-        Gdiplus::Image* tempImage = Gdiplus::Image::FromFile(fullPath.c_str());
-        if (tempImage && tempImage->GetLastStatus() == Gdiplus::Ok) {
-            pEnemyImage = tempImage;
-            return true;
-        }
-        if (tempImage) {
-            delete tempImage;
-            tempImage = NULL;
-        }
-    }
-
-    OutputDebugStringW((L"Enemy::LoadImage - Failed to load image: " + fileName + L"\n").c_str());
-    return false;
 }
 
 // establece el delay de spawn del enemigo y lo marca como no spawneado
@@ -758,6 +888,7 @@ bool Enemy::LoadImage() {
 void Enemy::SetSpawnDelay(float d) {
     spawnDelay = d;
     hasSpawned = false;
+    BumpMotionRevision();
 }
 
 // devuelve si el enemigo ya ha spawneado o no
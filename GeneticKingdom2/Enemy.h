@@ -16,6 +16,16 @@
 #include <string>
 #include <utility> // para std::pair
 #include <algorithm>  // For std::clamp
+#include <cstdint>
+
+// tramos de movimiento para predecir impactos
+#include "HitPredictor.h"
+
+// rutas compartidas entre enemigos
+#include "RouteTable.h"
+
+// sprites compartidos
+#include "AssetCache.h"
 
 // gdi+ para dibujar los sprites
 #include <objidl.h>
@@ -77,6 +87,7 @@ namespace std {
 class Enemy {
 public:
     Enemy(EnemyType type, float startX, float startY, const std::vector<std::pair<int, int>>& initialPath);
+    Enemy(EnemyType type, float startX, float startY, RouteHandle initialRoute);
     ~Enemy();
 
     void Update(float deltaTime);
@@ -92,12 +103,27 @@ public:
     EnemyType GetType() const;
     bool IsFlying() const;
     void SetPath(const std::vector<std::pair<int, int>>& newPath);
+    void SetRoute(RouteHandle newRoute);
+    const RouteHandle& GetRoute() const { return route; }
+
+    // el recorrido que le queda si nada cambia, en tramos rectos desde ahora
+    // (ver HitPredictor.h). la revision cambia cada vez que eso deja de valer:
+    // nuevo subtarget del jitter, siguiente waypoint, muerte, ruta nueva...
+    void GetMotionSegments(std::vector<MotionSegment>& out) const;
+    uint32_t GetMotionRevision() const { return motionRevision; }
+    // donde va a estar dentro de t segundos. false si para entonces ya no esta
+    bool PredictPosition(float t, float& outX, float& outY) const;
     float GetHealthPercentage() const;
 
     // funciones del algoritmo genetico
     double GetFitness() const;
     void CalculateFitness(const std::pair<int, int>& bridgeLocation, float mapWidth, float mapHeight, float timeSurvived, bool FUSION_ASSISTANT_SECRET_MARKER_reachedBridge);
     bool HasReachedBridge() const;
+
+    // la formula de CalculateFitness para un enemigo que termino en (x, y); la
+    // usa tambien el estimador del GA para que los dos puntajes se comparen
+    static double ComputeFitness(float x, float y, const std::pair<int, int>& bridgeLocation, float mapWidth, float mapHeight,
+                                 float timeSurvived, bool reachedBridge, bool died);
     float GetTimeAlive() const { return timeAlive; }
     
     // funciones para crear nuevas generaciones
@@ -106,7 +132,7 @@ public:
     int GetMaxHealth() const { return maxHealth; }
     float GetSpeed() const { return speed; }
     void SetMaxHealth(int newMaxHealth) { maxHealth = newMaxHealth; health = newMaxHealth; }
-    void SetSpeed(float newSpeed) { speed = newSpeed; }
+    void SetSpeed(float newSpeed) { speed = newSpeed; BumpMotionRevision(); }
     int GetHealth() const { return health; }
     
     float GetPathJitter() const { return pathJitter; }
@@ -117,9 +143,10 @@ public:
     bool HasSpawned() const;
 
     void ResetForNewWave(float startX, float startY, const std::vector<std::pair<int, int>>& newPath);
+    void ResetForNewWave(float startX, float startY, RouteHandle newRoute);
 
-    bool LoadImage();
-    Gdiplus::Image* pEnemyImage;
+    // sprite del tipo en el AssetCache (se carga una vez por proceso, no por enemigo)
+    AssetId GetAssetId() const;
 
     float GetArrowResistance() const { return resistanceArrow; }
     void SetArrowResistance(float resistance) { resistanceArrow = std::clamp(resistance, 0.1f, 3.0f); }
@@ -140,9 +167,11 @@ private:
     float x, y;
     float targetX, targetY;
 
-    std::vector<std::pair<int, int>> path;
+    RouteHandle route; // compartida, nunca se modifica
     int currentPathIndex;
 
+    size_t PathLength() const { return route ? route->Size() : 0; }
+
     bool isActive;
     bool isFlying;
 
@@ -165,6 +194,10 @@ private:
 
     float spawnDelay;
     bool hasSpawned;
+
+    // unica entre todos los enemigos, asi un vector nuevo no se confunde con el viejo
+    uint32_t motionRevision = 0;
+    void BumpMotionRevision();
 };
 
 // funcion para obtener el nombre del tipo de enemigo
@@ -0,0 +1,120 @@
+// carga de png con gdi+ para el AssetCache
+
+#include "framework.h"
+#include "GdiplusAssetLoader.h"
+
+GdiplusAssetLoader::GdiplusAssetLoader()
+    : fileOpens(0)
+{
+}
+
+namespace {
+
+std::wstring MakeAssetPath(const std::wstring& basePath, AssetId id)
+{
+    return basePath + GetAssetFolder(id) + L"\\" + GetAssetFileName(id);
+}
+
+} // namespace
+
+Gdiplus::Image* GdiplusAssetLoader::TryLoad(const std::wstring& basePath, AssetId id)
+{
+    std::wstring fullPath = MakeAssetPath(basePath, id);
+    fileOpens++;
+    Gdiplus::Image* image = Gdiplus::Image::FromFile(fullPath.c_str());
+    if (image && image->GetLastStatus() == Gdiplus::Ok) {
+        WCHAR debugMsg[512];
+        swprintf_s(debugMsg, L"Asset cargado: %s\n", fullPath.c_str());
+        OutputDebugStringW(debugMsg);
+        return image;
+    }
+    delete image;
+    return NULL;
+}
+
+std::vector<std::wstring> GdiplusAssetLoader::GetSearchBases()
+{
+    std::vector<std::wstring> bases;
+    bases.push_back(L"Assets\\");
+    bases.push_back(L"..\\GeneticKingdom2\\Assets\\");
+    bases.push_back(L"GeneticKingdom2\\Assets\\");
+    WCHAR exePath[MAX_PATH];
+    GetModuleFileNameW(NULL, exePath, MAX_PATH);
+    WCHAR* lastSlash = wcsrchr(exePath, L'\\');
+    if (lastSlash != NULL) {
+        *(lastSlash + 1) = L'\0';
+        bases.push_back(std::wstring(exePath) + L"Assets\\");
+    }
+    return bases;
+}
+
+std::wstring GdiplusAssetLoader::FindFile(AssetId id)
+{
+    for (const std::wstring& base : GetSearchBases()) {
+        std::wstring path = MakeAssetPath(base, id);
+        if (GetFileAttributesW(path.c_str()) != INVALID_FILE_ATTRIBUTES) {
+            return path;
+        }
+    }
+    return std::wstring();
+}
+
+uint64_t GdiplusAssetLoader::GetFileStamp(const std::wstring& path)
+{
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (path.empty() || !GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data)) {
+        return 0;
+    }
+    return (static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+}
+
+// intenta cargar desde varios directorios porque nunca sabes donde esta el
+// directorio de trabajo
+void* GdiplusAssetLoader::Load(AssetId id)
+{
+    if (!workingBase.empty()) {
+        if (Gdiplus::Image* image = TryLoad(workingBase, id)) {
+            return image;
+        }
+    }
+
+    for (const std::wstring& base : GetSearchBases()) {
+        if (base == workingBase) {
+            continue;
+        }
+        if (Gdiplus::Image* image = TryLoad(base, id)) {
+            workingBase = base;
+            return image;
+        }
+    }
+
+    WCHAR debugMsg[256];
+    swprintf_s(debugMsg, L"No se pudo cargar el asset %s\n", GetAssetFileName(id));
+    OutputDebugStringW(debugMsg);
+    return NULL;
+}
+
+void GdiplusAssetLoader::Free(AssetId, void* handle)
+{
+    delete static_cast<Gdiplus::Image*>(handle);
+}
+
+void DrawSprite(Gdiplus::Graphics& graphics, Gdiplus::Image* image, const Gdiplus::Rect& dest)
+{
+    const UINT width = image->GetWidth();
+    const UINT height = image->GetHeight();
+    if (width != static_cast<UINT>(dest.Width) || height != static_cast<UINT>(dest.Height)) {
+        graphics.DrawImage(image, dest, 0, 0, width, height, Gdiplus::UnitPixel);
+        return;
+    }
+
+    // ya viene horneado a este tamaño: vecino mas cercano con el medio pixel
+    // corrido es una copia exacta, sin el costo ni el borroneo del bicubic
+    const Gdiplus::InterpolationMode oldInterpolation = graphics.GetInterpolationMode();
+    const Gdiplus::PixelOffsetMode oldPixelOffset = graphics.GetPixelOffsetMode();
+    graphics.SetInterpolationMode(Gdiplus::InterpolationModeNearestNeighbor);
+    graphics.SetPixelOffsetMode(Gdiplus::PixelOffsetModeHalf);
+    graphics.DrawImage(image, dest, 0, 0, width, height, Gdiplus::UnitPixel);
+    graphics.SetPixelOffsetMode(oldPixelOffset);
+    graphics.SetInterpolationMode(oldInterpolation);
+}
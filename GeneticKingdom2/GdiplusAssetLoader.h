@@ -0,0 +1,53 @@
+/*
+ * gdiplusassetloader.h - el AssetLoader del juego: png de Assets con gdi+
+ *
+ * prueba las rutas de siempre (Assets\, ..\GeneticKingdom2\Assets\,
+ * GeneticKingdom2\Assets\ y la carpeta del exe). la primera base que
+ * funciona se prueba primero para los demas, asi que despues del primer
+ * sprite cada carga es un solo FromFile.
+ *
+ * DrawSprite es como dibujan los Draw: si el sprite ya tiene el tamaño del
+ * destino (los de Sprites.pak) es una copia 1:1, si no se escala con bicubic.
+ */
+
+#pragma once
+
+#include <Windows.h>
+#include <objidl.h>
+#include <gdiplus.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "AssetCache.h"
+
+class GdiplusAssetLoader : public AssetLoader {
+public:
+    GdiplusAssetLoader();
+
+    // devuelve un Gdiplus::Image*
+    void* Load(AssetId id) override;
+    void Free(AssetId id, void* handle) override;
+
+    // veces que se llamo a Image::FromFile
+    size_t GetFileOpenCount() const { return fileOpens; }
+
+    // la carpeta Assets\ donde se encontro el ultimo sprite (vacio si ninguno)
+    const std::wstring& GetWorkingBase() const { return workingBase; }
+
+    // las carpetas Assets\ candidatas, en el orden en que se prueban
+    static std::vector<std::wstring> GetSearchBases();
+
+    // la ruta del png del asset en la primera base que lo tenga, o vacio
+    static std::wstring FindFile(AssetId id);
+    // ultima escritura del archivo (FILETIME en 64 bits), 0 si no existe
+    static uint64_t GetFileStamp(const std::wstring& path);
+
+private:
+    Gdiplus::Image* TryLoad(const std::wstring& basePath, AssetId id);
+
+    std::wstring workingBase;  // la base que funciono la ultima vez
+    size_t fileOpens;
+};
+
+// dibuja el sprite en dest (entero). con el mismo tamaño no se interpola nada
+void DrawSprite(Gdiplus::Graphics& graphics, Gdiplus::Image* image, const Gdiplus::Rect& dest);
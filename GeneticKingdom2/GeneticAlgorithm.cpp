@@ -55,17 +55,16 @@ GeneticAlgorithm::GeneticAlgorithm(int populationSize, float mutationRate, float
                                    const Map* gameMap)
     : populationSize(populationSize), mutationRate(0.15f), crossoverRate(crossoverRate),
       enemyEntryPoint(entryPoint), bridgeLocation(bridgeLocation), currentMap(gameMap),
-      enemiesPerTypeBase(3), maxEnemiesPerType(5), wavesPerIncrement(2), wavesGeneratedCount(0) {
+      enemiesPerTypeBase(3), maxEnemiesPerType(5), wavesPerIncrement(2), wavesGeneratedCount(0),
+      routeTable(CELL_SIZE) {
     
     if (currentMap) {
-        GenerateAlternativePaths(4);
-        if (alternativePaths.empty()) {
-            initialEnemyPath = currentMap->GetPath(entryPoint, bridgeLocation); 
-             if (!initialEnemyPath.empty()) alternativePaths.push_back(initialEnemyPath);
-             OutputDebugStringW(L"GeneticAlgorithm Warning: Could not generate multiple alternative paths. Using single initial path.\n");
-        } else {
-            initialEnemyPath = alternativePaths[0];
-        }
+        // las rutas alternativas se piden sin bloquear y llegan en los Update
+        // del mapa. mientras tanto todos van por el camino del campo de
+        // distancias, que no corre ningun a*
+        initialEnemyPath = routeTable.Intern(FindPathToBridge());
+        if (!initialEnemyPath->Empty()) alternativePaths.push_back(initialEnemyPath);
+        RefreshPathsAsync();
     }
     
     OutputDebugStringW(L"GeneticAlgorithm initialized\n");
@@ -73,6 +72,8 @@ GeneticAlgorithm::GeneticAlgorithm(int populationSize, float mutationRate, float
 
 // Destructor
 GeneticAlgorithm::~GeneticAlgorithm() {
+    // el callback apunta a este objeto, que no lo llame nadie
+    if (pendingPathRequest) pendingPathRequest->Cancel();
     OutputDebugStringW(L"GeneticAlgorithm destroyed\n");
 }
 
@@ -90,11 +91,9 @@ GeneticAlgorithm::~GeneticAlgorithm() {
 void GeneticAlgorithm::InitializePopulation() {
     population.clear();
     if (alternativePaths.empty() && currentMap) {
-        GenerateAlternativePaths(10);
-        if (alternativePaths.empty()) {
-            initialEnemyPath = currentMap->GetPath(enemyEntryPoint, bridgeLocation);
-            if (!initialEnemyPath.empty()) alternativePaths.push_back(initialEnemyPath);
-        }
+        // las alternativas siguen en camino (RefreshPathsAsync), no las esperamos
+        initialEnemyPath = routeTable.Intern(FindPathToBridge());
+        if (!initialEnemyPath->Empty()) alternativePaths.push_back(initialEnemyPath);
     }
     if (alternativePaths.empty()) {
         OutputDebugStringW(L"GeneticAlgorithm::InitializePopulation - ERROR: No paths available!\n");
@@ -364,11 +363,13 @@ void GeneticAlgorithm::CrossoverAndMutate() {
                         << L", Starting mutations: " << mutationCount << L"\n";
     OutputDebugStringW(wss_debug_crossover.str().c_str());
 
+    // se generan de mas y el estimador se queda con los mas prometedores
+    const size_t candidateCount = static_cast<size_t>(populationSize) * GA_SURROGATE_OVERSAMPLE;
     std::vector<Enemy> newOffspringPopulation;
-    newOffspringPopulation.reserve(populationSize);
+    newOffspringPopulation.reserve(candidateCount);
 
     if (parents.empty()) { 
-        for(int i=0; i < populationSize; ++i) {
+        for(size_t i=0; i < candidateCount; ++i) {
             Enemy newEnemy = CreateRandomEnemy();
             Mutate(newEnemy);  // Asegurarnos de contar las mutaciones
             newOffspringPopulation.push_back(newEnemy);
@@ -379,7 +380,7 @@ void GeneticAlgorithm::CrossoverAndMutate() {
         std::uniform_real_distribution<float> dis(0.0f, 1.0f);
         std::uniform_int_distribution<int> parentDist(0, static_cast<int>(parents.size()) - 1);
 
-        while (newOffspringPopulation.size() < static_cast<size_t>(populationSize)) {
+        while (newOffspringPopulation.size() < candidateCount) {
             if (parents.size() >= 2 && dis(gen) < crossoverRate) {
                 int parent1Idx = parentDist(gen);
                 int parent2Idx = parentDist(gen);
@@ -392,7 +393,7 @@ void GeneticAlgorithm::CrossoverAndMutate() {
                 Mutate(offspring.second);
                 
                 newOffspringPopulation.push_back(offspring.first);
-                if (newOffspringPopulation.size() < static_cast<size_t>(populationSize)) {
+                if (newOffspringPopulation.size() < candidateCount) {
                     newOffspringPopulation.push_back(offspring.second);
                 }
             } else { 
@@ -403,6 +404,7 @@ void GeneticAlgorithm::CrossoverAndMutate() {
         }
     }
     
+    ScreenOffspring(newOffspringPopulation, static_cast<size_t>(populationSize));
     RebalanceEnemyTypes(newOffspringPopulation, currentTargetEnemiesPerType);
     population = newOffspringPopulation;
 
@@ -435,13 +437,13 @@ std::vector<Enemy> GeneticAlgorithm::GenerateNewGeneration() {
     /* sin caminos no hay juego BV */
     if (alternativePaths.empty()) {
          wss_gen_new_wave << L"  WARNING: No alternative paths. Will use initialEnemyPath for all.\n";
-        if(currentMap && initialEnemyPath.empty()) initialEnemyPath = currentMap->GetPath(enemyEntryPoint, bridgeLocation);
-        if(initialEnemyPath.empty() && (alternativePaths.empty() || alternativePaths[0].empty())){
+        if(currentMap && (!initialEnemyPath || initialEnemyPath->Empty())) initialEnemyPath = routeTable.Intern(FindPathToBridge());
+        if((!initialEnemyPath || initialEnemyPath->Empty()) && (alternativePaths.empty() || alternativePaths[0]->Empty())){
             wss_gen_new_wave << L"  CRITICAL ERROR: No paths available AT ALL. Cannot generate new wave.\n";
             OutputDebugStringW(wss_gen_new_wave.str().c_str());
             return {};
         }
-        if(alternativePaths.empty() && !initialEnemyPath.empty()) alternativePaths.push_back(initialEnemyPath);
+        if(alternativePaths.empty() && initialEnemyPath && !initialEnemyPath->Empty()) alternativePaths.push_back(initialEnemyPath);
     }
 
     /* aqui es donde la magia sucede - creamos los nuevos enemigos */
@@ -504,8 +506,30 @@ void GeneticAlgorithm::SetCurrentPopulation(const std::vector<Enemy>& population
 void GeneticAlgorithm::SetMapDetails(const Map* map) {
     currentMap = map;
     if (currentMap) {
-        initialEnemyPath = currentMap->GetPath(enemyEntryPoint, bridgeLocation);
+        initialEnemyPath = routeTable.Intern(FindPathToBridge());
+    }
+}
+
+/*
+ * camino de la entrada al puente. si el puente es el del mapa (lo normal)
+ * se baja por el campo de distancias compartido, que solo se recalcula en la
+ * zona que cambio cuando se ponen torres u obstaculos. si alguien nos dio
+ * otro destino caemos al a* de siempre
+ */
+std::vector<std::pair<int, int>> GeneticAlgorithm::FindPathToBridge() const {
+    if (!currentMap) {
+        return {};
     }
+    std::vector<std::pair<int, int>> cells;
+    if (bridgeLocation == currentMap->GetBridgeGridLocation()) {
+        currentMap->GetPathToBridge(enemyEntryPoint, cells);
+    } else {
+        currentMap->GetPath(enemyEntryPoint, bridgeLocation, cells);
+    }
+    // a los enemigos les damos solo las esquinas, no cada celda
+    std::vector<std::pair<int, int>> waypoints;
+    currentMap->SmoothPath(cells, waypoints);
+    return waypoints;
 }
 
 /* 
@@ -540,6 +564,75 @@ Enemy GeneticAlgorithm::SelectParentRoulette() const {
     return population.back();
 }
 
+/*
+ * el fitness de verdad tarda una oleada entera en salir, asi que para elegir
+ * entre los hijos se usa el estimador: cada ruta se muestrea una vez sobre el
+ * raster de amenaza de las torres actuales y despues cada candidato es un
+ * par de busquedas binarias. como GenerateNewGeneration reparte las rutas en
+ * ronda, el puntaje de un candidato es el promedio sobre todas
+ */
+void GeneticAlgorithm::ScreenOffspring(std::vector<Enemy>& candidates, size_t keep) {
+    if (candidates.size() <= keep) {
+        return;
+    }
+
+    surrogate.ClearRoutes();
+    if (currentMap) {
+        for (const RouteHandle& route : alternativePaths) {
+            if (route && !route->Empty()) surrogate.AddRoute(*route, currentMap->GetThreatMap(), CELL_SIZE);
+        }
+        if (surrogate.GetRouteCount() == 0 && initialEnemyPath && !initialEnemyPath->Empty()) {
+            surrogate.AddRoute(*initialEnemyPath, currentMap->GetThreatMap(), CELL_SIZE);
+        }
+    }
+    if (surrogate.GetRouteCount() == 0) {
+        candidates.erase(candidates.begin() + keep, candidates.end()); // sin rutas no hay nada que estimar
+        return;
+    }
+
+    std::vector<std::pair<double, size_t>> ranked;
+    ranked.reserve(candidates.size());
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        ranked.push_back(std::make_pair(PredictFitness(candidates[i]), i));
+    }
+    // a igual puntaje gana el que salio primero, como si no hubiera filtro
+    std::stable_sort(ranked.begin(), ranked.end(), [](const std::pair<double, size_t>& a, const std::pair<double, size_t>& b) {
+        return a.first > b.first;
+    });
+
+    std::vector<Enemy> kept;
+    kept.reserve(keep);
+    for (size_t i = 0; i < keep; ++i) {
+        kept.push_back(candidates[ranked[i].second]);
+    }
+
+    std::wstringstream wss;
+    wss << std::fixed << std::setprecision(1);
+    wss << L"GeneticAlgorithm::ScreenOffspring - " << candidates.size() << L" candidates on " << surrogate.GetRouteCount()
+        << L" routes, kept " << keep << L", predicted fitness " << ranked[keep - 1].first << L" .. " << ranked[0].first << L"\n";
+    OutputDebugStringW(wss.str().c_str());
+    candidates.swap(kept);
+}
+
+double GeneticAlgorithm::PredictFitness(const Enemy& enemy) const {
+    SurrogateGenome genome;
+    genome.health = static_cast<float>(enemy.GetMaxHealth());
+    genome.speed = enemy.GetSpeed();
+    genome.resistance[THREAT_ARROW] = enemy.GetArrowResistance();
+    genome.resistance[THREAT_MAGIC] = enemy.GetMagicResistance();
+    genome.resistance[THREAT_ARTILLERY] = enemy.GetArtilleryResistance();
+
+    float mapWidth = currentMap ? currentMap->GetMapPixelWidth() : 0.0f;
+    float mapHeight = currentMap ? currentMap->GetMapPixelHeight() : 0.0f;
+    double total = 0.0;
+    for (int route = 0; route < surrogate.GetRouteCount(); ++route) {
+        SurrogateOutcome outcome = surrogate.Evaluate(genome, route);
+        total += Enemy::ComputeFitness(outcome.x, outcome.y, bridgeLocation, mapWidth, mapHeight, outcome.survivalTime,
+                                       outcome.reachedBridge, !outcome.reachedBridge);
+    }
+    return total / surrogate.GetRouteCount();
+}
+
 /*
  * hace el apareamiento entre dos padres para crear dos hijos
  * usa crossover uniforme - cada atributo tiene 50% de probabilidad de venir de cada padre
@@ -602,8 +695,8 @@ std::pair<Enemy, Enemy> GeneticAlgorithm::PerformCrossover(const Enemy& parent1,
     if (!alternativePaths.empty()) {
         int pathIndex1 = gen() % alternativePaths.size();
         int pathIndex2 = gen() % alternativePaths.size();
-        offspring1.SetPath(alternativePaths[pathIndex1]);
-        offspring2.SetPath(alternativePaths[pathIndex2]);
+        offspring1.SetRoute(alternativePaths[pathIndex1]);
+        offspring2.SetRoute(alternativePaths[pathIndex2]);
     }
     
     return std::make_pair(offspring1, offspring2);
@@ -635,10 +728,10 @@ Enemy GeneticAlgorithm::CreateRandomEnemy() const {
     float startY = static_cast<float>(enemyEntryPoint.first * CELL_SIZE + CELL_SIZE / 2);
     
     // elige un camino aleatorio de las alternativas o usa el default
-    std::vector<std::pair<int, int>> chosenPathForNewEnemy;
+    RouteHandle chosenPathForNewEnemy;
     if (!alternativePaths.empty()) {
         chosenPathForNewEnemy = alternativePaths[gen() % alternativePaths.size()]; 
-    } else if (!initialEnemyPath.empty()) {
+    } else if (initialEnemyPath && !initialEnemyPath->Empty()) {
         chosenPathForNewEnemy = initialEnemyPath;
         OutputDebugStringW(L"CreateRandomEnemy: alternativePaths empty, using initialEnemyPath.\n");
     } else {
@@ -708,10 +801,10 @@ void GeneticAlgorithm::RebalanceEnemyTypes(std::vector<Enemy>& enemiesToRebalanc
             float startY = static_cast<float>(enemyEntryPoint.first * CELL_SIZE + CELL_SIZE / 2);
             
             // intentamos darle un camino aleatorio, si no hay usamos el default
-            std::vector<std::pair<int, int>> chosenPathForNewEnemy; 
+            RouteHandle chosenPathForNewEnemy; 
             if (!alternativePaths.empty()) {
                 chosenPathForNewEnemy = alternativePaths[(pathAssignIndex++) % alternativePaths.size()];
-            } else if (!initialEnemyPath.empty()) {
+            } else if (initialEnemyPath && !initialEnemyPath->Empty()) {
                 chosenPathForNewEnemy = initialEnemyPath;
                 wss_rebalance << L"    WARN: Creating new enemy in Rebalance (type " << static_cast<int>(currentProcessingType) 
                               << L"), alternativePaths empty, using initialEnemyPath.\n";
@@ -729,171 +822,71 @@ void GeneticAlgorithm::RebalanceEnemyTypes(std::vector<Enemy>& enemiesToRebalanc
     OutputDebugStringW(wss_rebalance.str().c_str());
 }
 
-/*
- * mira, esta funcion es la que genera los diferentes caminos que pueden tomar los enemigos
- * para llegar al puente. es una parte critica del algoritmo genetico porque necesitamos
- * que los enemigos tengan diferentes rutas para que el juego no sea tan predecible y aburrido.
- * 
- * basicamente lo que hace es:
- * 1. genera un camino optimo sin obstaculos (el mas directo)
- * 2. intenta forzar un camino por la parte superior del mapa
- * 3. intenta forzar un camino por la parte inferior
- * 4. intenta crear un camino en zigzag diagonal
- *
- * si todo falla, al menos nos aseguramos de tener un camino de emergencia
- * para que los enemigos no se queden atascados como idiotas
- */
-void GeneticAlgorithm::GenerateAlternativePaths(int numPathsToAttempt) {
+// convierte las rutas en celdas a waypoints y las deja como las rutas del ga
+void GeneticAlgorithm::AdoptAlternativePaths(const std::vector<std::vector<std::pair<int, int>>>& cellPaths,
+                                             std::wstringstream& wss_paths) {
     alternativePaths.clear();
-    if (!currentMap) {
-        OutputDebugStringW(L"GeneticAlgorithm::GenerateAlternativePaths - Error: currentMap is null.\n");
-        return;
-    }
-
-    Map* mutableMap = const_cast<Map*>(currentMap);
-    std::wstringstream wss_paths;
-    wss_paths << L"GeneticAlgorithm::GenerateAlternativePaths - Attempting to generate up to " << numPathsToAttempt << L" paths.\n";
-
-    /* primer camino: el mas simple y directo, sin trucos */
-    std::vector<std::pair<int, int>> path1 = currentMap->GetPath(enemyEntryPoint, bridgeLocation);
-    if (!path1.empty()) {
-        alternativePaths.push_back(path1);
-        wss_paths << L"  Added Path 1 (Optimal). Length: " << path1.size() << L"\n";
-    }
-
-    /* calculamos algunas dimensiones importantes del mapa para poner obstaculos */
-    int nRows = currentMap->GetNumRows();
-    int nCols = currentMap->GetNumCols();
-    int h_sup_r1 = nRows / 4 - 1; int h_sup_r2 = nRows / 4;
-    int h_mid_r = nRows / 2; 
-    int h_inf_r1 = 3 * nRows / 4; int h_inf_r2 = 3 * nRows / 4 + 1;
-    int cols_hileras_start = nCols / 5;
-    int cols_hileras_end = 4 * nCols / 5;
-
-    /* dimensiones del puente - no queremos bloquearlo porque seria estupido */
-    int bridgeWidthOriginal = nCols / 10;
-    int bridgeStartColOriginal = nCols - bridgeWidthOriginal;
-    int bridgeHeightOriginal = nRows / 10;
-    int bridgeTopRowOriginal = (nRows - bridgeHeightOriginal) / 2;
-
-    /* funcion lambda para agregar obstaculos solo si no joden algo importante */
-    auto addObstacleIfNotCritical = [&](int r, int c) {
-        if ( (r == enemyEntryPoint.first && c == enemyEntryPoint.second) ) return; 
-        if (c >= bridgeStartColOriginal && c < nCols &&
-            r >= bridgeTopRowOriginal && r < bridgeTopRowOriginal + bridgeHeightOriginal) {
-            return;
-        }
-        mutableMap->AddTemporaryObstacle(r, c);
-    };
-
-    /* funciones helper para poner obstaculos en filas y rangos */
-    auto addObstaclesInRow = [&](int r_target, int cStart, int cEnd) {
-        if (r_target >= 0 && r_target < nRows) {
-            for (int c = cStart; c <= cEnd; ++c) {
-                if (c >= 0 && c < nCols) addObstacleIfNotCritical(r_target, c);
-            }
-        }
-    };
-    auto addObstaclesInRowRange = [&](int r_start, int r_end, int cStart, int cEnd) {
-        for (int r_loop = r_start; r_loop <= r_end; ++r_loop) addObstaclesInRow(r_loop, cStart, cEnd);
-    };
-
-    /* segundo camino: forzamos a los enemigos a ir por arriba */
-    if (alternativePaths.size() < static_cast<size_t>(numPathsToAttempt)) {
-        mutableMap->ClearTemporaryObstacles();
-        wss_paths << L"  Generating Path 2 (attempting upper lane)...\n";
-        
-        // Bloqueamos la parte media y baja del mapa
-        int blockStartCol = nCols / 4;
-        int blockEndCol = 3 * nCols / 4;
-        
-        // Bloqueo más fuerte en la parte media-baja
-        for (int c = blockStartCol; c <= blockEndCol; c += 2) {
-            addObstaclesInRowRange(h_mid_r, h_inf_r1, c, c + 1);
-        }
-        
-        std::vector<std::pair<int, int>> path2 = currentMap->GetPath(enemyEntryPoint, bridgeLocation);
-        if (!path2.empty() && path2 != path1) {
-            alternativePaths.push_back(path2);
-            wss_paths << L"    Added Path 2 (Upper). Length: " << path2.size() << L"\n";
-        }
-        mutableMap->ClearTemporaryObstacles();
-    }
-
-    /* tercer camino: forzamos a los enemigos a ir por abajo */
-    if (alternativePaths.size() < static_cast<size_t>(numPathsToAttempt)) {
-        mutableMap->ClearTemporaryObstacles();
-        wss_paths << L"  Generating Path 3 (attempting lower lane)...\n";
-        
-        // Bloqueamos la parte media y alta del mapa
-        int blockStartCol = nCols / 4;
-        int blockEndCol = 3 * nCols / 4;
-        
-        // Bloqueo más fuerte en la parte media-alta
-        for (int c = blockStartCol; c <= blockEndCol; c += 2) {
-            addObstaclesInRowRange(h_sup_r1, h_mid_r, c, c + 1);
-        }
-        
-        std::vector<std::pair<int, int>> path3 = currentMap->GetPath(enemyEntryPoint, bridgeLocation);
-        bool isDifferent = true;
-        for (const auto& existingPath : alternativePaths) {
-            if (path3 == existingPath) {
-                isDifferent = false;
-                break;
-            }
-        }
-        
-        if (!path3.empty() && isDifferent) {
-            alternativePaths.push_back(path3);
-            wss_paths << L"    Added Path 3 (Lower). Length: " << path3.size() << L"\n";
-        }
-        mutableMap->ClearTemporaryObstacles();
-    }
-
-    /* cuarto camino: intentamos hacer que vayan en zigzag, porque yolo */
-    if (alternativePaths.size() < static_cast<size_t>(numPathsToAttempt)) {
-        mutableMap->ClearTemporaryObstacles();
-        wss_paths << L"  Generating Path 4 (attempting diagonal route)...\n";
-        
-        int blockStartCol = nCols / 4;
-        int blockEndCol = 3 * nCols / 4;
-        
-        for (int c = blockStartCol; c <= blockEndCol; c += 6) {
-            if (c % 12 == blockStartCol % 12) {
-                addObstaclesInRow(h_sup_r1, c, c + 2);
-                addObstaclesInRow(h_inf_r2, c + 3, c + 5);
-            } else {
-                addObstaclesInRow(h_sup_r2, c, c + 2);
-                addObstaclesInRow(h_inf_r1, c + 3, c + 5);
-            }
-        }
-
-        std::vector<std::pair<int, int>> path4 = currentMap->GetPath(enemyEntryPoint, bridgeLocation);
-        if (!path4.empty() && path4 != path1 && 
-            (alternativePaths.size() < 2 || path4 != alternativePaths[1]) &&
-            (alternativePaths.size() < 3 || path4 != alternativePaths[2])) {
-            alternativePaths.push_back(path4);
-            wss_paths << L"    Added Path 4 (Diagonal). Length: " << path4.size() << L"\n";
-        } else if(!path4.empty()){
-            wss_paths << L"    Path 4 was duplicate or A* could not find a distinct diagonal path.\n";
-        } else {
-            wss_paths << L"    Path 4 (Diagonal) FAILED to generate.\n";
-        }
-        mutableMap->ClearTemporaryObstacles();
+    routeTable.Clear();
+    std::vector<std::pair<int, int>> waypoints;
+    for (size_t i = 0; i < cellPaths.size(); ++i) {
+        currentMap->SmoothPath(cellPaths[i], waypoints);
+        wss_paths << L"  Added Path " << (i + 1) << L". Length: " << cellPaths[i].size()
+                  << L", cost: " << PathFinder::PathCost(cellPaths[i])
+                  << L", waypoints: " << waypoints.size() << L"\n";
+        alternativePaths.push_back(routeTable.Intern(waypoints));
     }
 
     /* si todo fallo, al menos aseguramos un camino basico */
-    if (alternativePaths.empty() && currentMap) { 
+    if (alternativePaths.empty()) { 
          wss_paths << L"  Fallback: No paths generated despite efforts. Adding emergency optimal path.\n";
-         std::vector<std::pair<int, int>> emergencyPath = currentMap->GetPath(enemyEntryPoint, bridgeLocation); 
-         if(!emergencyPath.empty()) alternativePaths.push_back(emergencyPath);
+         std::vector<std::pair<int, int>> emergencyPath = FindPathToBridge(); 
+         if(!emergencyPath.empty()) alternativePaths.push_back(routeTable.Intern(emergencyPath));
     }
     if (!alternativePaths.empty()) {
         initialEnemyPath = alternativePaths[0]; 
     } else {
-        OutputDebugStringW(L"CRITICAL ERROR in GenerateAlternativePaths: No paths could be generated for enemies! Map might be unnavigable.\n");
+        OutputDebugStringW(L"CRITICAL ERROR in AdoptAlternativePaths: No paths could be generated for enemies! Map might be unnavigable.\n");
     }
     
-    wss_paths << L"GeneticAlgorithm::GenerateAlternativePaths - Finished. Total unique paths found: " << alternativePaths.size() << L"\n";
-    OutputDebugStringW(wss_paths.str().c_str());
+    wss_paths << L"GeneticAlgorithm::AdoptAlternativePaths - Finished. Total unique paths found: " << alternativePaths.size() << L"\n";
+}
+
+/*
+ * mira, esta funcion es la que genera los diferentes caminos que pueden tomar los enemigos
+ * para llegar al puente. es una parte critica del algoritmo genetico porque necesitamos
+ * que los enemigos tengan diferentes rutas para que el juego no sea tan predecible y aburrido.
+ *
+ * antes esto ponia hileras de obstaculos a mano (carril de arriba, de abajo, zigzag)
+ * con un const_cast al mapa y corria un a* por cada una. ahora le pedimos al mapa
+ * k rutas distintas de un jalon: busca la optima, despues candidatas que la rodean
+ * con capas de obstaculos y se queda con las que no se parecen demasiado entre si.
+ *
+ * el pedido no bloquea: el mapa lo va buscando por tramos en sus Update y las
+ * rutas salen iguales que con GetAlternativePathsParallel. se llama al crear el
+ * ga y en cada frame; solo pide algo si el mapa cambio desde que se armaron las
+ * rutas (por ejemplo se puso una torre y las viejas pasan por encima). los
+ * enemigos que ya van caminando se quedan con su handle, solo las oleadas nuevas
+ * usan las rutas nuevas. si el mapa vuelve a cambiar antes de que llegue la
+ * respuesta, el mapa la vuelve a empezar solo
+ */
+void GeneticAlgorithm::RefreshPathsAsync(int numPathsToAttempt) {
+    if (!currentMap || currentMap->GetPassabilityVersion() == routesVersion) {
+        return;
+    }
+    if (pendingPathRequest && !pendingPathRequest->IsDone()) {
+        return;
+    }
+
+    DiversePathOptions options;
+    options.maxPaths = numPathsToAttempt;
+    options.avoidThreat = true; // las rutas esquivan el daño de las torres
+    pendingPathRequest = currentMap->RequestAlternativePaths(enemyEntryPoint, bridgeLocation, options,
+        [this](const PathRequest& request) {
+            std::wstringstream wss_paths;
+            wss_paths << L"GeneticAlgorithm::RefreshPathsAsync - " << request.GetPaths().size()
+                      << L" paths ready after " << request.GetSlices() << L" frames.\n";
+            routesVersion = request.GetVersion();
+            AdoptAlternativePaths(request.GetPaths(), wss_paths);
+            OutputDebugStringW(wss_paths.str().c_str());
+        });
 }
@@ -16,6 +16,7 @@
 
 #include "Map.h"
 #include "Enemy.h"
+#include "SurrogateFitness.h"
 #include <vector>
 #include <memory> // para los unique_ptr si manejamos enemigos con punteros
 #include <random>
@@ -24,6 +25,13 @@
 
 class Map; // declaracion forward para info del mapa que necesita el GA
 
+// cuantos hijos por lugar genera CrossoverAndMutate antes de quedarse con los
+// mejores segun el estimador (1 = sin filtro)
+#define GA_SURROGATE_OVERSAMPLE 3
+
+// cuantas rutas alternativas distintas se le piden al mapa
+#define GA_ALTERNATIVE_PATHS 10
+
 class GeneticAlgorithm {
 public:
     // constructor con toda la shi que necesita para funcionar
@@ -45,6 +53,10 @@ public:
     void SetCurrentPopulation(const std::vector<Enemy>& population);
     void SetMapDetails(const Map* map);
 
+    // si el mapa cambio desde que se armaron las rutas, pide unas nuevas sin
+    // bloquear (el mapa las va buscando en sus Update). se llama cada frame
+    void RefreshPathsAsync(int numPathsToAttempt = GA_ALTERNATIVE_PATHS);
+
     // Método para actualizar las estadísticas en el mapa
     void UpdateMapStatistics(Map* map) {
         if (map) {
@@ -134,14 +146,28 @@ private:
     Enemy SelectParentRoulette() const;
     std::pair<Enemy, Enemy> PerformCrossover(const Enemy& parent1, const Enemy& parent2) const;
     
-    // rutas que pueden seguir los enemigos
-    std::vector<std::pair<int, int>> initialEnemyPath;
-    std::vector<std::vector<std::pair<int, int>>> alternativePaths;
+    // rutas que pueden seguir los enemigos. se guardan una sola vez en la
+    // tabla y los enemigos solo se quedan con el handle
+    RouteTable routeTable;
+    RouteHandle initialEnemyPath;
+    std::vector<RouteHandle> alternativePaths;
 
     // helpers para crear y balancear enemigos
     Enemy CreateRandomEnemy() const;
     void RebalanceEnemyTypes(std::vector<Enemy>& enemies, int targetPerType);
-    void GenerateAlternativePaths(int numPathsToGenerate);
+    void AdoptAlternativePaths(const std::vector<std::vector<std::pair<int, int>>>& cellPaths, std::wstringstream& log);
+
+    // version de la transitabilidad con la que se armaron las rutas, y el
+    // pedido en curso para reemplazarlas
+    uint64_t routesVersion = 0;
+    PathRequestHandle pendingPathRequest;
+
+    // estima el fitness de cada candidato sobre las rutas y las torres de
+    // ahora y deja los keep mejores, sin jugar ninguna oleada
+    SurrogateEvaluator surrogate;
+    void ScreenOffspring(std::vector<Enemy>& candidates, size_t keep);
+    double PredictFitness(const Enemy& enemy) const;
+    std::vector<std::pair<int, int>> FindPathToBridge() const;
 
     int deadEnemiesCount = 0;
     int mutationCount = 0;
@@ -7,6 +7,11 @@
 #include "Map.h"
 #include "Enemy.h"
 #include "GeneticAlgorithm.h"
+#include "Benchmark.h"
+#include "AssetCache.h"
+#include "GdiplusAssetLoader.h"
+#include "MappedAssetLoader.h"
+#include "AssetPacker.h"
 #include <windowsx.h> // para obtener coordenadas del mouse, porque windows es especial
 #include <wingdi.h>   // para dibujar cosas feas con gdi
 #include <objidl.h>   // necesario para gdi+, otro invento de windows
@@ -56,6 +61,7 @@ INT_PTR CALLBACK    About(HWND, UINT, WPARAM, LPARAM);
 void                HandleMouseClick(HWND hWnd, int x, int y);
 void                DrawConstructionInfo(HDC hdc, int row, int col);
 void                UpdateGame(float deltaTime);
+void                SetWaveThreatResistances(const std::vector<Enemy>& wave);
 
 int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
                      _In_opt_ HINSTANCE hPrevInstance,
@@ -63,7 +69,6 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
                      _In_ int       nCmdShow)
 {
     UNREFERENCED_PARAMETER(hPrevInstance);
-    UNREFERENCED_PARAMETER(lpCmdLine);
 
     Status status = GdiplusStartup(&g_gdiplusToken, &g_gdiplusStartupInput, NULL);
     if (status != Ok) {
@@ -71,6 +76,29 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
         return FALSE;
     }
 
+    // modo empaquetador: hornea los png en Assets\Sprites.pak y se sale. va antes
+    // de instalar el loader porque no se puede escribir el archivo si esta mapeado
+    if (lpCmdLine && wcsstr(lpCmdLine, L"--pack-assets")) {
+        std::wstring archivePath;
+        bool packed = AssetPacker::Pack(CELL_SIZE, archivePath);
+        GdiplusShutdown(g_gdiplusToken);
+        return packed ? 0 : 1;
+    }
+
+    // los sprites se cargan una vez por proceso; hay que soltarlos antes de apagar gdi+.
+    // si hay Sprites.pak se mapea y se usa tal cual; lo que falte sale de los png
+    MappedAssetLoader* spriteLoader = new MappedAssetLoader(std::unique_ptr<AssetLoader>(new GdiplusAssetLoader()));
+    spriteLoader->Open(MappedAssetLoader::FindArchive(), CELL_SIZE);
+    AssetCache::Instance().SetLoader(std::unique_ptr<AssetLoader>(spriteLoader));
+
+    // modo benchmark: corre las mediciones sin abrir ventana y se sale
+    if (lpCmdLine && wcsstr(lpCmdLine, L"--benchmark")) {
+        int failedChecks = Benchmark::RunAll();
+        AssetCache::Instance().SetLoader(nullptr);
+        GdiplusShutdown(g_gdiplusToken);
+        return failedChecks == 0 ? 0 : 1;
+    }
+
     srand(static_cast<unsigned int>(time(NULL)));
 
     g_hBackgroundBrush = CreateSolidBrush(RGB(14, 129, 60));
@@ -84,6 +112,7 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
         if (g_hBackgroundBrush) {
             DeleteObject(g_hBackgroundBrush);
         }
+        AssetCache::Instance().SetLoader(nullptr);
         GdiplusShutdown(g_gdiplusToken);
         return FALSE;
     }
@@ -109,6 +138,7 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
         g_hBackgroundBrush = NULL;
     }
     
+    AssetCache::Instance().SetLoader(nullptr);
     GdiplusShutdown(g_gdiplusToken);
 
     return (int) msg.wParam;
@@ -154,6 +184,8 @@ BOOL InitInstance(HINSTANCE hInstance, int nCmdShow)
    g_pGeneticAlgorithm = new GeneticAlgorithm(POPULATION_SIZE, MUTATION_RATE, CROSSOVER_RATE, entryPoint, bridgeLocation, &gameMap);
    g_pGeneticAlgorithm->InitializePopulation();
    g_currentWaveEnemies = g_pGeneticAlgorithm->GetCurrentPopulation();
+   SetWaveThreatResistances(g_currentWaveEnemies);
+   gameMap.ReserveProjectilesForWave();
    g_currentWaveNumber = 1;
 
    HWND hWnd = CreateWindowW(
@@ -293,6 +325,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
         }
         break;
     case WM_DESTROY:
+        AssetCache::Instance().Clear();
         Gdiplus::GdiplusShutdown(g_gdiplusToken);
         KillTimer(hWnd, TIMER_ID);
         PostQuitMessage(0);
@@ -336,9 +369,28 @@ void HandleMouseClick(HWND hWnd, int x, int y) {
 void DrawConstructionInfo(HDC hdc, int row, int col) {
 }
 
+// el costo de amenaza se pesa con la resistencia promedio de la oleada, asi
+// una oleada de ogros no le tiene tanto miedo a las flechas. si cambia, la
+// version del mapa sube y RefreshPathsAsync vuelve a pedir las rutas
+void SetWaveThreatResistances(const std::vector<Enemy>& wave) {
+    if (wave.empty()) return;
+    float arrow = 0.0f, magic = 0.0f, artillery = 0.0f;
+    for (const Enemy& enemy : wave) {
+        arrow += enemy.GetArrowResistance();
+        magic += enemy.GetMagicResistance();
+        artillery += enemy.GetArtilleryResistance();
+    }
+    const float count = static_cast<float>(wave.size());
+    gameMap.SetThreatResistances(arrow / count, magic / count, artillery / count);
+}
+
 // actualiza todo el juego
 // esto es el cerebro del juego, si falla todo se rompe xd
 void UpdateGame(float deltaTime) {
+    // si se puso una torre las rutas del ga se recalculan de a poquito en gameMap.Update
+    if (g_pGeneticAlgorithm) {
+        g_pGeneticAlgorithm->RefreshPathsAsync();
+    }
     gameMap.Update(deltaTime, g_currentWaveEnemies);
 
     bool anyActiveEnemies = false;
@@ -416,6 +468,8 @@ void UpdateGame(float deltaTime) {
             g_pGeneticAlgorithm->CrossoverAndMutate();
             
             g_currentWaveEnemies = g_pGeneticAlgorithm->GenerateNewGeneration();
+            SetWaveThreatResistances(g_currentWaveEnemies);
+            gameMap.ReserveProjectilesForWave();
             g_currentWaveNumber++;
             g_timeSinceWaveEnd = 0.0f;
             
@@ -0,0 +1,575 @@
+// hpa*: clusters, entradas, grafo abstracto y refinado de tramos
+
+#include "HierarchicalPathFinder.h"
+#include <algorithm>
+#include <functional>
+#include <cfloat>
+#include <cstdlib>
+
+namespace {
+    const int kDr[] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+    const int kDc[] = { 0, 0, -1, 1, -1, 1, -1, 1 };
+    const float kMoveCost[] = {
+        PATH_STRAIGHT_COST, PATH_STRAIGHT_COST, PATH_STRAIGHT_COST, PATH_STRAIGHT_COST,
+        PATH_DIAGONAL_COST, PATH_DIAGONAL_COST, PATH_DIAGONAL_COST, PATH_DIAGONAL_COST
+    };
+
+    // un tramo de borde libre de este largo o mas lleva dos entradas (una en
+    // cada punta) en vez de una al medio, como en el paper
+    const int kLongEntrance = 6;
+}
+
+HierarchicalPathFinder::HierarchicalPathFinder()
+    : blocked(nullptr), rows(0), cols(0), clusterSize(10), clusterRows(0), clusterCols(0),
+      built(false), anyDirty(false), generation(0)
+{
+}
+
+void HierarchicalPathFinder::Build(const std::vector<uint8_t>* newBlocked, int newRows, int newCols, int newClusterSize)
+{
+    blocked = newBlocked;
+    rows = newRows < 0 ? 0 : newRows;
+    cols = newCols < 0 ? 0 : newCols;
+    clusterSize = newClusterSize < 2 ? 2 : newClusterSize;
+    clusterRows = (rows + clusterSize - 1) / clusterSize;
+    clusterCols = (cols + clusterSize - 1) / clusterSize;
+    built = false;
+    if (!blocked || blocked->size() < static_cast<size_t>(rows) * static_cast<size_t>(cols)) {
+        return;
+    }
+
+    size_t cellCount = static_cast<size_t>(rows) * static_cast<size_t>(cols);
+    int clusterCount = clusterRows * clusterCols;
+    borders.assign(static_cast<size_t>(clusterCount) * BORDER_DIRS, std::vector<Crossing>());
+    clusters.assign(clusterCount, ClusterData());
+    nodeLocalIndex.assign(cellCount, -1);
+    clusterDirty.assign(clusterCount, 0);
+    borderDirty.assign(static_cast<size_t>(clusterCount) * BORDER_DIRS, 0);
+    anyDirty = false;
+
+    size_t localCells = static_cast<size_t>(clusterSize) * clusterSize;
+    sourceDist.assign(localCells, FLT_MAX);
+    startDist.assign(localCells, FLT_MAX);
+    goalDist.assign(localCells, FLT_MAX);
+    localHeap.reserve(localCells);
+
+    visitStamp.assign(cellCount, 0);
+    closedStamp.assign(cellCount, 0);
+    gCost.assign(cellCount, FLT_MAX);
+    parent.assign(cellCount, -1);
+    generation = 0;
+
+    localFinder.Resize(rows, cols);
+
+    for (int cluster = 0; cluster < clusterCount; ++cluster) {
+        for (int dir = 0; dir < BORDER_DIRS; ++dir) {
+            RebuildBorder(cluster, dir);
+        }
+    }
+    for (int cluster = 0; cluster < clusterCount; ++cluster) {
+        RebuildCluster(cluster);
+    }
+
+    built = true;
+    stats.fullBuilds++;
+}
+
+void HierarchicalPathFinder::ClusterBounds(int cluster, int& r0, int& c0, int& r1, int& c1) const
+{
+    int cr = cluster / clusterCols;
+    int cc = cluster - cr * clusterCols;
+    r0 = cr * clusterSize;
+    c0 = cc * clusterSize;
+    r1 = (std::min)(r0 + clusterSize, rows);
+    c1 = (std::min)(c0 + clusterSize, cols);
+}
+
+// entradas entre el cluster y su vecino en la direccion dir. los tramos libres
+// de ambos lados se cruzan en linea recta; los cruces que solo existen en
+// diagonal (esquinas encerradas) tambien se agregan, si no el grafo perderia
+// conexiones que el a* plano si ve
+void HierarchicalPathFinder::RebuildBorder(int cluster, int dir)
+{
+    std::vector<Crossing>& crossings = borders[BorderIndex(cluster, dir)];
+    crossings.clear();
+
+    int cr = cluster / clusterCols;
+    int cc = cluster - cr * clusterCols;
+    int r0, c0, r1, c1;
+    ClusterBounds(cluster, r0, c0, r1, c1);
+
+    if (dir == BORDER_DOWN_RIGHT || dir == BORDER_DOWN_LEFT) {
+        // los dos clusters solo se tocan en una esquina
+        if (cr + 1 >= clusterRows) return;
+        int ownRow = r1 - 1;
+        int otherRow = r1;
+        int ownCol, otherCol;
+        if (dir == BORDER_DOWN_RIGHT) {
+            if (cc + 1 >= clusterCols) return;
+            ownCol = c1 - 1;
+            otherCol = c1;
+        } else {
+            if (cc == 0) return;
+            ownCol = c0;
+            otherCol = c0 - 1;
+        }
+        if (Walkable(ownRow, ownCol) && Walkable(otherRow, otherCol)) {
+            Crossing crossing = { ownRow * cols + ownCol, otherRow * cols + otherCol, PATH_DIAGONAL_COST };
+            crossings.push_back(crossing);
+        }
+        return;
+    }
+
+    // borde recto: lo recorremos con t a lo largo y "own"/"other" de cada lado
+    bool horizontal = (dir == BORDER_RIGHT);
+    if (horizontal && cc + 1 >= clusterCols) return;
+    if (!horizontal && cr + 1 >= clusterRows) return;
+
+    int length = horizontal ? (r1 - r0) : (c1 - c0);
+    auto ownCell = [&](int t) { return horizontal ? (r0 + t) * cols + (c1 - 1) : (r1 - 1) * cols + (c0 + t); };
+    auto otherCell = [&](int t) { return horizontal ? (r0 + t) * cols + c1 : r1 * cols + (c0 + t); };
+    auto open = [&](int t) { return !Blocked(ownCell(t)) && !Blocked(otherCell(t)); };
+
+    int t = 0;
+    while (t < length) {
+        if (!open(t)) {
+            ++t;
+            continue;
+        }
+        int runStart = t;
+        while (t < length && open(t)) ++t;
+        int runEnd = t - 1;
+        if (runEnd - runStart + 1 >= kLongEntrance) {
+            Crossing first = { ownCell(runStart), otherCell(runStart), PATH_STRAIGHT_COST };
+            Crossing last = { ownCell(runEnd), otherCell(runEnd), PATH_STRAIGHT_COST };
+            crossings.push_back(first);
+            crossings.push_back(last);
+        } else {
+            int middle = (runStart + runEnd) / 2;
+            Crossing crossing = { ownCell(middle), otherCell(middle), PATH_STRAIGHT_COST };
+            crossings.push_back(crossing);
+        }
+    }
+
+    // cruces diagonales dentro del mismo borde donde ninguna de las dos celdas
+    // tiene cruce recto
+    for (t = 0; t + 1 < length; ++t) {
+        int a = ownCell(t), b = otherCell(t + 1);
+        if (!Blocked(a) && !Blocked(b) && !open(t) && !open(t + 1)) {
+            Crossing crossing = { a, b, PATH_DIAGONAL_COST };
+            crossings.push_back(crossing);
+        }
+        a = ownCell(t + 1);
+        b = otherCell(t);
+        if (!Blocked(a) && !Blocked(b) && !open(t) && !open(t + 1)) {
+            Crossing crossing = { a, b, PATH_DIAGONAL_COST };
+            crossings.push_back(crossing);
+        }
+    }
+}
+
+void HierarchicalPathFinder::ClusterDijkstra(int cluster, int sourceCell, std::vector<float>& localDist)
+{
+    int r0, c0, r1, c1;
+    ClusterBounds(cluster, r0, c0, r1, c1);
+    int width = c1 - c0;
+    std::fill(localDist.begin(), localDist.end(), FLT_MAX);
+    localHeap.clear();
+
+    int sr = sourceCell / cols;
+    int sc = sourceCell - sr * cols;
+    int sourceLocal = (sr - r0) * width + (sc - c0);
+    localDist[sourceLocal] = 0.0f;
+    OpenEntry first = { 0.0f, sourceLocal };
+    localHeap.push_back(first);
+
+    while (!localHeap.empty()) {
+        std::pop_heap(localHeap.begin(), localHeap.end(), std::greater<OpenEntry>());
+        OpenEntry current = localHeap.back();
+        localHeap.pop_back();
+        if (current.fCost > localDist[current.cell]) {
+            continue;
+        }
+
+        int r = r0 + current.cell / width;
+        int c = c0 + current.cell % width;
+        for (int i = 0; i < 8; ++i) {
+            int nr = r + kDr[i];
+            int nc = c + kDc[i];
+            if (nr < r0 || nr >= r1 || nc < c0 || nc >= c1) continue;
+            if (Blocked(nr * cols + nc)) continue;
+
+            int neighborLocal = (nr - r0) * width + (nc - c0);
+            float candidate = current.fCost + kMoveCost[i];
+            if (candidate < localDist[neighborLocal]) {
+                localDist[neighborLocal] = candidate;
+                OpenEntry entry = { candidate, neighborLocal };
+                localHeap.push_back(entry);
+                std::push_heap(localHeap.begin(), localHeap.end(), std::greater<OpenEntry>());
+            }
+        }
+    }
+}
+
+float HierarchicalPathFinder::LocalDistance(int cluster, const std::vector<float>& localDist, int cell) const
+{
+    int r0, c0, r1, c1;
+    ClusterBounds(cluster, r0, c0, r1, c1);
+    int r = cell / cols;
+    int c = cell - r * cols;
+    return localDist[(r - r0) * (c1 - c0) + (c - c0)];
+}
+
+// junta las entradas del cluster desde sus ocho bordes y recalcula la
+// distancia entre cada par sin salirse del cluster
+void HierarchicalPathFinder::RebuildCluster(int cluster)
+{
+    ClusterData& data = clusters[cluster];
+    for (int cell : data.nodes) {
+        nodeLocalIndex[cell] = -1;
+    }
+    data.nodes.clear();
+    data.inter.clear();
+
+    int cr = cluster / clusterCols;
+    int cc = cluster - cr * clusterCols;
+
+    auto addEdge = [&](int from, int to, float cost) {
+        int local = nodeLocalIndex[from];
+        if (local == -1) {
+            local = static_cast<int>(data.nodes.size());
+            nodeLocalIndex[from] = local;
+            data.nodes.push_back(from);
+            data.inter.push_back(std::vector<Edge>());
+        }
+        Edge edge = { to, cost };
+        data.inter[local].push_back(edge);
+    };
+
+    // bordes propios: el cluster es el lado "own"
+    for (int dir = 0; dir < BORDER_DIRS; ++dir) {
+        for (const Crossing& crossing : borders[BorderIndex(cluster, dir)]) {
+            addEdge(crossing.ownCell, crossing.otherCell, crossing.cost);
+        }
+    }
+    // bordes de los vecinos de arriba y de la izquierda: el cluster es "other"
+    struct Owner { int dr, dc, dir; };
+    const Owner owners[] = {
+        { 0, -1, BORDER_RIGHT }, { -1, 0, BORDER_DOWN },
+        { -1, -1, BORDER_DOWN_RIGHT }, { -1, 1, BORDER_DOWN_LEFT }
+    };
+    for (const Owner& owner : owners) {
+        int nr = cr + owner.dr;
+        int nc = cc + owner.dc;
+        if (nr < 0 || nr >= clusterRows || nc < 0 || nc >= clusterCols) continue;
+        for (const Crossing& crossing : borders[BorderIndex(nr * clusterCols + nc, owner.dir)]) {
+            addEdge(crossing.otherCell, crossing.ownCell, crossing.cost);
+        }
+    }
+
+    size_t count = data.nodes.size();
+    data.distances.assign(count * count, FLT_MAX);
+    for (size_t i = 0; i < count; ++i) {
+        ClusterDijkstra(cluster, data.nodes[i], sourceDist);
+        for (size_t j = 0; j < count; ++j) {
+            data.distances[i * count + j] = LocalDistance(cluster, sourceDist, data.nodes[j]);
+        }
+    }
+}
+
+// los cuatro bordes propios y los cuatro de los vecinos que tocan al cluster
+void HierarchicalPathFinder::MarkBordersAround(int cluster)
+{
+    int cr = cluster / clusterCols;
+    int cc = cluster - cr * clusterCols;
+    for (int dr = -1; dr <= 1; ++dr) {
+        for (int dc = -1; dc <= 1; ++dc) {
+            int nr = cr + dr;
+            int nc = cc + dc;
+            if (nr < 0 || nr >= clusterRows || nc < 0 || nc >= clusterCols) continue;
+            int neighbor = nr * clusterCols + nc;
+            if (dr == 0 && dc == 0) {
+                for (int dir = 0; dir < BORDER_DIRS; ++dir) borderDirty[BorderIndex(neighbor, dir)] = 1;
+            } else if (dr == 0 && dc == -1) {
+                borderDirty[BorderIndex(neighbor, BORDER_RIGHT)] = 1;
+            } else if (dr == -1 && dc == 0) {
+                borderDirty[BorderIndex(neighbor, BORDER_DOWN)] = 1;
+            } else if (dr == -1 && dc == -1) {
+                borderDirty[BorderIndex(neighbor, BORDER_DOWN_RIGHT)] = 1;
+            } else if (dr == -1 && dc == 1) {
+                borderDirty[BorderIndex(neighbor, BORDER_DOWN_LEFT)] = 1;
+            }
+        }
+    }
+}
+
+void HierarchicalPathFinder::MarkCellChanged(int row, int col)
+{
+    if (!built || row < 0 || row >= rows || col < 0 || col >= cols) {
+        return;
+    }
+    int cluster = ClusterOf(row, col);
+    clusterDirty[cluster] = 1;
+    anyDirty = true;
+
+    // una celda de la orilla puede abrir o cerrar entradas
+    int r0, c0, r1, c1;
+    ClusterBounds(cluster, r0, c0, r1, c1);
+    if (row == r0 || row == r1 - 1 || col == c0 || col == c1 - 1) {
+        MarkBordersAround(cluster);
+    }
+}
+
+void HierarchicalPathFinder::Refresh()
+{
+    if (!built || !anyDirty) {
+        return;
+    }
+
+    // un borde que cambio le cambia las entradas a los dos clusters que separa
+    int clusterCount = clusterRows * clusterCols;
+    for (int cluster = 0; cluster < clusterCount; ++cluster) {
+        int cr = cluster / clusterCols;
+        int cc = cluster - cr * clusterCols;
+        for (int dir = 0; dir < BORDER_DIRS; ++dir) {
+            int index = BorderIndex(cluster, dir);
+            if (!borderDirty[index]) continue;
+            borderDirty[index] = 0;
+            RebuildBorder(cluster, dir);
+            stats.borderRebuilds++;
+
+            int nr = cr + (dir == BORDER_RIGHT ? 0 : 1);
+            int nc = cc + (dir == BORDER_DOWN ? 0 : (dir == BORDER_DOWN_LEFT ? -1 : 1));
+            clusterDirty[cluster] = 1;
+            if (nr < clusterRows && nc >= 0 && nc < clusterCols) {
+                clusterDirty[nr * clusterCols + nc] = 1;
+            }
+        }
+    }
+
+    for (int cluster = 0; cluster < clusterCount; ++cluster) {
+        if (!clusterDirty[cluster]) continue;
+        clusterDirty[cluster] = 0;
+        RebuildCluster(cluster);
+        stats.clusterRebuilds++;
+    }
+    anyDirty = false;
+}
+
+size_t HierarchicalPathFinder::GetEntranceCount() const
+{
+    size_t total = 0;
+    for (const ClusterData& data : clusters) {
+        total += data.nodes.size();
+    }
+    return total;
+}
+
+/*
+ * a* sobre el grafo abstracto. los nodos son celdas de entrada; el inicio y el
+ * fin se enganchan temporalmente a las entradas de su cluster con un dijkstra
+ * local cada uno (y entre ellos directo si comparten cluster). no se toca el
+ * grafo guardado, todo vive en el scratch de la consulta.
+ */
+bool HierarchicalPathFinder::FindRoute(std::pair<int, int> start, std::pair<int, int> goal, Route& route)
+{
+    route.waypoints.clear();
+    route.cells.clear();
+    route.nextSegment = 0;
+    if (!built || start.first < 0 || start.first >= rows || start.second < 0 || start.second >= cols ||
+        goal.first < 0 || goal.first >= rows || goal.second < 0 || goal.second >= cols) {
+        return false;
+    }
+    Refresh();
+
+    int startCell = start.first * cols + start.second;
+    int goalCell = goal.first * cols + goal.second;
+    if (startCell == goalCell) {
+        route.waypoints.push_back(start);
+        route.cells.push_back(start);
+        return true;
+    }
+    if (Blocked(goalCell)) {
+        return false;
+    }
+
+    int startCluster = ClusterOf(start.first, start.second);
+    int goalCluster = ClusterOf(goal.first, goal.second);
+
+    // en distancias cortas el grafo abstracto da vueltas de mas por las
+    // entradas; un a* normal metido en los clusters de los dos extremos (y los
+    // que los rodean) es igual de barato y da el camino optimo
+    int startClusterRow = startCluster / clusterCols, startClusterCol = startCluster % clusterCols;
+    int goalClusterRow = goalCluster / clusterCols, goalClusterCol = goalCluster % clusterCols;
+    if (std::abs(startClusterRow - goalClusterRow) <= 1 && std::abs(startClusterCol - goalClusterCol) <= 1) {
+        int minRow = ((std::min)(startClusterRow, goalClusterRow) - 1) * clusterSize;
+        int minCol = ((std::min)(startClusterCol, goalClusterCol) - 1) * clusterSize;
+        int maxRow = ((std::max)(startClusterRow, goalClusterRow) + 2) * clusterSize;
+        int maxCol = ((std::max)(startClusterCol, goalClusterCol) + 2) * clusterSize;
+        auto isBlocked = [&](int r, int c) {
+            return r < minRow || r >= maxRow || c < minCol || c >= maxCol || Blocked(r * cols + c);
+        };
+        if (localFinder.FindPath(start, goal, isBlocked, route.cells)) {
+            route.waypoints.push_back(start);
+            route.waypoints.push_back(goal);
+            route.nextSegment = 1;
+            return true;
+        }
+    }
+    route.cells.push_back(start);
+    ClusterDijkstra(startCluster, startCell, startDist);
+    ClusterDijkstra(goalCluster, goalCell, goalDist);
+
+    generation++;
+    if (generation == 0) {
+        std::fill(visitStamp.begin(), visitStamp.end(), 0u);
+        std::fill(closedStamp.begin(), closedStamp.end(), 0u);
+        generation = 1;
+    }
+    openList.clear();
+
+    auto relax = [&](int from, int to, float cost) {
+        if (cost == FLT_MAX) return;
+        if (closedStamp[to] == generation) return;
+        float candidate = gCost[from] + cost;
+        if (visitStamp[to] != generation || candidate < gCost[to]) {
+            visitStamp[to] = generation;
+            gCost[to] = candidate;
+            parent[to] = from;
+            int r = to / cols;
+            OpenEntry entry = { candidate + PathFinder::Heuristic(r, to - r * cols, goal.first, goal.second), to };
+            openList.push_back(entry);
+            std::push_heap(openList.begin(), openList.end(), std::greater<OpenEntry>());
+        }
+    };
+
+    visitStamp[startCell] = generation;
+    gCost[startCell] = 0.0f;
+    parent[startCell] = -1;
+    OpenEntry first = { 0.0f, startCell };
+    openList.push_back(first);
+
+    bool found = false;
+    while (!openList.empty()) {
+        std::pop_heap(openList.begin(), openList.end(), std::greater<OpenEntry>());
+        int current = openList.back().cell;
+        openList.pop_back();
+        if (closedStamp[current] == generation) continue;
+        closedStamp[current] = generation;
+        stats.abstractNodesExpanded++;
+
+        if (current == goalCell) {
+            found = true;
+            break;
+        }
+
+        int r = current / cols;
+        int cluster = ClusterOf(r, current - r * cols);
+
+        if (current == startCell) {
+            for (int node : clusters[startCluster].nodes) {
+                relax(current, node, LocalDistance(startCluster, startDist, node));
+            }
+            if (startCluster == goalCluster) {
+                relax(current, goalCell, LocalDistance(startCluster, startDist, goalCell));
+            }
+            // un enemigo parado en una celda que se acaba de bloquear no cuenta
+            // como entrada, pero igual puede salir directo al cluster de al lado
+            if (Blocked(startCell)) {
+                for (int i = 0; i < 8; ++i) {
+                    int nr = start.first + kDr[i];
+                    int nc = start.second + kDc[i];
+                    if (!Walkable(nr, nc)) continue;
+                    int neighborCluster = ClusterOf(nr, nc);
+                    if (neighborCluster == startCluster) continue;
+                    ClusterDijkstra(neighborCluster, nr * cols + nc, sourceDist);
+                    for (int node : clusters[neighborCluster].nodes) {
+                        relax(current, node, kMoveCost[i] + LocalDistance(neighborCluster, sourceDist, node));
+                    }
+                    if (neighborCluster == goalCluster) {
+                        relax(current, goalCell, kMoveCost[i] + LocalDistance(neighborCluster, sourceDist, goalCell));
+                    }
+                }
+            }
+        }
+
+        int local = nodeLocalIndex[current];
+        if (local != -1) {
+            const ClusterData& data = clusters[cluster];
+            size_t count = data.nodes.size();
+            for (size_t j = 0; j < count; ++j) {
+                if (static_cast<int>(j) == local) continue;
+                relax(current, data.nodes[j], data.distances[local * count + j]);
+            }
+            for (const Edge& edge : data.inter[local]) {
+                relax(current, edge.cell, edge.cost);
+            }
+            if (cluster == goalCluster) {
+                relax(current, goalCell, LocalDistance(goalCluster, goalDist, current));
+            }
+        }
+    }
+
+    if (!found) {
+        route.cells.clear();
+        return false;
+    }
+
+    for (int cell = goalCell; cell != -1; cell = parent[cell]) {
+        route.waypoints.push_back(std::make_pair(cell / cols, cell % cols));
+    }
+    std::reverse(route.waypoints.begin(), route.waypoints.end());
+
+    // lo primero que necesita el enemigo es el primer tramo, el resto despues
+    return RefineRoute(route, 2);
+}
+
+// un tramo es un cruce entre clusters (celdas vecinas) o un recorrido dentro
+// de un solo cluster. en el segundo caso un a* que no puede salir del
+// rectangulo da exactamente el costo que se guardo en el grafo
+bool HierarchicalPathFinder::RefineSegment(std::pair<int, int> from, std::pair<int, int> to,
+                                           std::vector<std::pair<int, int>>& cells)
+{
+    stats.segmentsRefined++;
+    if (std::abs(from.first - to.first) <= 1 && std::abs(from.second - to.second) <= 1) {
+        if (!Walkable(to.first, to.second)) return false;
+        cells.push_back(to);
+        return true;
+    }
+
+    int cluster = ClusterOf(to.first, to.second);
+    int r0, c0, r1, c1;
+    ClusterBounds(cluster, r0, c0, r1, c1);
+    auto isBlocked = [&](int r, int c) {
+        return r < r0 || r >= r1 || c < c0 || c >= c1 || Blocked(r * cols + c);
+    };
+    if (!localFinder.FindPath(from, to, isBlocked, segmentScratch)) {
+        return false;
+    }
+    cells.insert(cells.end(), segmentScratch.begin() + 1, segmentScratch.end());
+    return true;
+}
+
+bool HierarchicalPathFinder::RefineRoute(Route& route, size_t minCells)
+{
+    while (!route.IsFullyRefined() && route.cells.size() < minCells) {
+        if (!RefineSegment(route.waypoints[route.nextSegment], route.waypoints[route.nextSegment + 1], route.cells)) {
+            return false;
+        }
+        route.nextSegment++;
+    }
+    return true;
+}
+
+bool HierarchicalPathFinder::FindPath(std::pair<int, int> start, std::pair<int, int> goal,
+                                      std::vector<std::pair<int, int>>& outPath)
+{
+    Route route;
+    route.cells.swap(outPath);
+    bool ok = FindRoute(start, goal, route) && RefineRoute(route, static_cast<size_t>(-1));
+    outPath.swap(route.cells);
+    if (!ok) {
+        outPath.clear();
+    }
+    return ok;
+}
@@ -0,0 +1,161 @@
+/*
+ * hierarchicalpathfinder.h - pathfinding jerarquico (hpa*) para mapas grandes
+ *
+ * con CELL_SIZE 50 el mapa del juego es de 38x21 y el a* plano vuela, pero en
+ * mapas de miles de celdas por lado el a* se come el frame. hpa* (botea,
+ * muller y schaeffer) parte el grid en clusters cuadrados y precalcula:
+ * - las "entradas" entre clusters vecinos (celdas del borde por donde se puede
+ *   cruzar de uno a otro)
+ * - la distancia entre cada par de entradas del mismo cluster, sin salirse de el
+ * asi una consulta es un a* sobre ese grafo chiquito (entradas + inicio + fin)
+ * y el camino de verdad se arma despues tramo por tramo, cada tramo un a*
+ * dentro de un solo cluster. los tramos se pueden refinar a medida que el
+ * enemigo avanza en vez de todos de golpe.
+ *
+ * cuando cambia una celda solo se recalcula su cluster (y sus bordes y
+ * vecinos si la celda esta en un borde). el camino que sale es casi optimo,
+ * no exacto: el precio de no mirar todo el grid.
+ *
+ * lee la transitabilidad de un vector de bytes (0 = libre) que es del que
+ * llama, como la capa de bits del mapa.
+ */
+
+#pragma once
+
+#include "PathFinder.h"
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+class HierarchicalPathFinder {
+public:
+    struct Stats {
+        unsigned long long fullBuilds = 0;            // construcciones completas
+        unsigned long long clusterRebuilds = 0;       // clusters recalculados por cambios
+        unsigned long long borderRebuilds = 0;        // bordes recalculados por cambios
+        unsigned long long abstractNodesExpanded = 0; // nodos del grafo abstracto expandidos
+        unsigned long long segmentsRefined = 0;       // tramos convertidos a celdas
+    };
+
+    // ruta abstracta que se va refinando. waypoints son las entradas por las
+    // que pasa (mas inicio y fin); cells es lo ya refinado, celda por celda
+    struct Route {
+        std::vector<std::pair<int, int>> waypoints;
+        std::vector<std::pair<int, int>> cells;
+        size_t nextSegment = 0;
+
+        bool IsFullyRefined() const { return waypoints.size() < 2 || nextSegment + 1 >= waypoints.size(); }
+    };
+
+    HierarchicalPathFinder();
+
+    // arma todo el grafo de clusters. blocked tiene rows*cols bytes y tiene que
+    // seguir vivo (y al dia) mientras se use el buscador
+    void Build(const std::vector<uint8_t>* blocked, int rows, int cols, int clusterSize);
+
+    bool IsBuilt() const { return built; }
+    void Invalidate() { built = false; }
+
+    // anota que la celda cambio. se aplica en la siguiente consulta
+    void MarkCellChanged(int row, int col);
+
+    // recalcula los clusters y bordes marcados
+    void Refresh();
+
+    // busca la ruta abstracta y refina solo el primer tramo
+    bool FindRoute(std::pair<int, int> start, std::pair<int, int> goal, Route& route);
+
+    // refina tramos hasta tener al menos minCells celdas o terminar. false si
+    // un tramo ya no se puede recorrer (el mapa cambio) y hay que buscar de nuevo
+    bool RefineRoute(Route& route, size_t minCells);
+
+    // ruta abstracta + todos los tramos, en el mismo formato que PathFinder
+    bool FindPath(std::pair<int, int> start, std::pair<int, int> goal, std::vector<std::pair<int, int>>& outPath);
+
+    int GetClusterSize() const { return clusterSize; }
+    int GetClusterCount() const { return clusterRows * clusterCols; }
+    size_t GetEntranceCount() const;
+
+    const Stats& GetStats() const { return stats; }
+    void ResetStats() { stats = Stats(); }
+
+private:
+    // direcciones de borde que "posee" cada cluster; los otros cuatro bordes
+    // de un cluster son de sus vecinos de arriba/izquierda
+    enum BorderDir { BORDER_RIGHT = 0, BORDER_DOWN = 1, BORDER_DOWN_RIGHT = 2, BORDER_DOWN_LEFT = 3, BORDER_DIRS = 4 };
+
+    struct Crossing {
+        int ownCell;      // celda en el cluster duenio del borde
+        int otherCell;    // celda del otro lado
+        float cost;       // 1 recto, raiz de 2 diagonal
+    };
+
+    struct Edge {
+        int cell;
+        float cost;
+    };
+
+    struct ClusterData {
+        std::vector<int> nodes;                // celdas de entrada del cluster
+        std::vector<float> distances;          // nodes.size()^2, FLT_MAX si no se conectan
+        std::vector<std::vector<Edge>> inter;  // cruces hacia otros clusters por nodo
+    };
+
+    struct OpenEntry {
+        float fCost;
+        int cell;
+        bool operator>(const OpenEntry& other) const { return fCost > other.fCost; }
+    };
+
+    bool Blocked(int cell) const { return (*blocked)[cell] != 0; }
+    bool Walkable(int r, int c) const { return r >= 0 && r < rows && c >= 0 && c < cols && !Blocked(r * cols + c); }
+    int ClusterOf(int r, int c) const { return (r / clusterSize) * clusterCols + (c / clusterSize); }
+    void ClusterBounds(int cluster, int& r0, int& c0, int& r1, int& c1) const;
+    int BorderIndex(int cluster, int dir) const { return cluster * BORDER_DIRS + dir; }
+
+    void RebuildBorder(int cluster, int dir);
+    void RebuildCluster(int cluster);
+    void MarkBordersAround(int cluster);
+
+    // dijkstra dentro de un cluster desde sourceCell; deja la distancia a cada
+    // celda del cluster en localDist (indice local dentro del rectangulo)
+    void ClusterDijkstra(int cluster, int sourceCell, std::vector<float>& localDist);
+    float LocalDistance(int cluster, const std::vector<float>& localDist, int cell) const;
+
+    bool RefineSegment(std::pair<int, int> from, std::pair<int, int> to, std::vector<std::pair<int, int>>& cells);
+
+    const std::vector<uint8_t>* blocked;
+    int rows;
+    int cols;
+    int clusterSize;
+    int clusterRows;
+    int clusterCols;
+    bool built;
+
+    std::vector<std::vector<Crossing>> borders;  // clusters * BORDER_DIRS
+    std::vector<ClusterData> clusters;
+    std::vector<int> nodeLocalIndex;             // celda -> indice en su cluster, -1 si no es entrada
+    std::vector<uint8_t> clusterDirty;
+    std::vector<uint8_t> borderDirty;
+    bool anyDirty;
+
+    // scratch del dijkstra local
+    std::vector<OpenEntry> localHeap;
+    std::vector<float> sourceDist;
+    std::vector<float> startDist;
+    std::vector<float> goalDist;
+
+    // scratch de la busqueda abstracta, indexado por celda con generation stamps
+    std::vector<uint32_t> visitStamp;
+    std::vector<uint32_t> closedStamp;
+    std::vector<float> gCost;
+    std::vector<int> parent;
+    uint32_t generation;
+    std::vector<OpenEntry> openList;
+
+    // a* normal para refinar tramos, restringido al cluster del tramo
+    PathFinder localFinder;
+    std::vector<std::pair<int, int>> segmentScratch;
+
+    Stats stats;
+};
@@ -0,0 +1,82 @@
+/*
+ * hitpredictor.h - cuando choca un proyectil con un enemigo, sin simular
+ *
+ * los proyectiles van en linea recta a velocidad fija y los enemigos siguen
+ * los waypoints de su ruta, tambien en linea recta entre uno y otro. el
+ * movimiento del enemigo se parte en tramos (MotionSegment) y en cada tramo la
+ * distancia entre los dos es |A + B t|, asi que el primer instante en el que
+ * queda por debajo del radio sale de una cuadratica. con eso el impacto se
+ * calcula una vez al disparar en vez de probar proyectil contra enemigo en
+ * cada frame. la misma cuenta sobre un solo paso de simulacion es la
+ * colision "barrida": no importa cuanto avance el proyectil en el paso, no
+ * atraviesa a nadie sin tocarlo.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+// tramo de movimiento rectilineo: en t dentro de [t0, t1] la posicion es
+// (x0 + vx * (t - t0), y0 + vy * (t - t0)). t en segundos desde "ahora"
+struct MotionSegment {
+    float t0;
+    float t1;
+    float x0;
+    float y0;
+    float vx;
+    float vy;
+};
+
+// primer t en [startTime, horizon] en el que un punto que aparece en
+// (px, py) en startTime (antes no existe) y sigue con velocidad (pvx, pvy)
+// queda a radius o menos de alguien que hace los tramos. false si no se tocan
+// (o si el otro ya no existe despues del ultimo tramo)
+inline bool FirstContact(float px, float py, float pvx, float pvy, float startTime,
+                         const MotionSegment* segments, size_t count,
+                         float radius, float horizon, float& outTime)
+{
+    const float radiusSq = radius * radius;
+    for (size_t i = 0; i < count; ++i) {
+        const MotionSegment& s = segments[i];
+        if (s.t0 > horizon) {
+            break;
+        }
+        if (s.t1 < startTime) {
+            continue;
+        }
+        const float tStart = s.t0 > startTime ? s.t0 : startTime;
+        const float tEnd = s.t1 < horizon ? s.t1 : horizon;
+
+        // posicion relativa = A + B t
+        const float ax = px - pvx * startTime - s.x0 + s.vx * s.t0;
+        const float ay = py - pvy * startTime - s.y0 + s.vy * s.t0;
+        const float bx = pvx - s.vx;
+        const float by = pvy - s.vy;
+
+        // ya estan tocandose al empezar el tramo
+        const float startX = ax + bx * tStart;
+        const float startY = ay + by * tStart;
+        if (startX * startX + startY * startY <= radiusSq) {
+            outTime = tStart;
+            return true;
+        }
+
+        const float a = bx * bx + by * by;
+        if (a <= 0.0f) {
+            continue; // se mueven igual, la distancia no cambia
+        }
+        const float b = 2.0f * (ax * bx + ay * by);
+        const float c = ax * ax + ay * ay - radiusSq;
+        const float disc = b * b - 4.0f * a * c;
+        if (disc < 0.0f) {
+            continue;
+        }
+        const float enter = (-b - std::sqrt(disc)) / (2.0f * a);
+        if (enter >= tStart && enter <= tEnd) {
+            outTime = enter;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,105 @@
+// partes no-template del lpa*
+
+#include "IncrementalPlanner.h"
+#include <algorithm>
+#include <functional>
+
+IncrementalPlanner::IncrementalPlanner()
+    : rows(0), cols(0), active(false), start(-1, -1), goal(-1, -1), startIndex(-1), goalIndex(-1)
+{
+}
+
+void IncrementalPlanner::Resize(int newRows, int newCols)
+{
+    rows = newRows < 0 ? 0 : newRows;
+    cols = newCols < 0 ? 0 : newCols;
+    size_t cellCount = static_cast<size_t>(rows) * static_cast<size_t>(cols);
+    Key infinite = { DBL_MAX, DBL_MAX };
+    g.assign(cellCount, DBL_MAX);
+    rhs.assign(cellCount, DBL_MAX);
+    openKey.assign(cellCount, infinite);
+    inOpen.assign(cellCount, 0);
+    heap.clear();
+    heap.reserve(cellCount);
+    active = false;
+}
+
+// todo a infinito menos el rhs del inicio, que es 0 y es lo unico en el heap.
+// el primer ComputePath hace basicamente un a* normal
+void IncrementalPlanner::Reset(std::pair<int, int> newStart, std::pair<int, int> newGoal)
+{
+    active = false;
+    if (newStart.first < 0 || newStart.first >= rows || newStart.second < 0 || newStart.second >= cols ||
+        newGoal.first < 0 || newGoal.first >= rows || newGoal.second < 0 || newGoal.second >= cols) {
+        return;
+    }
+
+    start = newStart;
+    goal = newGoal;
+    startIndex = start.first * cols + start.second;
+    goalIndex = goal.first * cols + goal.second;
+
+    std::fill(g.begin(), g.end(), DBL_MAX);
+    std::fill(rhs.begin(), rhs.end(), DBL_MAX);
+    std::fill(inOpen.begin(), inOpen.end(), static_cast<uint8_t>(0));
+    heap.clear();
+
+    rhs[startIndex] = 0.0f;
+    Insert(startIndex);
+    active = true;
+    stats.resets++;
+}
+
+// octile con los costos del a*: nunca pasa el costo real de un paso, y en
+// double da exacto lo mismo que sumar los pasos (los empates no se rompen)
+double IncrementalPlanner::Heuristic(int index) const
+{
+    int dr = std::abs(index / cols - goal.first);
+    int dc = std::abs(index % cols - goal.second);
+    int diagonal = (std::min)(dr, dc);
+    int straight = (std::max)(dr, dc) - diagonal;
+    return static_cast<double>(PATH_DIAGONAL_COST) * diagonal + static_cast<double>(PATH_STRAIGHT_COST) * straight;
+}
+
+IncrementalPlanner::Key IncrementalPlanner::CalculateKey(int index) const
+{
+    double best = (std::min)(g[index], rhs[index]);
+    Key key;
+    if (best == DBL_MAX) {
+        key.primary = DBL_MAX;
+        key.secondary = DBL_MAX;
+        return key;
+    }
+    key.primary = best + Heuristic(index);
+    key.secondary = best;
+    return key;
+}
+
+void IncrementalPlanner::Insert(int index)
+{
+    QueueEntry entry;
+    entry.key = CalculateKey(index);
+    entry.index = index;
+    openKey[index] = entry.key;
+    inOpen[index] = 1;
+    heap.push_back(entry);
+    std::push_heap(heap.begin(), heap.end(), std::greater<QueueEntry>());
+}
+
+// el heap no soporta borrar del medio, asi que las entradas de celdas que
+// salieron o cambiaron de llave se quedan y se tiran cuando llegan arriba
+bool IncrementalPlanner::TopKey(Key& outKey)
+{
+    while (!heap.empty()) {
+        const QueueEntry& top = heap.front();
+        if (inOpen[top.index] &&
+            openKey[top.index].primary == top.key.primary &&
+            openKey[top.index].secondary == top.key.secondary) {
+            outKey = top.key;
+            return true;
+        }
+        std::pop_heap(heap.begin(), heap.end(), std::greater<QueueEntry>());
+        heap.pop_back();
+    }
+    return false;
+}
@@ -0,0 +1,238 @@
+/*
+ * incrementalplanner.h - replanificacion incremental (lpa*)
+ *
+ * el a* normal tira todo su trabajo al terminar. si despues cambia una sola
+ * celda y preguntamos otra vez lo mismo, vuelve a expandir todo desde cero.
+ * lpa* (lifelong planning a*, koenig y likhachev) guarda el arbol de busqueda
+ * entre consultas: cada celda tiene g (lo que valia la ultima vez) y rhs (lo
+ * que vale segun sus vecinos ahora). cuando una celda cambia solo se mete al
+ * heap lo que quedo inconsistente y se repara hasta que el camino al objetivo
+ * vuelve a ser optimo. lo que no toco el cambio ni se mira.
+ *
+ * sirve para una consulta fija (mismo inicio y mismo objetivo) que se repite
+ * mientras el mapa cambia; si cambian los extremos hay que hacer Reset.
+ * mismos costos que el PathFinder, asi que el largo del camino es el mismo
+ * que daria el a*.
+ *
+ * la condicion de corte es la del paper: seguir mientras el tope del heap
+ * tenga llave (primaria, secundaria) menor que la del objetivo o el objetivo
+ * este inconsistente. para que los empates sean empates de verdad, g, rhs y
+ * las llaves van en double (sumar costos float en double es exacto) y la
+ * heuristica es octile con los mismos costos, que es consistente; la
+ * euclidiana en float se pasaba por un ulp del costo diagonal.
+ */
+
+#pragma once
+
+#include "PathFinder.h"
+#include <vector>
+#include <utility>
+#include <cfloat>
+
+class IncrementalPlanner {
+public:
+    struct Stats {
+        unsigned long long resets = 0;          // inicializaciones desde cero
+        unsigned long long repairs = 0;         // consultas que reutilizaron el arbol
+        unsigned long long nodesExpanded = 0;   // celdas sacadas del heap
+        unsigned long long cellsNotified = 0;   // cambios de celda recibidos
+    };
+
+    IncrementalPlanner();
+
+    // dimensiona el planificador y lo deja sin consulta
+    void Resize(int rows, int cols);
+
+    // empieza una consulta nueva, sin nada calculado
+    void Reset(std::pair<int, int> start, std::pair<int, int> goal);
+
+    bool IsActive() const { return active; }
+    std::pair<int, int> GetStart() const { return start; }
+    std::pair<int, int> GetGoal() const { return goal; }
+
+    // avisa que la transitabilidad de una celda cambio. isBlocked ya debe
+    // devolver el valor nuevo
+    template <typename BlockedFn>
+    void NotifyCellChanged(int row, int col, BlockedFn isBlocked);
+
+    // repara lo necesario y escribe el camino optimo (vacio si no hay)
+    template <typename BlockedFn>
+    bool ComputePath(BlockedFn isBlocked, std::vector<std::pair<int, int>>& outPath);
+
+    const Stats& GetStats() const { return stats; }
+    void ResetStats() { stats = Stats(); }
+
+private:
+    struct Key {
+        double primary;   // min(g, rhs) + h
+        double secondary; // min(g, rhs)
+
+        bool operator<(const Key& other) const {
+            return primary < other.primary || (primary == other.primary && secondary < other.secondary);
+        }
+    };
+
+    struct QueueEntry {
+        Key key;
+        int index;
+
+        // para std::push_heap con std::greater: el de menor llave arriba
+        bool operator>(const QueueEntry& other) const {
+            return other.key < key;
+        }
+    };
+
+    Key CalculateKey(int index) const;
+    double Heuristic(int index) const; // octile hasta el objetivo
+
+    template <typename BlockedFn>
+    void UpdateVertex(int index, BlockedFn& isBlocked);
+
+    void Insert(int index);
+    bool TopKey(Key& outKey); // limpia entradas viejas del tope
+
+    int rows;
+    int cols;
+    bool active;
+    std::pair<int, int> start;
+    std::pair<int, int> goal;
+    int startIndex;
+    int goalIndex;
+    std::vector<double> g;
+    std::vector<double> rhs;
+    std::vector<Key> openKey;          // llave con la que la celda esta en el heap
+    std::vector<uint8_t> inOpen;       // la celda esta en el heap (las demas entradas son viejas)
+    std::vector<QueueEntry> heap;
+    Stats stats;
+};
+
+template <typename BlockedFn>
+void IncrementalPlanner::UpdateVertex(int index, BlockedFn& isBlocked)
+{
+    static const int dr[] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+    static const int dc[] = { 0, 0, -1, 1, -1, 1, -1, 1 };
+    static const float moveCost[] = {
+        PATH_STRAIGHT_COST, PATH_STRAIGHT_COST, PATH_STRAIGHT_COST, PATH_STRAIGHT_COST,
+        PATH_DIAGONAL_COST, PATH_DIAGONAL_COST, PATH_DIAGONAL_COST, PATH_DIAGONAL_COST
+    };
+
+    if (index != startIndex) {
+        int r = index / cols;
+        int c = index - r * cols;
+        double best = DBL_MAX;
+        // igual que en el a*: no se puede entrar a una celda bloqueada
+        if (!isBlocked(r, c)) {
+            for (int i = 0; i < 8; ++i) {
+                int nr = r + dr[i];
+                int nc = c + dc[i];
+                if (nr < 0 || nr >= rows || nc < 0 || nc >= cols) continue;
+                double neighborG = g[nr * cols + nc];
+                if (neighborG == DBL_MAX) continue;
+                double candidate = neighborG + moveCost[i];
+                if (candidate < best) best = candidate;
+            }
+        }
+        rhs[index] = best;
+    }
+
+    inOpen[index] = 0;
+    if (g[index] != rhs[index]) {
+        Insert(index);
+    }
+}
+
+template <typename BlockedFn>
+void IncrementalPlanner::NotifyCellChanged(int row, int col, BlockedFn isBlocked)
+{
+    if (!active || row < 0 || row >= rows || col < 0 || col >= cols) {
+        return;
+    }
+    stats.cellsNotified++;
+    // el costo de un movimiento depende solo de la celda a la que se entra,
+    // asi que el unico rhs que cambia directamente es el de la celda misma
+    UpdateVertex(row * cols + col, isBlocked);
+}
+
+template <typename BlockedFn>
+bool IncrementalPlanner::ComputePath(BlockedFn isBlocked, std::vector<std::pair<int, int>>& outPath)
+{
+    static const int dr[] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+    static const int dc[] = { 0, 0, -1, 1, -1, 1, -1, 1 };
+    static const float moveCost[] = {
+        PATH_STRAIGHT_COST, PATH_STRAIGHT_COST, PATH_STRAIGHT_COST, PATH_STRAIGHT_COST,
+        PATH_DIAGONAL_COST, PATH_DIAGONAL_COST, PATH_DIAGONAL_COST, PATH_DIAGONAL_COST
+    };
+
+    outPath.clear();
+    if (!active) {
+        return false;
+    }
+    if (startIndex == goalIndex) {
+        outPath.push_back(start);
+        return true;
+    }
+    stats.repairs++;
+
+    // se sigue mientras el tope sea menor que la llave del objetivo (las dos
+    // partes) o el objetivo este inconsistente; con la secundaria los vecinos
+    // del camino que empatan en la primaria salen antes que el objetivo
+    Key top;
+    while (TopKey(top) && (top < CalculateKey(goalIndex) || rhs[goalIndex] != g[goalIndex])) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<QueueEntry>());
+        int u = heap.back().index;
+        heap.pop_back();
+        inOpen[u] = 0;
+        stats.nodesExpanded++;
+
+        int r = u / cols;
+        int c = u - r * cols;
+        if (g[u] > rhs[u]) {
+            g[u] = rhs[u]; // sobre-consistente: ya sabemos su valor bueno
+        } else {
+            g[u] = DBL_MAX; // sub-consistente: algo empeoro, hay que recalcular
+            UpdateVertex(u, isBlocked);
+        }
+        for (int i = 0; i < 8; ++i) {
+            int nr = r + dr[i];
+            int nc = c + dc[i];
+            if (nr < 0 || nr >= rows || nc < 0 || nc >= cols) continue;
+            UpdateVertex(nr * cols + nc, isBlocked);
+        }
+    }
+
+    if (g[goalIndex] == DBL_MAX) {
+        return false;
+    }
+
+    // de atras para adelante: en cada paso el vecino con mejor g + costo
+    size_t maxLength = g.size() + 1;
+    int current = goalIndex;
+    outPath.push_back(goal);
+    while (current != startIndex) {
+        int r = current / cols;
+        int c = current - r * cols;
+        int bestNeighbor = -1;
+        double best = DBL_MAX;
+        for (int i = 0; i < 8; ++i) {
+            int nr = r + dr[i];
+            int nc = c + dc[i];
+            if (nr < 0 || nr >= rows || nc < 0 || nc >= cols) continue;
+            int neighbor = nr * cols + nc;
+            if (g[neighbor] == DBL_MAX) continue;
+            if (neighbor != startIndex && isBlocked(nr, nc)) continue;
+            double candidate = g[neighbor] + moveCost[i];
+            if (candidate < best) {
+                best = candidate;
+                bestNeighbor = neighbor;
+            }
+        }
+        if (bestNeighbor == -1 || outPath.size() > maxLength) {
+            outPath.clear();
+            return false;
+        }
+        current = bestNeighbor;
+        outPath.push_back(std::make_pair(current / cols, current % cols));
+    }
+    std::reverse(outPath.begin(), outPath.end());
+    return true;
+}
@@ -3,7 +3,6 @@
 #include "Enemy.h"
 #include <wincodec.h>
 #include <vector>
-#include <queue>
 #include <cmath>
 #include <algorithm>
 #include <map>
@@ -71,48 +70,6 @@ int getMaxInt(int a, int b) {
     return (a > b) ? a : b;
 }
 
-#ifndef M_SQRT2
-#define M_SQRT2 1.41421356237309504880f
-#endif
-
-namespace {
-    /*
-     * mira, este struct es para el pathfinding a*. es bastante simple:
-     * - guarda la posicion (row,col) del nodo
-     * - g_cost es el costo real desde el inicio hasta aqui
-     * - h_cost es la estimacion heuristica hasta el objetivo
-     * - f_cost es la suma de ambos, que usamos para decidir que nodo expandir
-     * - parent guarda de donde venimos para reconstruir el camino
-     * 
-     * nada del otro mundo, pero si lo rompes todo el pathfinding se va a la mierda
-     */
-    struct AStarNode {
-        int row, col;
-        float gCost;
-        float hCost;
-        float fCost;
-        std::pair<int, int> parent;
-
-        AStarNode(int r, int c, float g, float h, std::pair<int, int> p = {-1, -1})
-            : row(r), col(c), gCost(g), hCost(h), fCost(g + h), parent(p) {}
-
-        bool operator>(const AStarNode& other) const {
-            return fCost > other.fCost;
-        }
-    };
-
-    /*
-     * funcion simple que calcula la distancia euclidiana entre dos puntos
-     * la usamos como heuristica para a*. podriamos usar manhattan pero
-     * esta nos da mejores resultados para movimiento en 8 direcciones
-     */
-    float CalculateHeuristic(int r1, int c1, int r2, int c2) {
-        float dr = static_cast<float>(r1 - r2);
-        float dc = static_cast<float>(c1 - c2);
-        return std::sqrt(dr * dr + dc * dc);
-    }
-}
-
 /*
  * constructor del mapa. inicializa todo a valores por defecto y crea
  * los recursos graficos que necesitamos:
@@ -125,6 +82,8 @@ Map::Map() : numRows(0), numCols(0), entryRow(0), entryCol(0), gridPen(NULL), co
             pConstructionImage(NULL), constructionState(ConstructionState::NONE), selectedRow(-1), selectedCol(-1) {
     gridPen = CreatePen(PS_SOLID, 1, RGB(220, 220, 220));
     constructionSpotBrush = CreateSolidBrush(RGB(255, 255, 0));
+    // los pedidos por tramos reparten las capas en los mismos hilos
+    pathRequests.SetWorkerPool(&parallelPlanner.GetWorkerPool());
 }
 
 /*
@@ -170,6 +129,11 @@ void Map::Initialize(int screenWidth, int screenHeight) {
     entryRow = numRows / 2;
     entryCol = 0;
     grid[entryRow][entryCol].isEntryPoint = true;
+    passability.assign(static_cast<size_t>(numRows) * numCols, 0);
+    passabilityVersion++;
+    passabilityHash = 0;
+    ClearPathCache();
+    connectivity.Invalidate();
 
     int bridgeWidth = numCols / 10; 
     int bridgeStart = numCols - bridgeWidth;
@@ -183,6 +147,18 @@ void Map::Initialize(int screenWidth, int screenHeight) {
     }
 
     LoadConstructionSpots();
+    pathFinder.Resize(numRows, numCols);
+    bridgeField.Resize(numRows, numCols);
+    incrementalPlanner.Resize(numRows, numCols);
+    parallelPlanner.Resize(numRows, numCols);
+    pathRequests.Resize(numRows, numCols);
+    threatMap.Resize(numRows, numCols);
+    enemyGrid.Resize(GetMapPixelWidth(), GetMapPixelHeight(), static_cast<float>(CELL_SIZE));
+    towerManager.SetGrid(numRows, numCols, CELL_SIZE);
+    SetPathCostMode(pathCostMode); // el raster se volvio a pedir, el puntero cambio
+    hierarchicalFinder.Invalidate();
+    pendingFieldChanges.clear();
+    bridgeFieldDirty = true;
     // quito esto xd
     //LoadConstructionImage();
     economy.Initialize(500);
@@ -387,6 +363,9 @@ void Map::LoadConstructionSpots() {
     WCHAR msg[128];
     swprintf_s(msg, L"Map::LoadConstructionSpots - Loaded %zu construction spots.\n", constructionSpots.size());
     OutputDebugStringW(msg);
+
+    // cambiaron los spots, la capa de transitabilidad y el campo del puente se rehacen
+    RebuildPassability();
 }
 
 // funcion que dibuja todo el mapa
@@ -593,6 +572,7 @@ void Map::SetCellOccupied(int row, int col, bool occupied) {
         return;
     }
     grid[row][col].occupied = occupied;
+    SetPassabilityBit(row, col, PASS_BLOCK_OCCUPIED, occupied);
 }
 
 // configura el punto de entrada de enemigos, limpia el anterior
@@ -606,6 +586,7 @@ void Map::SetEntryPoint(int row, int col) {
         entryRow = row;
         entryCol = col;
         grid[entryRow][entryCol].isEntryPoint = true;
+        connectivity.Invalidate();
     }
 }
 
@@ -668,6 +649,12 @@ void Map::HandleClick(int x, int y) {
 
     /* si estamos seleccionando torre nueva, maneja el menu de construccion */
     if (constructionState == ConstructionState::SELECTING_TOWER) {
+        /* el mapa pudo cambiar desde que se abrio el menu, no cobramos por una torre que no se puede poner */
+        if (!CanBuildTowerAt(selectedRow, selectedCol)) {
+            constructionState = ConstructionState::NONE;
+            return;
+        }
+
         int menuX = x - (selectedCol * CELL_SIZE + CELL_SIZE + 10);
         int menuY = y - (selectedRow * CELL_SIZE);
         
@@ -738,7 +725,7 @@ void Map::HandleClick(int x, int y) {
                 towerManager.ShowRangeForTower(row, col);
             }
         }
-        else {
+        else if (CanBuildTowerAt(row, col)) {
             /* si no hay torre, muestra menu de construccion */
             selectedRow = row;
             selectedCol = col;
@@ -926,6 +913,16 @@ void Map::DrawConstructionMenu(HDC hdc) {
     DeleteObject(menuBrush);
 }
 
+// cada torre tirando a su ritmo y cada disparo volando a lo sumo lo que tarda
+// el mas lento (cañon) en cruzar el mapa en diagonal: con eso reservado,
+// disparar no pide memoria en medio de la oleada
+void Map::ReserveProjectilesForWave() {
+    const float width = GetMapPixelWidth();
+    const float height = GetMapPixelHeight();
+    const float longestFlight = std::sqrt(width * width + height * height) / GetProjectileSpeed(ProjectileType::CANNONBALL);
+    projectileManager.Reserve(static_cast<size_t>(std::ceil(towerManager.GetShotsPerSecond() * longestFlight)) + 1);
+}
+
 // Actualiza la lógica del mapa
 void Map::Update(float deltaTime, std::vector<Enemy>& currentWaveEnemies) {
     WCHAR debugMsg[256];
@@ -933,17 +930,21 @@ void Map::Update(float deltaTime, std::vector<Enemy>& currentWaveEnemies) {
               deltaTime, currentWaveEnemies.size(), towerManager.GetTowerCount());
     OutputDebugStringW(debugMsg);
     
-    // Actualizar torres
-    towerManager.Update(deltaTime, projectileManager, CELL_SIZE, currentWaveEnemies);
+    // Actualizar torres. de paso arma enemyGrid con las posiciones de este tick,
+    // que despues usan los proyectiles
+    towerManager.Update(deltaTime, projectileManager, CELL_SIZE, currentWaveEnemies, &enemyGrid);
 
     // Actualizar proyectiles
     projectileManager.Update(deltaTime, GetMapPixelWidth(), GetMapPixelHeight());
 
     // Verificar colisiones entre proyectiles y enemigos
-    projectileManager.CheckCollisions(currentWaveEnemies, CELL_SIZE, economy);
+    projectileManager.CheckCollisions(currentWaveEnemies, CELL_SIZE, economy, &enemyGrid);
+
+    // Caminos pedidos sin bloquear, con un tope de tiempo por frame
+    ProcessPathRequests(PATH_REQUEST_BUDGET_US);
 
     swprintf_s(debugMsg, L"Proyectiles activos: %zd\n", 
-              projectileManager.GetProjectiles().size());
+              projectileManager.GetProjectileCount());
     OutputDebugStringW(debugMsg);
 }
 
@@ -954,7 +955,10 @@ ConstructionState Map::GetConstructionState() const {
 
 // Verifica si existe una torre en la posición indicada
 bool Map::HasTower(int row, int col) const {
-    return towerManager.HasTower(row, col);
+    if (row < 0 || row >= numRows || col < 0 || col >= numCols) {
+        return false;
+    }
+    return (passability[row * numCols + col] & PASS_BLOCK_TOWER) != 0;
 }
 
 // Construye una torre del tipo especificado en la celda seleccionada
@@ -963,11 +967,65 @@ bool Map::BuildTower(TowerType type) {
         return false;
     }
     
+    return BuildTowerAt(type, selectedRow, selectedCol);
+}
+
+// Construye una torre en la celda indicada
+bool Map::BuildTowerAt(TowerType type, int row, int col) {
+    if (row < 0 || row >= numRows || col < 0 || col >= numCols) {
+        return false;
+    }
+
+    // la torre no puede dejar a los enemigos sin camino. solo importa fuera
+    // de los spots (que ya estan bloqueados); el indice es sobre celdas libres
+    if (WouldDisconnectBridge(row, col)) {
+        return false;
+    }
+
     // Marcar la celda como ocupada
-    SetCellOccupied(selectedRow, selectedCol, true);
-    
+    SetCellOccupied(row, col, true);
+
     // Construir la torre
-    return towerManager.AddTower(type, selectedRow, selectedCol);
+    if (!towerManager.AddTower(type, row, col)) {
+        return false;
+    }
+    SetPassabilityBit(row, col, PASS_BLOCK_TOWER, true);
+    if (const Tower* tower = towerManager.GetTowerAt(row, col)) {
+        ApplyTowerThreat(*tower, 1.0f);
+    }
+    return true;
+}
+
+/*
+ * antes para saber si una torre cortaba el camino habia que correr un a* y
+ * esperar a que inunde todo el mapa sin encontrar nada. el indice de
+ * conectividad ya tiene marcadas las celdas que separan la entrada del
+ * puente, asi que preguntar es leer un byte (y rearmarlo, lineal, solo si
+ * algo cambio cerca de donde llegan los enemigos)
+ */
+bool Map::WouldDisconnectBridge(int row, int col) const {
+    EnsureConnectivity();
+    return connectivity.WouldDisconnect(row, col);
+}
+
+// los spots ya estan bloqueados para los enemigos (PASS_BLOCK_CONSTRUCTION),
+// asi que una torre en un spot nunca corta el camino y no hace falta el indice
+bool Map::CanBuildTowerAt(int row, int col) const {
+    return IsConstructionSpot(row, col) && !HasTower(row, col);
+}
+
+bool Map::IsBridgeReachable() const {
+    EnsureConnectivity();
+    return connectivity.IsConnected();
+}
+
+void Map::EnsureConnectivity() const {
+    if (connectivity.IsBuilt()) {
+        return;
+    }
+    connectivity.Build(numRows, numCols, std::make_pair(entryRow, entryCol), GetBridgeGridLocation(), [this](int r, int c) {
+        return IsCellBlockedForPath(r, c);
+    });
 }
 
 // Mejora la torre en la celda seleccionada
@@ -976,7 +1034,62 @@ bool Map::UpgradeTower() {
         return false;
     }
     
-    return towerManager.UpgradeTower(selectedRow, selectedCol);
+    Tower* tower = towerManager.GetTowerAt(selectedRow, selectedCol);
+    if (!tower || !tower->CanUpgrade()) {
+        return false;
+    }
+
+    // el disco viejo afuera, el nuevo (mas rango, mas dps) adentro
+    ApplyTowerThreat(*tower, -1.0f);
+    bool upgraded = towerManager.UpgradeTower(selectedRow, selectedCol);
+    ApplyTowerThreat(*tower, 1.0f);
+    return upgraded;
+}
+
+/*
+ * suma (sign = 1) o resta (sign = -1) el disco de una torre en el raster de
+ * amenaza. solo toca las celdas de su rango, asi que es barato en cada click.
+ * las rutas que esquivan amenaza (las del GA, con avoidThreat) ahora cuestan
+ * otra cosa, asi que se sube la version: la cache, los pedidos a medias y el
+ * GA se enteran igual que cuando se bloquea una celda. las de distancia solo
+ * pierden su entrada de cache; el campo del puente y el hpa* no se enteran
+ */
+void Map::ApplyTowerThreat(const Tower& tower, float sign) {
+    ThreatChannel channel = THREAT_ARROW;
+    switch (tower.GetType()) {
+    case TowerType::ARCHER: channel = THREAT_ARROW; break;
+    case TowerType::MAGE:   channel = THREAT_MAGIC; break;
+    case TowerType::GUNNER: channel = THREAT_ARTILLERY; break;
+    }
+    float dps = tower.GetDamage() * tower.GetAttackSpeed();
+    threatMap.AddDisc(channel, tower.GetRow(), tower.GetCol(), tower.GetRange(), sign * dps);
+    passabilityVersion++;
+}
+
+// los demas buscadores (parallelPlanner, pathRequests) copian el campo de
+// pathFinder con Configure antes de cada uso
+void Map::SetPathCostMode(PathCostMode mode) {
+    pathCostMode = mode;
+    pathFinder.SetCostField(GetCostField(false), THREAT_PATH_WEIGHT);
+    passabilityVersion++;
+}
+
+// campo de costo de un pedido: amenaza si lo pide o si todo el mapa va por amenaza
+const float* Map::GetCostField(bool avoidThreat) const {
+    return avoidThreat || pathCostMode == PathCostMode::THREAT ? threatMap.GetCombinedData() : nullptr;
+}
+
+void Map::SetThreatResistances(float arrow, float magic, float artillery) {
+    const float weights[THREAT_CHANNEL_COUNT] = { arrow, magic, artillery };
+    bool changed = false;
+    for (int i = 0; i < THREAT_CHANNEL_COUNT; ++i) {
+        changed = changed || threatMap.GetChannelWeight(static_cast<ThreatChannel>(i)) != weights[i];
+    }
+    if (!changed) {
+        return; // misma oleada de siempre, las rutas siguen valiendo
+    }
+    threatMap.SetChannelWeights(weights);
+    passabilityVersion++;
 }
 
 // Obtiene una referencia a la economía
@@ -986,20 +1099,27 @@ Economy& Map::GetEconomy() {
 
 void Map::AddTemporaryObstacle(int row, int col) {
     if (row >= 0 && row < numRows && col >= 0 && col < numCols) {
-        // Avoid adding duplicates, though std::find on vector isn't most efficient for many obstacles
-        auto it = std::find(temporaryObstacles.begin(), temporaryObstacles.end(), std::make_pair(row, col));
-        if (it == temporaryObstacles.end()) {
+        // el bit de la capa ya nos dice si estaba, sin recorrer la lista
+        if (!IsCellTemporarilyObstructed(row, col)) {
             temporaryObstacles.push_back({row, col});
+            SetPassabilityBit(row, col, PASS_BLOCK_TEMPORARY, true);
         }
     }
 }
 
 void Map::ClearTemporaryObstacles() {
+    for (const auto& obstacle : temporaryObstacles) {
+        SetPassabilityBit(obstacle.first, obstacle.second, PASS_BLOCK_TEMPORARY, false);
+    }
     temporaryObstacles.clear();
 }
 
 // No se usará RemoveTemporaryObstacle por ahora, Clear es suficiente.
 void Map::RemoveTemporaryObstacle(int row, int col) {
+    if (!IsCellTemporarilyObstructed(row, col)) {
+        return;
+    }
+    SetPassabilityBit(row, col, PASS_BLOCK_TEMPORARY, false);
     temporaryObstacles.erase(
         std::remove_if(temporaryObstacles.begin(), temporaryObstacles.end(), 
                        [row, col](const std::pair<int,int>& obs){ return obs.first == row && obs.second == col; }), 
@@ -1007,7 +1127,10 @@ void Map::RemoveTemporaryObstacle(int row, int col) {
 }
 
 bool Map::IsCellTemporarilyObstructed(int row, int col) const {
-    return std::find(temporaryObstacles.begin(), temporaryObstacles.end(), std::make_pair(row, col)) != temporaryObstacles.end();
+    if (row < 0 || row >= numRows || col < 0 || col >= numCols) {
+        return false;
+    }
+    return (passability[row * numCols + col] & PASS_BLOCK_TEMPORARY) != 0;
 }
 
 /*
@@ -1016,90 +1139,435 @@ bool Map::IsCellTemporarilyObstructed(int row, int col) const {
  * pero es lo que hay que hacer si queremos que los enemigos no se queden
  * atascados como idiotas.
  *
+ * la busqueda en si la hace el PathFinder que vive dentro del mapa, que guarda
+ * su scratch entre llamadas para no andar pidiendo memoria cada vez. aqui solo
+ * le decimos que celdas estan bloqueadas.
+ *
  * recibe: punto inicial y final en coordenadas de grid
  * devuelve: vector con los puntos del camino, o vacio si no hay ruta
  */
 std::vector<std::pair<int, int>> Map::GetPath(std::pair<int, int> startCell, std::pair<int, int> endCell) const {
     std::vector<std::pair<int, int>> path;
-    if (startCell == endCell) {
-        path.push_back(startCell);
-        return path;
+    GetPath(startCell, endCell, path);
+    return path;
+}
+
+// version que escribe en un vector del que llama, para no pedir memoria nueva
+// en cada consulta (util en loops y benchmarks)
+bool Map::GetPath(std::pair<int, int> startCell, std::pair<int, int> endCell, std::vector<std::pair<int, int>>& outPath) const {
+    if (const PathCacheEntry* cached = FindPathCacheEntry(startCell, endCell, PATH_QUERY_SINGLE, nullptr)) {
+        if (cached->paths.empty()) outPath.clear();
+        else outPath = cached->paths[0];
+        return cached->found;
     }
-    if (startCell.first < 0 || startCell.first >= numRows || startCell.second < 0 || startCell.second >= numCols ||
-        endCell.first < 0 || endCell.first >= numRows || endCell.second < 0 || endCell.second >= numCols) {
-        return path; // si los puntos estan fuera del mapa, que se jodan
+
+    bool found;
+    if (UseHierarchicalPath()) {
+        // en mapas grandes el a* plano es lo que se come el frame
+        EnsureHierarchy();
+        found = hierarchicalFinder.FindPath(startCell, endCell, outPath);
+    } else {
+        EnsureLandmarks();
+        found = pathFinder.FindPath(startCell, endCell, [this](int r, int c) {
+            return IsCellBlockedForPath(r, c);
+        }, outPath);
     }
 
-    std::priority_queue<AStarNode, std::vector<AStarNode>, std::greater<AStarNode>> openList;
-    
-    // necesitamos estas estructuras para no volvernos locos:
-    // - costos g para cada celda (distancia desde inicio)
-    // - padres de cada celda para reconstruir el camino
-    // - lista cerrada para no revisar celdas mas de una vez
-    std::vector<std::vector<float>> gCosts(numRows, std::vector<float>(numCols, FLT_MAX));
-    std::vector<std::vector<std::pair<int,int>>> parents(numRows, std::vector<std::pair<int,int>>(numCols, {-1,-1}));
-    std::vector<std::vector<bool>> closedList(numRows, std::vector<bool>(numCols, false));
-
-    float startHCost = CalculateHeuristic(startCell.first, startCell.second, endCell.first, endCell.second);
-    openList.push(AStarNode(startCell.first, startCell.second, 0.0f, startHCost, {-1,-1}));
-    gCosts[startCell.first][startCell.second] = 0.0f;
-
-    // movimientos en 8 direcciones porque somos pros
-    int dr[] = {-1, 1, 0, 0, -1, -1, 1, 1}; 
-    int dc[] = {0, 0, -1, 1, -1, 1, -1, 1}; 
-    float moveCost[] = {1.0f, 1.0f, 1.0f, 1.0f, M_SQRT2, M_SQRT2, M_SQRT2, M_SQRT2}; 
-
-    while(!openList.empty()) {
-        AStarNode currentNode = openList.top();
-        openList.pop();
-
-        int r = currentNode.row;
-        int c = currentNode.col;
-
-        if (closedList[r][c]) {
-            continue; // ya revisamos esta celda, siguiente
+    if (pathCacheEnabled) {
+        PathCacheEntry& entry = StorePathCacheEntry(startCell, endCell, PATH_QUERY_SINGLE, nullptr);
+        entry.found = found;
+        entry.paths.resize(1);
+        entry.paths[0] = outPath;
+    }
+    return found;
+}
+
+/*
+ * a* incremental (lpa*). el planificador se queda con el arbol de la ultima
+ * consulta y el mapa le avisa de cada celda que cambia (MarkPassabilityChanged),
+ * asi que si se vuelve a pedir el mismo inicio y destino solo se reprocesa lo
+ * que el cambio afecto. si cambian los extremos se empieza de cero.
+ */
+bool Map::GetPathIncremental(std::pair<int, int> startCell, std::pair<int, int> endCell, std::vector<std::pair<int, int>>& outPath) const {
+    if (!incrementalPlanner.IsActive() ||
+        incrementalPlanner.GetStart() != startCell || incrementalPlanner.GetGoal() != endCell) {
+        incrementalPlanner.Reset(startCell, endCell);
+    }
+    return incrementalPlanner.ComputePath([this](int r, int c) {
+        return IsCellBlockedForPath(r, c);
+    }, outPath);
+}
+
+/*
+ * hpa*. en el mapa normal (38x21) no gana nada contra el a* plano, pero con
+ * mapas grandes la consulta pasa a ser un a* sobre las entradas entre clusters
+ * mas un a* chiquito por tramo. GetPath ya lo usa solo desde HPA_MIN_CELLS;
+ * esto es para pedirlo explicito. GetHierarchicalRoute deja refinar solo lo
+ * que se tiene adelante.
+ */
+bool Map::GetPathHierarchical(std::pair<int, int> startCell, std::pair<int, int> endCell, std::vector<std::pair<int, int>>& outPath) const {
+    EnsureHierarchy();
+    return hierarchicalFinder.FindPath(startCell, endCell, outPath);
+}
+
+bool Map::GetHierarchicalRoute(std::pair<int, int> startCell, std::pair<int, int> endCell, HierarchicalPathFinder::Route& route) const {
+    EnsureHierarchy();
+    return hierarchicalFinder.FindRoute(startCell, endCell, route);
+}
+
+bool Map::RefineHierarchicalRoute(HierarchicalPathFinder::Route& route, size_t minCells) const {
+    EnsureHierarchy();
+    return hierarchicalFinder.RefineRoute(route, minCells);
+}
+
+/*
+ * los enemigos caminan en linea recta de un waypoint al siguiente, asi que
+ * darles el camino celda por celda solo sirve para que paren en cada centro.
+ * con string pulling se quedan solo las esquinas de verdad
+ */
+void Map::SmoothPath(const std::vector<std::pair<int, int>>& path, std::vector<std::pair<int, int>>& outWaypoints) const {
+    pathFinder.SmoothPath(path, [this](int r, int c) {
+        return IsCellBlockedForPath(r, c);
+    }, outWaypoints);
+}
+
+/*
+ * heuristica alt. la euclidiana no sabe nada de las hileras de spots de
+ * construccion, asi que el a* se mete en cada callejon antes de rodearlas;
+ * con las distancias reales desde unos cuantos landmarks la cota sale casi
+ * exacta. las tablas solo se arman si la heuristica esta prendida y algo
+ * cambio desde la ultima vez (8 dijkstras sobre ~800 celdas, nada)
+ */
+void Map::EnsureLandmarks() const {
+    if (!pathFinder.GetUseLandmarks() || (!landmarksDirty && pathFinder.HasLandmarks())) {
+        return;
+    }
+    pathFinder.BuildLandmarks(LANDMARK_COUNT, GetBridgeGridLocation(), [this](int r, int c) {
+        return IsCellBlockedForPath(r, c);
+    });
+    landmarksDirty = false;
+}
+
+// el grafo lee directo la capa de transitabilidad, asi que solo hay que
+// armarlo una vez y avisarle que celdas cambiaron
+void Map::EnsureHierarchy() const {
+    if (!hierarchicalFinder.IsBuilt()) {
+        hierarchicalFinder.Build(&passability, numRows, numCols, HPA_CLUSTER_SIZE);
+    }
+}
+
+/*
+ * pedidos por tramos. miran la cache igual que GetPath / GetAlternativePathsParallel y al
+ * terminar guardan ahi la respuesta (con la version con la que se calculo, que
+ * puede ser vieja si el mapa cambio justo despues; la cache ya lo revisa)
+ */
+PathRequestHandle Map::RequestPath(std::pair<int, int> startCell, std::pair<int, int> endCell,
+                                   PathRequestCallback callback) const {
+    if (const PathCacheEntry* cached = FindPathCacheEntry(startCell, endCell, PATH_QUERY_SINGLE, nullptr)) {
+        std::vector<std::vector<std::pair<int, int>>> paths;
+        if (cached->found) paths = cached->paths;
+        return PathRequestQueue::MakeCompleted(startCell, endCell, false, paths, passabilityVersion, std::move(callback));
+    }
+    return pathRequests.Enqueue(startCell, endCell, [this, callback](const PathRequest& request) {
+        if (pathCacheEnabled && request.GetVersion() == passabilityVersion) {
+            PathCacheEntry& entry = StorePathCacheEntry(request.GetStart(), request.GetEnd(), PATH_QUERY_SINGLE, nullptr);
+            entry.found = request.Found();
+            entry.paths.assign(1, request.GetPath());
         }
-        closedList[r][c] = true;
-
-        if (r == endCell.first && c == endCell.second) { 
-            // llegamos! ahora hay que reconstruir el camino
-            std::pair<int,int> currentPathNode = endCell;
-            while(currentPathNode.first != -1) {
-                path.push_back(currentPathNode);
-                if (currentPathNode == startCell) break;
-                currentPathNode = parents[currentPathNode.first][currentPathNode.second];
-                if (path.size() > numRows * numCols * 2) return {}; // por si acaso hay ciclos infinitos
-            }
-            std::reverse(path.begin(), path.end());
-            return path;
+        if (callback) callback(request);
+    });
+}
+
+PathRequestHandle Map::RequestAlternativePaths(std::pair<int, int> startCell, std::pair<int, int> endCell,
+                                               const DiversePathOptions& options, PathRequestCallback callback) const {
+    if (const PathCacheEntry* cached = FindPathCacheEntry(startCell, endCell, PATH_QUERY_PARALLEL, &options)) {
+        return PathRequestQueue::MakeCompleted(startCell, endCell, true, cached->paths, passabilityVersion, std::move(callback));
+    }
+    return pathRequests.EnqueueAlternatives(startCell, endCell, options, [this, callback](const PathRequest& request) {
+        if (pathCacheEnabled && request.GetVersion() == passabilityVersion) {
+            PathCacheEntry& entry = StorePathCacheEntry(request.GetStart(), request.GetEnd(), PATH_QUERY_PARALLEL, &request.GetOptions());
+            entry.found = request.Found();
+            entry.paths = request.GetPaths();
         }
+        if (callback) callback(request);
+    });
+}
 
-        // revisamos los 8 vecinos de la celda actual
-        for (int i = 0; i < 8; ++i) {
-            int nextR = r + dr[i];
-            int nextC = c + dc[i];
-
-            // verificamos que la celda sea valida y no tenga obstaculos
-            if (nextR >= 0 && nextR < numRows && nextC >= 0 && nextC < numCols && 
-                !grid[nextR][nextC].occupied &&                
-                !IsCellTemporarilyObstructed(nextR, nextC) && 
-                !grid[nextR][nextC].isConstructionSpot &&     
-                !towerManager.HasTower(nextR, nextC) &&        
-                !closedList[nextR][nextC]) {
-                
-                float tentativeGCost = gCosts[r][c] + moveCost[i];
-
-                // si encontramos un mejor camino, actualizamos
-                if (tentativeGCost < gCosts[nextR][nextC]) {
-                    parents[nextR][nextC] = {r, c};
-                    gCosts[nextR][nextC] = tentativeGCost;
-                    float hCost = CalculateHeuristic(nextR, nextC, endCell.first, endCell.second);
-                    openList.push(AStarNode(nextR, nextC, tentativeGCost, hCost, {r,c} ));
-                }
-            }
+// los pasados de presupuesto quedan en GetPathRequestStats (slicesOverBudget)
+void Map::ProcessPathRequests(double budgetMicroseconds) const {
+    if (pathRequests.Empty()) {
+        return;
+    }
+    // misma configuracion que GetPath (las tablas alt solo se copian si cambiaron);
+    // los pedidos con avoidThreat buscan con el campo de amenaza
+    EnsureLandmarks();
+    pathRequests.Configure(pathFinder);
+    pathRequests.SetThreatField(threatMap.GetCombinedData(), THREAT_PATH_WEIGHT);
+    pathRequests.Process(budgetMicroseconds, passabilityVersion, [this](int r, int c) {
+        return IsCellBlockedForPath(r, c);
+    });
+}
+
+/*
+ * version de GetPath que no escribe nada del mapa: el scratch es del que
+ * llama y los obstaculos extra vienen en una capa aparte en vez de ponerlos
+ * como obstaculos temporales. con eso varias busquedas pueden correr a la vez
+ */
+bool Map::GetPath(std::pair<int, int> startCell, std::pair<int, int> endCell, const ObstacleOverlay& overlay,
+                  PathFinder& finder, std::vector<std::pair<int, int>>& outPath) const {
+    if (finder.GetRows() != numRows || finder.GetCols() != numCols) {
+        finder.Resize(numRows, numCols);
+    }
+    return finder.FindPath(startCell, endCell, [this, &overlay](int r, int c) {
+        return IsCellBlockedForPath(r, c) || overlay.Test(r, c);
+    }, outPath);
+}
+
+/*
+ * rutas alternativas para el GA. antes se hacian poniendo filas de obstaculos
+ * temporales a mano en el mapa y corriendo a* otra vez; ahora cada candidata
+ * rodea a las aceptadas con una capa de obstaculos aparte, asi que el mapa no
+ * se toca. las tandas de busquedas van en paralelo y pasan por la cache, asi
+ * que con el mapa quieto no se busca nada
+ */
+int Map::GetAlternativePathsParallel(std::pair<int, int> startCell, std::pair<int, int> endCell, const DiversePathOptions& options,
+                                     std::vector<std::vector<std::pair<int, int>>>& outPaths) const {
+    if (const PathCacheEntry* cached = FindPathCacheEntry(startCell, endCell, PATH_QUERY_PARALLEL, &options)) {
+        outPaths = cached->paths;
+        return static_cast<int>(outPaths.size());
+    }
+
+    // los workers buscan con la misma configuracion que GetPath (algoritmo,
+    // alt, campo de amenaza), asi que las rutas no dependen de por donde salen
+    EnsureLandmarks();
+    parallelPlanner.Configure(pathFinder);
+    parallelPlanner.SetCostField(GetCostField(options.avoidThreat), THREAT_PATH_WEIGHT);
+    int count = parallelPlanner.FindAlternatives(startCell, endCell, [this](int r, int c) {
+        return IsCellBlockedForPath(r, c);
+    }, options, outPaths);
+
+    if (pathCacheEnabled) {
+        PathCacheEntry& entry = StorePathCacheEntry(startCell, endCell, PATH_QUERY_PARALLEL, &options);
+        entry.found = count > 0;
+        entry.paths = outPaths;
+    }
+    return count;
+}
+
+/*
+ * cache de caminos. el GA pide las mismas rutas (entrada->puente) en cada
+ * generacion y cada oleada, y entre oleada y oleada el mapa casi nunca cambia,
+ * asi que la mayoria de esos a* daban lo mismo que la vez anterior.
+ *
+ * cada respuesta se guarda con la version de la capa de transitabilidad (sube
+ * en cada celda que cambia) y con el hash del conjunto de celdas bloqueadas,
+ * y solo sirve si los dos coinciden con los de ahora. no hace falta avisarle
+ * a la cache de nada: cualquier cambio pasa por SetPassabilityBit o
+ * RebuildPassability, que suben la version.
+ */
+namespace {
+    bool SameDiverseOptions(const DiversePathOptions& a, const DiversePathOptions& b) {
+        return a.maxPaths == b.maxPaths && a.maxAttempts == b.maxAttempts &&
+               a.maxOverlap == b.maxOverlap && a.maxStretch == b.maxStretch && a.avoidThreat == b.avoidThreat;
+    }
+
+    // clave fija por celda para el hash de la capa (splitmix64 del indice)
+    uint64_t PassabilityCellKey(int index) {
+        uint64_t z = static_cast<uint64_t>(index) + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+}
+
+void Map::SetPathCacheEnabled(bool enabled) {
+    pathCacheEnabled = enabled;
+    ClearPathCache();
+}
+
+Map::PathCacheEntry* Map::FindPathCacheEntry(std::pair<int, int> startCell, std::pair<int, int> endCell, PathQueryKind kind,
+                                             const DiversePathOptions* options) const {
+    if (!pathCacheEnabled) {
+        return nullptr;
+    }
+    for (PathCacheEntry& entry : pathCache) {
+        if (entry.start != startCell || entry.end != endCell || entry.kind != kind) continue;
+        if (options && !SameDiverseOptions(entry.options, *options)) continue;
+
+        if (entry.version == passabilityVersion && entry.hash == passabilityHash) {
+            pathCacheStats.hits++;
+            return &entry;
+        }
+        break; // vieja, se pisa al guardar
+    }
+    pathCacheStats.misses++;
+    return nullptr;
+}
+
+Map::PathCacheEntry& Map::StorePathCacheEntry(std::pair<int, int> startCell, std::pair<int, int> endCell, PathQueryKind kind,
+                                              const DiversePathOptions* options) const {
+    PathCacheEntry* slot = nullptr;
+    for (PathCacheEntry& entry : pathCache) {
+        if (entry.start == startCell && entry.end == endCell && entry.kind == kind &&
+            (!options || SameDiverseOptions(entry.options, *options))) {
+            slot = &entry;
+            break;
         }
     }
-    return path; // no hay camino, que se jodan x2
+    if (!slot) {
+        if (pathCache.size() < PATH_CACHE_CAPACITY) {
+            pathCache.push_back(PathCacheEntry());
+            slot = &pathCache.back();
+        } else {
+            // llena: se pisa la mas vieja, en ronda
+            slot = &pathCache[pathCacheNext];
+            pathCacheNext = (pathCacheNext + 1) % PATH_CACHE_CAPACITY;
+        }
+    }
+    slot->start = startCell;
+    slot->end = endCell;
+    slot->kind = kind;
+    slot->options = options ? *options : DiversePathOptions();
+    slot->version = passabilityVersion;
+    slot->hash = passabilityHash;
+    return *slot;
+}
+
+/*
+ * capa de transitabilidad. antes el a* le preguntaba a cada vecino si estaba
+ * en la lista de obstaculos temporales (std::find) y si tenia torre (recorrer
+ * todas las torres), o sea que el pathfinding se volvia mas lento con cada
+ * torre y cada obstaculo. ahora cada celda tiene un byte con los motivos por
+ * los que esta bloqueada, se actualiza cuando algo cambia y el loop caliente
+ * solo lee ese byte.
+ */
+void Map::SetPassabilityBit(int row, int col, uint8_t bit, bool set) {
+    if (row < 0 || row >= numRows || col < 0 || col >= numCols) {
+        return;
+    }
+    uint8_t& cell = passability[row * numCols + col];
+    bool wasBlocked = cell != 0;
+    if (set) cell |= bit;
+    else cell &= static_cast<uint8_t>(~bit);
+
+    if (wasBlocked != (cell != 0)) {
+        MarkPassabilityChanged(row, col);
+    }
+}
+
+void Map::RebuildPassability() {
+    passability.assign(static_cast<size_t>(numRows) * numCols, 0);
+    for (int r = 0; r < numRows; ++r) {
+        for (int c = 0; c < numCols; ++c) {
+            uint8_t bits = 0;
+            if (grid[r][c].occupied) bits |= PASS_BLOCK_OCCUPIED;
+            if (grid[r][c].isConstructionSpot) bits |= PASS_BLOCK_CONSTRUCTION;
+            if (towerManager.HasTower(r, c)) bits |= PASS_BLOCK_TOWER;
+            passability[r * numCols + c] = bits;
+        }
+    }
+    for (const auto& obstacle : temporaryObstacles) {
+        passability[obstacle.first * numCols + obstacle.second] |= PASS_BLOCK_TEMPORARY;
+    }
+    passabilityVersion++;
+    passabilityHash = 0;
+    for (int i = 0; i < numRows * numCols; ++i) {
+        if (passability[i] != 0) passabilityHash ^= PassabilityCellKey(i);
+    }
+    bridgeFieldDirty = true;
+    if (incrementalPlanner.IsActive()) {
+        incrementalPlanner.Reset(incrementalPlanner.GetStart(), incrementalPlanner.GetGoal());
+    }
+    hierarchicalFinder.Invalidate();
+    connectivity.Invalidate();
+    landmarksDirty = true;
+}
+
+/*
+ * campo de distancias al puente. en vez de que cada enemigo haga su propio a*
+ * hasta el mismo puente, hacemos un dijkstra desde el puente una sola vez y
+ * todos bajan por ahi. el costo por oleada ya no depende de cuantos enemigos
+ * haya, que era lo que nos limitaba para meter oleadas grandes.
+ *
+ * los cambios de transitabilidad (torres, obstaculos temporales) solo se
+ * anotan; el campo se pone al dia en la siguiente consulta y solo en la zona
+ * que cambio. si el GA pone y quita obstaculos sin consultar en medio, el
+ * campo ni se entera.
+ */
+void Map::MarkPassabilityChanged(int row, int col) {
+    passabilityVersion++;
+    passabilityHash ^= PassabilityCellKey(row * numCols + col);
+    if (incrementalPlanner.IsActive()) {
+        incrementalPlanner.NotifyCellChanged(row, col, [this](int r, int c) {
+            return IsCellBlockedForPath(r, c);
+        });
+    }
+    hierarchicalFinder.MarkCellChanged(row, col);
+    connectivity.NotifyCellChanged(row, col, IsCellBlockedForPath(row, col));
+    landmarksDirty = true;
+    if (bridgeFieldDirty) {
+        return; // igual se va a reconstruir todo
+    }
+    pendingFieldChanges.push_back(std::make_pair(row, col));
+}
+
+void Map::EnsureBridgeField() const {
+    auto isBlocked = [this](int r, int c) {
+        return IsCellBlockedForPath(r, c);
+    };
+
+    if (bridgeFieldDirty || !bridgeField.IsBuilt()) {
+        std::vector<std::pair<int, int>> targets(1, GetBridgeGridLocation());
+        bridgeField.Build(targets, isBlocked);
+        bridgeFieldDirty = false;
+        pendingFieldChanges.clear();
+        return;
+    }
+    if (!pendingFieldChanges.empty()) {
+        bridgeField.Update(pendingFieldChanges, isBlocked);
+        pendingFieldChanges.clear();
+    }
+}
+
+std::vector<std::pair<int, int>> Map::GetPathToBridge(std::pair<int, int> startCell) const {
+    std::vector<std::pair<int, int>> path;
+    GetPathToBridge(startCell, path);
+    return path;
+}
+
+// mismo formato que GetPath(start, puente): incluye inicio y puente, vacio si no hay ruta
+bool Map::GetPathToBridge(std::pair<int, int> startCell, std::vector<std::pair<int, int>>& outPath) const {
+    const std::pair<int, int> bridge = GetBridgeGridLocation();
+    if (pathCostMode == PathCostMode::THREAT) {
+        // el campo es de distancias, el a* con costo ya tiene su propia cache
+        return GetPath(startCell, bridge, outPath);
+    }
+    if (const PathCacheEntry* cached = FindPathCacheEntry(startCell, bridge, PATH_QUERY_BRIDGE, nullptr)) {
+        if (cached->paths.empty()) outPath.clear();
+        else outPath = cached->paths[0];
+        return cached->found;
+    }
+
+    EnsureBridgeField();
+    bool found = bridgeField.ExtractPath(startCell, outPath);
+
+    if (pathCacheEnabled) {
+        PathCacheEntry& entry = StorePathCacheEntry(startCell, bridge, PATH_QUERY_BRIDGE, nullptr);
+        entry.found = found;
+        entry.paths.resize(1);
+        entry.paths[0] = outPath;
+    }
+    return found;
+}
+
+bool Map::GetNextStepToBridge(int row, int col, std::pair<int, int>& outNext) const {
+    EnsureBridgeField();
+    return bridgeField.GetNextStep(row, col, outNext);
+}
+
+float Map::GetDistanceToBridge(int row, int col) const {
+    EnsureBridgeField();
+    return bridgeField.GetDistance(row, col);
 }
 
 /*
@@ -4,6 +4,7 @@
 #include <Windows.h>
 #include <string>
 #include <random> // Para generar posiciones aleatorias
+#include <cstdint>
 
 // Incluir GDI+ de forma segura
 #include <objidl.h>
@@ -19,9 +20,56 @@
 // Incluir gestor de proyectiles
 #include "Projectile.h"
 
+// Motor de pathfinding reutilizable
+#include "PathFinder.h"
+
+// Campo de distancias compartido hacia el puente
+#include "DistanceField.h"
+
+// Replanificacion incremental (lpa*)
+#include "IncrementalPlanner.h"
+
+// Pathfinding jerarquico (hpa*) para mapas grandes
+#include "HierarchicalPathFinder.h"
+
+// Celdas que no se pueden bloquear sin cortar la entrada del puente
+#include "ConnectivityIndex.h"
+
+// Rutas alternativas repartidas entre nucleos
+#include "ParallelPathPlanner.h"
+
+// Cola de busquedas por tramos
+#include "PathRequestQueue.h"
+
+// Daño por segundo de las torres por celda
+#include "ThreatMap.h"
+
+// Grid de enemigos por tick para "quien esta cerca"
+#include "SpatialHash.h"
+
 // Tamaño de cada celda en píxeles
 #define CELL_SIZE 50
 
+// Lado (en celdas) de cada cluster del pathfinding jerarquico
+#define HPA_CLUSTER_SIZE 16
+
+// Desde cuantas celdas GetPath usa hpa* en vez del a* plano (64x64; el mapa
+// normal de 38x21 sigue con a*)
+#define HPA_MIN_CELLS 4096
+
+// Cuantos landmarks usa la heuristica alt
+#define LANDMARK_COUNT 8
+
+// Cuantas consultas distintas guarda la cache de caminos
+#define PATH_CACHE_CAPACITY 16
+
+// Microsegundos por frame que Update le deja a la cola de caminos
+#define PATH_REQUEST_BUDGET_US 1000.0
+
+// Costo extra por celda, por cada punto de dps, en el modo de caminos por amenaza
+// (un arquero nivel 1 hace 18 de dps: pisar su rango cuesta casi el doble)
+#define THREAT_PATH_WEIGHT 0.05f
+
 // Forward declarations
 class TowerManager;
 class Economy;
@@ -37,6 +85,21 @@ struct Cell {
     // Puedes añadir más propiedades a la celda si es necesario
 };
 
+// Motivos por los que una celda no se puede pisar. cada celda guarda un byte
+// con estos bits, asi el pathfinding pregunta con una sola lectura
+enum PassabilityBit : uint8_t {
+    PASS_BLOCK_OCCUPIED     = 1 << 0, // marcada como ocupada
+    PASS_BLOCK_CONSTRUCTION = 1 << 1, // spot de construccion
+    PASS_BLOCK_TOWER        = 1 << 2, // hay una torre
+    PASS_BLOCK_TEMPORARY    = 1 << 3  // obstaculo temporal del GA
+};
+
+// Que minimiza GetPath: el largo del camino o el largo mas el daño que recibe
+enum class PathCostMode {
+    DISTANCE, // el camino mas corto
+    THREAT    // el que menos daño recibe (amenaza * THREAT_PATH_WEIGHT por celda)
+};
+
 // Estados de construcción
 enum class ConstructionState {
     NONE,            // Sin estado de construcción
@@ -101,6 +164,10 @@ public:
     // Actualiza la lógica del mapa
     void Update(float deltaTime, std::vector<Enemy>& currentWaveEnemies);
 
+    // Hace lugar para todos los proyectiles que las torres de ahora pueden
+    // tener en vuelo a la vez. se llama al empezar cada oleada
+    void ReserveProjectilesForWave();
+
     // Obtiene el estado de construcción actual
     ConstructionState GetConstructionState() const;
 
@@ -110,15 +177,156 @@ public:
     // Construye una torre del tipo especificado en la celda seleccionada
     bool BuildTower(TowerType type);
 
+    // Construye una torre en una celda concreta (sin pasar por la seleccion del menu)
+    bool BuildTowerAt(TowerType type, int row, int col);
+
+    // Bloquear esa celda dejaria a la entrada sin ningun camino al puente (sin correr a*)
+    bool WouldDisconnectBridge(int row, int col) const;
+
+    // Spot libre y sin torre (un spot nunca corta el camino: ya esta bloqueado)
+    bool CanBuildTowerAt(int row, int col) const;
+
+    // Hay algun camino de la entrada al puente
+    bool IsBridgeReachable() const;
+
+    // Estadísticas del indice de conectividad
+    const ConnectivityIndex::Stats& GetConnectivityStats() const { return connectivity.GetStats(); }
+
     // Mejora la torre en la celda seleccionada
     bool UpgradeTower();
 
     // Obtiene una referencia a la economía
     Economy& GetEconomy();
 
-    // Encuentra un camino desde startCell hasta endCell usando A*
+    // Encuentra un camino desde startCell hasta endCell usando A* (hpa* si el
+    // mapa tiene HPA_MIN_CELLS o mas y se busca por distancia)
     std::vector<std::pair<int, int>> GetPath(std::pair<int, int> startCell, std::pair<int, int> endCell) const;
 
+    // Igual que GetPath pero reutiliza el vector de salida (sin pedir memoria si ya tiene capacidad)
+    bool GetPath(std::pair<int, int> startCell, std::pair<int, int> endCell, std::vector<std::pair<int, int>>& outPath) const;
+
+    // Estadísticas del motor de pathfinding
+    const PathFinder::Stats& GetPathStats() const { return pathFinder.GetStats(); }
+
+    // Igual que GetPath pero con lpa*: guarda el arbol de busqueda entre llamadas y,
+    // si se repite la misma consulta despues de cambios, solo repara lo afectado
+    bool GetPathIncremental(std::pair<int, int> startCell, std::pair<int, int> endCell, std::vector<std::pair<int, int>>& outPath) const;
+
+    // Estadísticas del planificador incremental
+    const IncrementalPlanner::Stats& GetIncrementalPlannerStats() const { return incrementalPlanner.GetStats(); }
+
+    // Igual que GetPath pero con hpa*: casi optimo, pensado para mapas de miles de celdas
+    bool GetPathHierarchical(std::pair<int, int> startCell, std::pair<int, int> endCell, std::vector<std::pair<int, int>>& outPath) const;
+
+    // Ruta hpa* que se refina por tramos: GetHierarchicalRoute deja listo solo el
+    // primer tramo y RefineHierarchicalRoute agrega tramos hasta tener minCells celdas
+    bool GetHierarchicalRoute(std::pair<int, int> startCell, std::pair<int, int> endCell, HierarchicalPathFinder::Route& route) const;
+    bool RefineHierarchicalRoute(HierarchicalPathFinder::Route& route, size_t minCells) const;
+
+    // Estadísticas del buscador jerarquico
+    const HierarchicalPathFinder::Stats& GetHierarchicalStats() const { return hierarchicalFinder.GetStats(); }
+
+    // Igual que GetPath pero con obstaculos extra de solo lectura y el scratch del
+    // que llama. no toca nada del mapa (ni la cache ni los landmarks), asi que se
+    // puede llamar desde varios hilos a la vez mientras nadie modifique el mapa
+    bool GetPath(std::pair<int, int> startCell, std::pair<int, int> endCell, const ObstacleOverlay& overlay,
+                 PathFinder& finder, std::vector<std::pair<int, int>>& outPath) const;
+
+    // Hasta options.maxPaths rutas distintas de start a end, sin tocar el mapa.
+    // cada candidata es una busqueda independiente con una capa de obstaculos
+    // y las tandas se reparten entre los nucleos
+    int GetAlternativePathsParallel(std::pair<int, int> startCell, std::pair<int, int> endCell, const DiversePathOptions& options,
+                                    std::vector<std::vector<std::pair<int, int>>>& outPaths) const;
+
+    // Igual que GetPath / GetAlternativePathsParallel pero sin bloquear: la
+    // busqueda se reparte entre los siguientes Update con PATH_REQUEST_BUDGET_US
+    // por frame. el handle dice cuando termino y el callback (opcional) se llama
+    // desde Update. si la respuesta ya esta en la cache el pedido vuelve
+    // terminado. RequestAlternativePaths da las mismas rutas que
+    // GetAlternativePathsParallel (y comparte su entrada de cache); las capas
+    // de cada tanda avanzan a la vez en los hilos del planificador paralelo
+    PathRequestHandle RequestPath(std::pair<int, int> startCell, std::pair<int, int> endCell,
+                                  PathRequestCallback callback = nullptr) const;
+    PathRequestHandle RequestAlternativePaths(std::pair<int, int> startCell, std::pair<int, int> endCell,
+                                              const DiversePathOptions& options, PathRequestCallback callback = nullptr) const;
+
+    // Avanza los pedidos pendientes; Update ya lo llama con PATH_REQUEST_BUDGET_US
+    void ProcessPathRequests(double budgetMicroseconds) const;
+    const PathRequestQueue::Stats& GetPathRequestStats() const { return pathRequests.GetStats(); }
+    void ResetPathRequestStats() const { pathRequests.ResetStats(); }
+
+    // Hilos que usa GetAlternativePathsParallel, contando el que llama
+    int GetPathWorkerCount() const { return parallelPlanner.GetWorkerCount(); }
+    const ParallelPathPlanner::Stats& GetParallelPathStats() const { return parallelPlanner.GetStats(); }
+
+    // Costo de GetPath, GetAlternativePathsParallel, los Request*
+    // y GetPathToBridge: distancia (por defecto) o distancia + amenaza de las
+    // torres. en modo amenaza siempre corre a* (jps asume costo uniforme),
+    // GetPathToBridge pasa por GetPath y no se usa el hpa*. GetPathIncremental,
+    // GetPathHierarchical, GetNextStepToBridge y GetDistanceToBridge siguen
+    // siendo solo por distancia. para esquivar amenaza en un solo pedido de
+    // rutas distintas (lo que hace el GA) esta DiversePathOptions::avoidThreat,
+    // y lo demas sigue con jps, el campo del puente y el hpa*
+    void SetPathCostMode(PathCostMode mode);
+    PathCostMode GetPathCostMode() const { return pathCostMode; }
+
+    // Raster de amenaza, al dia con cada torre construida o mejorada
+    const ThreatMap& GetThreatMap() const { return threatMap; }
+
+    // Multiplicadores de daño por clase para el modo amenaza (las resistencias
+    // del enemigo que va a seguir el camino; 1, 1, 1 por defecto). el juego pone
+    // el promedio de cada oleada
+    void SetThreatResistances(float arrow, float magic, float artillery);
+
+    // Algoritmo que usa GetPath (a* o jump point search, mismo largo de camino)
+    void SetPathfindingAlgorithm(PathAlgorithm algorithm) { pathFinder.SetAlgorithm(algorithm); ClearPathCache(); }
+    PathAlgorithm GetPathfindingAlgorithm() const { return pathFinder.GetAlgorithm(); }
+
+    // Junta los tramos rectos de un camino de GetPath en pocos waypoints, con linea
+    // de vista sobre las mismas celdas bloqueadas que usa GetPath
+    void SmoothPath(const std::vector<std::pair<int, int>>& path, std::vector<std::pair<int, int>>& outWaypoints) const;
+
+    // Heuristica alt (landmarks) para GetPath y las rutas alternativas. las tablas se
+    // recalculan solas en la siguiente consulta despues de un cambio del mapa
+    void SetLandmarkHeuristic(bool enabled) { pathFinder.SetUseLandmarks(enabled); ClearPathCache(); }
+    bool IsLandmarkHeuristicEnabled() const { return pathFinder.GetUseLandmarks(); }
+
+    // Cache de GetPath, GetAlternativePathsParallel y GetPathToBridge. cada respuesta se
+    // guarda con la version y el hash de la capa de transitabilidad y solo
+    // sirve si los dos siguen iguales: mientras el mapa no cambie repetir la
+    // consulta no corre ningun a*. cualquier cambio sube la version, asi que
+    // aunque el mapa vuelva a quedar igual se busca de nuevo
+    struct PathCacheStats {
+        unsigned long long hits = 0;   // consultas respondidas desde la cache
+        unsigned long long misses = 0; // consultas que tuvieron que buscar
+    };
+    void SetPathCacheEnabled(bool enabled);
+    bool IsPathCacheEnabled() const { return pathCacheEnabled; }
+    void ClearPathCache() const { pathCache.clear(); pathCacheNext = 0; }
+    const PathCacheStats& GetPathCacheStats() const { return pathCacheStats; }
+    void ResetPathCacheStats() const { pathCacheStats = PathCacheStats(); }
+
+    // Sube cada vez que una celda pasa de libre a bloqueada o al reves y, en modo
+    // amenaza, cuando cambia el costo (torres, resistencias o el modo mismo)
+    uint64_t GetPassabilityVersion() const { return passabilityVersion; }
+
+    // Hash del conjunto de celdas bloqueadas (xor de una clave por celda)
+    uint64_t GetPassabilityHash() const { return passabilityHash; }
+
+    // Camino al puente bajando por el campo de distancias compartido (sin a* por enemigo), con cache.
+    // en modo amenaza es GetPath(start, puente): el campo no sabe de amenaza
+    std::vector<std::pair<int, int>> GetPathToBridge(std::pair<int, int> startCell) const;
+    bool GetPathToBridge(std::pair<int, int> startCell, std::vector<std::pair<int, int>>& outPath) const;
+
+    // Siguiente celda hacia el puente desde cualquier celda, O(1)
+    bool GetNextStepToBridge(int row, int col, std::pair<int, int>& outNext) const;
+
+    // Distancia en celdas hasta el puente (FLT_MAX si no se puede llegar)
+    float GetDistanceToBridge(int row, int col) const;
+
+    // Estadísticas del campo de distancias
+    const DistanceField::Stats& GetBridgeFieldStats() const { return bridgeField.GetStats(); }
+
     // Obtiene la ubicación del puente en coordenadas de cuadrícula (podría ser el centro o un punto de referencia)
     std::pair<int, int> GetBridgeGridLocation() const;
 
@@ -170,8 +378,115 @@ private:
     // Gestor de proyectiles
     ProjectileManager projectileManager;
 
+    // Enemigos de la oleada por balde, rearmado al inicio de cada Update. lo
+    // consultan las torres para apuntar y los proyectiles para chocar
+    SpatialHash enemyGrid;
+
     std::vector<std::pair<int, int>> temporaryObstacles;
 
+    // Motor a* con scratch reutilizable (mutable porque GetPath es const)
+    mutable PathFinder pathFinder;
+
+    // Las tablas alt del pathFinder son una foto de la capa de transitabilidad
+    mutable bool landmarksDirty = true;
+    void EnsureLandmarks() const;
+
+    // Campo de distancias al puente. se actualiza perezosamente en la siguiente
+    // consulta con las celdas que cambiaron desde la ultima vez
+    mutable DistanceField bridgeField;
+    mutable std::vector<std::pair<int, int>> pendingFieldChanges;
+    mutable bool bridgeFieldDirty = true;
+
+    // Planificador lpa* de GetPathIncremental. se le avisa de cada cambio al momento
+    mutable IncrementalPlanner incrementalPlanner;
+
+    // Hilos y un PathFinder por hilo para GetAlternativePathsParallel
+    mutable ParallelPathPlanner parallelPlanner;
+
+    // Pedidos de RequestPath / RequestAlternativePaths (con sus propios
+    // PathFinder; las capas usan los hilos de parallelPlanner)
+    mutable PathRequestQueue pathRequests;
+
+    // Amenaza por celda y clase de daño. cada torre suma su disco al construirse
+    // y al mejorarse se cambia el disco viejo por el nuevo
+    ThreatMap threatMap;
+    PathCostMode pathCostMode = PathCostMode::DISTANCE;
+    void ApplyTowerThreat(const Tower& tower, float sign);
+    const float* GetCostField(bool avoidThreat) const;
+
+    // Grafo de clusters de hpa*. se arma en la primera consulta jerarquica y
+    // despues solo se recalculan los clusters que tocan los cambios
+    mutable HierarchicalPathFinder hierarchicalFinder;
+    void EnsureHierarchy() const;
+
+    // GetPath pasa por hpa*: mapa grande y costo uniforme (hpa* no sabe de amenaza)
+    bool UseHierarchicalPath() const {
+        return pathCostMode == PathCostMode::DISTANCE && numRows * numCols >= HPA_MIN_CELLS;
+    }
+
+    // Puntos de corte entre la entrada y el puente. se rearma en la siguiente
+    // consulta solo si cambio una celda que la entrada alcanza
+    mutable ConnectivityIndex connectivity;
+    void EnsureConnectivity() const;
+
+    // Una celda no se puede pisar (ocupada, obstaculo temporal, spot o torre).
+    // una sola lectura de la capa de bits, sin rango (el que llama ya lo reviso)
+    bool IsCellBlockedForPath(int row, int col) const {
+        return passability[row * numCols + col] != 0;
+    }
+
+    // Capa de transitabilidad: un byte de PassabilityBit por celda, se mantiene
+    // al dia en cada cambio en vez de preguntarle a torres y obstaculos cada vez
+    std::vector<uint8_t> passability;
+
+    // Prende o apaga un motivo de bloqueo y avisa si la celda cambio de estado
+    void SetPassabilityBit(int row, int col, uint8_t bit, bool set);
+
+    // Recalcula la capa entera desde el grid, las torres y los obstaculos
+    void RebuildPassability();
+
+    // Anota que la transitabilidad de una celda pudo cambiar
+    void MarkPassabilityChanged(int row, int col);
+
+    // Version y hash de la capa, para la cache de caminos
+    uint64_t passabilityVersion = 0;
+    uint64_t passabilityHash = 0;
+
+    // que funcion guardo la entrada (las de rutas multiples tambien guardan options)
+    enum PathQueryKind : uint8_t {
+        PATH_QUERY_SINGLE,    // GetPath
+        PATH_QUERY_PARALLEL,  // GetAlternativePathsParallel
+        PATH_QUERY_BRIDGE     // GetPathToBridge (end es el puente)
+    };
+
+    struct PathCacheEntry {
+        std::pair<int, int> start;
+        std::pair<int, int> end;
+        PathQueryKind kind;
+        DiversePathOptions options;
+        uint64_t version;
+        uint64_t hash;
+        bool found;
+        std::vector<std::vector<std::pair<int, int>>> paths;
+    };
+
+    // Pocas entradas y busqueda lineal: el juego repite siempre las mismas dos o tres consultas
+    mutable std::vector<PathCacheEntry> pathCache;
+    mutable size_t pathCacheNext = 0;
+    mutable PathCacheStats pathCacheStats;
+    bool pathCacheEnabled = true;
+
+    // Entrada valida para la consulta, o nullptr (cuenta el acierto o el fallo)
+    PathCacheEntry* FindPathCacheEntry(std::pair<int, int> startCell, std::pair<int, int> endCell, PathQueryKind kind,
+                                       const DiversePathOptions* options) const;
+
+    // Entrada donde guardar una respuesta nueva (la misma consulta vieja o la mas antigua)
+    PathCacheEntry& StorePathCacheEntry(std::pair<int, int> startCell, std::pair<int, int> endCell, PathQueryKind kind,
+                                        const DiversePathOptions* options) const;
+
+    // Pone al dia el campo de distancias antes de consultarlo
+    void EnsureBridgeField() const;
+
     // Estadísticas para mostrar
     int generationCount = 0;
     int deadEnemiesCount = 0;
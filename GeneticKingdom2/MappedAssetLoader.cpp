@@ -0,0 +1,141 @@
+// sprites desde el archivo mapeado
+
+#include "framework.h"
+#include "MappedAssetLoader.h"
+#include "GdiplusAssetLoader.h"
+
+MappedAssetLoader::MappedAssetLoader(std::unique_ptr<AssetLoader> fallback)
+    : fallback(std::move(fallback)), file(INVALID_HANDLE_VALUE), mapping(NULL), view(nullptr)
+{
+    Close();
+}
+
+// los bitmaps apuntan al mapeo, asi que el AssetCache los tiene que haber
+// soltado antes (SetLoader hace Clear antes de devolver este loader)
+MappedAssetLoader::~MappedAssetLoader()
+{
+    Close();
+}
+
+bool MappedAssetLoader::Open(const std::wstring& path, int cellSize)
+{
+    Close();
+    if (path.empty()) {
+        return false;
+    }
+
+    file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                       FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        Close();
+        return false;
+    }
+    mapping = CreateFileMappingW(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (mapping == NULL) {
+        Close();
+        return false;
+    }
+    view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    if (view == nullptr || !archive.Open(view, static_cast<size_t>(size.QuadPart), cellSize)) {
+        OutputDebugStringW(L"El archivo de sprites no sirve, se usan los png\n");
+        Close();
+        return false;
+    }
+
+    WCHAR debugMsg[512];
+    // un png sin fecha (no esta, se distribuye solo el archivo) no invalida nada
+    for (size_t i = 0; i < ASSET_COUNT; ++i) {
+        const AssetId id = static_cast<AssetId>(i);
+        const AssetArchiveEntry* entry = archive.Find(id);
+        if (!entry) {
+            continue;
+        }
+        const uint64_t stamp = GdiplusAssetLoader::GetFileStamp(GdiplusAssetLoader::FindFile(id));
+        if (stamp != 0 && stamp != entry->sourceStamp) {
+            stale[i] = true;
+            swprintf_s(debugMsg, L"%s cambio despues de empaquetar, se usa el png (corre --pack-assets)\n",
+                       GetAssetFileName(id));
+            OutputDebugStringW(debugMsg);
+        }
+    }
+
+    swprintf_s(debugMsg, L"Sprites mapeados de %s\n", path.c_str());
+    OutputDebugStringW(debugMsg);
+    return true;
+}
+
+void MappedAssetLoader::Close()
+{
+    archive.Close();
+    for (size_t i = 0; i < ASSET_COUNT; ++i) {
+        stale[i] = false;
+    }
+    if (view) {
+        UnmapViewOfFile(view);
+        view = nullptr;
+    }
+    if (mapping) {
+        CloseHandle(mapping);
+        mapping = NULL;
+    }
+    if (file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+        file = INVALID_HANDLE_VALUE;
+    }
+}
+
+const AssetArchiveEntry* MappedAssetLoader::FindFresh(AssetId id) const
+{
+    const size_t index = static_cast<size_t>(id);
+    return index < ASSET_COUNT && !stale[index] ? archive.Find(id) : nullptr;
+}
+
+size_t MappedAssetLoader::GetStaleCount() const
+{
+    size_t count = 0;
+    for (size_t i = 0; i < ASSET_COUNT; ++i) {
+        count += stale[i] ? 1 : 0;
+    }
+    return count;
+}
+
+void* MappedAssetLoader::Load(AssetId id)
+{
+    if (const AssetArchiveEntry* entry = FindFresh(id)) {
+        // scan0 es del mapeo: gdi+ no copia los pixeles
+        BYTE* pixels = const_cast<BYTE*>(archive.GetPixels(*entry));
+        Gdiplus::Bitmap* bitmap = new Gdiplus::Bitmap(entry->width, entry->height, entry->stride,
+                                                      PixelFormat32bppPARGB, pixels);
+        if (bitmap->GetLastStatus() == Gdiplus::Ok) {
+            return static_cast<Gdiplus::Image*>(bitmap);
+        }
+        delete bitmap;
+    }
+    return fallback ? fallback->Load(id) : nullptr;
+}
+
+void MappedAssetLoader::Free(AssetId id, void* handle)
+{
+    // el archivo no cambia mientras esta abierto, asi que FindFresh dice quien lo cargo
+    if (FindFresh(id) || !fallback) {
+        delete static_cast<Gdiplus::Image*>(handle);
+    }
+    else {
+        fallback->Free(id, handle);
+    }
+}
+
+std::wstring MappedAssetLoader::FindArchive()
+{
+    for (const std::wstring& base : GdiplusAssetLoader::GetSearchBases()) {
+        std::wstring path = base + ASSET_ARCHIVE_FILE_NAME;
+        if (GetFileAttributesW(path.c_str()) != INVALID_FILE_ATTRIBUTES) {
+            return path;
+        }
+    }
+    return std::wstring();
+}
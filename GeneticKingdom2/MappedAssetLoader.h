@@ -0,0 +1,60 @@
+/*
+ * mappedassetloader.h - AssetLoader sobre el archivo de sprites mapeado
+ *
+ * mapea Sprites.pak (lo arma --pack-assets) y cada Load es un
+ * Gdiplus::Bitmap en PARGB armado directo sobre los bytes del mapeo: no se
+ * decodifica ni se copia nada, y la memoria son paginas del archivo que el
+ * sistema comparte. el mapeo es copy-on-write por si gdi+ quisiera escribir.
+ *
+ * lo que el archivo no tenga (o si no hay archivo, o se horneo con otro
+ * CELL_SIZE) se pide al loader de respaldo, normalmente el de png. lo
+ * mismo con cada sprite cuyo png tiene otra fecha que la que quedo en el
+ * archivo: alguien lo cambio y no re-empaqueto, asi que gana el png.
+ */
+
+#pragma once
+
+#include <Windows.h>
+#include <objidl.h>
+#include <gdiplus.h>
+#include <memory>
+#include <string>
+#include "AssetArchive.h"
+
+const wchar_t* const ASSET_ARCHIVE_FILE_NAME = L"Sprites.pak";
+
+class MappedAssetLoader : public AssetLoader {
+public:
+    explicit MappedAssetLoader(std::unique_ptr<AssetLoader> fallback);
+    ~MappedAssetLoader() override;
+
+    // mapea el archivo; false (y todo va al respaldo) si no existe o no sirve.
+    // los sprites viejos respecto a su png se marcan aca y van al respaldo
+    bool Open(const std::wstring& path, int cellSize);
+    void Close();
+    bool IsOpen() const { return archive.IsOpen(); }
+
+    // devuelve un Gdiplus::Image* (un Bitmap si salio del archivo)
+    void* Load(AssetId id) override;
+    void Free(AssetId id, void* handle) override;
+
+    // el Sprites.pak en las carpetas Assets\ de siempre, o vacio si no hay
+    static std::wstring FindArchive();
+
+    // sprites del archivo que no se usan porque su png cambio
+    size_t GetStaleCount() const;
+
+private:
+    MappedAssetLoader(const MappedAssetLoader&) = delete;
+    MappedAssetLoader& operator=(const MappedAssetLoader&) = delete;
+
+    // la entrada del archivo si se puede usar (existe y no esta vieja)
+    const AssetArchiveEntry* FindFresh(AssetId id) const;
+
+    std::unique_ptr<AssetLoader> fallback;
+    HANDLE file;
+    HANDLE mapping;
+    const void* view;
+    AssetArchive archive;
+    bool stale[ASSET_COUNT];
+};
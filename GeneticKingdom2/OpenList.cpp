@@ -0,0 +1,71 @@
+// partes frias de las listas abiertas (reservas y el reparto del radix heap)
+
+#include "OpenList.h"
+
+bool BinaryHeapOpenList::Reserve(size_t cellCount)
+{
+    // puede tener duplicados, pero casi nunca pasa de una entrada por celda
+    // en grids como los nuestros
+    if (heap.capacity() >= cellCount) {
+        return false;
+    }
+    heap.reserve(cellCount);
+    return true;
+}
+
+RadixHeapOpenList::RadixHeapOpenList()
+    : generation(1), last(0), count(0)
+{
+}
+
+bool RadixHeapOpenList::Reserve(size_t cellCount)
+{
+    if (stamp.size() >= cellCount) {
+        return false;
+    }
+    stamp.assign(cellCount, 0);
+    bucketOf.resize(cellCount);
+    slotOf.resize(cellCount);
+    generation = 1;
+    return true;
+}
+
+// igual que el scratch del PathFinder: subir la generacion invalida las
+// posiciones de todas las celdas de golpe
+void RadixHeapOpenList::Clear()
+{
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        buckets[i].clear();
+    }
+    generation++;
+    if (generation == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0u);
+        generation = 1;
+    }
+    last = 0;
+    count = 0;
+}
+
+/*
+ * todas las entradas del balde i comparten con la ultima clave los bits por
+ * encima del i, y difieren en el i. al tomar el minimo del balde como nueva
+ * ultima clave, cada una queda difiriendo en un bit mas bajo, o sea que cae
+ * en un balde menor que i. por eso el costo amortizado es O(32) por entrada
+ */
+void RadixHeapOpenList::Refill()
+{
+    int i = 1;
+    while (buckets[i].empty()) {
+        ++i;
+    }
+    std::vector<Entry>& source = buckets[i];
+    uint32_t minKey = source[0].key;
+    for (const Entry& entry : source) {
+        if (entry.key < minKey) minKey = entry.key;
+    }
+    last = minKey;
+    for (const Entry& entry : source) {
+        Insert(entry.key, entry.fCost, entry.index);
+    }
+    source.clear();
+}
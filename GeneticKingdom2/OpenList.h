@@ -0,0 +1,179 @@
+/*
+ * openlist.h - listas abiertas para las busquedas del PathFinder
+ *
+ * - BinaryHeapOpenList: el heap binario de siempre (push_heap/pop_heap). no
+ *   sabe bajar la prioridad de algo que ya esta adentro, asi que cada mejora
+ *   mete un duplicado y la busqueda descarta los viejos al sacarlos (los que
+ *   ya estan cerrados). O(log n) por push y por pop.
+ *
+ * - RadixHeapOpenList: radix heap monotono (ahuja, mehlhorn, orlin y tarjan).
+ *   sirve porque en a* con heuristica consistente (y en dijkstra) las claves
+ *   que salen nunca bajan. los floats positivos se ordenan igual que sus bits
+ *   leidos como enteros, asi que se usan esos bits como clave entera, sin
+ *   redondear los costos. cada entrada va al balde del bit mas alto en el que
+ *   difiere de la ultima clave sacada; push es O(1) y cada entrada baja de
+ *   balde a lo sumo 32 veces en toda su vida. si se vuelve a meter una celda
+ *   que ya esta adentro se mueve (decrease-key), sin duplicados.
+ *
+ * el PathFinder usa el heap binario salvo que se compile con
+ * PATHFINDER_USE_RADIX_HEAP.
+ */
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// entrada de la lista abierta, lo minimo para que quepa en cache
+struct OpenEntry {
+    float fCost;
+    int index;
+
+    bool operator>(const OpenEntry& other) const {
+        return fCost > other.fCost;
+    }
+};
+
+class BinaryHeapOpenList {
+public:
+    // reserva para cellCount entradas; true si tuvo que pedir memoria
+    bool Reserve(size_t cellCount);
+
+    void Clear() { heap.clear(); }
+    bool Empty() const { return heap.empty(); }
+    size_t Size() const { return heap.size(); }
+
+    // true si el vector tuvo que crecer
+    bool Push(float fCost, int index) {
+        bool grew = heap.size() == heap.capacity();
+        OpenEntry entry;
+        entry.fCost = fCost;
+        entry.index = index;
+        heap.push_back(entry);
+        std::push_heap(heap.begin(), heap.end(), std::greater<OpenEntry>());
+        return grew;
+    }
+
+    OpenEntry Pop() {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<OpenEntry>());
+        OpenEntry entry = heap.back();
+        heap.pop_back();
+        return entry;
+    }
+
+private:
+    std::vector<OpenEntry> heap;
+};
+
+class RadixHeapOpenList {
+public:
+    RadixHeapOpenList();
+
+    // dimensiona las posiciones por celda; true si tuvo que pedir memoria
+    bool Reserve(size_t cellCount);
+
+    void Clear();
+    bool Empty() const { return count == 0; }
+    size_t Size() const { return count; }
+
+    // mete la celda, o le baja la clave si ya estaba. claves menores que la
+    // ultima sacada (redondeo de floats) se suben a esa. true si algun balde creció
+    bool Push(float fCost, int index) {
+        uint32_t key = KeyOf(fCost);
+        if (key < last) key = last;
+
+        if (stamp[index] == generation && bucketOf[index] >= 0) {
+            Entry& current = buckets[bucketOf[index]][slotOf[index]];
+            if (key >= current.key) {
+                return false; // no mejora
+            }
+            Remove(index);
+        } else {
+            stamp[index] = generation;
+            count++;
+        }
+        return Insert(key, fCost, index);
+    }
+
+    OpenEntry Pop() {
+        if (buckets[0].empty()) {
+            Refill();
+        }
+        Entry entry = buckets[0].back();
+        buckets[0].pop_back();
+        bucketOf[entry.index] = -1;
+        count--;
+        OpenEntry result;
+        result.fCost = entry.fCost;
+        result.index = entry.index;
+        return result;
+    }
+
+private:
+    static const int BUCKET_COUNT = 33; // balde 0 = igual a la ultima, 1..32 = bit mas alto distinto
+
+    struct Entry {
+        uint32_t key;
+        float fCost;
+        int index;
+    };
+
+    static uint32_t KeyOf(float fCost) {
+        if (!(fCost > 0.0f)) return 0; // el -0 tiene el bit de signo prendido
+        uint32_t bits;
+        std::memcpy(&bits, &fCost, sizeof(bits));
+        return bits;
+    }
+
+    int BucketFor(uint32_t key) const {
+        uint32_t diff = key ^ last;
+        if (diff == 0) return 0;
+#if defined(_MSC_VER)
+        unsigned long highest;
+        _BitScanReverse(&highest, diff);
+        return static_cast<int>(highest) + 1;
+#else
+        return 32 - __builtin_clz(diff);
+#endif
+    }
+
+    bool Insert(uint32_t key, float fCost, int index) {
+        int bucket = BucketFor(key);
+        std::vector<Entry>& target = buckets[bucket];
+        bool grew = target.size() == target.capacity();
+        bucketOf[index] = bucket;
+        slotOf[index] = static_cast<int>(target.size());
+        Entry entry = { key, fCost, index };
+        target.push_back(entry);
+        return grew;
+    }
+
+    // saca la celda de su balde cambiandola por la ultima
+    void Remove(int index) {
+        std::vector<Entry>& bucket = buckets[bucketOf[index]];
+        int slot = slotOf[index];
+        bucket[slot] = bucket.back();
+        slotOf[bucket[slot].index] = slot;
+        bucket.pop_back();
+    }
+
+    // el balde 0 se vacio: busca el primer balde con algo, toma su minimo
+    // como nueva ultima clave y reparte sus entradas en baldes mas bajos
+    void Refill();
+
+    std::vector<Entry> buckets[BUCKET_COUNT];
+    std::vector<uint32_t> stamp;  // busqueda en la que se metio cada celda
+    std::vector<int> bucketOf;    // balde de la celda, -1 si ya salio
+    std::vector<int> slotOf;      // posicion dentro del balde
+    uint32_t generation;
+    uint32_t last;                // ultima clave sacada
+    size_t count;
+};
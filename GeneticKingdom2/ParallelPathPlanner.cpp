@@ -0,0 +1,127 @@
+// capas de obstaculos para las rutas alternativas en paralelo
+
+#include "ParallelPathPlanner.h"
+
+ParallelPathPlanner::ParallelPathPlanner(int threadCount)
+    : rows(0), cols(0), pool(threadCount), finders(pool.GetWorkerCount())
+{
+}
+
+void ParallelPathPlanner::Resize(int newRows, int newCols)
+{
+    rows = newRows;
+    cols = newCols;
+    for (PathFinder& finder : finders) {
+        finder.Resize(rows, cols);
+    }
+    alternatives.Resize(rows, cols);
+}
+
+void ParallelPathPlanner::Configure(const PathFinder& reference)
+{
+    for (PathFinder& finder : finders) {
+        finder.CopySettingsFrom(reference);
+    }
+}
+
+void ParallelPathPlanner::SetCostField(const float* field, float scale)
+{
+    for (PathFinder& finder : finders) {
+        finder.SetCostField(field, scale);
+    }
+}
+
+void AlternativeRoutes::Resize(int newRows, int newCols)
+{
+    rows = newRows;
+    cols = newCols;
+    overlapFinder.Resize(rows, cols);
+}
+
+void AlternativeRoutes::Begin(std::pair<int, int> newStart, std::pair<int, int> newEnd, const DiversePathOptions& newOptions,
+                              const std::vector<std::pair<int, int>>& optimal,
+                              std::vector<std::vector<std::pair<int, int>>>& outPaths)
+{
+    start = newStart;
+    end = newEnd;
+    options = newOptions;
+    optimalCost = PathFinder::PathCost(optimal);
+    acceptedHashes.assign(1, PathFinder::PathHash(optimal));
+    outPaths.assign(1, optimal);
+    searches = 1;
+    maxAttempts = options.maxAttempts > 0 ? options.maxAttempts : options.maxPaths * 4;
+    finished = false;
+}
+
+/*
+ * capa i: radio 1, 2 o 3 (i / 3) y tramo (i % 3) del 10 al 90% de cada ruta,
+ * o solo su primera o segunda mitad. las primeras capas son las que menos
+ * tapan, asi que las rutas que salen primero son los rodeos mas cortos. los
+ * extremos de cada ruta quedan libres para no encerrar la entrada ni el puente
+ */
+int AlternativeRoutes::BeginRound(const std::vector<std::vector<std::pair<int, int>>>& accepted)
+{
+    if (finished || static_cast<int>(accepted.size()) >= options.maxPaths || searches >= maxAttempts) {
+        finished = true;
+        return 0;
+    }
+    static const float sections[3][2] = { { 0.1f, 0.9f }, { 0.1f, 0.5f }, { 0.5f, 0.9f } };
+
+    const int count = (std::min)(static_cast<int>(LAYERS_PER_ROUND), maxAttempts - searches);
+    searches += count;
+    layers.resize(count);
+    for (int i = 0; i < count; ++i) {
+        ObstacleOverlay& layer = layers[i];
+        layer.Resize(rows, cols);
+        const int radius = 1 + (i / 3) % 3;
+        const float* section = sections[i % 3];
+
+        for (const auto& path : accepted) {
+            int length = static_cast<int>(path.size());
+            if (length < 3) continue;
+            int from = (std::max)(1, static_cast<int>(length * section[0]));
+            int to = (std::min)(length - 2, static_cast<int>(length * section[1]));
+            for (int k = from; k <= to; ++k) {
+                for (int r = path[k].first - radius; r <= path[k].first + radius; ++r) {
+                    for (int c = path[k].second - radius; c <= path[k].second + radius; ++c) {
+                        if (r < 0 || r >= rows || c < 0 || c >= cols) continue;
+                        if ((r == start.first && c == start.second) || (r == end.first && c == end.second)) continue;
+                        layer.Set(r, c);
+                    }
+                }
+            }
+        }
+    }
+    return count;
+}
+
+void AlternativeRoutes::EndRound(const std::vector<std::vector<std::pair<int, int>>>& candidates, int count,
+                                 std::vector<std::vector<std::pair<int, int>>>& outPaths)
+{
+    bool added = false;
+    for (int i = 0; i < count && static_cast<int>(outPaths.size()) < options.maxPaths; ++i) {
+        const std::vector<std::pair<int, int>>& candidate = candidates[i];
+        if (candidate.empty() || PathFinder::PathCost(candidate) > optimalCost * options.maxStretch) {
+            continue;
+        }
+        uint64_t hash = PathFinder::PathHash(candidate);
+        if (std::find(acceptedHashes.begin(), acceptedHashes.end(), hash) != acceptedHashes.end()) {
+            duplicates++;
+            continue;
+        }
+        bool accept = true;
+        for (size_t j = 0; accept && j < outPaths.size(); ++j) {
+            if (overlapFinder.PathOverlap(candidate, outPaths[j]) > options.maxOverlap) {
+                accept = false;
+            }
+        }
+        if (accept) {
+            acceptedHashes.push_back(hash);
+            outPaths.push_back(candidate);
+            added = true;
+        }
+    }
+    if (!added) {
+        finished = true; // las capas ya no sacan nada nuevo
+    }
+}
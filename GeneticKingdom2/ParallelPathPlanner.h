@@ -0,0 +1,165 @@
+/*
+ * parallelpathplanner.h - rutas alternativas en paralelo con capas de obstaculos
+ *
+ * cada candidata es una busqueda independiente sobre la transitabilidad del
+ * mapa mas una ObstacleOverlay de solo lectura, asi que una tanda entera se
+ * reparte entre los nucleos.
+ *
+ * las capas tapan un "tubo" alrededor de las rutas ya aceptadas (radio de 1 a
+ * 3 celdas, sobre todo el tramo del medio o solo una mitad) para obligar a la
+ * siguiente a rodearlas. se hacen tandas hasta tener las rutas pedidas: la
+ * primera tanda rodea a la optima, la segunda a todas las aceptadas, etc.
+ * las candidatas se revisan en orden de capa, asi que el resultado no depende
+ * de que hilo termino primero. los duplicados se descartan por PathHash.
+ *
+ * cada worker tiene su propio PathFinder, configurado igual que el del que
+ * llama (Configure). isBlocked se llama desde varios hilos a la vez: tiene
+ * que ser de solo lectura. el resultado no depende de cuantos hilos haya:
+ * con uno solo las capas se buscan una tras otra.
+ */
+
+#pragma once
+
+#include "PathFinder.h"
+#include "WorkerPool.h"
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+/*
+ * las capas y el criterio para aceptar candidatas, sin las busquedas. lo usan
+ * ParallelPathPlanner (cada tanda de una vez) y PathRequestQueue (cada tanda
+ * por tramos), asi las dos dan las mismas rutas. el ciclo es:
+ * Begin con la optima, y mientras BeginRound devuelva capas, buscar un camino
+ * por capa y pasarselos a EndRound
+ */
+class AlternativeRoutes {
+public:
+    static const int LAYERS_PER_ROUND = 9; // 3 radios x 3 tramos
+
+    void Resize(int rows, int cols);
+
+    // arranca con la ruta optima ya buscada; outPaths queda con esa sola
+    void Begin(std::pair<int, int> start, std::pair<int, int> end, const DiversePathOptions& options,
+               const std::vector<std::pair<int, int>>& optimal,
+               std::vector<std::vector<std::pair<int, int>>>& outPaths);
+
+    // arma las capas de la proxima tanda alrededor de las rutas aceptadas y
+    // devuelve cuantas son. 0 = ya esta, outPaths es el resultado
+    int BeginRound(const std::vector<std::vector<std::pair<int, int>>>& outPaths);
+    const ObstacleOverlay& GetLayer(int index) const { return layers[index]; }
+    const std::vector<ObstacleOverlay>& GetLayers() const { return layers; }
+
+    // revisa las candidatas de la tanda en orden de capa (candidates[i] vacio
+    // si la capa i no tuvo camino) y agrega las que sirven a outPaths
+    void EndRound(const std::vector<std::vector<std::pair<int, int>>>& candidates, int count,
+                  std::vector<std::vector<std::pair<int, int>>>& outPaths);
+
+    unsigned long long GetDuplicates() const { return duplicates; }
+
+private:
+    int rows = 0;
+    int cols = 0;
+    std::pair<int, int> start;
+    std::pair<int, int> end;
+    DiversePathOptions options;
+    float optimalCost = 0.0f;
+    int searches = 0;
+    int maxAttempts = 0;
+    bool finished = true;
+    std::vector<uint64_t> acceptedHashes;
+    std::vector<ObstacleOverlay> layers;
+    PathFinder overlapFinder; // solo para PathOverlap
+    unsigned long long duplicates = 0;
+};
+
+class ParallelPathPlanner {
+public:
+    struct Stats {
+        unsigned long long rounds = 0;    // tandas en paralelo
+        unsigned long long searches = 0;  // busquedas a* en total
+        unsigned long long duplicates = 0; // candidatas descartadas por hash
+    };
+
+    // threadCount = 0 usa todos los nucleos
+    explicit ParallelPathPlanner(int threadCount = 0);
+
+    void Resize(int rows, int cols);
+    int GetWorkerCount() const { return pool.GetWorkerCount(); }
+
+    // para que PathRequestQueue reparta sus capas en los mismos hilos
+    WorkerPool& GetWorkerPool() { return pool; }
+
+    // copia algoritmo, landmarks y campo de costo de reference a los finders
+    // de los workers. hay que volver a llamarlo si cambian en reference
+    void Configure(const PathFinder& reference);
+
+    // campo de costo para los finders de los workers (despues de Configure)
+    void SetCostField(const float* field, float scale);
+
+    // un camino por capa, en paralelo. outPaths[i] queda vacio si con la capa
+    // i no hay ruta
+    template <typename BlockedFn>
+    void FindPaths(std::pair<int, int> start, std::pair<int, int> end, BlockedFn isBlocked,
+                   const std::vector<ObstacleOverlay>& layers,
+                   std::vector<std::vector<std::pair<int, int>>>& outPaths);
+
+    // hasta options.maxPaths rutas distintas de start a end
+    template <typename BlockedFn>
+    int FindAlternatives(std::pair<int, int> start, std::pair<int, int> end, BlockedFn isBlocked,
+                         const DiversePathOptions& options,
+                         std::vector<std::vector<std::pair<int, int>>>& outPaths);
+
+    const Stats& GetStats() const { return stats; }
+    void ResetStats() { stats = Stats(); }
+
+private:
+    int rows;
+    int cols;
+    WorkerPool pool;
+    std::vector<PathFinder> finders; // uno por worker
+    AlternativeRoutes alternatives;
+    std::vector<std::vector<std::pair<int, int>>> candidates;
+    Stats stats;
+};
+
+template <typename BlockedFn>
+void ParallelPathPlanner::FindPaths(std::pair<int, int> start, std::pair<int, int> end, BlockedFn isBlocked,
+                                    const std::vector<ObstacleOverlay>& layers,
+                                    std::vector<std::vector<std::pair<int, int>>>& outPaths)
+{
+    outPaths.resize(layers.size());
+    pool.ParallelFor(static_cast<int>(layers.size()), [&](int item, int worker) {
+        const ObstacleOverlay& layer = layers[item];
+        finders[worker].FindPath(start, end, [&isBlocked, &layer](int r, int c) {
+            return isBlocked(r, c) || layer.Test(r, c);
+        }, outPaths[item]);
+    });
+    stats.rounds++;
+    stats.searches += layers.size();
+}
+
+template <typename BlockedFn>
+int ParallelPathPlanner::FindAlternatives(std::pair<int, int> start, std::pair<int, int> end, BlockedFn isBlocked,
+                                          const DiversePathOptions& options,
+                                          std::vector<std::vector<std::pair<int, int>>>& outPaths)
+{
+    outPaths.clear();
+    if (options.maxPaths <= 0) {
+        return 0;
+    }
+
+    candidates.resize(1);
+    stats.searches++;
+    if (!finders[0].FindPath(start, end, isBlocked, candidates[0])) {
+        return 0;
+    }
+    const unsigned long long duplicatesBefore = alternatives.GetDuplicates();
+    alternatives.Begin(start, end, options, candidates[0], outPaths);
+    for (int count = alternatives.BeginRound(outPaths); count > 0; count = alternatives.BeginRound(outPaths)) {
+        FindPaths(start, end, isBlocked, alternatives.GetLayers(), candidates);
+        alternatives.EndRound(candidates, count, outPaths);
+    }
+    stats.duplicates += alternatives.GetDuplicates() - duplicatesBefore;
+    return static_cast<int>(outPaths.size());
+}
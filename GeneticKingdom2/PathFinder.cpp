@@ -0,0 +1,207 @@
+// implementacion de las partes no-template del motor a*
+// la busqueda en si vive en el header porque recibe el predicado de bloqueo
+// como template, asi el compilador lo puede inlinear en el loop caliente
+
+#include "PathFinder.h"
+
+PathFinder::PathFinder()
+    : rows(0), cols(0), algorithm(PathAlgorithm::ASTAR), generation(0), costField(nullptr), costFieldScale(0.0f),
+      markGeneration(0), steppedStatus(SearchStatus::NOT_FOUND), steppedStart(-1), steppedEnd(-1), useLandmarks(false), landmarkCount(0), landmarkRevision(0), landmarkSource(nullptr),
+      landmarkSourceRevision(0)
+{
+}
+
+// dimensiona los arreglos planos. si el grid no cambio de tamaño no hace nada,
+// que es lo normal: el mapa se inicializa una vez y ya
+void PathFinder::Resize(int newRows, int newCols)
+{
+    if (newRows < 0) newRows = 0;
+    if (newCols < 0) newCols = 0;
+
+    size_t cellCount = static_cast<size_t>(newRows) * static_cast<size_t>(newCols);
+    if (cellCount > visitStamp.size()) {
+        visitStamp.assign(cellCount, 0);
+        closedStamp.assign(cellCount, 0);
+        gCost.resize(cellCount);
+        parent.resize(cellCount);
+        markStamp.assign(cellCount, 0);
+        generation = 0;
+        markGeneration = 0;
+        stats.scratchAllocations++;
+    }
+    if (openList.Reserve(cellCount)) {
+        stats.scratchAllocations++;
+    }
+
+    // las tablas alt son de un grid de otro tamaño
+    if (newRows != rows || newCols != cols) {
+        ClearLandmarks();
+    }
+
+    rows = newRows;
+    cols = newCols;
+}
+
+// copia lo que decide el resultado de una busqueda (algoritmo, tablas alt y
+// campo de costo) pero no el scratch ni los costos por celda, que son de una
+// sola consulta. las tablas se copian solo si son otras que las de la ultima
+// vez, asi se puede llamar en cada frame
+void PathFinder::CopySettingsFrom(const PathFinder& other)
+{
+    algorithm = other.algorithm;
+    useLandmarks = other.useLandmarks;
+    costField = other.costField;
+    costFieldScale = other.costFieldScale;
+    if (landmarkSource == &other && landmarkSourceRevision == other.landmarkRevision) {
+        return;
+    }
+    if (other.rows == rows && other.cols == cols && other.landmarkCount > 0) {
+        landmarkCount = other.landmarkCount;
+        landmarkCells = other.landmarkCells;
+        landmarkDist = other.landmarkDist;
+        landmarkRevision++;
+    } else {
+        ClearLandmarks();
+    }
+    landmarkSource = &other;
+    landmarkSourceRevision = other.landmarkRevision;
+}
+
+// en vez de limpiar los arreglos subimos el numero de generacion. cuando da la
+// vuelta (4 mil millones de busquedas despues, lol) si hay que limpiar de verdad
+void PathFinder::BeginSearch()
+{
+    openList.Clear();
+    generation++;
+    if (generation == 0) {
+        std::fill(visitStamp.begin(), visitStamp.end(), 0u);
+        std::fill(closedStamp.begin(), closedStamp.end(), 0u);
+        generation = 1;
+    }
+}
+
+// mete una entrada en la lista abierta, contando si tuvo que crecer
+void PathFinder::PushOpen(float fCost, int index)
+{
+    if (openList.Push(fCost, index)) {
+        stats.scratchAllocations++;
+    }
+}
+
+void PathFinder::StartAStar(int startIndex, int endIndex)
+{
+    Touch(startIndex);
+    gCost[startIndex] = 0.0f;
+    PushOpen(Estimate(startIndex, endIndex, endIndex / cols, endIndex % cols), startIndex);
+}
+
+void PathFinder::BeginSteppedPath(std::pair<int, int> start, std::pair<int, int> end,
+                                  std::vector<std::pair<int, int>>& outPath)
+{
+    outPath.clear();
+    stats.queries++;
+    steppedStatus = SearchStatus::NOT_FOUND;
+
+    if (start == end) {
+        outPath.push_back(start);
+        steppedStatus = SearchStatus::FOUND;
+        return;
+    }
+    if (start.first < 0 || start.first >= rows || start.second < 0 || start.second >= cols ||
+        end.first < 0 || end.first >= rows || end.second < 0 || end.second >= cols) {
+        return;
+    }
+
+    steppedStart = start.first * cols + start.second;
+    steppedEnd = end.first * cols + end.second;
+    BeginSearch();
+    StartAStar(steppedStart, steppedEnd);
+    steppedStatus = SearchStatus::RUNNING;
+}
+
+void PathFinder::CancelSteppedSearch()
+{
+    steppedStatus = SearchStatus::NOT_FOUND;
+}
+
+// sigue los padres desde el final hasta el inicio y voltea el resultado
+void PathFinder::Reconstruct(int startIndex, int endIndex, std::vector<std::pair<int, int>>& outPath) const
+{
+    outPath.clear();
+    size_t maxLength = static_cast<size_t>(rows) * static_cast<size_t>(cols) + 1;
+    int current = endIndex;
+    while (current != -1) {
+        outPath.push_back(std::make_pair(current / cols, current % cols));
+        if (current == startIndex) break;
+        current = parent[current];
+        if (outPath.size() > maxLength) { // por si acaso hay ciclos, que no deberia
+            outPath.clear();
+            return;
+        }
+    }
+    std::reverse(outPath.begin(), outPath.end());
+}
+
+// jps devuelve solo los puntos de salto; entre dos consecutivos el tramo es
+// recto o diagonal puro, asi que basta con caminar paso a paso hasta el otro
+void PathFinder::ExpandJumpPoints(std::vector<std::pair<int, int>>& outPath)
+{
+    outPath.clear();
+    outPath.push_back(jumpPoints[0]);
+    for (size_t i = 1; i < jumpPoints.size(); ++i) {
+        std::pair<int, int> cell = jumpPoints[i - 1];
+        const std::pair<int, int>& target = jumpPoints[i];
+        int dr = (target.first > cell.first) - (target.first < cell.first);
+        int dc = (target.second > cell.second) - (target.second < cell.second);
+        while (cell != target) {
+            cell.first += dr;
+            cell.second += dc;
+            outPath.push_back(cell);
+        }
+    }
+}
+
+float PathFinder::PathCost(const std::vector<std::pair<int, int>>& path)
+{
+    float cost = 0.0f;
+    for (size_t i = 1; i < path.size(); ++i) {
+        bool diagonal = path[i].first != path[i - 1].first && path[i].second != path[i - 1].second;
+        cost += diagonal ? PATH_DIAGONAL_COST : PATH_STRAIGHT_COST;
+    }
+    return cost;
+}
+
+// marca las celdas de b y cuenta cuantas de a caen ahi, sin sets ni sorts
+float PathFinder::PathOverlap(const std::vector<std::pair<int, int>>& a, const std::vector<std::pair<int, int>>& b)
+{
+    if (a.empty() || b.empty()) {
+        return 0.0f;
+    }
+    markGeneration++;
+    if (markGeneration == 0) {
+        std::fill(markStamp.begin(), markStamp.end(), 0u);
+        markGeneration = 1;
+    }
+    for (const auto& cell : b) {
+        markStamp[cell.first * cols + cell.second] = markGeneration;
+    }
+    size_t shared = 0;
+    for (const auto& cell : a) {
+        if (markStamp[cell.first * cols + cell.second] == markGeneration) shared++;
+    }
+    return static_cast<float>(shared) / static_cast<float>(a.size());
+}
+
+// fnv-1a sobre las coordenadas
+uint64_t PathFinder::PathHash(const std::vector<std::pair<int, int>>& path)
+{
+    uint64_t hash = 1469598103934665603ull;
+    for (const auto& cell : path) {
+        uint32_t packed = (static_cast<uint32_t>(cell.first) << 16) ^ static_cast<uint32_t>(cell.second);
+        for (int i = 0; i < 4; ++i) {
+            hash ^= (packed >> (i * 8)) & 0xFFu;
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
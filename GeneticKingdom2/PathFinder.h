@@ -0,0 +1,793 @@
+/*
+ * pathfinder.h - motor de busqueda a* reutilizable
+ *
+ * antes cada llamada a Map::GetPath creaba tres matrices de vectores (gCosts,
+ * parents, closedList) y una priority_queue nueva, o sea un monton de new/delete
+ * por cada busqueda. el GA llama GetPath un chorro de veces, asi que esto
+ * guarda todo el scratch en arreglos planos que se reutilizan entre consultas.
+ *
+ * el truco es el "generation stamp": en vez de limpiar los arreglos en cada
+ * busqueda, cada celda guarda en que busqueda fue tocada por ultima vez. si el
+ * stamp no coincide con la busqueda actual, la celda cuenta como virgen.
+ *
+ * no depende del mapa, recibe una funcion isBlocked(row, col) para saber que
+ * celdas no se pueden pisar. asi se puede usar con grids sinteticos en los
+ * benchmarks.
+ *
+ * tiene dos algoritmos con la misma interfaz:
+ * - ASTAR: el a* de toda la vida, celda por celda
+ * - JPS: jump point search. en un grid de costo uniforme hay un monton de
+ *   caminos simetricos del mismo largo y el a* los expande todos. jps solo
+ *   mete al heap los "puntos de salto" (donde aparece un vecino forzado por
+ *   un obstaculo) y corre en linea recta entre ellos. mismo largo de camino,
+ *   muchisimos menos nodos en el heap. el camino se devuelve celda por celda
+ *   igual que el a*, asi que para el que llama no cambia nada.
+ *
+ * aparte del algoritmo se puede prender la heuristica alt (landmarks): con las
+ * hileras de spots de construccion la euclidiana se queda muy corta y el a*
+ * inunda medio mapa antes de llegar al puente. ver BuildLandmarks.
+ *
+ * la lista abierta es un heap binario; compilando con PATHFINDER_USE_RADIX_HEAP
+ * pasa a ser un radix heap con decrease-key (ver OpenList.h).
+ */
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <cstdlib>
+#include <cfloat>
+#include <cstdint>
+#include <climits>
+#include "OpenList.h"
+
+// lista abierta de las busquedas, se elige al compilar
+#ifdef PATHFINDER_USE_RADIX_HEAP
+typedef RadixHeapOpenList PathOpenList;
+#else
+typedef BinaryHeapOpenList PathOpenList;
+#endif
+
+// costos de movimiento en la cuadricula de 8 direcciones
+const float PATH_STRAIGHT_COST = 1.0f;
+const float PATH_DIAGONAL_COST = 1.41421356237309504880f;
+
+// medio ancho (en celdas) del pasillo libre que SmoothPath garantiza alrededor
+// de cada tramo que junta. el jitter de los enemigos no se sale de ahi
+const float PATH_SMOOTH_CLEARANCE = 0.4f;
+
+// parametros para las rutas alternativas (ver AlternativeRoutes)
+struct DiversePathOptions {
+    int maxPaths = 4;            // cuantas rutas distintas queremos
+    int maxAttempts = 0;         // busquedas maximas (0 = 4 por ruta pedida)
+    float maxOverlap = 0.75f;    // fraccion maxima de celdas compartidas con una ruta ya aceptada
+    float maxStretch = 1.6f;     // una ruta no puede ser mas larga que esto por la optima
+    bool avoidThreat = false;    // el mapa suma la amenaza de las torres al costo de este pedido
+};
+
+// obstaculos extra de solo lectura para una consulta, un bit por celda. sirve
+// para pedir un camino "como si" hubiera mas obstaculos sin tocar el mapa, y
+// como nadie la modifica durante la busqueda se puede compartir entre hilos
+class ObstacleOverlay {
+public:
+    void Resize(int rows, int cols) {
+        this->cols = cols;
+        bits.assign((static_cast<size_t>(rows) * cols + 63) / 64, 0);
+    }
+    void Clear() { std::fill(bits.begin(), bits.end(), 0ull); }
+
+    void Set(int row, int col) {
+        size_t index = static_cast<size_t>(row) * cols + col;
+        bits[index >> 6] |= 1ull << (index & 63);
+    }
+    bool Test(int row, int col) const {
+        size_t index = static_cast<size_t>(row) * cols + col;
+        return (bits[index >> 6] >> (index & 63)) & 1ull;
+    }
+
+private:
+    int cols = 0;
+    std::vector<uint64_t> bits;
+};
+
+// algoritmo de busqueda que usa FindPath
+enum class PathAlgorithm {
+    ASTAR, // a* clasico
+    JPS    // jump point search, mismo resultado con menos expansiones
+};
+
+// estado de una busqueda por tramos
+enum class SearchStatus {
+    RUNNING,  // falta, hay que volver a llamar StepSearch
+    FOUND,
+    NOT_FOUND
+};
+
+class PathFinder {
+public:
+    // contadores para saber que tan caro esta saliendo el pathfinding
+    struct Stats {
+        unsigned long long queries = 0;           // busquedas realizadas
+        unsigned long long nodesExpanded = 0;     // nodos sacados de la lista abierta
+        unsigned long long scratchAllocations = 0; // veces que el scratch tuvo que crecer
+        unsigned long long cellsScanned = 0;      // celdas revisadas por los saltos de jps
+        unsigned long long landmarkBuilds = 0;    // veces que se recalcularon las tablas alt
+    };
+
+    PathFinder();
+
+    // dimensiona el scratch para un grid de rows x cols, solo reserva si crece
+    void Resize(int rows, int cols);
+
+    int GetRows() const { return rows; }
+    int GetCols() const { return cols; }
+
+    // misma configuracion que other (algoritmo, landmarks, campo de costo),
+    // para que otra instancia busque exactamente igual. el campo se comparte;
+    // las tablas alt solo se copian si cambiaron desde la ultima vez
+    void CopySettingsFrom(const PathFinder& other);
+
+    void SetAlgorithm(PathAlgorithm newAlgorithm) { algorithm = newAlgorithm; }
+    PathAlgorithm GetAlgorithm() const { return algorithm; }
+
+    // busca un camino de start a end. escribe el resultado en outPath (que se
+    // reutiliza, no se libera su capacidad) y devuelve false si no hay ruta.
+    template <typename BlockedFn>
+    bool FindPath(std::pair<int, int> start, std::pair<int, int> end, BlockedFn isBlocked,
+                  std::vector<std::pair<int, int>>& outPath);
+
+    /*
+     * busquedas por tramos, para no congelar un frame con un a* largo. Begin*
+     * arranca la busqueda y cada Step* expande a lo sumo maxExpansions nodos;
+     * devuelve RUNNING hasta que termina, y entonces el resultado queda en
+     * outPath (que tiene que ser el mismo en todas las llamadas). siempre a*,
+     * nunca jps. mientras haya una activa este PathFinder no se puede usar
+     * para nada mas: el scratch es suyo
+     */
+    void BeginSteppedPath(std::pair<int, int> start, std::pair<int, int> end, std::vector<std::pair<int, int>>& outPath);
+
+    template <typename BlockedFn>
+    SearchStatus StepSearch(int maxExpansions, BlockedFn isBlocked, std::vector<std::pair<int, int>>& outPath);
+
+    void CancelSteppedSearch();
+    bool IsSteppedSearchActive() const { return steppedStatus == SearchStatus::RUNNING; }
+
+    // costo extra denso, de un raster de rows * cols fila por fila que es del
+    // que llama (por ejemplo la amenaza de las torres): al entrar a una celda
+    // se suma scale * field[celda]. tiene que ser >= 0. nullptr lo apaga. con
+    // un campo puesto FindPath usa a* aunque este en jps
+    void SetCostField(const float* field, float scale) { costField = field; costFieldScale = scale; }
+    bool HasCostField() const { return costField != nullptr; }
+    const float* GetCostField() const { return costField; }
+    float GetCostFieldScale() const { return costFieldScale; }
+
+    // costo total de un camino celda por celda (1 recto, raiz de 2 diagonal)
+    static float PathCost(const std::vector<std::pair<int, int>>& path);
+
+    // fraccion de las celdas de "a" que tambien estan en "b"
+    float PathOverlap(const std::vector<std::pair<int, int>>& a, const std::vector<std::pair<int, int>>& b);
+
+    // hash barato de un camino para detectar duplicados sin comparar vectores
+    static uint64_t PathHash(const std::vector<std::pair<int, int>>& path);
+
+    // true si se puede ir en linea recta del centro de "from" al centro de "to"
+    // sin pisar celdas bloqueadas. "from" no se revisa (es donde ya estamos) y
+    // pasar justo por una esquina cuenta como un paso diagonal, igual que en el a*
+    template <typename BlockedFn>
+    bool LineOfSight(std::pair<int, int> from, std::pair<int, int> to, BlockedFn isBlocked) const;
+
+    // como LineOfSight pero con ancho: true si ninguna celda que toque la
+    // franja de medio ancho halfWidth (en celdas, < 0.5) alrededor del tramo
+    // de centro a centro esta bloqueada. las esquinas exactas cuentan como
+    // bloqueadas si alguna de las dos vecinas lo esta
+    template <typename BlockedFn>
+    bool CorridorClear(std::pair<int, int> from, std::pair<int, int> to, float halfWidth, BlockedFn isBlocked) const;
+
+    /*
+     * string pulling: junta los tramos rectos de un camino celda por celda en
+     * unos pocos waypoints. desde cada waypoint se avanza por el camino
+     * mientras el pasillo de PATH_SMOOTH_CLEARANCE este libre (CorridorClear)
+     * y se pone el siguiente en la ultima celda visible. el primero y el
+     * ultimo se conservan. los tramos entre celdas vecinas son los del camino
+     * original y no se revisan. los waypoints ya no son vecinos, asi que
+     * PathCost no sirve para el resultado
+     */
+    template <typename BlockedFn>
+    void SmoothPath(const std::vector<std::pair<int, int>>& path, BlockedFn isBlocked,
+                    std::vector<std::pair<int, int>>& outWaypoints) const;
+
+    /*
+     * heuristica alt (a*, landmarks, desigualdad triangular). se eligen count
+     * celdas "landmark" lo mas alejadas posible entre si (la primera es la mas
+     * lejana a seed) y se guarda la distancia real de cada una a todo el grid.
+     * para cualquier celda n y objetivo g, |d(L,g) - d(L,n)| nunca pasa del
+     * costo real de n a g, asi que el maximo sobre los landmarks es una cota
+     * admisible y mucho mas ajustada que la linea recta cuando hay paredes.
+     * las tablas son una foto del grid: si cambia la transitabilidad hay que
+     * volver a llamar esto. los costos extra solo encarecen, asi que no la rompen
+     */
+    template <typename BlockedFn>
+    void BuildLandmarks(int count, std::pair<int, int> seed, BlockedFn isBlocked);
+    void ClearLandmarks() { landmarkCount = 0; landmarkCells.clear(); landmarkRevision++; landmarkSource = nullptr; }
+    bool HasLandmarks() const { return landmarkCount > 0; }
+    const std::vector<int>& GetLandmarks() const { return landmarkCells; }
+
+    // usar las tablas alt (si estan armadas) ademas de la euclidiana
+    void SetUseLandmarks(bool use) { useLandmarks = use; }
+    bool GetUseLandmarks() const { return useLandmarks; }
+
+    const Stats& GetStats() const { return stats; }
+    void ResetStats() { stats = Stats(); }
+
+    // heuristica euclidiana, la misma que usaba el a* original
+    static float Heuristic(int r1, int c1, int r2, int c2) {
+        float dr = static_cast<float>(r1 - r2);
+        float dc = static_cast<float>(c1 - c2);
+        return std::sqrt(dr * dr + dc * dc);
+    }
+
+private:
+    // empieza una busqueda nueva, invalidando todo el scratch de golpe
+    void BeginSearch();
+
+    // marca la celda como tocada en esta busqueda si no lo estaba
+    void Touch(int index) {
+        if (visitStamp[index] != generation) {
+            visitStamp[index] = generation;
+            gCost[index] = FLT_MAX;
+            parent[index] = -1;
+        }
+    }
+
+    // heuristica que usa la busqueda: euclidiana, o el maximo entre esa y la
+    // cota de los landmarks si estan prendidos
+    float Estimate(int index, int endIndex, int endRow, int endCol) const {
+        int r = index / cols;
+        float h = Heuristic(r, index - r * cols, endRow, endCol);
+        if (useLandmarks && landmarkCount > 0) {
+            const float* fromTable = &landmarkDist[static_cast<size_t>(index) * landmarkCount];
+            const float* goalTable = &landmarkDist[static_cast<size_t>(endIndex) * landmarkCount];
+            for (int i = 0; i < landmarkCount; ++i) {
+                if (fromTable[i] == FLT_MAX || goalTable[i] == FLT_MAX) continue; // otro pedazo del mapa
+                float bound = std::fabs(goalTable[i] - fromTable[i]);
+                if (bound > h) h = bound;
+            }
+        }
+        return h;
+    }
+
+    // dijkstra desde source sin costos extra, deja las distancias en out
+    template <typename BlockedFn>
+    void DistancesFrom(int source, BlockedFn& isBlocked, std::vector<float>& out);
+
+    void PushOpen(float fCost, int index);
+    void Reconstruct(int startIndex, int endIndex, std::vector<std::pair<int, int>>& outPath) const;
+
+    template <typename BlockedFn>
+    bool FindPathAStar(int startIndex, int endIndex, BlockedFn& isBlocked, std::vector<std::pair<int, int>>& outPath);
+
+    // deja el inicio en la lista abierta de una busqueda nueva
+    void StartAStar(int startIndex, int endIndex);
+
+    // el loop del a*: expande hasta terminar o hasta gastar budget nodos (lo
+    // que gasta se le descuenta)
+    template <typename BlockedFn>
+    SearchStatus ExpandAStar(int& budget, int startIndex, int endIndex, BlockedFn& isBlocked,
+                             std::vector<std::pair<int, int>>& outPath);
+
+    template <typename BlockedFn>
+    bool FindPathJPS(int startIndex, int endIndex, BlockedFn& isBlocked, std::vector<std::pair<int, int>>& outPath);
+
+    // corre en linea recta (dr, dc) desde (r, c) hasta encontrar un punto de
+    // salto, el objetivo o una pared. devuelve el indice o -1
+    template <typename BlockedFn>
+    int Jump(int r, int c, int dr, int dc, int endIndex, BlockedFn& isBlocked);
+
+    template <typename BlockedFn>
+    bool Walkable(int r, int c, BlockedFn& isBlocked) const {
+        return r >= 0 && r < rows && c >= 0 && c < cols && !isBlocked(r, c);
+    }
+
+    // rellena las celdas intermedias entre puntos de salto consecutivos
+    void ExpandJumpPoints(std::vector<std::pair<int, int>>& outPath);
+
+    int rows;
+    int cols;
+    PathAlgorithm algorithm;
+    uint32_t generation;                 // id de la busqueda actual
+    std::vector<uint32_t> visitStamp;    // busqueda en la que se toco cada celda
+    std::vector<uint32_t> closedStamp;   // busqueda en la que se cerro cada celda
+    std::vector<float> gCost;            // costo desde el inicio (valido si visitStamp == generation)
+    std::vector<int> parent;             // indice del padre para reconstruir el camino
+    PathOpenList openList;               // heap binario o radix heap, reservado de antemano
+    std::vector<std::pair<int, int>> jumpPoints; // scratch para el camino de jps antes de rellenarlo
+    const float* costField;              // costo extra denso de SetCostField (no es nuestro)
+    float costFieldScale;
+    std::vector<uint32_t> markStamp;     // scratch para contar celdas compartidas entre caminos
+    uint32_t markGeneration;
+    SearchStatus steppedStatus;          // busqueda por tramos (NOT_FOUND si no hay ninguna)
+    int steppedStart;
+    int steppedEnd;
+    bool useLandmarks;
+    int landmarkCount;
+    std::vector<int> landmarkCells;
+    std::vector<float> landmarkDist;     // celda por celda: landmarkCount distancias seguidas
+    std::vector<float> landmarkScratch;  // distancias de un solo dijkstra
+    uint32_t landmarkRevision;           // sube cada vez que cambian las tablas
+    const PathFinder* landmarkSource;    // de quien se copiaron (CopySettingsFrom) y en que revision
+    uint32_t landmarkSourceRevision;
+    Stats stats;
+};
+
+template <typename BlockedFn>
+bool PathFinder::FindPath(std::pair<int, int> start, std::pair<int, int> end, BlockedFn isBlocked,
+                          std::vector<std::pair<int, int>>& outPath)
+{
+    outPath.clear();
+    stats.queries++;
+
+    if (start == end) {
+        outPath.push_back(start);
+        return true;
+    }
+    if (start.first < 0 || start.first >= rows || start.second < 0 || start.second >= cols ||
+        end.first < 0 || end.first >= rows || end.second < 0 || end.second >= cols) {
+        return false;
+    }
+
+    BeginSearch();
+
+    const int startIndex = start.first * cols + start.second;
+    const int endIndex = end.first * cols + end.second;
+
+    // jps asume costo uniforme, con costo extra solo vale el a*
+    if (algorithm == PathAlgorithm::JPS && !costField) {
+        return FindPathJPS(startIndex, endIndex, isBlocked, outPath);
+    }
+    return FindPathAStar(startIndex, endIndex, isBlocked, outPath);
+}
+
+template <typename BlockedFn>
+bool PathFinder::FindPathAStar(int startIndex, int endIndex, BlockedFn& isBlocked,
+                               std::vector<std::pair<int, int>>& outPath)
+{
+    int budget = INT_MAX;
+    StartAStar(startIndex, endIndex);
+    return ExpandAStar(budget, startIndex, endIndex, isBlocked, outPath) == SearchStatus::FOUND;
+}
+
+template <typename BlockedFn>
+SearchStatus PathFinder::ExpandAStar(int& budget, int startIndex, int endIndex, BlockedFn& isBlocked,
+                                     std::vector<std::pair<int, int>>& outPath)
+{
+    const int endRow = endIndex / cols;
+    const int endCol = endIndex % cols;
+
+    // movimientos en 8 direcciones, en el mismo orden que el a* original
+    static const int dr[] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+    static const int dc[] = { 0, 0, -1, 1, -1, 1, -1, 1 };
+    static const float moveCost[] = {
+        PATH_STRAIGHT_COST, PATH_STRAIGHT_COST, PATH_STRAIGHT_COST, PATH_STRAIGHT_COST,
+        PATH_DIAGONAL_COST, PATH_DIAGONAL_COST, PATH_DIAGONAL_COST, PATH_DIAGONAL_COST
+    };
+
+    while (!openList.Empty()) {
+        if (budget <= 0) {
+            return SearchStatus::RUNNING;
+        }
+        int current = openList.Pop().index;
+
+        if (closedStamp[current] == generation) {
+            continue; // entrada vieja, ya cerramos esta celda
+        }
+        closedStamp[current] = generation;
+        stats.nodesExpanded++;
+        budget--;
+
+        if (current == endIndex) {
+            Reconstruct(startIndex, endIndex, outPath);
+            return outPath.empty() ? SearchStatus::NOT_FOUND : SearchStatus::FOUND;
+        }
+
+        int r = current / cols;
+        int c = current - r * cols;
+        float currentG = gCost[current];
+        const float* field = costField;
+
+        for (int i = 0; i < 8; ++i) {
+            int nextR = r + dr[i];
+            int nextC = c + dc[i];
+            if (nextR < 0 || nextR >= rows || nextC < 0 || nextC >= cols) {
+                continue;
+            }
+
+            int next = nextR * cols + nextC;
+            if (closedStamp[next] == generation || isBlocked(nextR, nextC)) {
+                continue;
+            }
+
+            Touch(next);
+            float tentativeG = currentG + moveCost[i];
+            if (field) {
+                tentativeG += costFieldScale * field[next];
+            }
+            if (tentativeG < gCost[next]) {
+                gCost[next] = tentativeG;
+                parent[next] = current;
+                PushOpen(tentativeG + Estimate(next, endIndex, endRow, endCol), next);
+            }
+        }
+    }
+
+    outPath.clear();
+    return SearchStatus::NOT_FOUND; // no hay camino
+}
+
+template <typename BlockedFn>
+int PathFinder::Jump(int r, int c, int dr, int dc, int endIndex, BlockedFn& isBlocked)
+{
+    while (true) {
+        r += dr;
+        c += dc;
+        if (!Walkable(r, c, isBlocked)) {
+            return -1;
+        }
+        stats.cellsScanned++;
+
+        int index = r * cols + c;
+        if (index == endIndex) {
+            return index;
+        }
+
+        if (dr != 0 && dc != 0) {
+            // diagonal: vecino forzado si hay pared detras de nosotros en algun eje
+            if ((!Walkable(r, c - dc, isBlocked) && Walkable(r + dr, c - dc, isBlocked)) ||
+                (!Walkable(r - dr, c, isBlocked) && Walkable(r - dr, c + dc, isBlocked))) {
+                return index;
+            }
+            // y si las rectas que salen de aqui encuentran algo, esta celda es punto de salto
+            if (Jump(r, c, dr, 0, endIndex, isBlocked) != -1 ||
+                Jump(r, c, 0, dc, endIndex, isBlocked) != -1) {
+                return index;
+            }
+        } else if (dc != 0) {
+            // horizontal: pared arriba o abajo que se acaba
+            if ((!Walkable(r - 1, c, isBlocked) && Walkable(r - 1, c + dc, isBlocked)) ||
+                (!Walkable(r + 1, c, isBlocked) && Walkable(r + 1, c + dc, isBlocked))) {
+                return index;
+            }
+        } else {
+            // vertical: pared a la izquierda o derecha que se acaba
+            if ((!Walkable(r, c - 1, isBlocked) && Walkable(r + dr, c - 1, isBlocked)) ||
+                (!Walkable(r, c + 1, isBlocked) && Walkable(r + dr, c + 1, isBlocked))) {
+                return index;
+            }
+        }
+    }
+}
+
+/*
+ * jps (harabor y grastien 2011), con la misma regla de movimiento que el a*:
+ * diagonales permitidas aunque las dos ortogonales esten bloqueadas. cada nodo
+ * solo mira los vecinos "naturales" segun la direccion en la que llegamos mas
+ * los forzados por obstaculos, y desde cada uno salta hasta el siguiente
+ * punto interesante. los tramos entre puntos de salto son rectos o diagonales
+ * puros, asi que su costo es facil de calcular y rellenarlos es trivial.
+ */
+template <typename BlockedFn>
+bool PathFinder::FindPathJPS(int startIndex, int endIndex, BlockedFn& isBlocked,
+                             std::vector<std::pair<int, int>>& outPath)
+{
+    const int endRow = endIndex / cols;
+    const int endCol = endIndex % cols;
+
+    Touch(startIndex);
+    gCost[startIndex] = 0.0f;
+    PushOpen(Estimate(startIndex, endIndex, endRow, endCol), startIndex);
+
+    int dirs[8][2];
+    while (!openList.Empty()) {
+        int current = openList.Pop().index;
+
+        if (closedStamp[current] == generation) {
+            continue;
+        }
+        closedStamp[current] = generation;
+        stats.nodesExpanded++;
+
+        if (current == endIndex) {
+            Reconstruct(startIndex, endIndex, jumpPoints);
+            outPath.clear();
+            if (jumpPoints.empty()) {
+                return false;
+            }
+            ExpandJumpPoints(outPath);
+            return true;
+        }
+
+        int r = current / cols;
+        int c = current - r * cols;
+        float currentG = gCost[current];
+
+        // direcciones a explorar, podadas segun de donde venimos
+        int dirCount = 0;
+        int from = parent[current];
+        if (from == -1) {
+            for (int dr = -1; dr <= 1; ++dr) {
+                for (int dc = -1; dc <= 1; ++dc) {
+                    if (dr == 0 && dc == 0) continue;
+                    dirs[dirCount][0] = dr; dirs[dirCount][1] = dc; dirCount++;
+                }
+            }
+        } else {
+            int pr = from / cols;
+            int pc = from - pr * cols;
+            int dr = (r > pr) - (r < pr);
+            int dc = (c > pc) - (c < pc);
+
+            if (dr != 0 && dc != 0) {
+                dirs[dirCount][0] = 0;  dirs[dirCount][1] = dc; dirCount++;
+                dirs[dirCount][0] = dr; dirs[dirCount][1] = 0;  dirCount++;
+                dirs[dirCount][0] = dr; dirs[dirCount][1] = dc; dirCount++;
+                if (!Walkable(r, c - dc, isBlocked)) { dirs[dirCount][0] = dr;  dirs[dirCount][1] = -dc; dirCount++; }
+                if (!Walkable(r - dr, c, isBlocked)) { dirs[dirCount][0] = -dr; dirs[dirCount][1] = dc;  dirCount++; }
+            } else if (dc != 0) {
+                dirs[dirCount][0] = 0; dirs[dirCount][1] = dc; dirCount++;
+                if (!Walkable(r - 1, c, isBlocked)) { dirs[dirCount][0] = -1; dirs[dirCount][1] = dc; dirCount++; }
+                if (!Walkable(r + 1, c, isBlocked)) { dirs[dirCount][0] = 1;  dirs[dirCount][1] = dc; dirCount++; }
+            } else {
+                dirs[dirCount][0] = dr; dirs[dirCount][1] = 0; dirCount++;
+                if (!Walkable(r, c - 1, isBlocked)) { dirs[dirCount][0] = dr; dirs[dirCount][1] = -1; dirCount++; }
+                if (!Walkable(r, c + 1, isBlocked)) { dirs[dirCount][0] = dr; dirs[dirCount][1] = 1;  dirCount++; }
+            }
+        }
+
+        for (int i = 0; i < dirCount; ++i) {
+            int jumpIndex = Jump(r, c, dirs[i][0], dirs[i][1], endIndex, isBlocked);
+            if (jumpIndex == -1 || closedStamp[jumpIndex] == generation) {
+                continue;
+            }
+
+            int jr = jumpIndex / cols;
+            int jc = jumpIndex - jr * cols;
+            int steps = std::abs(jr - r) > std::abs(jc - c) ? std::abs(jr - r) : std::abs(jc - c);
+            float stepCost = (jr != r && jc != c) ? PATH_DIAGONAL_COST : PATH_STRAIGHT_COST;
+
+            Touch(jumpIndex);
+            float tentativeG = currentG + stepCost * static_cast<float>(steps);
+            if (tentativeG < gCost[jumpIndex]) {
+                gCost[jumpIndex] = tentativeG;
+                parent[jumpIndex] = current;
+                PushOpen(tentativeG + Estimate(jumpIndex, endIndex, endRow, endCol), jumpIndex);
+            }
+        }
+    }
+
+    return false;
+}
+
+template <typename BlockedFn>
+SearchStatus PathFinder::StepSearch(int maxExpansions, BlockedFn isBlocked, std::vector<std::pair<int, int>>& outPath)
+{
+    if (steppedStatus != SearchStatus::RUNNING) {
+        return steppedStatus;
+    }
+    steppedStatus = ExpandAStar(maxExpansions, steppedStart, steppedEnd, isBlocked, outPath);
+    return steppedStatus;
+}
+
+template <typename BlockedFn>
+void PathFinder::DistancesFrom(int source, BlockedFn& isBlocked, std::vector<float>& out)
+{
+    static const int dr[] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+    static const int dc[] = { 0, 0, -1, 1, -1, 1, -1, 1 };
+    static const float moveCost[] = {
+        PATH_STRAIGHT_COST, PATH_STRAIGHT_COST, PATH_STRAIGHT_COST, PATH_STRAIGHT_COST,
+        PATH_DIAGONAL_COST, PATH_DIAGONAL_COST, PATH_DIAGONAL_COST, PATH_DIAGONAL_COST
+    };
+
+    std::fill(out.begin(), out.end(), FLT_MAX);
+    openList.Clear();
+    out[source] = 0.0f;
+    PushOpen(0.0f, source);
+
+    while (!openList.Empty()) {
+        OpenEntry current = openList.Pop();
+        if (current.fCost > out[current.index]) {
+            continue;
+        }
+
+        int r = current.index / cols;
+        int c = current.index - r * cols;
+        for (int i = 0; i < 8; ++i) {
+            int nr = r + dr[i];
+            int nc = c + dc[i];
+            if (nr < 0 || nr >= rows || nc < 0 || nc >= cols || isBlocked(nr, nc)) continue;
+            int next = nr * cols + nc;
+            float candidate = current.fCost + moveCost[i];
+            if (candidate < out[next]) {
+                out[next] = candidate;
+                PushOpen(candidate, next);
+            }
+        }
+    }
+}
+
+// seleccion "farthest": cada landmark nuevo es la celda alcanzable que queda
+// mas lejos del landmark mas cercano ya elegido. asi quedan repartidos por las
+// orillas del mapa, que es donde dan las mejores cotas
+template <typename BlockedFn>
+void PathFinder::BuildLandmarks(int count, std::pair<int, int> seed, BlockedFn isBlocked)
+{
+    ClearLandmarks();
+    size_t cellCount = static_cast<size_t>(rows) * static_cast<size_t>(cols);
+    if (count <= 0 || cellCount == 0 ||
+        seed.first < 0 || seed.first >= rows || seed.second < 0 || seed.second >= cols) {
+        return;
+    }
+
+    landmarkScratch.resize(cellCount);
+    landmarkDist.assign(cellCount * count, FLT_MAX);
+    std::vector<float> nearest(cellCount, FLT_MAX); // distancia al landmark mas cercano
+
+    DistancesFrom(seed.first * cols + seed.second, isBlocked, landmarkScratch);
+    std::vector<float>* ranking = &landmarkScratch;
+    for (int l = 0; l < count; ++l) {
+        int farthest = -1;
+        float farthestDistance = 0.0f;
+        for (size_t i = 0; i < cellCount; ++i) {
+            float d = (*ranking)[i];
+            if (d != FLT_MAX && d > farthestDistance) {
+                farthestDistance = d;
+                farthest = static_cast<int>(i);
+            }
+        }
+        if (farthest == -1) {
+            break; // todo lo alcanzable ya es landmark
+        }
+
+        landmarkCells.push_back(farthest);
+        DistancesFrom(farthest, isBlocked, landmarkScratch);
+        for (size_t i = 0; i < cellCount; ++i) {
+            float d = landmarkScratch[i];
+            landmarkDist[i * count + l] = d;
+            if (d < nearest[i]) nearest[i] = d;
+        }
+        ranking = &nearest;
+    }
+
+    // si hubo menos landmarks que los pedidos, compactamos la tabla
+    int built = static_cast<int>(landmarkCells.size());
+    if (built < count) {
+        for (size_t i = 0; i < cellCount; ++i) {
+            for (int l = 0; l < built; ++l) {
+                landmarkDist[i * built + l] = landmarkDist[i * count + l];
+            }
+        }
+        landmarkDist.resize(cellCount * built);
+    }
+    landmarkCount = built;
+    landmarkRevision++;
+    landmarkSource = nullptr;
+    stats.landmarkBuilds++;
+}
+
+// recorrido de celdas de centro a centro (supercover). cuando la linea pasa
+// exacto por una esquina se salta directo a la diagonal
+template <typename BlockedFn>
+bool PathFinder::LineOfSight(std::pair<int, int> from, std::pair<int, int> to, BlockedFn isBlocked) const
+{
+    int r = from.first;
+    int c = from.second;
+    int dr = std::abs(to.first - from.first);
+    int dc = std::abs(to.second - from.second);
+    int stepR = to.first > from.first ? 1 : -1;
+    int stepC = to.second > from.second ? 1 : -1;
+    int error = dc - dr;
+    dr *= 2;
+    dc *= 2;
+
+    while (r != to.first || c != to.second) {
+        if (error > 0) {
+            c += stepC;
+            error -= dr;
+        } else if (error < 0) {
+            r += stepR;
+            error += dc;
+        } else {
+            r += stepR;
+            c += stepC;
+            error += dc - dr;
+        }
+        if (r < 0 || r >= rows || c < 0 || c >= cols || isBlocked(r, c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// la franja es convexa y mide menos de una celda de ancho, asi que toda celda
+// que la toca la cruza alguno de sus dos bordes: basta con recorrer los dos
+// bordes (amanatides-woo). las tapas quedan dentro de las celdas de los extremos
+template <typename BlockedFn>
+bool PathFinder::CorridorClear(std::pair<int, int> from, std::pair<int, int> to, float halfWidth, BlockedFn isBlocked) const
+{
+    if (halfWidth <= 0.0f) {
+        return LineOfSight(from, to, isBlocked);
+    }
+    const float dx = static_cast<float>(to.second - from.second);
+    const float dy = static_cast<float>(to.first - from.first);
+    const float length = std::sqrt(dx * dx + dy * dy);
+    if (length == 0.0f) {
+        return true;
+    }
+    const float nx = -dy / length * halfWidth;
+    const float ny = dx / length * halfWidth;
+    const float stepX = dx > 0.0f ? 1.0f : -1.0f;
+    const float stepY = dy > 0.0f ? 1.0f : -1.0f;
+    const float tDeltaX = dx != 0.0f ? 1.0f / std::fabs(dx) : FLT_MAX;
+    const float tDeltaY = dy != 0.0f ? 1.0f / std::fabs(dy) : FLT_MAX;
+    const float cornerEpsilon = 1e-5f;
+
+    auto blocked = [&](int r, int c) {
+        return r < 0 || r >= rows || c < 0 || c >= cols || isBlocked(r, c);
+    };
+
+    for (int side = -1; side <= 1; side += 2) {
+        // borde de la franja, en coordenadas de celda (la celda c va de c a c+1)
+        const float x0 = from.second + 0.5f + side * nx;
+        const float y0 = from.first + 0.5f + side * ny;
+        int c = static_cast<int>(std::floor(x0));
+        int r = static_cast<int>(std::floor(y0));
+        float tMaxX = dx > 0.0f ? (c + 1 - x0) * tDeltaX : dx < 0.0f ? (x0 - c) * tDeltaX : FLT_MAX;
+        float tMaxY = dy > 0.0f ? (r + 1 - y0) * tDeltaY : dy < 0.0f ? (y0 - r) * tDeltaY : FLT_MAX;
+        const int stepC = static_cast<int>(stepX);
+        const int stepR = static_cast<int>(stepY);
+
+        while ((std::min)(tMaxX, tMaxY) < 1.0f) {
+            if (std::fabs(tMaxX - tMaxY) <= cornerEpsilon) {
+                if (blocked(r, c + stepC) || blocked(r + stepR, c)) {
+                    return false;
+                }
+                c += stepC;
+                r += stepR;
+                tMaxX += tDeltaX;
+                tMaxY += tDeltaY;
+            } else if (tMaxX < tMaxY) {
+                c += stepC;
+                tMaxX += tDeltaX;
+            } else {
+                r += stepR;
+                tMaxY += tDeltaY;
+            }
+            if (blocked(r, c)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <typename BlockedFn>
+void PathFinder::SmoothPath(const std::vector<std::pair<int, int>>& path, BlockedFn isBlocked,
+                            std::vector<std::pair<int, int>>& outWaypoints) const
+{
+    outWaypoints.clear();
+    if (path.size() <= 2) {
+        outWaypoints.assign(path.begin(), path.end());
+        return;
+    }
+
+    size_t anchor = 0;
+    outWaypoints.push_back(path[0]);
+    for (size_t i = 2; i < path.size(); ++i) {
+        if (!CorridorClear(path[anchor], path[i], PATH_SMOOTH_CLEARANCE, isBlocked)) {
+            anchor = i - 1;
+            outWaypoints.push_back(path[anchor]);
+        }
+    }
+    outWaypoints.push_back(path.back());
+}
@@ -0,0 +1,171 @@
+// cola de busquedas por tramos
+// el loop de Process vive en el header porque recibe el predicado de bloqueo
+
+#include "PathRequestQueue.h"
+
+void PathRequestQueue::Resize(int rows, int cols)
+{
+    if (rows == finder.GetRows() && cols == finder.GetCols()) {
+        return;
+    }
+    // una busqueda a medias sobre otro grid no sirve, se arranca de nuevo
+    CancelActive();
+    finder.Resize(rows, cols);
+    layerFinders.resize(AlternativeRoutes::LAYERS_PER_ROUND);
+    for (PathFinder& layerFinder : layerFinders) {
+        layerFinder.Resize(rows, cols);
+    }
+    alternatives.Resize(rows, cols);
+}
+
+void PathRequestQueue::Configure(const PathFinder& reference)
+{
+    finder.CopySettingsFrom(reference);
+    for (PathFinder& layerFinder : layerFinders) {
+        layerFinder.CopySettingsFrom(reference);
+    }
+    baseField = reference.GetCostField();
+    baseFieldScale = reference.GetCostFieldScale();
+}
+
+void PathRequestQueue::ApplyCostField(const PathRequest& request)
+{
+    const bool threat = request.options.avoidThreat && threatField;
+    const float* field = threat ? threatField : baseField;
+    const float scale = threat ? threatFieldScale : baseFieldScale;
+    finder.SetCostField(field, scale);
+    for (PathFinder& layerFinder : layerFinders) {
+        layerFinder.SetCostField(field, scale);
+    }
+}
+
+unsigned long long PathRequestQueue::CountExpanded() const
+{
+    unsigned long long total = finder.GetStats().nodesExpanded;
+    for (const PathFinder& layerFinder : layerFinders) {
+        total += layerFinder.GetStats().nodesExpanded;
+    }
+    return total;
+}
+
+PathRequestHandle PathRequestQueue::Enqueue(std::pair<int, int> start, std::pair<int, int> end, PathRequestCallback callback)
+{
+    PathRequestHandle request = std::make_shared<PathRequest>();
+    request->id = ++nextId;
+    request->start = start;
+    request->end = end;
+    request->callback = std::move(callback);
+    pending.push_back(request);
+    return request;
+}
+
+PathRequestHandle PathRequestQueue::EnqueueAlternatives(std::pair<int, int> start, std::pair<int, int> end,
+                                                        const DiversePathOptions& options, PathRequestCallback callback)
+{
+    PathRequestHandle request = Enqueue(start, end, std::move(callback));
+    request->diverse = true;
+    request->options = options;
+    return request;
+}
+
+PathRequestHandle PathRequestQueue::MakeCompleted(std::pair<int, int> start, std::pair<int, int> end, bool diverse,
+                                                  const std::vector<std::vector<std::pair<int, int>>>& paths,
+                                                  uint64_t version, PathRequestCallback callback)
+{
+    PathRequestHandle request = std::make_shared<PathRequest>();
+    request->start = start;
+    request->end = end;
+    request->diverse = diverse;
+    request->paths = paths;
+    request->version = version;
+    request->done = true;
+    if (callback) {
+        callback(*request);
+    }
+    return request;
+}
+
+void PathRequestQueue::BeginActive(PathRequest& request)
+{
+    if (request.diverse) {
+        // primero la optima con finder; StepAlternatives sigue con las capas
+        request.paths.clear();
+        inLayers = false;
+        layerCount = 0;
+        layersRunning = 0;
+        layerPaths.resize(1);
+        if (request.options.maxPaths > 0) {
+            finder.BeginSteppedPath(request.start, request.end, layerPaths[0]);
+        } else {
+            finder.CancelSteppedSearch(); // no se pidio nada: termina sin rutas
+        }
+    } else {
+        request.paths.resize(1);
+        finder.BeginSteppedPath(request.start, request.end, request.paths[0]);
+    }
+    active = true;
+}
+
+bool PathRequestQueue::BeginLayers(PathRequest& request)
+{
+    layerCount = alternatives.BeginRound(request.paths);
+    if (layerCount == 0) {
+        return false;
+    }
+    // los caminos se dimensionan antes de arrancar: cada finder guarda el suyo
+    layerPaths.resize(layerCount);
+    layerStatus.assign(layerCount, SearchStatus::RUNNING);
+    for (int i = 0; i < layerCount; ++i) {
+        layerFinders[i].BeginSteppedPath(request.start, request.end, layerPaths[i]);
+    }
+    layersRunning = layerCount;
+    return true;
+}
+
+void PathRequestQueue::CancelActive()
+{
+    finder.CancelSteppedSearch();
+    for (PathFinder& layerFinder : layerFinders) {
+        layerFinder.CancelSteppedSearch();
+    }
+    active = false;
+}
+
+void PathRequestQueue::CancelAll()
+{
+    for (const PathRequestHandle& request : pending) {
+        request->Cancel();
+    }
+    DropCancelled();
+}
+
+void PathRequestQueue::Finish(bool found)
+{
+    // se saca antes del callback por si el callback pide otra ruta
+    PathRequestHandle request = pending.front();
+    pending.pop_front();
+    active = false;
+
+    if (!found) {
+        request->paths.clear();
+    }
+    request->done = true;
+    stats.completed++;
+    if (request->callback) {
+        PathRequestCallback callback = std::move(request->callback);
+        request->callback = nullptr; // lo que capture el callback no tiene por que vivir tanto como el handle
+        callback(*request);
+    }
+}
+
+void PathRequestQueue::DropCancelled()
+{
+    while (!pending.empty() && pending.front()->cancelled) {
+        if (active) {
+            CancelActive();
+        }
+        pending.front()->callback = nullptr;
+        pending.pop_front();
+        stats.cancelled++;
+    }
+}
@@ -0,0 +1,324 @@
+/*
+ * pathrequestqueue.h - busquedas de caminos repartidas entre frames
+ *
+ * un a* sobre un mapa grande puede tardar mas que un frame entero. aca los
+ * pedidos entran a una cola y Process avanza el primero de a tandas de nodos
+ * hasta gastar el presupuesto de microsegundos del frame; lo que falta sigue
+ * en el proximo. el tamaño de cada tanda sale de lo que vienen costando las
+ * expansiones, para que la ultima no se pase. si igual se pasa queda contado
+ * en las stats (slicesOverBudget, maxSliceMicroseconds).
+ *
+ * cada pedido devuelve un handle compartido que sirve de "future" (IsDone,
+ * Found, GetPaths, Cancel) y ademas puede llevar un callback que se llama
+ * desde Process cuando termina. si la transitabilidad cambia a mitad de una
+ * busqueda (otra version) se vuelve a empezar, para no devolver rutas que
+ * atraviesan una torre recien puesta.
+ *
+ * las rutas alternativas (EnqueueAlternatives) usan el mismo
+ * AlternativeRoutes que ParallelPathPlanner, asi que salen las mismas rutas
+ * que en GetAlternativePathsParallel. las capas de cada tanda avanzan juntas,
+ * cada una con su PathFinder; con SetWorkerPool cada tramo las reparte entre
+ * los hilos del pool, sin pool van una tras otra en el mismo tramo.
+ *
+ * usa sus propios PathFinder, asi que no se pisa con el del mapa (Configure
+ * les copia la configuracion). fuera de las capas todo corre en el hilo que
+ * llama a Process, y Process vuelve recien cuando los workers terminaron.
+ */
+
+#pragma once
+
+#include "PathFinder.h"
+#include "ParallelPathPlanner.h"
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <utility>
+#include <chrono>
+#include <cstdint>
+
+class PathRequest;
+typedef std::shared_ptr<PathRequest> PathRequestHandle;
+typedef std::function<void(const PathRequest&)> PathRequestCallback;
+
+class PathRequest {
+public:
+    bool IsDone() const { return done; }
+    bool IsCancelled() const { return cancelled; }
+    bool Found() const { return done && !paths.empty(); }
+
+    // un solo camino para RequestPath, varios para las rutas alternativas
+    const std::vector<std::vector<std::pair<int, int>>>& GetPaths() const { return paths; }
+    const std::vector<std::pair<int, int>>& GetPath() const {
+        static const std::vector<std::pair<int, int>> empty;
+        return paths.empty() ? empty : paths[0];
+    }
+
+    std::pair<int, int> GetStart() const { return start; }
+    std::pair<int, int> GetEnd() const { return end; }
+    bool IsDiverse() const { return diverse; }
+    const DiversePathOptions& GetOptions() const { return options; }
+
+    // version de la transitabilidad con la que se calculo el resultado
+    uint64_t GetVersion() const { return version; }
+
+    // en cuantos Process se repartio (1 = termino en el mismo frame)
+    int GetSlices() const { return slices; }
+
+    // ya no interesa: se saca de la cola y el callback no se llama
+    void Cancel() { if (!done) cancelled = true; }
+
+private:
+    friend class PathRequestQueue;
+
+    uint64_t id = 0;        // unico en la cola, para no comparar direcciones
+    std::pair<int, int> start;
+    std::pair<int, int> end;
+    bool diverse = false;   // rutas alternativas (EnqueueAlternatives)
+    DiversePathOptions options;
+    PathRequestCallback callback;
+    std::vector<std::vector<std::pair<int, int>>> paths;
+    uint64_t version = 0;
+    int slices = 0;
+    bool done = false;
+    bool cancelled = false;
+};
+
+class PathRequestQueue {
+public:
+    static const int EXPANSIONS_PER_CHECK = 256; // nodos entre cada mirada al reloj, como mucho
+
+    struct Stats {
+        unsigned long long slices = 0;           // llamadas a Process que hicieron algo
+        unsigned long long slicesOverBudget = 0; // de esas, cuantas se pasaron del presupuesto
+        double lastSliceMicroseconds = 0.0;
+        double maxSliceMicroseconds = 0.0;
+        unsigned long long completed = 0;
+        unsigned long long restarted = 0;        // por cambios de transitabilidad
+        unsigned long long cancelled = 0;
+        unsigned long long expansions = 0;
+    };
+
+    void Resize(int rows, int cols);
+
+    PathRequestHandle Enqueue(std::pair<int, int> start, std::pair<int, int> end, PathRequestCallback callback = nullptr);
+    // lo mismo que ParallelPathPlanner::FindAlternatives, por tramos
+    PathRequestHandle EnqueueAlternatives(std::pair<int, int> start, std::pair<int, int> end, const DiversePathOptions& options,
+                                          PathRequestCallback callback = nullptr);
+
+    // busca con la configuracion de reference (algoritmo, landmarks, campo de costo)
+    void Configure(const PathFinder& reference);
+
+    // hilos para las capas de las rutas alternativas (nullptr = todo en el
+    // que llama). el pool no puede estar ocupado con otra cosa durante Process
+    void SetWorkerPool(WorkerPool* workerPool) { pool = workerPool; }
+
+    // campo de costo para los pedidos con options.avoidThreat; los demas usan
+    // el de Configure
+    void SetThreatField(const float* field, float scale) { threatField = field; threatFieldScale = scale; }
+
+    // pedido ya resuelto (por ejemplo desde una cache). el callback se llama aca mismo
+    static PathRequestHandle MakeCompleted(std::pair<int, int> start, std::pair<int, int> end, bool diverse,
+                                           const std::vector<std::vector<std::pair<int, int>>>& paths,
+                                           uint64_t version, PathRequestCallback callback = nullptr);
+
+    // avanza los pedidos hasta gastar budgetMicroseconds. version es la de la
+    // transitabilidad que ve isBlocked. devuelve cuantos pedidos termino
+    template <typename BlockedFn>
+    int Process(double budgetMicroseconds, uint64_t version, BlockedFn isBlocked);
+
+    bool Empty() const { return pending.empty(); }
+    size_t GetPendingCount() const { return pending.size(); }
+    void CancelAll();
+
+    const Stats& GetStats() const { return stats; }
+    void ResetStats() { stats = Stats(); }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    // parte del presupuesto que se planea gastar en expansiones; el resto
+    // queda para los callbacks y para lo que el reloj no ve venir
+    static constexpr double BUDGET_SAFETY = 0.8;
+
+    // saca el primero de la cola, lo marca terminado y llama su callback
+    void Finish(bool found);
+
+    // saca los cancelados del frente de la cola
+    void DropCancelled();
+
+    // arranca el primero de la cola en finder
+    void BeginActive(PathRequest& request);
+
+    // corta la busqueda a medias (la de finder y las de las capas)
+    void CancelActive();
+
+    // campo de costo del pedido en todos los finders
+    void ApplyCostField(const PathRequest& request);
+
+    // nodos expandidos entre finder y los de las capas
+    unsigned long long CountExpanded() const;
+
+    // un tramo de las rutas alternativas: la optima y despues las capas de
+    // cada tanda, todas a la vez
+    template <typename BlockedFn>
+    SearchStatus StepAlternatives(int maxExpansions, BlockedFn& isBlocked, PathRequest& request);
+
+    // arranca la proxima tanda de capas en layerFinders; false si ya no hay
+    bool BeginLayers(PathRequest& request);
+
+    std::deque<PathRequestHandle> pending;
+    PathFinder finder;
+    bool active = false;       // el primero de la cola ya arranco en finder
+    uint64_t nextId = 0;
+    WorkerPool* pool = nullptr;
+    AlternativeRoutes alternatives;
+    bool inLayers = false;     // ya se tiene la optima, se buscan las capas
+    int layerCount = 0;        // capas de la tanda actual
+    int layersRunning = 0;     // de esas, cuantas siguen buscando
+    std::vector<PathFinder> layerFinders;      // uno por capa de la tanda
+    std::vector<SearchStatus> layerStatus;
+    std::vector<std::vector<std::pair<int, int>>> layerPaths;
+    uint64_t activeVersion = 0;
+    double microsecondsPerExpansion = 0.0; // estimado, para no pasarse del presupuesto
+    const float* baseField = nullptr;   // el de Configure
+    float baseFieldScale = 0.0f;
+    const float* threatField = nullptr;
+    float threatFieldScale = 0.0f;
+    Stats stats;
+};
+
+template <typename BlockedFn>
+int PathRequestQueue::Process(double budgetMicroseconds, uint64_t version, BlockedFn isBlocked)
+{
+    DropCancelled();
+    if (pending.empty()) {
+        return 0;
+    }
+
+    const Clock::time_point sliceStart = Clock::now();
+    double elapsed = 0.0;
+    int completed = 0;
+    uint64_t counted = 0; // id del ultimo pedido al que se le conto este frame
+
+    while (!pending.empty()) {
+        // cuantos nodos caben en lo que queda, con lo que viene costando cada
+        // uno. siempre se hace al menos uno para que nada se quede trabado
+        int expansions = EXPANSIONS_PER_CHECK;
+        if (microsecondsPerExpansion > 0.0) {
+            double fit = (budgetMicroseconds - elapsed) * BUDGET_SAFETY / microsecondsPerExpansion;
+            if (fit < 1.0) {
+                if (counted) break;
+                fit = 1.0;
+            }
+            if (fit < expansions) expansions = static_cast<int>(fit);
+        }
+
+        PathRequest& request = *pending.front();
+        if (active && activeVersion != version) {
+            CancelActive(); // el grid cambio, lo hecho ya no sirve
+            stats.restarted++;
+        }
+        if (!active) {
+            BeginActive(request);
+            activeVersion = version;
+        }
+        if (counted != request.id) {
+            request.slices++;
+            counted = request.id;
+        }
+        ApplyCostField(request);
+
+        // con las capas en paralelo esto mide tiempo de pared por nodo, asi
+        // que el tamaño de la tanda ya cuenta cuantos hilos hay
+        const Clock::time_point chunkStart = Clock::now();
+        const unsigned long long expandedBefore = CountExpanded();
+        SearchStatus status = request.diverse
+            ? StepAlternatives(expansions, isBlocked, request)
+            : finder.StepSearch(expansions, isBlocked, request.paths[0]);
+        const Clock::time_point chunkEnd = Clock::now();
+        const unsigned long long expanded = CountExpanded() - expandedBefore;
+        stats.expansions += expanded;
+        if (expanded > 0) {
+            // sube de una si algo salio mas caro, baja despacio
+            double sample = std::chrono::duration<double, std::micro>(chunkEnd - chunkStart).count() / expanded;
+            microsecondsPerExpansion = sample > microsecondsPerExpansion
+                ? sample : microsecondsPerExpansion * 0.98 + sample * 0.02;
+        }
+
+        if (status != SearchStatus::RUNNING) {
+            request.version = version;
+            Finish(status == SearchStatus::FOUND);
+            completed++;
+            DropCancelled(); // el callback pudo cancelar otros
+        }
+
+        elapsed = std::chrono::duration<double, std::micro>(Clock::now() - sliceStart).count();
+        if (elapsed >= budgetMicroseconds) {
+            break;
+        }
+    }
+
+    stats.slices++;
+    stats.lastSliceMicroseconds = elapsed;
+    if (elapsed > stats.maxSliceMicroseconds) {
+        stats.maxSliceMicroseconds = elapsed;
+    }
+    if (elapsed > budgetMicroseconds) {
+        stats.slicesOverBudget++;
+    }
+    return completed;
+}
+
+template <typename BlockedFn>
+SearchStatus PathRequestQueue::StepAlternatives(int maxExpansions, BlockedFn& isBlocked, PathRequest& request)
+{
+    if (!inLayers) {
+        SearchStatus status = finder.StepSearch(maxExpansions, isBlocked, layerPaths[0]);
+        if (status != SearchStatus::FOUND) {
+            return status;
+        }
+        alternatives.Begin(request.start, request.end, request.options, layerPaths[0], request.paths);
+        inLayers = true;
+        return BeginLayers(request) ? SearchStatus::RUNNING : SearchStatus::FOUND;
+    }
+
+    // el presupuesto se reparte entre las capas que siguen; cada una escribe
+    // solo en su finder, su camino y su estado, y la capa es de solo lectura
+    const int perLayer = (std::max)(1, maxExpansions / layersRunning);
+    auto stepLayer = [&](int item, int) {
+        if (layerStatus[item] != SearchStatus::RUNNING) {
+            return;
+        }
+        const ObstacleOverlay& layer = alternatives.GetLayer(item);
+        layerStatus[item] = layerFinders[item].StepSearch(perLayer, [&isBlocked, &layer](int r, int c) {
+            return isBlocked(r, c) || layer.Test(r, c);
+        }, layerPaths[item]);
+    };
+    if (pool) {
+        pool->ParallelFor(layerCount, stepLayer);
+    } else {
+        for (int i = 0; i < layerCount; ++i) {
+            stepLayer(i, 0);
+        }
+    }
+
+    layersRunning = 0;
+    for (int i = 0; i < layerCount; ++i) {
+        if (layerStatus[i] == SearchStatus::RUNNING) {
+            layersRunning++;
+        }
+    }
+    if (layersRunning > 0) {
+        return SearchStatus::RUNNING;
+    }
+
+    // EndRound revisa en orden de capa, asi que da igual cual termino primero
+    for (int i = 0; i < layerCount; ++i) {
+        if (layerStatus[i] == SearchStatus::NOT_FOUND) {
+            layerPaths[i].clear();
+        }
+    }
+    alternatives.EndRound(layerPaths, layerCount, request.paths);
+    return BeginLayers(request) ? SearchStatus::RUNNING : SearchStatus::FOUND;
+}
@@ -1,10 +1,11 @@
 /*
  * mira este codigo es para manejar los proyectiles del juego. es bastante simple:
  * - tenemos diferentes tipos de proyectiles (flechas, bolas de fuego, etc)
- * - cada proyectil tiene una posicion, velocidad y angulo
+ * - cada proyectil tiene una posicion y una velocidad (calculada al disparar)
  * - se mueven en linea recta hacia su objetivo
+ * - viven en un ProjectilePool: un arreglo por campo, sin new por disparo
  * - pueden tener un objetivo preciso o solo una celda objetivo
- * - se renderizan con gdi+ y rotan segun su direccion
+ * - se renderizan con gdi+ (la imagen del tipo sale del AssetCache) y rotan segun su direccion
  * - el codigo es una mierda pero funciona, asi que no lo toques mucho
  */
 
@@ -13,261 +14,513 @@
 #include "Projectile.h"
 #include "Enemy.h"
 #include "Economy.h" 
+#include "SpatialHash.h"
 #include <cmath>
+#include <algorithm>
 #include "Map.h" 
 
 // estos valores los saque de mi trasero pero funcionan bien
 const float PROJECTILE_SIZE_RADIUS = 6.0f; 
+// largo (en celdas) de cada tramo del recorrido que PredictHit le pregunta al grid
+const float PREDICT_QUERY_CELLS = 2.0f;
 const float ENEMY_SIZE_RADIUS = CELL_SIZE / 5.0f;
 
-Projectile::Projectile(ProjectileType type, int startRow, int startCol, int targetCellRow, int targetCellCol, int cs, float actualTargetX, float actualTargetY)
-    : type(type), pImage(NULL), cellSize(cs), isActive(true), hasPreciseTarget(false), initialTargetX(0), initialTargetY(0)
+// velocidad en pixeles por segundo de cada tipo
+float GetProjectileSpeed(ProjectileType type)
 {
-    x = (startCol + 0.5f) * cellSize;
-    y = (startRow + 0.5f) * cellSize;
-
-    if (actualTargetX != -1.0f && actualTargetY != -1.0f) {
-        targetX = actualTargetX;
-        targetY = actualTargetY;
-        hasPreciseTarget = true;
-    } else {
-        targetX = (targetCellCol + 0.5f) * cellSize;
-        targetY = (targetCellRow + 0.5f) * cellSize;
-        hasPreciseTarget = false;
-    }
-
-    float dx = targetX - x;
-    float dy = targetY - y;
-    angle = atan2(dy, dx);
-
     switch (type) {
     case ProjectileType::ARROW:
     case ProjectileType::FIREARROW:
-        speed = 350.0f; // velocidad en pixeles por segundo
-        break;
+        return 350.0f;
     case ProjectileType::FIREBALL:
     case ProjectileType::PURPLEFIREBALL:
-        speed = 250.0f;
-        break;
+        return 250.0f;
     case ProjectileType::CANNONBALL:
     case ProjectileType::NUKEBOMB:
-        speed = 200.0f;
-        break;
+        return 200.0f;
     default:
-        speed = 250.0f;
+        return 250.0f;
     }
-    LoadImage();
 }
 
-// el destructor es una mierda pero gdi+ se encarga de limpiar todo
-Projectile::~Projectile()
+// devuelve el daño que hace cada tipo de proyectil, no lo cambies o la cagas
+int GetProjectileDamage(ProjectileType type)
 {
-    if (pImage) {
-        pImage = NULL;
+    switch (type) {
+        case ProjectileType::ARROW: return 15;
+        case ProjectileType::FIREBALL: return 25;
+        case ProjectileType::CANNONBALL: return 45;
+        case ProjectileType::FIREARROW: return 30;
+        case ProjectileType::PURPLEFIREBALL: return 50;
+        case ProjectileType::NUKEBOMB: return 150;
+        default: return 7;
     }
 }
 
-// dibuja esta basura usando gdi+, que dios nos ayude
-void Projectile::Draw(HDC hdc)
+void ProjectilePool::Reserve(size_t count)
 {
-    if (!isActive || !pImage || pImage->GetLastStatus() != Gdiplus::Ok) return;
-
-    Gdiplus::Graphics graphics(hdc);
-    graphics.SetSmoothingMode(Gdiplus::SmoothingModeAntiAlias);
-    graphics.SetInterpolationMode(Gdiplus::InterpolationModeHighQualityBicubic);
-
-    float imgWidth = static_cast<float>(pImage->GetWidth());
-    float imgHeight = static_cast<float>(pImage->GetHeight());
-    
-    const float desiredProjectileWidth = 15.0f;
-    const float desiredProjectileHeight = 15.0f;
-
-    Gdiplus::Matrix matrix;
-    matrix.Translate(x, y);
-    matrix.Rotate(angle * (180.0f / static_cast<float>(M_PI)));
-    matrix.Translate(-desiredProjectileWidth / 2.0f, -desiredProjectileHeight / 2.0f); 
-    graphics.SetTransform(&matrix);
-
-    graphics.DrawImage(pImage, 0.0f, 0.0f, desiredProjectileWidth, desiredProjectileHeight);
-    
-    graphics.ResetTransform();
+    type.reserve(count);
+    x.reserve(count);
+    y.reserve(count);
+    vx.reserve(count);
+    vy.reserve(count);
+    speed.reserve(count);
+    prevX.reserve(count);
+    prevY.reserve(count);
+    stepStart.reserve(count);
+    launchDelay.reserve(count);
+    leftMap.reserve(count);
+    hitEnemy.reserve(count);
+    hitRevision.reserve(count);
+    hitTime.reserve(count);
+    hitScheduled.reserve(count);
 }
 
-// actualiza la posicion del proyectil, fisica basica para idiotas
-bool Projectile::Update(float deltaTime)
+// clear no suelta la memoria, que es justamente lo que queremos
+void ProjectilePool::Clear()
 {
-    if (!isActive) return false;
-
-    float moveX = speed * cos(angle) * deltaTime;
-    float moveY = speed * sin(angle) * deltaTime;
-
-    x += moveX;
-    y += moveY;
-
-    return true;
+    type.clear();
+    x.clear();
+    y.clear();
+    vx.clear();
+    vy.clear();
+    speed.clear();
+    prevX.clear();
+    prevY.clear();
+    stepStart.clear();
+    launchDelay.clear();
+    leftMap.clear();
+    hitEnemy.clear();
+    hitRevision.clear();
+    hitTime.clear();
+    hitScheduled.clear();
 }
 
-// retorna el tipo de proyectil, por si eres muy tonto para saberlo
-ProjectileType Projectile::GetType() const
+size_t ProjectilePool::Add(ProjectileType projectileType, float startX, float startY, float velocityX, float velocityY,
+                           float projectileSpeed, float delay)
 {
-    return type;
+    type.push_back(projectileType);
+    x.push_back(startX);
+    y.push_back(startY);
+    vx.push_back(velocityX);
+    vy.push_back(velocityY);
+    speed.push_back(projectileSpeed);
+    prevX.push_back(startX);
+    prevY.push_back(startY);
+    stepStart.push_back(0.0f);
+    launchDelay.push_back(delay);
+    leftMap.push_back(0);
+    hitEnemy.push_back(-1);
+    hitRevision.push_back(0);
+    hitTime.push_back(0.0f);
+    hitScheduled.push_back(0);
+    return x.size() - 1;
 }
 
-// maldita sea, otra vez tengo que cargar imagenes de mierda
-bool Projectile::LoadImage()
+void ProjectilePool::Remove(size_t i)
 {
-    pImage = NULL;
-    std::wstring fileName;
-    switch (type) {
-    case ProjectileType::ARROW: fileName = L"Arrow.png"; break;
-    case ProjectileType::FIREBALL: fileName = L"Fireball.png"; break;
-    case ProjectileType::CANNONBALL: fileName = L"Bomb.png"; break;
-    case ProjectileType::FIREARROW: fileName = L"FireArrow.png"; break;
-    case ProjectileType::PURPLEFIREBALL: fileName = L"PurpleFireball.png"; break;
-    case ProjectileType::NUKEBOMB: fileName = L"NukeBomb.png"; break;
-    default: return false;
+    const size_t last = x.size() - 1;
+    if (i != last) {
+        type[i] = type[last];
+        x[i] = x[last];
+        y[i] = y[last];
+        vx[i] = vx[last];
+        vy[i] = vy[last];
+        speed[i] = speed[last];
+        prevX[i] = prevX[last];
+        prevY[i] = prevY[last];
+        stepStart[i] = stepStart[last];
+        launchDelay[i] = launchDelay[last];
+        leftMap[i] = leftMap[last];
+        hitEnemy[i] = hitEnemy[last];
+        hitRevision[i] = hitRevision[last];
+        hitTime[i] = hitTime[last];
+        hitScheduled[i] = hitScheduled[last];
     }
+    type.pop_back();
+    x.pop_back();
+    y.pop_back();
+    vx.pop_back();
+    vy.pop_back();
+    speed.pop_back();
+    prevX.pop_back();
+    prevY.pop_back();
+    stepStart.pop_back();
+    launchDelay.pop_back();
+    leftMap.pop_back();
+    hitEnemy.pop_back();
+    hitRevision.pop_back();
+    hitTime.pop_back();
+    hitScheduled.pop_back();
+}
 
-    const wchar_t* possiblePaths[] = { L"Assets\\Projectiles\\", L"..\\GeneticKingdom2\\Assets\\Projectiles\\", L"GeneticKingdom2\\Assets\\Projectiles\\" };
-    for (const wchar_t* basePath : possiblePaths) {
-        std::wstring fullPath = basePath + fileName;
-        Gdiplus::Image* tempImage = Gdiplus::Image::FromFile(fullPath.c_str());
-        if (tempImage && tempImage->GetLastStatus() == Gdiplus::Ok) {
-            pImage = tempImage;
-            return true;
-        }
-        if (tempImage) delete tempImage;
-    }
-    WCHAR exePath[MAX_PATH];
-    GetModuleFileNameW(NULL, exePath, MAX_PATH);
-    WCHAR* lastSlash = wcsrchr(exePath, L'\\');
-    if (lastSlash != NULL) {
-        *(lastSlash + 1) = L'\0';
-        std::wstring fullPath = exePath;
-        fullPath += L"Assets\\Projectiles\\";
-        fullPath += fileName;
-        Gdiplus::Image* tempImage = Gdiplus::Image::FromFile(fullPath.c_str());
-        if (tempImage && tempImage->GetLastStatus() == Gdiplus::Ok) {
-            pImage = tempImage;
-            return true;
-        }
-        if (tempImage) delete tempImage;
+AssetId GetProjectileAssetId(ProjectileType type)
+{
+    switch (type) {
+    case ProjectileType::FIREBALL: return AssetId::PROJECTILE_FIREBALL;
+    case ProjectileType::CANNONBALL: return AssetId::PROJECTILE_CANNONBALL;
+    case ProjectileType::FIREARROW: return AssetId::PROJECTILE_FIREARROW;
+    case ProjectileType::PURPLEFIREBALL: return AssetId::PROJECTILE_PURPLEFIREBALL;
+    case ProjectileType::NUKEBOMB: return AssetId::PROJECTILE_NUKEBOMB;
+    default: return AssetId::PROJECTILE_ARROW;
     }
-    return false;
 }
 
 // esta mierda maneja todos los proyectiles, que dios nos ayude
 ProjectileManager::ProjectileManager()
+    : predictiveHits(true), clock(0.0f), lastDeltaTime(0.0f), lastMapWidth(0.0f), lastMapHeight(0.0f),
+      trackedEnemies(nullptr), trackedEnemyCount(0), frame(0), predictStamp(0)
 {
 }
 
 // destructor que limpia toda la basura que dejamos tirada
 ProjectileManager::~ProjectileManager()
 {
-    for (auto& projectile : projectiles) {
-        delete projectile;
-    }
-    projectiles.clear();
+    pool.Clear();
 }
 
-// agrega un nuevo proyectil al gestor, espero que sepas lo que haces
-void ProjectileManager::AddProjectile(ProjectileType type, int startRow, int startCol, int targetRow, int targetCol, int cellSize, float targetActualX, float targetActualY)
+// agrega un nuevo proyectil al gestor, espero que sepas lo que haces.
+// la direccion se calcula aca una vez; despues solo se suma la velocidad
+void ProjectileManager::AddProjectile(ProjectileType type, int startRow, int startCol, int targetRow, int targetCol, int cellSize, float targetActualX, float targetActualY, float launchDelay)
 {
-    WCHAR debugMsg[256];
-    swprintf_s(debugMsg, L"Creando proyectil tipo %d desde [%d,%d] hacia [%d,%d]\n", 
-              static_cast<int>(type), startRow, startCol, targetRow, targetCol);
-    OutputDebugStringW(debugMsg);
-    
-    projectiles.push_back(new Projectile(type, startRow, startCol, targetRow, targetCol, cellSize, targetActualX, targetActualY));
+    float startX = (startCol + 0.5f) * cellSize;
+    float startY = (startRow + 0.5f) * cellSize;
+
+    // con objetivo preciso va a esa posicion, si no al centro de la celda
+    float targetX, targetY;
+    if (targetActualX != -1.0f && targetActualY != -1.0f) {
+        targetX = targetActualX;
+        targetY = targetActualY;
+    } else {
+        targetX = (targetCol + 0.5f) * cellSize;
+        targetY = (targetRow + 0.5f) * cellSize;
+    }
+
+    float angle = atan2(targetY - startY, targetX - startX);
+    float speed = GetProjectileSpeed(type);
+    pool.Add(type, startX, startY, speed * cos(angle), speed * sin(angle), speed, launchDelay);
 }
 
-// dibuja todos los proyectiles activos, si es que hay alguno
+// dibuja todos los proyectiles, si es que hay alguno
 void ProjectileManager::DrawProjectiles(HDC hdc)
 {
-    for (auto& projectile : projectiles) {
-        if (projectile->IsActive()) {
-            projectile->Draw(hdc);
-        }
+    if (pool.Size() == 0) return;
+
+    Gdiplus::Graphics graphics(hdc);
+    graphics.SetSmoothingMode(Gdiplus::SmoothingModeAntiAlias);
+    graphics.SetInterpolationMode(Gdiplus::InterpolationModeHighQualityBicubic);
+
+    AssetCache& assets = AssetCache::Instance();
+    for (size_t i = 0; i < pool.Size(); ++i) {
+        const AssetId assetId = GetProjectileAssetId(pool.type[i]);
+        Gdiplus::Image* image = assets.GetAs<Gdiplus::Image>(assetId);
+        if (!image || image->GetLastStatus() != Gdiplus::Ok) continue;
+
+        // rotado siempre se interpola, pero el sprite horneado ya tiene este
+        // tamaño y no se escala encima
+        const int side = GetAssetDrawSize(assetId, CELL_SIZE);
+        float angle = atan2(pool.vy[i], pool.vx[i]);
+        Gdiplus::Matrix matrix;
+        matrix.Translate(pool.x[i], pool.y[i]);
+        matrix.Rotate(angle * (180.0f / static_cast<float>(M_PI)));
+        matrix.Translate(-side / 2.0f, -side / 2.0f); 
+        graphics.SetTransform(&matrix);
+
+        graphics.DrawImage(image, Gdiplus::Rect(0, 0, side, side), 0, 0, image->GetWidth(), image->GetHeight(),
+                           Gdiplus::UnitPixel);
     }
+    graphics.ResetTransform();
 }
 
-// actualiza la posicion de los proyectiles y elimina los que se salen del mapa
+// mueve los proyectiles, fisica basica para idiotas. un loop plano sobre los
+// arreglos, sin senos ni cosenos. los que se salen del mapa en este paso
+// quedan marcados y se dan de baja en CheckCollisions, que todavia tiene que
+// barrer el tramo que hicieron
 void ProjectileManager::Update(float deltaTime, float mapWidth, float mapHeight)
 {
-    for (size_t i = 0; i < projectiles.size();) {
-        if (projectiles[i]->Update(deltaTime)) {
-            float projX, projY;
-            projectiles[i]->GetPosition(projX, projY);
-            if (projX < 0 || projX > mapWidth || projY < 0 || projY > mapHeight) {
-                projectiles[i]->SetActive(false);
+    clock += deltaTime;
+    lastDeltaTime = deltaTime;
+    lastMapWidth = mapWidth;
+    lastMapHeight = mapHeight;
+
+    const size_t count = pool.Size();
+    for (size_t i = 0; i < count; ++i) {
+        // si salio de la torre a mitad del paso, solo se mueve lo que queda
+        pool.prevX[i] = pool.x[i];
+        pool.prevY[i] = pool.y[i];
+        float start = (std::min)(pool.launchDelay[i], deltaTime);
+        pool.stepStart[i] = start;
+        pool.launchDelay[i] -= start;
+        float movingTime = deltaTime - start;
+
+        float projX = pool.x[i] + pool.vx[i] * movingTime;
+        float projY = pool.y[i] + pool.vy[i] * movingTime;
+        pool.x[i] = projX;
+        pool.y[i] = projY;
+        pool.leftMap[i] = (projX < 0 || projX > mapWidth || projY < 0 || projY > mapHeight) ? 1 : 0;
+    }
+}
+
+// revisa todas las colisiones y mata enemigos si es necesario
+void ProjectileManager::CheckCollisions(std::vector<Enemy>& enemies, int cs, Economy& economy, const SpatialHash* enemyGrid) {
+    if (predictiveHits) {
+        // este ya no recorre enemigos por frame salvo los que cambiaron de rumbo
+        CheckCollisionsPredictive(enemies, cs, economy, enemyGrid);
+    } else {
+        CheckCollisionsBruteForce(enemies, cs, economy, enemyGrid);
+    }
+}
+
+void ProjectileManager::SetPredictiveHits(bool enabled) {
+    predictiveHits = enabled;
+    // lo agendado con el otro modo no sirve, que se prediga todo de nuevo
+    trackedEnemies = nullptr;
+    trackedEnemyCount = 0;
+    std::fill(pool.hitScheduled.begin(), pool.hitScheduled.end(), static_cast<uint8_t>(0));
+}
+
+void ProjectileManager::ApplyHit(size_t i, Enemy& enemy, Economy& economy) {
+    enemy.TakeDamage(GetProjectileDamage(pool.type[i]), pool.type[i]);
+    stats.hits++;
+
+    if (!enemy.IsAlive()) {
+        economy.AddGold(enemy.GetGoldReward());
+    }
+}
+
+// todos contra todos: O(proyectiles * enemigos) en cada frame, o solo los
+// vecinos del tramo si hay grid. cada proyectil se queda con el primer
+// enemigo que toca en su tramo (a igual tiempo, el de menor indice)
+void ProjectileManager::CheckCollisionsBruteForce(std::vector<Enemy>& enemies, int cs, Economy& economy, const SpatialHash* enemyGrid) {
+    frame++;
+    enemySegments.resize(enemies.size());
+    segmentFrame.resize(enemies.size(), 0);
+
+    const float radius = PROJECTILE_SIZE_RADIUS + static_cast<float>(cs) / 4.0f;
+    for (size_t i = 0; i < pool.Size();) {
+        // descarte rapido: circulo que encierra el tramo del proyectil contra
+        // lo mas lejos que pudo llegar el enemigo en el paso
+        const float midX = 0.5f * (pool.prevX[i] + pool.x[i]);
+        const float midY = 0.5f * (pool.prevY[i] + pool.y[i]);
+        const float reach = 0.5f * pool.speed[i] * (lastDeltaTime - pool.stepStart[i]) + radius;
+
+        int hit = -1;
+        float best = lastDeltaTime;
+        auto consider = [&](size_t j) {
+            const Enemy& enemy = enemies[j];
+            if (!enemy.IsActive() || !enemy.IsAlive()) return;
+            float dx = enemy.GetX() - midX;
+            float dy = enemy.GetY() - midY;
+            float limit = reach + enemy.GetSpeed() * lastDeltaTime;
+            if (dx * dx + dy * dy > limit * limit) return;
+
+            float t;
+            if (ContactTime(i, enemies, j, cs, best, t) &&
+                (hit < 0 || t < best || (t == best && static_cast<int>(j) < hit))) {
+                best = t;
+                hit = static_cast<int>(j);
+            }
+        };
+
+        if (enemyGrid) {
+            enemyGrid->ForEachInRadius(midX, midY, reach + enemyGrid->GetMaxSpeed() * lastDeltaTime,
+                                       [&](uint32_t j, float, float, float) {
+                if (j < enemies.size()) consider(j);
+            });
+        } else {
+            for (size_t j = 0; j < enemies.size(); ++j) {
+                consider(j);
             }
         }
 
-        if (!projectiles[i]->IsActive()) {
-            delete projectiles[i];
-            projectiles.erase(projectiles.begin() + i);
+        // el que pega o se va del mapa se saca ya; en su lugar queda el ultimo,
+        // que todavia no se miro
+        if (hit >= 0) {
+            ApplyHit(i, enemies[hit], economy);
+            pool.Remove(i);
+        } else if (pool.leftMap[i]) {
+            pool.Remove(i);
         } else {
-            i++;
+            ++i;
         }
     }
 }
 
-// devuelve la posicion actual del proyectil, por si te interesa
-void Projectile::GetPosition(float& outX, float& outY) const
-{
-    outX = x;
-    outY = y;
+float ProjectileManager::TimeToLeaveMap(size_t i) const {
+    // antes del primer Update no sabemos el tamaño; un rato largo alcanza
+    if (lastMapWidth <= 0.0f || lastMapHeight <= 0.0f) {
+        return 60.0f;
+    }
+    const float vx = pool.vx[i];
+    const float vy = pool.vy[i];
+    const float px = pool.prevX[i];
+    const float py = pool.prevY[i];
+    float horizon = 60.0f;
+    if (vx > 0.0f) horizon = (std::min)(horizon, (lastMapWidth - px) / vx);
+    if (vx < 0.0f) horizon = (std::min)(horizon, -px / vx);
+    if (vy > 0.0f) horizon = (std::min)(horizon, (lastMapHeight - py) / vy);
+    if (vy < 0.0f) horizon = (std::min)(horizon, -py / vy);
+    return pool.stepStart[i] + (std::max)(horizon, 0.0f);
 }
 
-// verifica si el proyectil le dio a un enemigo, fisica simple para idiotas
-bool Projectile::CheckCollision(const Enemy& enemy, int cs) const 
-{
-    if (!isActive || !enemy.IsActive() || !enemy.IsAlive()) {
+// los enemigos todavia estan al inicio del paso (se mueven despues de esto),
+// asi que todo se mide desde ahi: el proyectil sale de donde estaba entonces
+bool ProjectileManager::ContactTime(size_t i, const std::vector<Enemy>& enemies, size_t index,
+                                    int cs, float horizon, float& outTime) {
+    const Enemy& enemy = enemies[index];
+    if (!enemy.IsActive() || !enemy.IsAlive()) {
         return false;
     }
-    float enemyX = enemy.GetX();
-    float enemyY = enemy.GetY();
-    float distSq = (x - enemyX) * (x - enemyX) + (y - enemyY) * (y - enemyY);
-    
-    float currentEnemyRadius = static_cast<float>(cs) / 4.0f; 
-    float combinedRadius = PROJECTILE_SIZE_RADIUS + currentEnemyRadius; 
-    return distSq <= (combinedRadius * combinedRadius);
+    if (segmentFrame[index] != frame) {
+        enemy.GetMotionSegments(enemySegments[index]);
+        segmentFrame[index] = frame;
+    }
+    stats.contactTests++;
+
+    const float radius = PROJECTILE_SIZE_RADIUS + static_cast<float>(cs) / 4.0f;
+    const std::vector<MotionSegment>& segments = enemySegments[index];
+    return FirstContact(pool.prevX[i], pool.prevY[i], pool.vx[i], pool.vy[i], pool.stepStart[i],
+                        segments.data(), segments.size(), radius, horizon, outTime);
 }
 
-// funciones simples que cualquier idiota puede entender
-bool Projectile::IsActive() const { return isActive; }
-void Projectile::SetActive(bool active) { isActive = active; }
+// sin grid se prueba contra todos. con grid se recorre el vuelo en tramos de
+// PREDICT_QUERY_CELLS y en cada uno solo se prueban los enemigos que pudieron
+// llegar a ese tramo a la velocidad maxima del grid; se corta cuando el tramo
+// ya empieza despues del mejor impacto. a igual tiempo gana el de menor
+// indice, igual que recorriendo todos en orden
+void ProjectileManager::PredictHit(size_t i, const std::vector<Enemy>& enemies, int cs, const SpatialHash* enemyGrid) {
+    stats.predictions++;
+    pool.hitScheduled[i] = 1;
+    int32_t hitEnemy = -1;
+
+    const float stepBegin = clock - lastDeltaTime;
+    float best = TimeToLeaveMap(i);
+    auto consider = [&](size_t j) {
+        float t;
+        if (ContactTime(i, enemies, j, cs, best, t) &&
+            (hitEnemy < 0 || t < best || (t == best && static_cast<int32_t>(j) < hitEnemy))) {
+            best = t;
+            hitEnemy = static_cast<int32_t>(j);
+        }
+    };
 
-// devuelve el daño que hace cada tipo de proyectil, no lo cambies o la cagas
-int Projectile::GetDamage() const {
-    switch (type) {
-        case ProjectileType::ARROW: return 15;
-        case ProjectileType::FIREBALL: return 25;
-        case ProjectileType::CANNONBALL: return 45;
-        case ProjectileType::FIREARROW: return 30;
-        case ProjectileType::PURPLEFIREBALL: return 50;
-        case ProjectileType::NUKEBOMB: return 150;
-        default: return 7;
+    if (enemyGrid) {
+        if (++predictStamp == 0) {
+            std::fill(predictMark.begin(), predictMark.end(), 0u);
+            predictStamp = 1;
+        }
+        predictMark.resize(enemies.size(), 0u);
+
+        // un pixel de mas por el redondeo de los tramos del enemigo
+        const float radius = PROJECTILE_SIZE_RADIUS + static_cast<float>(cs) / 4.0f + 1.0f;
+        const float speed = pool.speed[i];
+        const float maxEnemySpeed = enemyGrid->GetMaxSpeed();
+        const float chunk = speed > 0.0f ? PREDICT_QUERY_CELLS * static_cast<float>(cs) / speed : best;
+        for (float t0 = pool.stepStart[i]; t0 <= best; t0 += chunk) {
+            const float t1 = (std::min)(t0 + chunk, best);
+            const float flight = 0.5f * (t0 + t1) - pool.stepStart[i];
+            const float midX = pool.prevX[i] + pool.vx[i] * flight;
+            const float midY = pool.prevY[i] + pool.vy[i] * flight;
+            const float reach = 0.5f * speed * (t1 - t0) + radius + maxEnemySpeed * t1;
+            enemyGrid->ForEachInRadius(midX, midY, reach, [&](uint32_t j, float, float, float) {
+                if (j < enemies.size() && predictMark[j] != predictStamp) {
+                    predictMark[j] = predictStamp;
+                    consider(j);
+                }
+            });
+            if (t1 >= best) {
+                break;
+            }
+        }
+    } else {
+        for (size_t j = 0; j < enemies.size(); ++j) {
+            consider(j);
+        }
+    }
+    pool.hitEnemy[i] = hitEnemy;
+    if (hitEnemy >= 0) {
+        pool.hitTime[i] = stepBegin + best;
+        pool.hitRevision[i] = enemies[hitEnemy].GetMotionRevision();
     }
 }
 
-// revisa todas las colisiones y mata enemigos si es necesario
-void ProjectileManager::CheckCollisions(std::vector<Enemy>& enemies, int cs, Economy& economy) {
-    for (size_t i = 0; i < projectiles.size(); ++i) {
-        if (!projectiles[i]->IsActive()) continue;
-
-        for (Enemy& enemy : enemies) {
-            if (!enemy.IsActive() || !enemy.IsAlive()) continue;
-
-            if (projectiles[i]->CheckCollision(enemy, cs)) {
-                enemy.TakeDamage(projectiles[i]->GetDamage(), projectiles[i]->GetType());
-                projectiles[i]->SetActive(false);
+// cada proyectil ya sabe a quien le pega y cuando. por frame solo se mira que
+// enemigos cambiaron de rumbo (O(enemigos)), se corrigen los proyectiles que
+// dependen de eso y se aplican los impactos que caen dentro del paso. antes
+// de aplicar uno se vuelve a resolver ese par con el estado de ahora; si ya
+// no toca (el enemigo murio o se desvio) se predice de nuevo contra todos
+void ProjectileManager::CheckCollisionsPredictive(std::vector<Enemy>& enemies, int cs, Economy& economy, const SpatialHash* enemyGrid) {
+    frame++;
+    changedEnemies.clear();
+
+    const Enemy* data = enemies.empty() ? nullptr : enemies.data();
+    if (data != trackedEnemies || enemies.size() != trackedEnemyCount) {
+        // vector nuevo (otra oleada, realloc): los indices agendados ya no valen
+        trackedEnemies = data;
+        trackedEnemyCount = enemies.size();
+        enemyRevisions.resize(enemies.size());
+        enemySegments.resize(enemies.size());
+        segmentFrame.assign(enemies.size(), 0);
+        for (size_t j = 0; j < enemies.size(); ++j) {
+            enemyRevisions[j] = enemies[j].GetMotionRevision();
+        }
+        std::fill(pool.hitScheduled.begin(), pool.hitScheduled.end(), static_cast<uint8_t>(0));
+    } else {
+        for (size_t j = 0; j < enemies.size(); ++j) {
+            uint32_t revision = enemies[j].GetMotionRevision();
+            if (revision != enemyRevisions[j]) {
+                enemyRevisions[j] = revision;
+                changedEnemies.push_back(j);
+            }
+        }
+    }
 
-                if (!enemy.IsAlive()) {
-                    economy.AddGold(enemy.GetGoldReward());
+    const float stepBegin = clock - lastDeltaTime;
+    for (size_t i = 0; i < pool.Size();) {
+        if (!pool.hitScheduled[i]) {
+            PredictHit(i, enemies, cs, enemyGrid);
+        } else if (!changedEnemies.empty()) {
+            bool targetChanged = false;
+            for (size_t j : changedEnemies) {
+                if (static_cast<int32_t>(j) == pool.hitEnemy[i]) {
+                    targetChanged = true;
+                    break;
                 }
-                break;
             }
+            if (targetChanged) {
+                PredictHit(i, enemies, cs, enemyGrid);
+            } else {
+                // los demas siguen igual; solo puede aparecer uno que llegue antes
+                float horizon = pool.hitEnemy[i] >= 0 ? pool.hitTime[i] - stepBegin : TimeToLeaveMap(i);
+                for (size_t j : changedEnemies) {
+                    float t;
+                    if (ContactTime(i, enemies, j, cs, horizon, t) && t < horizon) {
+                        horizon = t;
+                        pool.hitEnemy[i] = static_cast<int32_t>(j);
+                        pool.hitTime[i] = stepBegin + t;
+                        pool.hitRevision[i] = enemies[j].GetMotionRevision();
+                    }
+                }
+            }
+        }
+
+        if (pool.hitEnemy[i] >= 0 && pool.hitTime[i] <= clock) {
+            float t;
+            if (!ContactTime(i, enemies, pool.hitEnemy[i], cs, lastDeltaTime, t)) {
+                stats.fallbacks++;
+                PredictHit(i, enemies, cs, enemyGrid);
+            }
+        }
+
+        // el que pega o se va del mapa se saca ya; en su lugar queda el ultimo,
+        // que todavia no se miro
+        if (pool.hitEnemy[i] >= 0 && pool.hitTime[i] <= clock) {
+            ApplyHit(i, enemies[pool.hitEnemy[i]], economy);
+            pool.Remove(i);
+        } else if (pool.leftMap[i]) {
+            pool.Remove(i);
+        } else {
+            ++i;
         }
     }
-} 
\ No newline at end of file
+}
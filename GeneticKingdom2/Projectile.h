@@ -6,11 +6,15 @@
 #pragma comment(lib, "gdiplus.lib")
 #include <string>
 #include <vector>
+#include <cstdint>
+#include "HitPredictor.h"
+#include "AssetCache.h"
 
 // Forward declaration
 struct DummyTarget;
 class Enemy;
 class Economy;
+class SpatialHash;
 
 // Tipos de proyectiles
 enum class ProjectileType {
@@ -22,49 +26,46 @@ enum class ProjectileType {
     NUKEBOMB    // Bomba nuclear (poderosa) para torre Gunner
 };
 
-// Clase para manejar un proyectil individual
-class Projectile {
-public:
-    Projectile(ProjectileType type, int startRow, int startCol, int targetRow, int targetCol, int cellSize, float targetActualX = -1.0f, float targetActualY = -1.0f);
-    ~Projectile();
-
-    // Dibuja el proyectil
-    void Draw(HDC hdc);
-
-    // Actualiza la posición del proyectil
-    bool Update(float deltaTime);
-
-    // bool IsFinished() const; // Replaced by IsActive
-    // void SetFinished(); // Replaced by SetActive(false)
-
-    // Obtiene el tipo de proyectil
-    ProjectileType GetType() const;
-    
-    // Obtiene la posición actual del proyectil
-    void GetPosition(float& outX, float& outY) const;
-    
-    // Verifica si el proyectil colisiona con un objetivo dummy
-    bool CheckCollision(const Enemy& enemy, int cs) const;
-
-    bool IsActive() const; 
-    void SetActive(bool active);
-
-    int GetDamage() const; // Needs implementation based on type
-
-private:
-    // Carga la imagen adecuada para el tipo de proyectil
-    bool LoadImage();
-
-    ProjectileType type;    // Tipo de proyectil
-    float x, y;             // Posición actual
-    float targetX, targetY; // Posición objetivo
-    float initialTargetX, initialTargetY; // Store initial precise target if provided
-    bool hasPreciseTarget;                // Flag if precise target was given
-    float angle;            // Ángulo de movimiento
-    float speed;            // Velocidad en píxeles por segundo
-    bool isActive;          
-    Gdiplus::Image* pImage; // Imagen del proyectil
-    int cellSize;           // Tamaño de celda para calcular colisiones
+// velocidad (pixeles por segundo) y daño de cada tipo
+float GetProjectileSpeed(ProjectileType type);
+int GetProjectileDamage(ProjectileType type);
+// sprite de cada tipo en el AssetCache
+AssetId GetProjectileAssetId(ProjectileType type);
+
+// los proyectiles vivos, un arreglo por campo (structure of arrays). el slot i
+// de cada arreglo es el mismo proyectil. sacar uno mueve el ultimo a su lugar,
+// asi que no hay huecos ni corrimientos y el orden no se mantiene. los
+// arreglos solo crecen: una vez que llegaron al maximo de la partida, disparar
+// no pide memoria
+struct ProjectilePool {
+    std::vector<ProjectileType> type;
+    std::vector<float> x, y;             // posicion actual
+    std::vector<float> vx, vy;           // velocidad, calculada al disparar (va siempre en linea recta)
+    std::vector<float> speed;            // su modulo, para no volver a preguntarlo por tipo en cada paso
+
+    // el ultimo paso, para la colision barrida: salio de (prevX, prevY) y
+    // arranco a moverse stepStart segundos despues del inicio del paso
+    std::vector<float> prevX, prevY;
+    std::vector<float> stepStart;
+    std::vector<float> launchDelay;      // cuanto espera en la torre antes de salir (disparos dentro de un paso largo)
+    std::vector<uint8_t> leftMap;        // salio del mapa en el ultimo paso; se da de baja despues de barrer colisiones
+
+    // impacto agendado por el modo predictivo del gestor
+    std::vector<int32_t> hitEnemy;       // indice en el vector de enemigos, -1 = no le pega a nadie
+    std::vector<uint32_t> hitRevision;   // revision de movimiento de ese enemigo al predecir
+    std::vector<float> hitTime;          // reloj del gestor en el que le pega
+    std::vector<uint8_t> hitScheduled;   // 0 = todavia no se predijo
+
+    size_t Size() const { return x.size(); }
+    void Reserve(size_t count);
+    void Clear();
+
+    // agrega uno quieto en la torre; devuelve su slot
+    size_t Add(ProjectileType projectileType, float startX, float startY, float velocityX, float velocityY,
+               float projectileSpeed, float delay);
+
+    // saca el slot i pasando el ultimo a su lugar
+    void Remove(size_t i);
 };
 
 // Gestor de proyectiles
@@ -73,8 +74,9 @@ public:
     ProjectileManager();
     ~ProjectileManager();
 
-    // Añade un nuevo proyectil
-    void AddProjectile(ProjectileType type, int startRow, int startCol, int targetRow, int targetCol, int cellSize, float targetActualX = -1.0f, float targetActualY = -1.0f);
+    // Añade un nuevo proyectil. launchDelay: cuanto despues del inicio del
+    // proximo Update sale de la torre (varios disparos en un paso largo)
+    void AddProjectile(ProjectileType type, int startRow, int startCol, int targetRow, int targetCol, int cellSize, float targetActualX = -1.0f, float targetActualY = -1.0f, float launchDelay = 0.0f);
 
     // Dibuja todos los proyectiles
     void DrawProjectiles(HDC hdc);
@@ -82,12 +84,74 @@ public:
     // Actualiza todos los proyectiles
     void Update(float deltaTime, float mapWidth, float mapHeight);
     
-    // Comprueba colisiones con los objetivos dummy y devuelve los índices impactados
-    void CheckCollisions(std::vector<Enemy>& enemies, int cellSize, Economy& economy);
+    // Comprueba colisiones con los enemigos. es barrida: mira todo el tramo que
+    // hizo cada proyectil en el ultimo Update contra el movimiento del enemigo
+    // en ese mismo tiempo, asi que pasos grandes no atraviesan a nadie. los
+    // enemigos tienen que estar todavia al inicio del paso (se mueven despues).
+    // con enemyGrid (armado sobre el mismo vector) el modo todos contra todos
+    // solo mira a los enemigos cerca del tramo de cada proyectil y el
+    // predictivo, al predecir, solo a los que pueden cruzarse con su vuelo
+    void CheckCollisions(std::vector<Enemy>& enemies, int cellSize, Economy& economy, const SpatialHash* enemyGrid = nullptr);
     
-    // Obtiene la lista de proyectiles
-    const std::vector<Projectile*>& GetProjectiles() const { return projectiles; }
+    // proyectiles en vuelo
+    size_t GetProjectileCount() const { return pool.Size(); }
+    // lugar para count proyectiles a la vez, para no pedir memoria a mitad de oleada
+    void Reserve(size_t count) { pool.Reserve(count); }
+    const ProjectilePool& GetPool() const { return pool; }
+
+    // modo predictivo (prendido por defecto): el impacto de cada proyectil se
+    // calcula una vez al dispararlo con HitPredictor y CheckCollisions solo
+    // aplica los que ya llegaron. si el enemigo cambia de rumbo (jitter,
+    // waypoint) o muere, se vuelve a predecir. apagado es el loop de antes,
+    // todos los proyectiles contra todos los enemigos en cada frame
+    void SetPredictiveHits(bool enabled);
+    bool IsPredictiveHits() const { return predictiveHits; }
+
+    struct Stats {
+        unsigned long long predictions = 0;  // predicciones contra todos los enemigos
+        unsigned long long contactTests = 0; // pares proyectil-enemigo probados
+        unsigned long long hits = 0;         // impactos aplicados
+        unsigned long long fallbacks = 0;    // impactos agendados que no se cumplieron y se re-predijeron
+    };
+    const Stats& GetStats() const { return stats; }
+    void ResetStats() { stats = Stats(); }
 
 private:
-    std::vector<Projectile*> projectiles; // Lista de proyectiles activos
+    void CheckCollisionsBruteForce(std::vector<Enemy>& enemies, int cellSize, Economy& economy, const SpatialHash* enemyGrid);
+    void CheckCollisionsPredictive(std::vector<Enemy>& enemies, int cellSize, Economy& economy, const SpatialHash* enemyGrid);
+
+    // busca el primer enemigo que va a tocar el proyectil i y lo agenda
+    void PredictHit(size_t i, const std::vector<Enemy>& enemies, int cellSize, const SpatialHash* enemyGrid);
+    // cuanto falta, desde el inicio del ultimo paso, para que el proyectil i toque al enemigo index
+    bool ContactTime(size_t i, const std::vector<Enemy>& enemies, size_t index,
+                     int cellSize, float horizon, float& outTime);
+    // cuando sale del mapa (desde el inicio del ultimo paso), mas alla de eso no hay impacto
+    float TimeToLeaveMap(size_t i) const;
+    // aplica el daño del proyectil i; el que llama lo saca del pool
+    void ApplyHit(size_t i, Enemy& enemy, Economy& economy);
+
+    ProjectilePool pool;                  // proyectiles en vuelo
+
+    bool predictiveHits;
+    float clock;           // segundos acumulados en Update (fin del ultimo paso)
+    float lastDeltaTime;   // el inicio del ultimo paso es clock - lastDeltaTime
+    float lastMapWidth;    // limites del ultimo Update
+    float lastMapHeight;
+
+    // el vector de enemigos que conocemos: si cambia, los indices agendados no valen
+    const Enemy* trackedEnemies;
+    size_t trackedEnemyCount;
+    std::vector<uint32_t> enemyRevisions;
+    std::vector<size_t> changedEnemies;   // scratch: enemigos que cambiaron de rumbo este frame
+
+    // tramos de cada enemigo, armados a lo sumo una vez por frame y solo si hacen falta
+    std::vector<std::vector<MotionSegment>> enemySegments;
+    std::vector<unsigned> segmentFrame;
+    unsigned frame;
+
+    // enemigos ya probados en la prediccion actual (con grid un enemigo cae en varios tramos)
+    std::vector<unsigned> predictMark;
+    unsigned predictStamp;
+
+    Stats stats;
 }; 
\ No newline at end of file
@@ -0,0 +1,38 @@
+// tabla de rutas compartidas
+
+#include "RouteTable.h"
+#include "PathFinder.h"
+
+RouteTable::RouteTable(int cellSize)
+    : cellSize(cellSize)
+{
+}
+
+RouteHandle RouteTable::Intern(const std::vector<std::pair<int, int>>& cells)
+{
+    uint64_t hash = PathFinder::PathHash(cells);
+    for (const RouteHandle& route : routes) {
+        if (route->hash == hash && route->cells == cells) {
+            stats.reused++;
+            return route;
+        }
+    }
+    RouteHandle route = MakeRoute(cells, cellSize);
+    routes.push_back(route);
+    stats.created++;
+    return route;
+}
+
+RouteHandle RouteTable::MakeRoute(const std::vector<std::pair<int, int>>& cells, int cellSize)
+{
+    std::shared_ptr<Route> route = std::make_shared<Route>();
+    route->cells = cells;
+    route->points.reserve(cells.size());
+    float half = cellSize / 2.0f;
+    for (const auto& cell : cells) {
+        RoutePoint point = { static_cast<float>(cell.second * cellSize) + half, static_cast<float>(cell.first * cellSize) + half };
+        route->points.push_back(point);
+    }
+    route->hash = PathFinder::PathHash(cells);
+    return route;
+}
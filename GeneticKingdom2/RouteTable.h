@@ -0,0 +1,65 @@
+/*
+ * routetable.h - rutas compartidas e inmutables para los enemigos
+ *
+ * antes cada enemigo guardaba su propio vector con el camino, y como el GA
+ * copia enemigos a lo loco (constructor de copia, SetPath, ResetForNewWave,
+ * crossover, enemigos random) cada copia pedia memoria y copiaba un camino
+ * que era uno de los mismos 4 o 5 de siempre.
+ *
+ * ahora cada ruta distinta se guarda una sola vez, con los waypoints en
+ * celdas y ya convertidos a pixeles (centro de la celda), y los enemigos solo
+ * tienen un RouteHandle. copiar un enemigo es subir un contador, no copiar
+ * el camino. las rutas no se modifican nunca: si el camino cambia se crea
+ * otra, y la vieja vive mientras algun enemigo la siga usando.
+ */
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <memory>
+#include <cstdint>
+
+// waypoint en pixeles
+struct RoutePoint {
+    float x;
+    float y;
+};
+
+struct Route {
+    std::vector<std::pair<int, int>> cells; // waypoints en celdas (fila, columna)
+    std::vector<RoutePoint> points;         // los mismos waypoints en pixeles
+    uint64_t hash;
+
+    size_t Size() const { return cells.size(); }
+    bool Empty() const { return cells.empty(); }
+};
+
+typedef std::shared_ptr<const Route> RouteHandle;
+
+class RouteTable {
+public:
+    struct Stats {
+        unsigned long long created = 0; // rutas nuevas guardadas
+        unsigned long long reused = 0;  // pedidos que ya estaban en la tabla
+    };
+
+    explicit RouteTable(int cellSize);
+
+    // devuelve la ruta guardada con esas celdas, o la crea si no existe
+    RouteHandle Intern(const std::vector<std::pair<int, int>>& cells);
+
+    // olvida las rutas de la tabla (los enemigos que las usan las mantienen vivas)
+    void Clear() { routes.clear(); }
+    size_t Size() const { return routes.size(); }
+
+    const Stats& GetStats() const { return stats; }
+
+    // ruta suelta, fuera de cualquier tabla
+    static RouteHandle MakeRoute(const std::vector<std::pair<int, int>>& cells, int cellSize);
+
+private:
+    int cellSize;
+    std::vector<RouteHandle> routes; // son pocas, busqueda lineal por hash
+    Stats stats;
+};
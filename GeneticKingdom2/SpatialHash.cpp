@@ -0,0 +1,80 @@
+// grid uniforme de puntos
+
+#include "SpatialHash.h"
+#include <algorithm>
+#include <cmath>
+
+SpatialHash::SpatialHash()
+    : rows(0), cols(0), inverseBucketSize(1.0f), maxSpeed(0.0f)
+{
+}
+
+void SpatialHash::Resize(float width, float height, float bucketSize)
+{
+    if (bucketSize <= 0.0f) {
+        bucketSize = 1.0f;
+    }
+    inverseBucketSize = 1.0f / bucketSize;
+    cols = (std::max)(1, static_cast<int>(std::ceil(width / bucketSize)));
+    rows = (std::max)(1, static_cast<int>(std::ceil(height / bucketSize)));
+    bucketStart.assign(static_cast<size_t>(rows) * static_cast<size_t>(cols) + 1, 0);
+    sortedIndex.clear();
+    sortedX.clear();
+    sortedY.clear();
+}
+
+bool SpatialHash::BeginBuild()
+{
+    stats.builds++;
+    pointBucket.clear();
+    pointX.clear();
+    pointY.clear();
+    pointIndex.clear();
+
+    const size_t bucketCount = static_cast<size_t>(rows) * static_cast<size_t>(cols);
+    bucketStart.assign(bucketCount + 1, 0);
+    if (bucketCount == 0) {
+        sortedIndex.clear();
+        sortedX.clear();
+        sortedY.clear();
+        return false;
+    }
+    return true;
+}
+
+void SpatialHash::Build(size_t count, const uint32_t* indices, const float* xs, const float* ys)
+{
+    if (!BeginBuild()) {
+        return;
+    }
+    for (size_t k = 0; k < count; ++k) {
+        AddPoint(indices[k], xs[k], ys[k]);
+    }
+    FinishBuild();
+}
+
+void SpatialHash::FinishBuild()
+{
+    // prefijo: donde empieza cada balde
+    const size_t bucketCount = static_cast<size_t>(rows) * static_cast<size_t>(cols);
+    for (size_t b = 0; b < bucketCount; ++b) {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+
+    // repartir (estable: dentro de un balde quedan en el orden en que llegaron)
+    const size_t placed = pointIndex.size();
+    sortedIndex.resize(placed);
+    sortedX.resize(placed);
+    sortedY.resize(placed);
+    for (size_t p = 0; p < placed; ++p) {
+        uint32_t slot = bucketStart[pointBucket[p]]++;
+        sortedIndex[slot] = pointIndex[p];
+        sortedX[slot] = pointX[p];
+        sortedY[slot] = pointY[p];
+    }
+    // el reparto corrio cada inicio hasta el final de su balde; volver atras
+    for (size_t b = bucketCount; b > 0; --b) {
+        bucketStart[b] = bucketStart[b - 1];
+    }
+    bucketStart[0] = 0;
+}
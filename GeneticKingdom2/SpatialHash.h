@@ -0,0 +1,150 @@
+/*
+ * spatialhash.h - grid uniforme de puntos para "quien esta cerca de aca"
+ *
+ * las torres buscan al enemigo mas cercano en rango y los proyectiles a quien
+ * tocan; recorrer todos los enemigos para cada una es O(torres * enemigos) por
+ * frame. esto arma una vez por tick un grid de baldes del tamaño de una celda
+ * con un counting sort: se cuenta cuantos caen en cada balde, prefijo, y se
+ * copian ordenados por balde a arreglos planos (indice, x, y). una fila de
+ * baldes queda contigua en memoria, asi que una consulta por radio recorre
+ * unos pocos tramos seguidos en vez de saltar entre listas.
+ *
+ * los puntos fuera de los limites caen en el balde del borde, la prueba de
+ * distancia es exacta igual.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+class SpatialHash {
+public:
+    struct Stats {
+        unsigned long long builds = 0;   // veces que se armo
+        unsigned long long queries = 0;  // consultas por radio
+        unsigned long long visited = 0;  // puntos mirados por esas consultas
+    };
+
+    SpatialHash();
+
+    // area cubierta en pixeles y lado de cada balde
+    void Resize(float width, float height, float bucketSize);
+
+    // arma el grid con count puntos. getPosition(i, x, y) devuelve false para
+    // dejar afuera el punto i (por ejemplo un enemigo muerto)
+    template <typename GetPosition>
+    void Build(size_t count, GetPosition getPosition);
+
+    // lo mismo desde arreglos planos ya filtrados (la copia de TargetKernel):
+    // el punto k es el indice indices[k] en (xs[k], ys[k])
+    void Build(size_t count, const uint32_t* indices, const float* xs, const float* ys);
+
+    // lo mas rapido que se mueve un punto del grid, en pixeles por segundo.
+    // lo pone quien lo arma; sirve para agrandar una consulta que mira a futuro
+    void SetMaxSpeed(float speed) { maxSpeed = speed; }
+    float GetMaxSpeed() const { return maxSpeed; }
+
+    size_t GetCount() const { return sortedIndex.size(); }
+
+    // llama visit(indice, x, y, distanciaAlCuadrado) para cada punto a radius
+    // o menos de (x, y). el orden es por balde, no por indice
+    template <typename Visit>
+    void ForEachInRadius(float x, float y, float radius, Visit visit) const;
+
+    const Stats& GetStats() const { return stats; }
+    void ResetStats() { stats = Stats(); }
+
+private:
+    int BucketColumn(float x) const;
+    int BucketRow(float y) const;
+
+    // armado en tres partes: BeginBuild (false si no hay baldes), AddPoint por
+    // cada punto y FinishBuild, que hace el prefijo y el reparto
+    bool BeginBuild();
+    void AddPoint(uint32_t index, float x, float y);
+    void FinishBuild();
+
+    int rows;
+    int cols;
+    float inverseBucketSize;
+    float maxSpeed;
+
+    std::vector<uint32_t> bucketStart;  // rows * cols + 1; el balde b va de bucketStart[b] a bucketStart[b + 1]
+    std::vector<uint32_t> sortedIndex;  // puntos ordenados por balde
+    std::vector<float> sortedX;
+    std::vector<float> sortedY;
+
+    // scratch del armado
+    std::vector<uint32_t> pointBucket;
+    std::vector<float> pointX;
+    std::vector<float> pointY;
+    std::vector<uint32_t> pointIndex;
+
+    mutable Stats stats;
+};
+
+inline int SpatialHash::BucketColumn(float x) const {
+    int c = static_cast<int>(x * inverseBucketSize);
+    return c < 0 ? 0 : (c >= cols ? cols - 1 : c);
+}
+
+inline int SpatialHash::BucketRow(float y) const {
+    int r = static_cast<int>(y * inverseBucketSize);
+    return r < 0 ? 0 : (r >= rows ? rows - 1 : r);
+}
+
+inline void SpatialHash::AddPoint(uint32_t index, float x, float y) {
+    uint32_t bucket = static_cast<uint32_t>(BucketRow(y) * cols + BucketColumn(x));
+    pointBucket.push_back(bucket);
+    pointX.push_back(x);
+    pointY.push_back(y);
+    pointIndex.push_back(index);
+    bucketStart[bucket + 1]++;
+}
+
+template <typename GetPosition>
+void SpatialHash::Build(size_t count, GetPosition getPosition)
+{
+    if (!BeginBuild()) {
+        return;
+    }
+    // contar
+    for (size_t i = 0; i < count; ++i) {
+        float x, y;
+        if (getPosition(i, x, y)) {
+            AddPoint(static_cast<uint32_t>(i), x, y);
+        }
+    }
+    FinishBuild();
+}
+
+template <typename Visit>
+void SpatialHash::ForEachInRadius(float x, float y, float radius, Visit visit) const
+{
+    stats.queries++;
+    if (sortedIndex.empty() || radius < 0.0f) {
+        return;
+    }
+    const int c0 = BucketColumn(x - radius);
+    const int c1 = BucketColumn(x + radius);
+    const int r0 = BucketRow(y - radius);
+    const int r1 = BucketRow(y + radius);
+    const float radiusSq = radius * radius;
+
+    for (int r = r0; r <= r1; ++r) {
+        // los baldes c0..c1 de una fila son un solo tramo de los arreglos
+        const uint32_t begin = bucketStart[r * cols + c0];
+        const uint32_t end = bucketStart[r * cols + c1 + 1];
+        stats.visited += end - begin;
+        for (uint32_t k = begin; k < end; ++k) {
+            const float dx = sortedX[k] - x;
+            const float dy = sortedY[k] - y;
+            const float distSq = dx * dx + dy * dy;
+            if (distSq <= radiusSq) {
+                visit(sortedIndex[k], sortedX[k], sortedY[k], distSq);
+            }
+        }
+    }
+}
@@ -0,0 +1,124 @@
+// estimador de supervivencia sobre el raster de amenaza
+
+#include "SurrogateFitness.h"
+#include <cmath>
+
+int SurrogateEvaluator::AddRoute(const Route& route, const ThreatMap& threat, int cellSize)
+{
+    profiles.emplace_back();
+    Profile& profile = profiles.back();
+    stats.profiles++;
+    if (route.points.empty()) {
+        return static_cast<int>(profiles.size()) - 1;
+    }
+
+    float traveled = 0.0f;
+    float accumulated[THREAT_CHANNEL_COUNT] = { 0.0f, 0.0f, 0.0f };
+    float previousThreat[THREAT_CHANNEL_COUNT];
+    auto push = [&](float px, float py) {
+        profile.distance.push_back(traveled);
+        profile.x.push_back(px);
+        profile.y.push_back(py);
+        for (int ch = 0; ch < THREAT_CHANNEL_COUNT; ++ch) {
+            profile.exposure[ch].push_back(accumulated[ch]);
+        }
+    };
+    auto sample = [&](float px, float py, float* out) {
+        int row = static_cast<int>(py / cellSize);
+        int col = static_cast<int>(px / cellSize);
+        for (int ch = 0; ch < THREAT_CHANNEL_COUNT; ++ch) {
+            out[ch] = threat.Get(static_cast<ThreatChannel>(ch), row, col);
+        }
+    };
+
+    sample(route.points[0].x, route.points[0].y, previousThreat);
+    push(route.points[0].x, route.points[0].y);
+
+    // cada tramo en pasos de a lo sumo SAMPLE_SPACING, integrando por trapecios
+    for (size_t i = 1; i < route.points.size(); ++i) {
+        const RoutePoint& from = route.points[i - 1];
+        const RoutePoint& to = route.points[i];
+        float dx = to.x - from.x;
+        float dy = to.y - from.y;
+        float length = std::sqrt(dx * dx + dy * dy);
+        int steps = static_cast<int>(std::ceil(length / SAMPLE_SPACING));
+        if (steps < 1) steps = 1;
+        float stepLength = length / steps;
+
+        for (int s = 1; s <= steps; ++s) {
+            float t = static_cast<float>(s) / steps;
+            float px = from.x + dx * t;
+            float py = from.y + dy * t;
+            float currentThreat[THREAT_CHANNEL_COUNT];
+            sample(px, py, currentThreat);
+            for (int ch = 0; ch < THREAT_CHANNEL_COUNT; ++ch) {
+                accumulated[ch] += 0.5f * (previousThreat[ch] + currentThreat[ch]) * stepLength;
+                previousThreat[ch] = currentThreat[ch];
+            }
+            traveled += stepLength;
+            push(px, py);
+        }
+    }
+    return static_cast<int>(profiles.size()) - 1;
+}
+
+SurrogateOutcome SurrogateEvaluator::Evaluate(const SurrogateGenome& genome, int routeIndex) const
+{
+    stats.evaluations++;
+    const Profile& profile = profiles[routeIndex];
+    SurrogateOutcome outcome = { 0.0f, 0.0f, false, 0.0f, 0.0f };
+    if (profile.distance.empty() || genome.speed <= 0.0f) {
+        return outcome;
+    }
+
+    // daño acumulado hasta la muestra i, sin dividir por la velocidad: se
+    // compara contra health * speed y nos ahorramos la division en el loop
+    const float ra = genome.resistance[THREAT_ARROW];
+    const float rm = genome.resistance[THREAT_MAGIC];
+    const float rt = genome.resistance[THREAT_ARTILLERY];
+    const float* ea = profile.exposure[THREAT_ARROW].data();
+    const float* em = profile.exposure[THREAT_MAGIC].data();
+    const float* et = profile.exposure[THREAT_ARTILLERY].data();
+    auto damageAt = [=](size_t i) { return ra * ea[i] + rm * em[i] + rt * et[i]; };
+    const float lethal = genome.health * genome.speed;
+
+    const size_t last = profile.distance.size() - 1;
+    if (damageAt(last) < lethal) {
+        outcome.reachedBridge = true;
+        outcome.distance = profile.distance[last];
+        outcome.x = profile.x[last];
+        outcome.y = profile.y[last];
+        outcome.survivalTime = outcome.distance / genome.speed;
+        return outcome;
+    }
+
+    // primera muestra donde ya esta muerto
+    size_t lo = 0;
+    size_t hi = last;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (damageAt(mid) >= lethal) hi = mid;
+        else lo = mid + 1;
+    }
+
+    // interpolar dentro del tramo entre la muestra anterior y esa
+    float t = 1.0f;
+    if (lo > 0) {
+        float before = damageAt(lo - 1);
+        float after = damageAt(lo);
+        if (after > before) t = (lethal - before) / (after - before);
+    }
+    size_t prev = lo > 0 ? lo - 1 : 0;
+    outcome.distance = profile.distance[prev] + (profile.distance[lo] - profile.distance[prev]) * t;
+    outcome.x = profile.x[prev] + (profile.x[lo] - profile.x[prev]) * t;
+    outcome.y = profile.y[prev] + (profile.y[lo] - profile.y[prev]) * t;
+    outcome.survivalTime = outcome.distance / genome.speed;
+    return outcome;
+}
+
+void SurrogateEvaluator::EvaluateBatch(const SurrogateGenome* genomes, size_t count, int routeIndex, SurrogateOutcome* out) const
+{
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = Evaluate(genomes[i], routeIndex);
+    }
+}
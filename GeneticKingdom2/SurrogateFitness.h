@@ -0,0 +1,81 @@
+/*
+ * surrogatefitness.h - fitness estimado sin jugar la oleada
+ *
+ * el fitness de verdad (Enemy::CalculateFitness) solo se sabe cuando termina
+ * una oleada en tiempo real, y da una sola muestra ruidosa por enemigo. esto
+ * estima lo mismo a mano: camina cada ruta de a poquito sobre el ThreatMap y
+ * acumula, por canal, la integral de la amenaza a lo largo del camino (dps *
+ * pixeles). un enemigo con velocidad v y resistencias r recibe hasta la
+ * distancia d
+ *
+ *     daño(d) = (r_flecha * E_flecha(d) + r_magia * E_magia(d) + r_art * E_art(d)) / v
+ *
+ * que nunca baja con d, asi que el punto donde muere sale con una busqueda
+ * binaria sobre las muestras. armar el perfil de una ruta es lineal en su
+ * largo y se hace una vez por oleada; despues cada genoma cuesta O(log n).
+ *
+ * lo que no ve: que las torres reparten los disparos entre varios enemigos,
+ * los proyectiles que fallan y el jitter del movimiento. sirve para ordenar
+ * candidatos, no para predecir el numero exacto.
+ */
+
+#pragma once
+
+#include "ThreatMap.h"
+#include "RouteTable.h"
+#include <vector>
+#include <cstddef>
+
+// lo que le importa al estimador de un enemigo
+struct SurrogateGenome {
+    float health;
+    float speed;                             // pixeles por segundo
+    float resistance[THREAT_CHANNEL_COUNT];  // multiplicador de daño por clase
+};
+
+struct SurrogateOutcome {
+    float survivalTime;  // segundos hasta morir o llegar al puente
+    float distance;      // pixeles recorridos sobre la ruta
+    bool reachedBridge;
+    float x;             // donde termino, en pixeles
+    float y;
+};
+
+class SurrogateEvaluator {
+public:
+    struct Stats {
+        unsigned long long profiles = 0;    // rutas muestreadas
+        unsigned long long evaluations = 0; // genomas evaluados
+    };
+
+    // pixeles entre muestras al caminar una ruta
+    static const int SAMPLE_SPACING = 10;
+
+    // olvida los perfiles (por ejemplo porque cambiaron las torres)
+    void ClearRoutes() { profiles.clear(); }
+
+    // muestrea la ruta sobre la amenaza actual. devuelve su indice
+    int AddRoute(const Route& route, const ThreatMap& threat, int cellSize);
+    int GetRouteCount() const { return static_cast<int>(profiles.size()); }
+
+    SurrogateOutcome Evaluate(const SurrogateGenome& genome, int routeIndex) const;
+
+    // lo mismo para muchos genomas sobre la misma ruta
+    void EvaluateBatch(const SurrogateGenome* genomes, size_t count, int routeIndex, SurrogateOutcome* out) const;
+
+    const Stats& GetStats() const { return stats; }
+    void ResetStats() { stats = Stats(); }
+
+private:
+    // muestras de una ruta: distancia acumulada, posicion y exposicion
+    // acumulada por canal hasta cada una
+    struct Profile {
+        std::vector<float> distance;
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> exposure[THREAT_CHANNEL_COUNT];
+    };
+
+    std::vector<Profile> profiles;
+    mutable Stats stats;
+};
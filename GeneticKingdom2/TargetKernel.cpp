@@ -0,0 +1,216 @@
+// busqueda de objetivo sobre arreglos planos, con simd si hay
+
+#include "TargetKernel.h"
+#include <algorithm>
+#include <cfloat>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define TARGET_KERNEL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// msvc deja usar intrinsics de avx2 en cualquier funcion; gcc/clang piden marcarla
+#if defined(TARGET_KERNEL_X86) && (defined(__GNUC__) || defined(__clang__))
+#define TARGET_KERNEL_AVX2_FUNCTION __attribute__((target("avx2")))
+#else
+#define TARGET_KERNEL_AVX2_FUNCTION
+#endif
+
+// carriles por query (los de avx2; sse2 usa los primeros 4 y escalar el primero)
+const size_t KERNEL_LANES = 8;
+
+// enemigos por tanda: 1024 * 12 bytes entran comodos en la cache l1
+const size_t KERNEL_BLOCK = 1024;
+
+// posicion de relleno: la distancia da infinito y nunca queda a tiro
+const float KERNEL_FAR_AWAY = 1e30f;
+
+namespace {
+
+void ScanScalar(const float* xs, const float* ys, const uint32_t* flyingMask, size_t begin, size_t end,
+                const TargetKernel::Query& query, float* laneDistance, int32_t* laneSlot)
+{
+    const uint32_t skip = query.skipFlying ? 0xffffffffu : 0u;
+    float best = laneDistance[0];
+    int32_t bestSlot = laneSlot[0];
+    for (size_t i = begin; i < end; ++i) {
+        const float dx = xs[i] - query.x;
+        const float dy = ys[i] - query.y;
+        const float d = dx * dx + dy * dy;
+        if (d <= query.rangeSq && d < best && !(flyingMask[i] & skip)) {
+            best = d;
+            bestSlot = static_cast<int32_t>(i);
+        }
+    }
+    laneDistance[0] = best;
+    laneSlot[0] = bestSlot;
+}
+
+#if defined(TARGET_KERNEL_X86)
+
+void ScanSse2(const float* xs, const float* ys, const uint32_t* flyingMask, size_t begin, size_t end,
+              const TargetKernel::Query& query, float* laneDistance, int32_t* laneSlot)
+{
+    const __m128 qx = _mm_set1_ps(query.x);
+    const __m128 qy = _mm_set1_ps(query.y);
+    const __m128 rangeSq = _mm_set1_ps(query.rangeSq);
+    const __m128i skip = _mm_set1_epi32(query.skipFlying ? -1 : 0);
+    const __m128i step = _mm_set1_epi32(4);
+    __m128 best = _mm_loadu_ps(laneDistance);
+    __m128i bestSlot = _mm_loadu_si128(reinterpret_cast<const __m128i*>(laneSlot));
+    __m128i slot = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(begin)), _mm_setr_epi32(0, 1, 2, 3));
+
+    for (size_t i = begin; i < end; i += 4) {
+        const __m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + i), qx);
+        const __m128 dy = _mm_sub_ps(_mm_loadu_ps(ys + i), qy);
+        const __m128 d = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        const __m128i blocked = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(flyingMask + i)), skip);
+        __m128 take = _mm_and_ps(_mm_cmple_ps(d, rangeSq), _mm_cmplt_ps(d, best));
+        take = _mm_andnot_ps(_mm_castsi128_ps(blocked), take);
+        const __m128i takeInt = _mm_castps_si128(take);
+        best = _mm_or_ps(_mm_and_ps(take, d), _mm_andnot_ps(take, best));
+        bestSlot = _mm_or_si128(_mm_and_si128(takeInt, slot), _mm_andnot_si128(takeInt, bestSlot));
+        slot = _mm_add_epi32(slot, step);
+    }
+    _mm_storeu_ps(laneDistance, best);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(laneSlot), bestSlot);
+}
+
+TARGET_KERNEL_AVX2_FUNCTION
+void ScanAvx2(const float* xs, const float* ys, const uint32_t* flyingMask, size_t begin, size_t end,
+              const TargetKernel::Query& query, float* laneDistance, int32_t* laneSlot)
+{
+    const __m256 qx = _mm256_set1_ps(query.x);
+    const __m256 qy = _mm256_set1_ps(query.y);
+    const __m256 rangeSq = _mm256_set1_ps(query.rangeSq);
+    const __m256i skip = _mm256_set1_epi32(query.skipFlying ? -1 : 0);
+    const __m256i step = _mm256_set1_epi32(8);
+    __m256 best = _mm256_loadu_ps(laneDistance);
+    __m256i bestSlot = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(laneSlot));
+    __m256i slot = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(begin)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+
+    for (size_t i = begin; i < end; i += 8) {
+        const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs + i), qx);
+        const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ys + i), qy);
+        const __m256 d = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+        const __m256i blocked = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(flyingMask + i)), skip);
+        __m256 take = _mm256_and_ps(_mm256_cmp_ps(d, rangeSq, _CMP_LE_OQ), _mm256_cmp_ps(d, best, _CMP_LT_OQ));
+        take = _mm256_andnot_ps(_mm256_castsi256_ps(blocked), take);
+        best = _mm256_blendv_ps(best, d, take);
+        bestSlot = _mm256_blendv_epi8(bestSlot, slot, _mm256_castps_si256(take));
+        slot = _mm256_add_epi32(slot, step);
+    }
+    _mm256_storeu_ps(laneDistance, best);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(laneSlot), bestSlot);
+}
+
+#endif
+
+} // namespace
+
+TargetKernel::TargetKernel()
+    : path(BestPath()), count(0)
+{
+}
+
+TargetKernel::Path TargetKernel::BestPath()
+{
+#if defined(TARGET_KERNEL_X86)
+#if defined(_MSC_VER)
+    int info[4] = { 0, 0, 0, 0 };
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const bool sse2 = (info[3] & (1 << 26)) != 0;
+    // avx necesita que el sistema guarde los registros ymm (osxsave + xgetbv)
+    const bool osSavesAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+    if (maxLeaf >= 7 && osSavesAvx) {
+        __cpuidex(info, 7, 0);
+        if (info[1] & (1 << 5)) {
+            return Path::AVX2;
+        }
+    }
+    return sse2 ? Path::SSE2 : Path::SCALAR;
+#else
+    if (__builtin_cpu_supports("avx2")) {
+        return Path::AVX2;
+    }
+    return __builtin_cpu_supports("sse2") ? Path::SSE2 : Path::SCALAR;
+#endif
+#else
+    return Path::SCALAR;
+#endif
+}
+
+void TargetKernel::SetPath(Path newPath)
+{
+    const Path best = BestPath();
+    path = static_cast<int>(newPath) <= static_cast<int>(best) ? newPath : best;
+}
+
+void TargetKernel::Append(uint32_t index, float x, float y, bool flying)
+{
+    xs.push_back(x);
+    ys.push_back(y);
+    flyingMask.push_back(flying ? 0xffffffffu : 0u);
+    indices.push_back(index);
+    count++;
+}
+
+void TargetKernel::Pad()
+{
+    while (xs.size() % KERNEL_LANES != 0) {
+        xs.push_back(KERNEL_FAR_AWAY);
+        ys.push_back(KERNEL_FAR_AWAY);
+        flyingMask.push_back(0u);
+        indices.push_back(0u);
+    }
+}
+
+void TargetKernel::FindNearest(const Query* queries, size_t queryCount, int32_t* outIndex)
+{
+    stats.queries += queryCount;
+    stats.pairs += static_cast<unsigned long long>(queryCount) * count;
+    laneDistance.assign(queryCount * KERNEL_LANES, FLT_MAX);
+    laneSlot.assign(queryCount * KERNEL_LANES, -1);
+
+    const size_t padded = xs.size();
+    for (size_t begin = 0; begin < padded; begin += KERNEL_BLOCK) {
+        const size_t end = (std::min)(padded, begin + KERNEL_BLOCK);
+        for (size_t q = 0; q < queryCount; ++q) {
+            float* distance = &laneDistance[q * KERNEL_LANES];
+            int32_t* slot = &laneSlot[q * KERNEL_LANES];
+            switch (path) {
+#if defined(TARGET_KERNEL_X86)
+            case Path::AVX2:
+                ScanAvx2(xs.data(), ys.data(), flyingMask.data(), begin, end, queries[q], distance, slot);
+                break;
+            case Path::SSE2:
+                ScanSse2(xs.data(), ys.data(), flyingMask.data(), begin, end, queries[q], distance, slot);
+                break;
+#endif
+            default:
+                ScanScalar(xs.data(), ys.data(), flyingMask.data(), begin, end, queries[q], distance, slot);
+                break;
+            }
+        }
+    }
+
+    // juntar carriles: el mas cercano, y si empatan el de menor slot (= menor indice)
+    for (size_t q = 0; q < queryCount; ++q) {
+        float best = FLT_MAX;
+        int32_t bestSlot = -1;
+        for (size_t lane = 0; lane < KERNEL_LANES; ++lane) {
+            const float d = laneDistance[q * KERNEL_LANES + lane];
+            const int32_t slot = laneSlot[q * KERNEL_LANES + lane];
+            if (slot >= 0 && (bestSlot < 0 || d < best || (d == best && slot < bestSlot))) {
+                best = d;
+                bestSlot = slot;
+            }
+        }
+        outIndex[q] = bestSlot >= 0 ? static_cast<int32_t>(indices[bestSlot]) : -1;
+    }
+}
@@ -0,0 +1,108 @@
+/*
+ * targetkernel.h - enemigo mas cercano a tiro para muchas torres de una vez
+ *
+ * buscar objetivo leyendo cada Enemy (ruta, imagen, resistencias, decenas de
+ * campos) trae una linea de cache entera por enemigo para usar dos floats y
+ * dos bools. aca se copia una vez por tick lo que hace falta a arreglos
+ * planos (x, y, mascara de volador, indice original) y la busqueda recorre
+ * eso con avx2, sse2 o en escalar segun lo que tenga el procesador.
+ *
+ * las torres se procesan por tandas de enemigos: un bloque de enemigos queda
+ * en cache mientras pasan todas las torres. cada carril se queda con el mas
+ * cercano que vio (el primero si empatan) y al final se juntan los carriles,
+ * asi que el resultado es el mismo con cualquier camino: el mas cercano, y a
+ * igual distancia el de menor indice.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+class TargetKernel {
+public:
+    enum class Path {
+        SCALAR,
+        SSE2,
+        AVX2
+    };
+
+    // una torre: centro, rango al cuadrado (pixeles) y si no le tira a voladores
+    struct Query {
+        float x;
+        float y;
+        float rangeSq;
+        bool skipFlying;
+    };
+
+    struct Stats {
+        unsigned long long builds = 0;   // snapshots armados
+        unsigned long long queries = 0;  // torres resueltas
+        unsigned long long pairs = 0;    // distancias torre-enemigo calculadas
+    };
+
+    TargetKernel();
+
+    // copia count enemigos. getEnemy(i, x, y, flying) devuelve false para
+    // dejar afuera al enemigo i (muerto, inactivo)
+    template <typename GetEnemy>
+    void Build(size_t count, GetEnemy getEnemy);
+
+    size_t GetCount() const { return count; }
+
+    // la copia del ultimo Build: el enemigo k es el indice GetIndices()[k] en
+    // (GetXs()[k], GetYs()[k]), por indice creciente
+    const uint32_t* GetIndices() const { return indices.data(); }
+    const float* GetXs() const { return xs.data(); }
+    const float* GetYs() const { return ys.data(); }
+
+    // para cada query, el indice original del enemigo mas cercano a tiro o -1
+    void FindNearest(const Query* queries, size_t queryCount, int32_t* outIndex);
+
+    // el mejor camino que soporta este procesador
+    static Path BestPath();
+    Path GetPath() const { return path; }
+    // si el procesador no lo soporta se queda con el mejor que si
+    void SetPath(Path newPath);
+
+    const Stats& GetStats() const { return stats; }
+    void ResetStats() { stats = Stats(); }
+
+private:
+    void Append(uint32_t index, float x, float y, bool flying);
+    void Pad();
+
+    Path path;
+    size_t count;                   // enemigos reales; los arreglos van rellenos hasta multiplo de 8
+
+    std::vector<float> xs;
+    std::vector<float> ys;
+    std::vector<uint32_t> flyingMask;  // 0xffffffff si vuela
+    std::vector<uint32_t> indices;     // indice en el vector original
+
+    // scratch de FindNearest: 8 carriles por query
+    std::vector<float> laneDistance;
+    std::vector<int32_t> laneSlot;
+
+    Stats stats;
+};
+
+template <typename GetEnemy>
+void TargetKernel::Build(size_t enemyCount, GetEnemy getEnemy)
+{
+    stats.builds++;
+    count = 0;
+    xs.clear();
+    ys.clear();
+    flyingMask.clear();
+    indices.clear();
+    for (size_t i = 0; i < enemyCount; ++i) {
+        float x, y;
+        bool flying;
+        if (getEnemy(i, x, y, flying)) {
+            Append(static_cast<uint32_t>(i), x, y, flying);
+        }
+    }
+    Pad();
+}
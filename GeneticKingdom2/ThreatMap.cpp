@@ -0,0 +1,106 @@
+// raster de amenaza por celda
+
+#include "ThreatMap.h"
+#include <algorithm>
+#include <cmath>
+
+ThreatMap::ThreatMap()
+    : rows(0), cols(0)
+{
+    for (int i = 0; i < THREAT_CHANNEL_COUNT; ++i) {
+        weights[i] = 1.0f;
+    }
+}
+
+void ThreatMap::Resize(int newRows, int newCols)
+{
+    rows = newRows > 0 ? newRows : 0;
+    cols = newCols > 0 ? newCols : 0;
+    size_t cellCount = static_cast<size_t>(rows) * static_cast<size_t>(cols);
+    for (int i = 0; i < THREAT_CHANNEL_COUNT; ++i) {
+        channels[i].assign(cellCount, 0.0f);
+    }
+    combined.assign(cellCount, 0.0f);
+}
+
+void ThreatMap::Clear()
+{
+    for (int i = 0; i < THREAT_CHANNEL_COUNT; ++i) {
+        std::fill(channels[i].begin(), channels[i].end(), 0.0f);
+    }
+    std::fill(combined.begin(), combined.end(), 0.0f);
+}
+
+void ThreatMap::AddDisc(ThreatChannel channel, int row, int col, int range, float dps)
+{
+    if (range < 0 || dps == 0.0f || rows == 0 || cols == 0) {
+        return;
+    }
+
+    // ancho del disco en cada fila, en enteros para que sumar y restar el
+    // mismo disco toque exactamente las mismas celdas
+    halfWidth.resize(range + 1);
+    for (int dr = 0; dr <= range; ++dr) {
+        int w = static_cast<int>(std::sqrt(static_cast<float>(range * range - dr * dr)));
+        while (w * w + dr * dr > range * range) w--;
+        while ((w + 1) * (w + 1) + dr * dr <= range * range) w++;
+        halfWidth[dr] = w;
+    }
+
+    const float weighted = dps * weights[channel];
+    const int firstRow = (std::max)(row - range, 0);
+    const int lastRow = (std::min)(row + range, rows - 1);
+    for (int r = firstRow; r <= lastRow; ++r) {
+        int w = halfWidth[r > row ? r - row : row - r];
+        int c0 = (std::max)(col - w, 0);
+        int c1 = (std::min)(col + w, cols - 1);
+        if (c0 > c1) {
+            continue;
+        }
+
+        // tramo contiguo, sin ramas: se vectoriza. el max con 0 se come el
+        // redondeo de restar una torre (que no quede amenaza negativa)
+        float* channelRow = channels[channel].data() + r * cols;
+        float* combinedRow = combined.data() + r * cols;
+        for (int c = c0; c <= c1; ++c) {
+            channelRow[c] = (std::max)(channelRow[c] + dps, 0.0f);
+            combinedRow[c] = (std::max)(combinedRow[c] + weighted, 0.0f);
+        }
+        stats.cellsTouched += c1 - c0 + 1;
+    }
+    stats.discUpdates++;
+}
+
+// cambiar los pesos obliga a rearmar el combinado entero, pero es una pasada
+// lineal y pasa una vez por oleada como mucho
+void ThreatMap::SetChannelWeights(const float newWeights[THREAT_CHANNEL_COUNT])
+{
+    bool changed = false;
+    for (int i = 0; i < THREAT_CHANNEL_COUNT; ++i) {
+        changed = changed || weights[i] != newWeights[i];
+        weights[i] = newWeights[i];
+    }
+    if (!changed) {
+        return;
+    }
+
+    const size_t cellCount = combined.size();
+    const float* arrow = channels[THREAT_ARROW].data();
+    const float* magic = channels[THREAT_MAGIC].data();
+    const float* artillery = channels[THREAT_ARTILLERY].data();
+    float* out = combined.data();
+    for (size_t i = 0; i < cellCount; ++i) {
+        out[i] = arrow[i] * weights[THREAT_ARROW] + magic[i] * weights[THREAT_MAGIC] +
+                 artillery[i] * weights[THREAT_ARTILLERY];
+    }
+    stats.reweights++;
+}
+
+float ThreatMap::GetMaxCombined() const
+{
+    float maxThreat = 0.0f;
+    for (float threat : combined) {
+        maxThreat = (std::max)(maxThreat, threat);
+    }
+    return maxThreat;
+}
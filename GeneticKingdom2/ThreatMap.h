@@ -0,0 +1,84 @@
+/*
+ * threatmap.h - cuanto daño por segundo cae en cada celda
+ *
+ * cada torre cubre un disco de GetRange() celdas y hace GetDamage() *
+ * GetAttackSpeed() de daño por segundo ahi adentro. este raster guarda la
+ * suma de todas las torres por celda, con un canal por clase de daño (flechas,
+ * magia, artilleria) porque cada enemigo resiste distinto cada una.
+ *
+ * al poner o mejorar una torre solo se toca su disco: fila por fila se saca
+ * el tramo [c0, c1] que cae adentro y se le suma el dps. son sumas sobre
+ * floats contiguos sin ramas, asi que el compilador las vectoriza solo.
+ * mejorar = restar el disco viejo y sumar el nuevo.
+ *
+ * ademas de los canales hay un raster combinado (suma de canales por un peso
+ * cada uno, por ejemplo las resistencias de un tipo de enemigo) que es el que
+ * usa el PathFinder como costo extra por celda para buscar la ruta que menos
+ * duele.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+enum ThreatChannel {
+    THREAT_ARROW,      // arqueros
+    THREAT_MAGIC,      // magos
+    THREAT_ARTILLERY,  // cañones
+    THREAT_CHANNEL_COUNT
+};
+
+class ThreatMap {
+public:
+    struct Stats {
+        unsigned long long discUpdates = 0;  // discos sumados o restados
+        unsigned long long cellsTouched = 0; // celdas escritas por esos discos
+        unsigned long long reweights = 0;    // rearmados del combinado por cambio de pesos
+    };
+
+    ThreatMap();
+
+    // dimensiona y deja todo en cero
+    void Resize(int rows, int cols);
+    void Clear();
+
+    int GetRows() const { return rows; }
+    int GetCols() const { return cols; }
+
+    // suma dps a todas las celdas a distancia <= range (en celdas, centro a
+    // centro) de (row, col). con dps negativo lo quita
+    void AddDisc(ThreatChannel channel, int row, int col, int range, float dps);
+
+    // pesos del combinado, uno por canal (por defecto 1)
+    void SetChannelWeights(const float weights[THREAT_CHANNEL_COUNT]);
+    float GetChannelWeight(ThreatChannel channel) const { return weights[channel]; }
+
+    float Get(ThreatChannel channel, int row, int col) const {
+        if (row < 0 || row >= rows || col < 0 || col >= cols) return 0.0f;
+        return channels[channel][row * cols + col];
+    }
+    float GetCombined(int row, int col) const {
+        if (row < 0 || row >= rows || col < 0 || col >= cols) return 0.0f;
+        return combined[row * cols + col];
+    }
+
+    // rasters planos de rows * cols, fila por fila. el puntero vale hasta el
+    // siguiente Resize
+    const float* GetChannelData(ThreatChannel channel) const { return channels[channel].data(); }
+    const float* GetCombinedData() const { return combined.data(); }
+
+    float GetMaxCombined() const;
+
+    const Stats& GetStats() const { return stats; }
+    void ResetStats() { stats = Stats(); }
+
+private:
+    int rows;
+    int cols;
+    std::vector<float> channels[THREAT_CHANNEL_COUNT];
+    std::vector<float> combined;
+    float weights[THREAT_CHANNEL_COUNT];
+    std::vector<int> halfWidth; // scratch: ancho del disco en cada fila
+    Stats stats;
+};
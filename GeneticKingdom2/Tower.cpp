@@ -7,7 +7,10 @@
 #include "framework.h"
 #include "Tower.h"
 #include "Enemy.h" // necesitamos esto para que las torres puedan atacar enemigos
+#include "SpatialHash.h"
+#include "GdiplusAssetLoader.h"
 #include <cmath>
+#include <algorithm>
 #include "Map.h" // para los objetivos falsos que usan las torres
 #include <random> // para generar numeros aleatorios 
 #include <cstdlib> // mas random porque nunca es suficiente
@@ -18,22 +21,20 @@
 // row y col son la posicion en el mapa, porque windows es especial y usa matrices
 Tower::Tower(TowerType type, int row, int col)
     : type(type), level(TowerLevel::LEVEL_1), row(row), col(col), 
-      attackCooldown(0.0f), pTowerImage(NULL), showRange(false)
+      attackCooldown(0.0f), showRange(false)
 {
-    LoadImage();
 }
 
 // el destructor mas basura del mundo
-// ni siquiera borra la imagen porque gdi+ se encarga de eso
-// que conveniente, no?
+// la imagen es del AssetCache, asi que no hay nada que borrar
 Tower::~Tower()
 {
-    pTowerImage = NULL;
 }
 
 // Dibuja la torre en la posición especificada
 void Tower::Draw(HDC hdc, int cellSize)
 {
+    Gdiplus::Image* pTowerImage = AssetCache::Instance().GetAs<Gdiplus::Image>(GetAssetId());
     if (pTowerImage && pTowerImage->GetLastStatus() == Gdiplus::Ok) {
         try {
             Gdiplus::Graphics graphics(hdc);
@@ -42,25 +43,19 @@ void Tower::Draw(HDC hdc, int cellSize)
             graphics.SetSmoothingMode(Gdiplus::SmoothingModeHighQuality);
             graphics.SetInterpolationMode(Gdiplus::InterpolationModeHighQualityBicubic);
             
-            // Dibujar la imagen en la posición de la celda
-            graphics.DrawImage(
-                pTowerImage,
-                Gdiplus::Rect(col * cellSize, row * cellSize, cellSize, cellSize), // Destino
-                0, 0, pTowerImage->GetWidth(), pTowerImage->GetHeight(), // Fuente
-                Gdiplus::UnitPixel
-            );
+            // Dibujar la imagen en la posición de la celda (1:1 si viene de Sprites.pak)
+            const int spriteSize = GetAssetDrawSize(GetAssetId(), cellSize);
+            DrawSprite(graphics, pTowerImage, Gdiplus::Rect(col * cellSize, row * cellSize, spriteSize, spriteSize));
         }
         catch (...) {
-            // Si ocurre alguna excepción al dibujar, solo marcamos el puntero como NULL
-            // pero no lo eliminamos, ya que GDI+ se encargará de eso
+            // la imagen es del AssetCache, solo avisamos
             OutputDebugStringW(L"Error al dibujar la imagen de la torre\n");
-            pTowerImage = NULL;
         }
     }
 }
 
-// puta que es facil mejorar una torre, solo hay que subirle el nivel
-// y cargar una imagen nueva, que podria malir sal?
+// puta que es facil mejorar una torre, solo hay que subirle el nivel.
+// la imagen nueva la da el AssetCache al dibujar
 bool Tower::Upgrade()
 {
     if (level == TowerLevel::LEVEL_3) {
@@ -69,8 +64,6 @@ bool Tower::Upgrade()
     
     level = static_cast<TowerLevel>(static_cast<int>(level) + 1);
     
-    LoadImage();
-    
     return true;
 }
 
@@ -105,84 +98,18 @@ bool Tower::CanUpgrade() const
     return level != TowerLevel::LEVEL_3;
 }
 
-// esta funcion es un puto desastre
-// intenta cargar una imagen desde 500 lugares diferentes
-// porque windows es una mierda y no sabe donde estan los archivos
-bool Tower::LoadImage()
+// que sprite le toca segun tipo y nivel
+AssetId Tower::GetAssetId() const
 {
-    pTowerImage = NULL;
-
-    std::wstring fileName;
-    
+    int levelOffset = static_cast<int>(level) - 1;
     switch (type) {
-    case TowerType::ARCHER:
-        fileName = L"Archerlvl";
-        break;
-    case TowerType::GUNNER:
-        fileName = L"Gunnerlvl";
-        break;
     case TowerType::MAGE:
-        fileName = L"Magelvl";
-        break;
-    }
-    
-    fileName += std::to_wstring(static_cast<int>(level));
-    fileName += L".png";
-    
-    const wchar_t* possiblePaths[] = {
-        L"Assets\\Towers\\",
-        L"..\\GeneticKingdom2\\Assets\\Towers\\",
-        L"GeneticKingdom2\\Assets\\Towers\\",
-        L"C:\\Users\\Admin\\source\\repos\\GeneticKingdom2\\GeneticKingdom2\\Assets\\Towers\\"
-    };
-    
-    for (const wchar_t* basePath : possiblePaths) {
-        std::wstring fullPath = basePath + fileName;
-        Gdiplus::Image* tempImage = Gdiplus::Image::FromFile(fullPath.c_str());
-        
-        if (tempImage && tempImage->GetLastStatus() == Gdiplus::Ok) {
-            pTowerImage = tempImage;
-            
-            WCHAR debugMsg[256];
-            swprintf_s(debugMsg, L"Imagen de torre cargada correctamente: %s\n", fullPath.c_str());
-            OutputDebugStringW(debugMsg);
-            return true;
-        }
-        else if (tempImage) {
-            tempImage = NULL;
-        }
-    }
-    
-    WCHAR exePath[MAX_PATH];
-    GetModuleFileNameW(NULL, exePath, MAX_PATH);
-    
-    WCHAR* lastSlash = wcsrchr(exePath, L'\\');
-    if (lastSlash != NULL) {
-        *(lastSlash + 1) = L'\0';
-        
-        std::wstring fullPath = exePath;
-        fullPath += L"Assets\\Towers\\";
-        fullPath += fileName;
-        
-        Gdiplus::Image* tempImage = Gdiplus::Image::FromFile(fullPath.c_str());
-        
-        if (tempImage && tempImage->GetLastStatus() == Gdiplus::Ok) {
-            pTowerImage = tempImage;
-            
-            WCHAR debugMsg[256];
-            swprintf_s(debugMsg, L"Imagen de torre cargada correctamente: %s\n", fullPath.c_str());
-            OutputDebugStringW(debugMsg);
-            return true;
-        }
-        else if (tempImage) {
-            tempImage = NULL;
-        }
+        return static_cast<AssetId>(static_cast<int>(AssetId::TOWER_MAGE_1) + levelOffset);
+    case TowerType::GUNNER:
+        return static_cast<AssetId>(static_cast<int>(AssetId::TOWER_GUNNER_1) + levelOffset);
+    default:
+        return static_cast<AssetId>(static_cast<int>(AssetId::TOWER_ARCHER_1) + levelOffset);
     }
-    
-    WCHAR errorMsg[256];
-    swprintf_s(errorMsg, L"Error al cargar la imagen de la torre: %s\n", fileName.c_str());
-    OutputDebugStringW(errorMsg);
-    return false;
 }
 
 // Obtiene el rango de ataque (en celdas)
@@ -346,61 +273,137 @@ ProjectileType Tower::GetProjectileType() const
     return baseProjectileType;
 }
 
-// aqui esta la funcion que actualiza las torres y dispara a los enemigos
-// esta mierda es un desastre pero funciona, asi que no la toques
-// si la tocas y se rompe, es tu culpa, no la mia
-void Tower::Update(float deltaTime, ProjectileManager& projectileManager, int cellSize, const std::vector<Enemy>& enemies)
+// lo mismo que mira FindTarget con t = 0, en la forma que usa TargetKernel
+TargetKernel::Query Tower::GetTargetQuery(int cellSize) const
 {
-    if (attackCooldown > 0) {
-        attackCooldown -= deltaTime;
-        if (attackCooldown < 0) {
-            attackCooldown = 0;
-        }
-    }
-    
-    if (attackCooldown <= 0 && !enemies.empty()) {
-        int range = GetRange();
-        float towerCenterX = (col + 0.5f) * cellSize;
-        float towerCenterY = (row + 0.5f) * cellSize;
+    float rangePixels = static_cast<float>(GetRange() * cellSize);
+    TargetKernel::Query query;
+    query.x = (col + 0.5f) * cellSize;
+    query.y = (row + 0.5f) * cellSize;
+    query.rangeSq = rangePixels * rangePixels;
+    query.skipFlying = (type == TowerType::GUNNER);
+    return query;
+}
 
-        const Enemy* closestEnemy = nullptr;
-        float minDistanceSq = FLT_MAX;
+// cada cuanto se vuelve a buscar objetivo dentro de un paso largo sin nadie a tiro
+const float TARGET_PROBE_INTERVAL = 1.0f / 30.0f;
 
-        for (const auto& enemy : enemies) {
-            if (!enemy.IsActive() || !enemy.IsAlive()) {
-                continue;
-            }
+// el enemigo mas cercano en rango dentro de t segundos (t = 0: donde esta
+// ahora). devuelve donde va a estar en outX/outY. a igual distancia gana el
+// de menor indice, asi da lo mismo con lista de candidatos, con grid o sin nada
+const Enemy* Tower::FindTarget(const std::vector<Enemy>& enemies, const SpatialHash* enemyGrid,
+                               const TargetCandidates* candidates, int cellSize, float t,
+                               float& outX, float& outY) const
+{
+    float towerCenterX = (col + 0.5f) * cellSize;
+    float towerCenterY = (row + 0.5f) * cellSize;
+    float rangePixels = static_cast<float>(GetRange() * cellSize);
 
-            if (type == TowerType::GUNNER && enemy.IsFlying()) {
-                continue; 
-            }
+    size_t closestIndex = enemies.size();
+    float minDistanceSq = FLT_MAX;
+
+    auto consider = [&](size_t index) {
+        const Enemy& enemy = enemies[index];
+        if (!enemy.IsActive() || !enemy.IsAlive()) {
+            return;
+        }
 
-            float dx = enemy.GetX() - towerCenterX;
-            float dy = enemy.GetY() - towerCenterY;
-            float distanceSq = dx * dx + dy * dy;
-            float rangePixels = static_cast<float>(range * cellSize);
+        if (type == TowerType::GUNNER && enemy.IsFlying()) {
+            return; 
+        }
+
+        float enemyX = enemy.GetX();
+        float enemyY = enemy.GetY();
+        if (t > 0.0f && !enemy.PredictPosition(t, enemyX, enemyY)) {
+            return; // para entonces ya llego al puente
+        }
+        float dx = enemyX - towerCenterX;
+        float dy = enemyY - towerCenterY;
+        float distanceSq = dx * dx + dy * dy;
+
+        if (distanceSq <= (rangePixels * rangePixels) &&
+            (distanceSq < minDistanceSq || (distanceSq == minDistanceSq && index < closestIndex))) {
+            closestIndex = index;
+            minDistanceSq = distanceSq;
+            outX = enemyX;
+            outY = enemyY;
+        }
+    };
 
-            if (distanceSq <= (rangePixels * rangePixels) && distanceSq < minDistanceSq) {
-                closestEnemy = &enemy;
-                minDistanceSq = distanceSq;
+    if (candidates && t <= candidates->validFor) {
+        // los de las celdas que cubre la torre; nadie de afuera llega a tiro tan rapido
+        for (size_t k = 0; k < candidates->count; ++k) {
+            uint32_t index = candidates->indices[k];
+            if (index < enemies.size()) consider(index);
+        }
+    } else if (enemyGrid) {
+        // solo los que pueden llegar a estar en rango dentro de t
+        float reach = rangePixels + enemyGrid->GetMaxSpeed() * t;
+        enemyGrid->ForEachInRadius(towerCenterX, towerCenterY, reach, [&](uint32_t index, float, float, float) {
+            if (index < enemies.size()) consider(index);
+        });
+    } else {
+        for (size_t i = 0; i < enemies.size(); ++i) {
+            consider(i);
+        }
+    }
+    return closestIndex < enemies.size() ? &enemies[closestIndex] : nullptr;
+}
+
+// aqui esta la funcion que actualiza las torres y dispara a los enemigos
+// esta mierda es un desastre pero funciona, asi que no la toques
+// si la tocas y se rompe, es tu culpa, no la mia
+//
+// attackCooldown es cuanto falta para el proximo disparo desde el inicio del
+// paso. si el paso es mas largo que el intervalo salen varios disparos en el
+// mismo Update, cada uno en su momento (el proyectil espera launchDelay antes
+// de moverse) y apuntando a donde va a estar el enemigo entonces. asi un paso
+// de 1 s dispara lo mismo que treinta de 1/30
+void Tower::Update(float deltaTime, ProjectileManager& projectileManager, int cellSize, const std::vector<Enemy>& enemies,
+                   const SpatialHash* enemyGrid, const TargetCandidates* candidates)
+{
+    const float interval = 1.0f / GetAttackSpeed();
+    float shotTime = attackCooldown > 0.0f ? attackCooldown : 0.0f;
+    bool idle = false;
+
+    while (shotTime <= 0.0f || shotTime < deltaTime) {
+        float targetX = 0.0f;
+        float targetY = 0.0f;
+        bool found = false;
+        if (shotTime <= 0.0f && candidates && candidates->nearestKnown) {
+            // ya lo busco TargetKernel junto con las demas torres
+            found = candidates->nearestNow >= 0 && static_cast<size_t>(candidates->nearestNow) < enemies.size();
+            if (found) {
+                targetX = enemies[candidates->nearestNow].GetX();
+                targetY = enemies[candidates->nearestNow].GetY();
             }
+        } else {
+            found = !enemies.empty() && FindTarget(enemies, enemyGrid, candidates, cellSize, shotTime, targetX, targetY);
         }
-        
-        if (closestEnemy) {
-            int targetEnemyCellCol = static_cast<int>(closestEnemy->GetX() / cellSize);
-            int targetEnemyCellRow = static_cast<int>(closestEnemy->GetY() / cellSize);
-
-            projectileManager.AddProjectile(
-                GetProjectileType(),
-                row, col,                       
-                targetEnemyCellRow, targetEnemyCellCol, 
-                cellSize,
-                closestEnemy->GetX(), closestEnemy->GetY()
-            );
-            
-            attackCooldown = 1.0f / GetAttackSpeed();
+        if (!found) {
+            // nadie a tiro: se vuelve a mirar un poco mas adelante dentro del paso
+            idle = true;
+            shotTime += TARGET_PROBE_INTERVAL;
+            continue;
         }
+        idle = false;
+
+        int targetEnemyCellCol = static_cast<int>(targetX / cellSize);
+        int targetEnemyCellRow = static_cast<int>(targetY / cellSize);
+
+        projectileManager.AddProjectile(
+            GetProjectileType(),
+            row, col,                       
+            targetEnemyCellRow, targetEnemyCellCol, 
+            cellSize,
+            targetX, targetY,
+            shotTime
+        );
+        shotTime += interval;
     }
+
+    // sin objetivo queda lista para disparar apenas aparezca alguien
+    attackCooldown = idle ? 0.0f : shotTime - deltaTime;
 }
 
 // muestra u oculta el rango de la torre, por si eres ciego y no lo ves
@@ -421,6 +424,7 @@ bool Tower::IsShowingRange() const
 //////////////////////////////////////////////////////////////
 
 TowerManager::TowerManager()
+    : coverageCellSize(0), coverageEnabled(false)
 {
 }
 
@@ -435,6 +439,33 @@ void TowerManager::Initialize()
 {
 }
 
+// la cobertura se marca con una celda de margen sobre el rango: un enemigo que
+// arranca el paso fuera de esas celdas no entra en rango antes de recorrer eso
+const int COVERAGE_MARGIN_CELLS = 1;
+
+// arma el indice de cobertura para el mapa y marca las torres que ya hay
+void TowerManager::SetGrid(int rows, int cols, int cellSize)
+{
+    coverageCellSize = cellSize;
+    coverage.Resize(rows, cols, static_cast<float>(cellSize));
+    for (size_t i = 0; i < towers.size(); ++i) {
+        UpdateCoverage(static_cast<int>(i));
+    }
+}
+
+// solo se tocan las celdas del disco de esta torre
+void TowerManager::UpdateCoverage(int id)
+{
+    if (!coverage.IsReady()) {
+        return;
+    }
+    const Tower* tower = towers[id];
+    float centerX = (tower->GetCol() + 0.5f) * coverageCellSize;
+    float centerY = (tower->GetRow() + 0.5f) * coverageCellSize;
+    float radius = static_cast<float>((tower->GetRange() + COVERAGE_MARGIN_CELLS) * coverageCellSize);
+    coverage.SetTower(id, centerX, centerY, radius);
+}
+
 // agrega una torre nueva, si ya hay una ahi te manda a la shi
 bool TowerManager::AddTower(TowerType type, int row, int col)
 {
@@ -444,6 +475,7 @@ bool TowerManager::AddTower(TowerType type, int row, int col)
     
     Tower* newTower = new Tower(type, row, col);
     towers.push_back(newTower);
+    UpdateCoverage(static_cast<int>(towers.size() - 1));
     
     return true;
 }
@@ -457,7 +489,18 @@ bool TowerManager::UpgradeTower(int row, int col)
         return false;
     }
     
-    return tower->Upgrade();
+    if (!tower->Upgrade()) {
+        return false;
+    }
+
+    // con el nivel puede cambiar el rango
+    for (size_t i = 0; i < towers.size(); ++i) {
+        if (towers[i] == tower) {
+            UpdateCoverage(static_cast<int>(i));
+            break;
+        }
+    }
+    return true;
 }
 
 // dibuja todas las torres, si no se ven es tu problema
@@ -468,6 +511,15 @@ void TowerManager::DrawTowers(HDC hdc, int cellSize)
     }
 }
 
+float TowerManager::GetShotsPerSecond() const
+{
+    float shots = 0.0f;
+    for (const Tower* tower : towers) {
+        shots += tower->GetAttackSpeed();
+    }
+    return shots;
+}
+
 // comprueba si hay una torre en esa posicion, util para no cagarla
 bool TowerManager::HasTower(int row, int col) const
 {
@@ -495,10 +547,70 @@ void TowerManager::DrawTowerRanges(HDC hdc, int cellSize)
 }
 
 // Actualiza la lógica de todas las torres (apuntando a enemigos)
-void TowerManager::Update(float deltaTime, ProjectileManager& projectileManager, int cellSize, const std::vector<Enemy>& enemies)
+void TowerManager::Update(float deltaTime, ProjectileManager& projectileManager, int cellSize, const std::vector<Enemy>& enemies,
+                          SpatialHash* enemyGrid)
 {
-    for (auto& tower : towers) {
-        tower->Update(deltaTime, projectileManager, cellSize, enemies);
+    // copia plana de los enemigos vivos: una sola pasada por los Enemy
+    float maxEnemySpeed = 0.0f;
+    targetKernel.Build(enemies.size(), [&](size_t i, float& x, float& y, bool& flying) {
+        const Enemy& enemy = enemies[i];
+        if (!enemy.IsActive() || !enemy.IsAlive()) {
+            return false;
+        }
+        x = enemy.GetX();
+        y = enemy.GetY();
+        flying = enemy.IsFlying();
+        maxEnemySpeed = (std::max)(maxEnemySpeed, enemy.GetSpeed());
+        return true;
+    });
+
+    // el grid (y la cobertura, si esta prendida) salen de la copia, no de
+    // volver a recorrer los Enemy
+    if (enemyGrid) {
+        enemyGrid->Build(targetKernel.GetCount(), targetKernel.GetIndices(), targetKernel.GetXs(), targetKernel.GetYs());
+        enemyGrid->SetMaxSpeed(maxEnemySpeed);
+    }
+
+    // las torres que pueden tirar ya buscan objetivo todas juntas
+    readyQueries.clear();
+    readyTowers.clear();
+    for (size_t i = 0; i < towers.size(); ++i) {
+        if (towers[i]->IsReadyToFire()) {
+            readyQueries.push_back(towers[i]->GetTargetQuery(cellSize));
+            readyTowers.push_back(i);
+        }
+    }
+    readyTargets.resize(readyQueries.size());
+    if (!readyQueries.empty()) {
+        targetKernel.FindNearest(readyQueries.data(), readyQueries.size(), readyTargets.data());
+    }
+
+    // cada enemigo queda anotado en las torres que cubren su celda (solo si
+    // se pidio, si no alcanza con enemyGrid)
+    bool useCoverage = coverageEnabled && coverage.IsReady() && cellSize == coverageCellSize;
+    if (useCoverage) {
+        coverage.Bin(targetKernel.GetCount(), targetKernel.GetIndices(), targetKernel.GetXs(), targetKernel.GetYs());
+    }
+
+    // hasta cuando dentro del paso alcanza con las listas: nadie recorre mas
+    // que el margen de cobertura
+    TargetCandidates candidates;
+    candidates.indices = nullptr;
+    candidates.count = 0;
+    candidates.validFor = -1.0f;
+    if (useCoverage) {
+        float margin = static_cast<float>(COVERAGE_MARGIN_CELLS * cellSize);
+        candidates.validFor = maxEnemySpeed > 0.0f ? margin / maxEnemySpeed : FLT_MAX;
+    }
+
+    size_t nextReady = 0;
+    for (size_t i = 0; i < towers.size(); ++i) {
+        if (useCoverage) {
+            candidates.indices = coverage.GetCandidates(static_cast<int>(i), candidates.count);
+        }
+        candidates.nearestKnown = nextReady < readyTowers.size() && readyTowers[nextReady] == i;
+        candidates.nearestNow = candidates.nearestKnown ? readyTargets[nextReady++] : -1;
+        towers[i]->Update(deltaTime, projectileManager, cellSize, enemies, enemyGrid, &candidates);
     }
 }
 
@@ -9,10 +9,14 @@
 
 // Incluir el gestor de proyectiles
 #include "Projectile.h"
+#include "TowerCoverage.h"
+#include "TargetKernel.h"
+#include "AssetCache.h"
 
 // Forward declaration para evitar inclusión circular
 struct DummyTarget;
 class Enemy; // Forward declare Enemy class
+class SpatialHash;
 
 // Definición de tipos de torre
 enum class TowerType {
@@ -28,6 +32,19 @@ enum class TowerLevel {
     LEVEL_3 = 3
 };
 
+// lo que TowerManager ya averiguo para una torre al empezar el paso.
+// indices: enemigos que pueden estar a tiro (indices en el vector de enemigos,
+// crecientes) sacados del indice de cobertura; sirven para disparos hasta
+// validFor segundos adentro del paso. nearestNow: el mas cercano a tiro ahora
+// mismo (-1 nadie), si nearestKnown
+struct TargetCandidates {
+    const uint32_t* indices;
+    size_t count;
+    float validFor;
+    bool nearestKnown;
+    int32_t nearestNow;
+};
+
 // Clase para manejar una torre individual
 class Tower {
 public:
@@ -70,9 +87,18 @@ public:
     // Actualiza la lógica de la torre e intenta disparar si es posible (hacia la dirección por defecto)
     void Update(float deltaTime, ProjectileManager& projectileManager, int cellSize);
     
-    // Actualiza la lógica de la torre e intenta disparar hacia el enemigo más cercano
-    void Update(float deltaTime, ProjectileManager& projectileManager, int cellSize, const std::vector<Enemy>& enemies);
+    // Actualiza la lógica de la torre e intenta disparar hacia el enemigo más cercano.
+    // con enemyGrid (armado sobre el mismo vector) solo mira a los que estan cerca,
+    // con candidates solo a los de las celdas que cubre
+    void Update(float deltaTime, ProjectileManager& projectileManager, int cellSize, const std::vector<Enemy>& enemies,
+                const SpatialHash* enemyGrid = nullptr, const TargetCandidates* candidates = nullptr);
     
+    // si puede disparar apenas empieza el proximo paso
+    bool IsReadyToFire() const { return attackCooldown <= 0.0f; }
+
+    // centro y rango para buscarle objetivo con TargetKernel
+    TargetKernel::Query GetTargetQuery(int cellSize) const;
+
     // Muestra/oculta el rango de la torre
     void SetShowRange(bool show);
     
@@ -80,18 +106,22 @@ public:
     bool IsShowingRange() const;
 
 private:
-    // Carga la imagen adecuada para el tipo y nivel de torre
-    bool LoadImage();
+    // sprite del tipo y nivel en el AssetCache
+    AssetId GetAssetId() const;
     
     // Obtiene el tipo de proyectil para esta torre
     ProjectileType GetProjectileType() const;
 
+    // Enemigo mas cercano en rango dentro de t segundos, y donde va a estar
+    const Enemy* FindTarget(const std::vector<Enemy>& enemies, const SpatialHash* enemyGrid,
+                            const TargetCandidates* candidates, int cellSize, float t,
+                            float& outX, float& outY) const;
+
     TowerType type;                // Tipo de torre
     TowerLevel level;              // Nivel actual de la torre
     int row;                       // Fila en la cuadrícula
     int col;                       // Columna en la cuadrícula
     float attackCooldown;          // Tiempo restante para el próximo ataque
-    Gdiplus::Image* pTowerImage;   // Imagen de la torre
     bool showRange;                // Indica si se debe mostrar el rango
 };
 
@@ -104,6 +134,16 @@ public:
     // Inicializa el gestor de torres
     void Initialize();
 
+    // tamaño del mapa para el indice de cobertura. sin esto las torres
+    // buscan con el grid de enemigos o mirando a todos
+    void SetGrid(int rows, int cols, int cellSize);
+
+    // buscar objetivo con las listas de cobertura en vez del grid de enemigos.
+    // apagado por defecto: repartir a los enemigos entre las listas con 60
+    // torres sale mas caro que consultar enemyGrid
+    void SetUseCoverage(bool enabled) { coverageEnabled = enabled; }
+    bool IsUsingCoverage() const { return coverageEnabled; }
+
     // Agrega una nueva torre en la posición especificada
     bool AddTower(TowerType type, int row, int col);
 
@@ -125,8 +165,11 @@ public:
     // Actualiza la lógica de todas las torres (disparo por defecto)
     void Update(float deltaTime, ProjectileManager& projectileManager, int cellSize);
     
-    // Actualiza la lógica de todas las torres (apuntando a enemigos)
-    void Update(float deltaTime, ProjectileManager& projectileManager, int cellSize, const std::vector<Enemy>& enemies);
+    // Actualiza la lógica de todas las torres (apuntando a enemigos). los
+    // enemigos se leen una sola vez por tick; si viene enemyGrid se arma aca
+    // con esa misma copia y queda listo para los proyectiles
+    void Update(float deltaTime, ProjectileManager& projectileManager, int cellSize, const std::vector<Enemy>& enemies,
+                SpatialHash* enemyGrid = nullptr);
     
     // Activa la visualización del rango para una torre específica
     void ShowRangeForTower(int row, int col);
@@ -137,6 +180,23 @@ public:
     // Obtiene el número total de torres
     size_t GetTowerCount() const { return towers.size(); }
 
+    // disparos por segundo sumando todas las torres
+    float GetShotsPerSecond() const;
+
+    const TowerCoverage& GetCoverage() const { return coverage; }
+
 private:
+    // vuelve a marcar las celdas que cubre la torre id (indice en towers)
+    void UpdateCoverage(int id);
+
     std::vector<Tower*> towers;  // Vector de torres
+    TowerCoverage coverage;      // celda -> torres que la alcanzan
+    int coverageCellSize;
+    bool coverageEnabled;
+
+    // objetivo de las torres listas para tirar, todas juntas sobre arreglos planos
+    TargetKernel targetKernel;
+    std::vector<TargetKernel::Query> readyQueries;
+    std::vector<size_t> readyTowers;    // indices en towers, crecientes
+    std::vector<int32_t> readyTargets;
 }; 
\ No newline at end of file
@@ -0,0 +1,206 @@
+// indice celda -> torres que la cubren
+
+#include "TowerCoverage.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+// indice del bit prendido mas bajo (bits no puede ser 0)
+inline int LowestBit(uint64_t bits)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+#if defined(_WIN64)
+    _BitScanForward64(&index, bits);
+#else
+    if (!_BitScanForward(&index, static_cast<unsigned long>(bits))) {
+        _BitScanForward(&index, static_cast<unsigned long>(bits >> 32));
+        index += 32;
+    }
+#endif
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+} // namespace
+
+TowerCoverage::TowerCoverage()
+    : rows(0), cols(0), cellSize(1.0f), maskWords(0), binnedOutside(0)
+{
+}
+
+void TowerCoverage::Resize(int newRows, int newCols, float newCellSize)
+{
+    rows = newRows > 0 ? newRows : 0;
+    cols = newCols > 0 ? newCols : 0;
+    cellSize = newCellSize > 0.0f ? newCellSize : 1.0f;
+    const size_t cellCount = static_cast<size_t>(rows) * static_cast<size_t>(cols);
+    maskWords = (cellCount + 63) / 64;
+    cellTowers.assign(cellCount, std::vector<int>());
+    masks.clear();
+    candidateStart.clear();
+    candidateIndex.clear();
+}
+
+void TowerCoverage::EnsureTower(int id)
+{
+    if (static_cast<size_t>(id) >= masks.size()) {
+        masks.resize(id + 1);
+    }
+    if (masks[id].size() != maskWords) {
+        masks[id].assign(maskWords, 0);
+    }
+}
+
+// solo se tocan las celdas donde la mascara vieja y la nueva no coinciden
+void TowerCoverage::ApplyMask(int id, const std::vector<uint64_t>& mask)
+{
+    std::vector<uint64_t>& current = masks[id];
+    for (size_t w = 0; w < maskWords; ++w) {
+        uint64_t changed = current[w] ^ mask[w];
+        while (changed) {
+            const int bit = LowestBit(changed);
+            changed &= changed - 1;
+
+            std::vector<int>& towers = cellTowers[w * 64 + bit];
+            auto it = std::lower_bound(towers.begin(), towers.end(), id);
+            if ((mask[w] >> bit) & 1ull) {
+                towers.insert(it, id);
+            } else if (it != towers.end() && *it == id) {
+                towers.erase(it);
+            }
+            stats.cellsChanged++;
+        }
+        current[w] = mask[w];
+    }
+}
+
+void TowerCoverage::SetTower(int id, float centerX, float centerY, float radius)
+{
+    if (!IsReady() || id < 0) {
+        return;
+    }
+    EnsureTower(id);
+    stats.discUpdates++;
+
+    newMask.assign(maskWords, 0);
+    const float radiusSq = radius * radius;
+    const int r0 = (std::max)(0, static_cast<int>(std::floor((centerY - radius) / cellSize)));
+    const int r1 = (std::min)(rows - 1, static_cast<int>(std::floor((centerY + radius) / cellSize)));
+    const int c0 = (std::max)(0, static_cast<int>(std::floor((centerX - radius) / cellSize)));
+    const int c1 = (std::min)(cols - 1, static_cast<int>(std::floor((centerX + radius) / cellSize)));
+    for (int r = r0; r <= r1; ++r) {
+        // punto de la celda mas cercano al centro
+        const float top = r * cellSize;
+        const float ny = (std::max)(top, (std::min)(centerY, top + cellSize));
+        const float dy = ny - centerY;
+        for (int c = c0; c <= c1; ++c) {
+            const float left = c * cellSize;
+            const float nx = (std::max)(left, (std::min)(centerX, left + cellSize));
+            const float dx = nx - centerX;
+            if (dx * dx + dy * dy <= radiusSq) {
+                const size_t cell = static_cast<size_t>(r) * cols + c;
+                newMask[cell / 64] |= 1ull << (cell % 64);
+            }
+        }
+    }
+    ApplyMask(id, newMask);
+}
+
+void TowerCoverage::RemoveTower(int id)
+{
+    if (!IsReady() || id < 0 || static_cast<size_t>(id) >= masks.size()) {
+        return;
+    }
+    stats.discUpdates++;
+    newMask.assign(maskWords, 0);
+    ApplyMask(id, newMask);
+}
+
+const std::vector<int>& TowerCoverage::GetTowersAt(int row, int col) const
+{
+    static const std::vector<int> none;
+    if (row < 0 || row >= rows || col < 0 || col >= cols) {
+        return none;
+    }
+    return cellTowers[row * cols + col];
+}
+
+bool TowerCoverage::Covers(int id, int row, int col) const
+{
+    if (id < 0 || static_cast<size_t>(id) >= masks.size() || row < 0 || row >= rows || col < 0 || col >= cols) {
+        return false;
+    }
+    const size_t cell = static_cast<size_t>(row) * cols + col;
+    return (masks[id][cell / 64] >> (cell % 64)) & 1ull;
+}
+
+const uint32_t* TowerCoverage::GetCandidates(int id, size_t& count) const
+{
+    if (id < 0 || static_cast<size_t>(id) + 1 >= candidateStart.size()) {
+        count = 0;
+        return nullptr;
+    }
+    count = candidateStart[id + 1] - candidateStart[id];
+    return candidateIndex.data() + candidateStart[id];
+}
+
+bool TowerCoverage::BeginBin()
+{
+    stats.bins++;
+    candidateStart.assign(masks.size() + 1, 0);
+    candidateIndex.clear();
+    binnedIndex.clear();
+    binnedCell.clear();
+    binnedOutside = 0;
+    return IsReady();
+}
+
+void TowerCoverage::Bin(size_t count, const uint32_t* indices, const float* xs, const float* ys)
+{
+    if (!BeginBin()) {
+        return;
+    }
+    for (size_t k = 0; k < count; ++k) {
+        AddPoint(indices[k], xs[k], ys[k]);
+    }
+    FinishBin();
+}
+
+void TowerCoverage::FinishBin()
+{
+    const size_t towerCount = masks.size();
+    stats.binned += binnedIndex.size();
+    if (binnedOutside > 0) {
+        for (size_t id = 0; id < towerCount; ++id) {
+            candidateStart[id + 1] += static_cast<uint32_t>(binnedOutside);
+        }
+    }
+
+    // prefijo y reparto, en orden de llegada
+    for (size_t id = 0; id < towerCount; ++id) {
+        candidateStart[id + 1] += candidateStart[id];
+    }
+    candidateIndex.resize(candidateStart[towerCount]);
+    stats.candidates += candidateIndex.size();
+    candidateFill.assign(candidateStart.begin(), candidateStart.end() - 1);
+    for (size_t p = 0; p < binnedIndex.size(); ++p) {
+        const uint32_t index = binnedIndex[p];
+        if (binnedCell[p] < 0) {
+            for (size_t id = 0; id < towerCount; ++id) {
+                candidateIndex[candidateFill[id]++] = index;
+            }
+            continue;
+        }
+        for (int id : cellTowers[binnedCell[p]]) {
+            candidateIndex[candidateFill[id]++] = index;
+        }
+    }
+}
@@ -0,0 +1,131 @@
+/*
+ * towercoverage.h - que torres alcanzan cada celda
+ *
+ * las torres solo se mueven (o cambian de rango) al construir o mejorar, pero
+ * cada frame cada torre volvia a mirar a todos los enemigos para ver quien
+ * esta en rango. esto guarda al reves, celda -> torres que la cubren, y por
+ * cada torre una mascara de bits de las celdas que cubre. construir o mejorar
+ * solo toca las celdas que cambian entre la mascara vieja y la nueva.
+ *
+ * por tick se pasa una sola vez por los enemigos (Bin): cada uno cae en su
+ * celda y se anota como candidato de las torres que la cubren. el trabajo es
+ * proporcional a los pares torre-enemigo que de verdad estan cerca, no a
+ * torres * enemigos. una celda cuenta como cubierta si cualquier punto de ella
+ * esta dentro del radio, asi que la prueba exacta de distancia la sigue
+ * haciendo la torre.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+class TowerCoverage {
+public:
+    struct Stats {
+        unsigned long long discUpdates = 0;  // SetTower / RemoveTower
+        unsigned long long cellsChanged = 0; // celdas que ganaron o perdieron una torre
+        unsigned long long bins = 0;         // pasadas de Bin
+        unsigned long long binned = 0;       // puntos repartidos en esas pasadas
+        unsigned long long candidates = 0;   // pares torre-punto anotados
+    };
+
+    TowerCoverage();
+
+    // grid de rows x cols celdas de cellSize pixeles. borra todas las torres
+    void Resize(int rows, int cols, float cellSize);
+    bool IsReady() const { return rows > 0 && cols > 0; }
+
+    // la torre id cubre las celdas que tocan el disco de radius pixeles
+    // alrededor de (centerX, centerY). reemplaza lo que cubria antes
+    void SetTower(int id, float centerX, float centerY, float radius);
+    void RemoveTower(int id);
+
+    // torres que cubren la celda, ordenadas por id
+    const std::vector<int>& GetTowersAt(int row, int col) const;
+    bool Covers(int id, int row, int col) const;
+
+    // reparte count puntos entre las torres que cubren su celda.
+    // getPosition(i, x, y) devuelve false para saltear el punto i. los que caen
+    // fuera del grid van a todas las torres (no sabemos que cubren ahi afuera)
+    template <typename GetPosition>
+    void Bin(size_t count, GetPosition getPosition);
+
+    // lo mismo desde arreglos planos ya filtrados (la copia de TargetKernel):
+    // el punto k es el indice indices[k] en (xs[k], ys[k])
+    void Bin(size_t count, const uint32_t* indices, const float* xs, const float* ys);
+
+    // puntos anotados para la torre id en el ultimo Bin, por indice creciente.
+    // count queda en cuantos son; el puntero vale hasta el proximo Bin
+    const uint32_t* GetCandidates(int id, size_t& count) const;
+
+    const Stats& GetStats() const { return stats; }
+    void ResetStats() { stats = Stats(); }
+
+private:
+    int rows;
+    int cols;
+    float cellSize;
+    size_t maskWords;                         // uint64 por mascara
+
+    std::vector<std::vector<int>> cellTowers; // celda -> torres
+    std::vector<std::vector<uint64_t>> masks; // torre -> celdas cubiertas
+    std::vector<uint64_t> newMask;            // scratch de SetTower
+
+    // resultado del ultimo Bin: los de la torre id van de candidateStart[id]
+    // a candidateStart[id + 1] en candidateIndex
+    std::vector<uint32_t> candidateStart;
+    std::vector<uint32_t> candidateIndex;
+
+    // scratch de Bin
+    std::vector<uint32_t> binnedIndex;
+    std::vector<int> binnedCell;              // -1: fuera del grid
+    std::vector<uint32_t> candidateFill;
+    size_t binnedOutside;                     // puntos fuera del grid en este Bin
+
+    void EnsureTower(int id);
+    void ApplyMask(int id, const std::vector<uint64_t>& mask);
+
+    // Bin en tres partes: BeginBin (false si no hay grid), AddPoint por cada
+    // punto y FinishBin, que hace el prefijo y el reparto
+    bool BeginBin();
+    void AddPoint(uint32_t index, float x, float y);
+    void FinishBin();
+
+    Stats stats;
+};
+
+inline void TowerCoverage::AddPoint(uint32_t index, float x, float y)
+{
+    // contar cuantos le tocan a cada torre
+    const float inverseCellSize = 1.0f / cellSize;
+    int col = static_cast<int>(x * inverseCellSize);
+    int row = static_cast<int>(y * inverseCellSize);
+    int cell = -1;
+    if (x >= 0.0f && y >= 0.0f && row < rows && col < cols) {
+        cell = row * cols + col;
+        for (int id : cellTowers[cell]) {
+            candidateStart[id + 1]++;
+        }
+    } else {
+        binnedOutside++;
+    }
+    binnedIndex.push_back(index);
+    binnedCell.push_back(cell);
+}
+
+template <typename GetPosition>
+void TowerCoverage::Bin(size_t count, GetPosition getPosition)
+{
+    if (!BeginBin()) {
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        float x, y;
+        if (getPosition(i, x, y)) {
+            AddPoint(static_cast<uint32_t>(i), x, y);
+        }
+    }
+    FinishBin();
+}
@@ -0,0 +1,98 @@
+// reparto de trabajo entre hilos fijos
+
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(int threadCount)
+    : workerCount(threadCount), job(nullptr), jobCount(0), nextItem(0), busyWorkers(0), jobGeneration(0), stopping(false)
+{
+    if (workerCount <= 0) {
+        workerCount = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    workerCount = (std::max)(1, (std::min)(workerCount, static_cast<int>(WORKER_POOL_MAX_THREADS)));
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::Start()
+{
+    threads.reserve(workerCount - 1);
+    for (int worker = 1; worker < workerCount; ++worker) {
+        threads.push_back(std::thread(&WorkerPool::WorkerLoop, this, worker));
+    }
+}
+
+void WorkerPool::ParallelFor(int count, const std::function<void(int, int)>& body)
+{
+    if (count <= 0) {
+        return;
+    }
+    if (workerCount == 1 || count == 1) {
+        for (int item = 0; item < count; ++item) {
+            body(item, 0);
+        }
+        return;
+    }
+    if (threads.empty()) {
+        Start();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &body;
+        jobCount = count;
+        nextItem.store(0);
+        busyWorkers = static_cast<int>(threads.size());
+        jobGeneration++;
+    }
+    wake.notify_all();
+
+    RunItems(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return busyWorkers == 0; });
+    job = nullptr;
+}
+
+void WorkerPool::RunItems(int worker)
+{
+    for (;;) {
+        int item = nextItem.fetch_add(1);
+        if (item >= jobCount) {
+            return;
+        }
+        (*job)(item, worker);
+    }
+}
+
+void WorkerPool::WorkerLoop(int worker)
+{
+    uint64_t seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this, seenGeneration] { return stopping || jobGeneration != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = jobGeneration;
+        }
+        RunItems(worker);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busyWorkers == 0) {
+                done.notify_one();
+            }
+        }
+    }
+}
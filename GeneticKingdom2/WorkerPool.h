@@ -0,0 +1,57 @@
+/*
+ * workerpool.h - hilos fijos para repartir trabajo independiente
+ *
+ * los hilos se crean la primera vez que hay algo para repartir y se quedan
+ * dormidos entre tanda y tanda, asi no se paga crear hilos en cada consulta.
+ * el hilo que llama tambien trabaja (es el worker 0), asi que con un solo
+ * nucleo todo corre en el mismo hilo sin sincronizar nada.
+ *
+ * ParallelFor no es reentrante: una tanda a la vez, desde un solo hilo.
+ */
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+class WorkerPool {
+public:
+    // threadCount = 0 usa los nucleos de la maquina (hasta WORKER_POOL_MAX_THREADS)
+    explicit WorkerPool(int threadCount = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // cuantos workers hay contando al que llama; body recibe un worker en [0, esto)
+    int GetWorkerCount() const { return workerCount; }
+
+    // corre body(item, worker) para cada item en [0, count) y vuelve cuando
+    // terminaron todos. los items se reparten de a uno segun se van liberando
+    void ParallelFor(int count, const std::function<void(int, int)>& body);
+
+    static const int WORKER_POOL_MAX_THREADS = 16;
+
+private:
+    void Start();
+    void WorkerLoop(int worker);
+    void RunItems(int worker);
+
+    int workerCount;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    const std::function<void(int, int)>* job;
+    int jobCount;
+    std::atomic<int> nextItem;
+    int busyWorkers;
+    uint64_t jobGeneration;
+    bool stopping;
+};